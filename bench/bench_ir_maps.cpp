@@ -0,0 +1,142 @@
+// IRMaps: the former four std::unordered_maps vs the dense/flat tables.
+// Reports heap bytes and insert/lookup throughput for one side (DIE
+// offsets <-> IR type IDs) filled the way a reader fills it.
+//
+//   bench_ir_maps [entries]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "ir/IRMaps.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::size_t gAllocated = 0;
+
+// Counts what the node-based maps really allocate.
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+    T* allocate(std::size_t n) {
+        gAllocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) {
+        gAllocated -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+template <typename K, typename V>
+using CountedMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>,
+                                      CountingAllocator<std::pair<const K, V>>>;
+
+double Seconds(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double MopsPerSec(std::size_t ops, double secs) { return secs > 0 ? ops / secs / 1e6 : 0; }
+
+// DIE offsets grow with uneven gaps, as in .debug_info.
+std::vector<std::uint64_t> MakeOffsets(std::size_t count) {
+    std::vector<std::uint64_t> offsets(count);
+    std::uint64_t off = 0x0b;
+    for (std::size_t i = 0; i < count; ++i) {
+        offsets[i] = off;
+        off += 5 + (i * 2654435761u) % 40;
+    }
+    return offsets;
+}
+
+// A fixed pseudo-random probe order over [0, count).
+std::vector<std::size_t> MakeProbes(std::size_t count) {
+    std::vector<std::size_t> probes(count);
+    std::uint64_t x = 88172645463325252ull;
+    for (std::size_t& p : probes) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        p = static_cast<std::size_t>(x % count);
+    }
+    return probes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    if (!count) return 1;
+    std::vector<std::uint64_t> offsets = MakeOffsets(count);
+    std::vector<std::size_t> probes = MakeProbes(count);
+    std::uint64_t sink = 0;
+
+    // Before: node-based hash maps in both directions.
+    double hashInsert, hashToIR, hashFromIR;
+    std::size_t hashBytes;
+    {
+        CountedMap<std::uint64_t, IRTypeID> dieToIR;
+        CountedMap<IRTypeID, std::uint64_t> irToDie;
+        auto t0 = Clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            IRTypeID id = static_cast<IRTypeID>(i + 1);
+            dieToIR[offsets[i]] = id;
+            irToDie[id] = offsets[i];
+        }
+        hashInsert = Seconds(t0);
+        hashBytes = gAllocated;
+
+        t0 = Clock::now();
+        for (std::size_t p : probes) sink += dieToIR.find(offsets[p])->second;
+        hashToIR = Seconds(t0);
+        t0 = Clock::now();
+        for (std::size_t p : probes) sink += irToDie.find(static_cast<IRTypeID>(p + 1))->second;
+        hashFromIR = Seconds(t0);
+    }
+
+    // After: IRMaps, one insert at a time and bulk.
+    double flatInsert, bulkInsert, flatToIR, flatFromIR;
+    std::size_t flatBytes;
+    {
+        IRMaps maps;
+        auto t0 = Clock::now();
+        for (std::size_t i = 0; i < count; ++i) maps.linkDwarf(static_cast<IRTypeID>(i + 1), offsets[i]);
+        flatInsert = Seconds(t0);
+        flatBytes = maps.dwarfSideBytes();
+
+        t0 = Clock::now();
+        for (std::size_t p : probes) sink += maps.dwarfDieToIR.find(offsets[p]);
+        flatToIR = Seconds(t0);
+        t0 = Clock::now();
+        for (std::size_t p : probes) sink += *maps.irToDwarfDie.find(static_cast<IRTypeID>(p + 1));
+        flatFromIR = Seconds(t0);
+
+        std::vector<std::pair<std::uint64_t, IRTypeID>> pairs(count);
+        for (std::size_t i = 0; i < count; ++i) pairs[i] = {offsets[i], static_cast<IRTypeID>(i + 1)};
+        IRMaps bulk;
+        t0 = Clock::now();
+        bulk.linkDwarf(pairs);
+        bulkInsert = Seconds(t0);
+        sink += bulk.dwarfDieToIR.size();
+    }
+
+    std::cout << count << " DIE <-> IR pairs (checksum " << sink % 997 << ")\n"
+              << "unordered_map : " << hashBytes / 1024 << " KiB, insert " << MopsPerSec(count, hashInsert)
+              << " M/s, die->ir " << MopsPerSec(count, hashToIR) << " M/s, ir->die "
+              << MopsPerSec(count, hashFromIR) << " M/s\n"
+              << "IRMaps        : " << flatBytes / 1024 << " KiB, insert " << MopsPerSec(count, flatInsert)
+              << " M/s (bulk " << MopsPerSec(count, bulkInsert) << " M/s), die->ir "
+              << MopsPerSec(count, flatToIR) << " M/s, ir->die " << MopsPerSec(count, flatFromIR) << " M/s\n";
+    return 0;
+}
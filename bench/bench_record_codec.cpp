@@ -0,0 +1,292 @@
+// Record codec throughput: schema-driven decode/encode vs a hand-written
+// switch over leaf kinds, on a synthetic TPI-like stream; and DIE bodies
+// decoded through a dw:: schema vs form by form from the abbrev.
+//
+//   bench_record_codec [records]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dwarf/DwarfSchema.h"
+#include "pdb/CodeViewSchema.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<std::uint8_t> MakeStream(std::size_t records) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i < records; ++i) {
+        std::uint32_t ti = 0x1000 + static_cast<std::uint32_t>(i);
+        switch (i % 3) {
+        case 0:
+            cv::LfPointer::encode({ti - 1, 0x1000cu}, out);
+            break;
+        case 1:
+            cv::LfStructure::encode({std::uint16_t(4), std::uint16_t(0x200), ti - 1, 0u, 0u,
+                                     std::uint64_t(i * 8), "ns::Record", ".?AURecord@ns@@"}, out);
+            break;
+        default:
+            cv::LfArray::encode({ti - 2, 0x23u, std::uint64_t(i * 16), ""}, out);
+            break;
+        }
+    }
+    return out;
+}
+
+std::uint32_t Get32(const std::uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (std::uint32_t(p[3]) << 24);
+}
+std::uint16_t Get16(const std::uint8_t* p) { return static_cast<std::uint16_t>(p[0] | (p[1] << 8)); }
+
+// The pre-schema style: per-kind offsets and manual numeric leaves, with
+// the same length checks the schema performs (strings are bounded by the
+// record, as in the repo's other hand-written readers).
+std::uint64_t ManualNumeric(const std::uint8_t*& p) {
+    std::uint16_t leaf = Get16(p);
+    p += 2;
+    if (leaf < 0x8000) return leaf;
+    switch (leaf) {
+    case 0x8002: { std::uint64_t v = Get16(p); p += 2; return v; }
+    case 0x8004: { std::uint64_t v = Get32(p); p += 4; return v; }
+    default: p += 8; return 0;
+    }
+}
+
+std::uint64_t DecodeSwitch(const std::vector<std::uint8_t>& s) {
+    std::uint64_t sum = 0;
+    std::size_t at = 0;
+    while (at + 4 <= s.size()) {
+        std::uint16_t len = Get16(&s[at]);
+        std::uint16_t kind = Get16(&s[at + 2]);
+        const std::uint8_t* p = &s[at + 4];
+        const std::size_t body = len >= 2 ? len - 2u : 0;
+        if (at + 2 + len > s.size()) break;
+        const std::uint8_t* end = p + body;
+        auto str = [&](const std::uint8_t* q) -> std::size_t {
+            const void* nul = std::memchr(q, 0, static_cast<std::size_t>(end - q));
+            return nul ? static_cast<std::size_t>(static_cast<const std::uint8_t*>(nul) - q) : 0;
+        };
+        switch (kind) {
+        case 0x1002:
+            if (body < 8) break;
+            sum += Get32(p) + Get32(p + 4);
+            break;
+        case 0x1505: {
+            if (body < 18) break;
+            sum += Get32(p + 4);
+            p += 16;
+            sum += ManualNumeric(p);
+            std::size_t n = str(p);
+            sum += n;
+            p += n + 1;
+            if (p < end && *p < 0xF0) p += str(p) + 1; // unique name
+            break;
+        }
+        case 0x1503: {
+            if (body < 10) break;
+            sum += Get32(p) + Get32(p + 4);
+            p += 8;
+            sum += ManualNumeric(p);
+            sum += str(p);
+            break;
+        }
+        }
+        at += 2 + len;
+    }
+    return sum;
+}
+
+void Put16(std::vector<std::uint8_t>& out, std::uint16_t v) {
+    out.push_back(v & 0xff);
+    out.push_back(v >> 8);
+}
+void Put32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xff);
+}
+void PutNumeric(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    if (v < 0x8000) { Put16(out, static_cast<std::uint16_t>(v)); return; }
+    if (v <= 0xFFFF) { Put16(out, 0x8002); Put16(out, static_cast<std::uint16_t>(v)); return; }
+    Put16(out, 0x8004);
+    Put32(out, static_cast<std::uint32_t>(v));
+}
+void PutString(std::vector<std::uint8_t>& out, const char* s) {
+    out.insert(out.end(), s, s + std::strlen(s) + 1);
+}
+void FinishRecord(std::vector<std::uint8_t>& out, std::size_t start) {
+    while ((out.size() - start) % 4) out.push_back(static_cast<std::uint8_t>(0xF0 | (4 - (out.size() - start) % 4)));
+    std::uint16_t len = static_cast<std::uint16_t>(out.size() - start - 2);
+    out[start] = len & 0xff;
+    out[start + 1] = len >> 8;
+}
+
+// Same stream as MakeStream, written field by field.
+std::vector<std::uint8_t> EncodeSwitch(std::size_t records) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i < records; ++i) {
+        std::uint32_t ti = 0x1000 + static_cast<std::uint32_t>(i);
+        std::size_t start = out.size();
+        Put16(out, 0);
+        switch (i % 3) {
+        case 0:
+            Put16(out, 0x1002);
+            Put32(out, ti - 1);
+            Put32(out, 0x1000c);
+            break;
+        case 1:
+            Put16(out, 0x1505);
+            Put16(out, 4);
+            Put16(out, 0x200);
+            Put32(out, ti - 1);
+            Put32(out, 0);
+            Put32(out, 0);
+            PutNumeric(out, i * 8);
+            PutString(out, "ns::Record");
+            PutString(out, ".?AURecord@ns@@");
+            break;
+        default:
+            Put16(out, 0x1503);
+            Put32(out, ti - 2);
+            Put32(out, 0x23);
+            PutNumeric(out, i * 16);
+            PutString(out, "");
+            break;
+        }
+        FinishRecord(out, start);
+    }
+    return out;
+}
+
+std::uint64_t DecodeSchema(const std::vector<std::uint8_t>& s) {
+    std::uint64_t sum = 0;
+    std::size_t at = 0;
+    while (at + 4 <= s.size()) {
+        std::uint16_t len = schema::LoadLE<std::uint16_t>(&s[at]);
+        std::uint16_t kind = schema::LoadLE<std::uint16_t>(&s[at + 2]);
+        IRBytes rec{&s[at], s.size() - at};
+        cv::Dispatch<cv::LfPointer, cv::LfStructure, cv::LfArray>(kind, [&](auto r) {
+            using Rec = decltype(r);
+            typename Rec::Values v;
+            if (!Rec::decode(rec, v)) return;
+            if constexpr (std::is_same<Rec, cv::LfPointer>::value) {
+                sum += std::get<Rec::Referent>(v) + std::get<Rec::Attributes>(v);
+            } else if constexpr (std::is_same<Rec, cv::LfStructure>::value) {
+                sum += std::get<Rec::FieldList>(v) + std::get<Rec::Size>(v) + std::get<Rec::Name>(v).size();
+            } else {
+                sum += std::get<Rec::ElementType>(v) + std::get<Rec::IndexType>(v) + std::get<Rec::Size>(v) +
+                       std::get<Rec::Name>(v).size();
+            }
+        });
+        at += 2 + len;
+    }
+    return sum;
+}
+
+// DW_TAG_member DIEs (abbrev code 1) back to back, as in a .debug_info.
+std::vector<std::uint8_t> MakeDies(std::size_t records) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i < records; ++i) {
+        dw::Member::encode(1, {static_cast<std::uint32_t>(i * 12), static_cast<std::uint32_t>(0x40 + i % 64),
+                               std::uint64_t(i % 300)}, out);
+    }
+    return out;
+}
+
+std::uint64_t DecodeDiesSchema(const std::vector<std::uint8_t>& s) {
+    std::uint64_t sum = 0;
+    const std::uint8_t* p = s.data();
+    const std::uint8_t* end = p + s.size();
+    while (p < end) {
+        std::uint64_t code = 0;
+        if (!schema::Uleb::read(p, end, code)) break;
+        dw::Member::Values v;
+        std::size_t used = 0;
+        if (!dw::Member::decode(IRBytes{p, static_cast<std::size_t>(end - p)}, v, &used)) break;
+        p += used;
+        sum += code + std::get<dw::Member::Name>(v) + std::get<dw::Member::Type>(v) +
+               std::get<dw::Member::DataMemberLocation>(v);
+    }
+    return sum;
+}
+
+// The generic walk: one form switch per (attr, form) pair of the abbrev.
+std::uint64_t DecodeDiesForms(const std::vector<std::uint8_t>& s, const std::vector<std::uint8_t>& abbrev) {
+    std::vector<std::uint64_t> forms;
+    const std::uint8_t* a = abbrev.data() + 3; // code, tag, children
+    const std::uint8_t* aEnd = abbrev.data() + abbrev.size();
+    for (;;) {
+        std::uint64_t at = 0, form = 0;
+        if (!schema::Uleb::read(a, aEnd, at) || !schema::Uleb::read(a, aEnd, form) || !at) break;
+        forms.push_back(form);
+    }
+
+    std::uint64_t sum = 0;
+    const std::uint8_t* p = s.data();
+    const std::uint8_t* end = p + s.size();
+    while (p < end) {
+        std::uint64_t code = 0;
+        if (!schema::Uleb::read(p, end, code)) return sum;
+        sum += code;
+        for (std::uint64_t form : forms) {
+            std::uint64_t v = 0;
+            switch (form) {
+            case 0x0e: case 0x13: // strp, ref4
+                if (end - p < 4) return sum;
+                v = Get32(p);
+                p += 4;
+                break;
+            case 0x0f:            // udata
+                if (!schema::Uleb::read(p, end, v)) return sum;
+                break;
+            default:
+                return sum;
+            }
+            sum += v;
+        }
+    }
+    return sum;
+}
+
+template <typename F>
+void Report(const char* label, std::size_t bytes, int iterations, F&& body) {
+    std::uint64_t sink = 0;
+    auto t0 = Clock::now();
+    for (int i = 0; i < iterations; ++i) sink += body();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    double mbps = secs > 0 ? double(bytes) * iterations / secs / (1024.0 * 1024.0) : 0.0;
+    std::cout << label << ": " << mbps << " MB/s (checksum " << sink << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const int iterations = 10;
+
+    std::vector<std::uint8_t> stream = MakeStream(records);
+    std::cout << records << " records, " << stream.size() << " bytes" << std::endl;
+
+    if (EncodeSwitch(records) != stream) {
+        std::cerr << "encoders disagree" << std::endl;
+        return 1;
+    }
+
+    Report("decode/switch", stream.size(), iterations, [&] { return DecodeSwitch(stream); });
+    Report("decode/schema", stream.size(), iterations, [&] { return DecodeSchema(stream); });
+    Report("encode/switch", stream.size(), iterations, [&] { return std::uint64_t(EncodeSwitch(records).size()); });
+    Report("encode/schema", stream.size(), iterations, [&] { return std::uint64_t(MakeStream(records).size()); });
+
+    std::vector<std::uint8_t> dies = MakeDies(records);
+    std::vector<std::uint8_t> abbrev;
+    dw::Member::appendAbbrev(1, abbrev);
+    if (DecodeDiesSchema(dies) != DecodeDiesForms(dies, abbrev)) {
+        std::cerr << "DIE decoders disagree" << std::endl;
+        return 1;
+    }
+    Report("dies/forms", dies.size(), iterations, [&] { return DecodeDiesForms(dies, abbrev); });
+    Report("dies/schema", dies.size(), iterations, [&] { return DecodeDiesSchema(dies); });
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Template-heavy type names: flat std::string vs interned IRName DAG.
+// Reports resident bytes and interning/hashing throughput.
+//
+//   bench_type_names [types]
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "ir/IRName.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// std::map<K_i, std::vector<V_j>> over a few long argument types.
+std::vector<std::string> MakeNames(std::size_t count) {
+    const std::string str = "std::basic_string<char, std::char_traits<char>, std::allocator<char> >";
+    const std::string args[] = {
+        str,
+        "std::vector<" + str + ", std::allocator<" + str + " > >",
+        "std::pair<const " + str + ", int>",
+        "ns::detail::Node<" + str + ", 16>",
+    };
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string& k = args[i % 4];
+        const std::string& v = args[(i / 4) % 4];
+        names.push_back("app::Table" + std::to_string(i % 997) + "<" + k + ", std::vector<" + v + " > >");
+    }
+    return names;
+}
+
+double Seconds(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::vector<std::string> input = MakeNames(count);
+
+    std::size_t flatBytes = 0;
+    for (const std::string& s : input) flatBytes += s.capacity() + sizeof(std::string);
+
+    // Flat: dedupe through a string set (what interning costs today).
+    auto t0 = Clock::now();
+    std::unordered_set<std::string> flat(input.begin(), input.end());
+    double flatSecs = Seconds(t0);
+
+    IRNameStore store;
+    t0 = Clock::now();
+    std::vector<IRName> names;
+    names.reserve(count);
+    for (const std::string& s : input) names.push_back(store.parse(s));
+    double parseSecs = Seconds(t0);
+
+    t0 = Clock::now();
+    std::unordered_set<IRName, IRNameHash> interned(names.begin(), names.end());
+    double setSecs = Seconds(t0);
+
+    std::cout << count << " names, " << flat.size() << " distinct\n"
+              << "flat strings : " << flatBytes / 1024 << " KiB, set build " << flatSecs * 1e3 << " ms\n"
+              << "IRName store : " << (store.memoryBytes() + names.size() * sizeof(IRName)) / 1024
+              << " KiB (" << store.nodeCount() << " nodes), parse " << parseSecs * 1e3
+              << " ms, set build " << setSecs * 1e3 << " ms (" << interned.size() << " distinct)\n";
+    return 0;
+}
@@ -0,0 +1,338 @@
+#include "DwarfCompress.h"
+#include <algorithm>
+#include <cstring>
+#include "../util/ParallelFor.h"
+#include "../util/RecordSchema.h"
+#ifdef DWARF_PDB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef DWARF_PDB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr std::uint32_t kElfCompressZlib = 1;
+constexpr std::uint32_t kElfCompressZstd = 2;
+constexpr std::size_t   kChdrSize = 24;          // Elf64_Chdr
+constexpr std::uint64_t kMaxSection = std::uint64_t(1) << 32;
+constexpr std::size_t   kMinChunk = 64 * 1024;
+constexpr std::size_t   kMaxChunk = 64 * 1024 * 1024;
+
+#if defined(DWARF_PDB_HAVE_ZLIB) || defined(DWARF_PDB_HAVE_ZSTD)
+
+void PutChdr(std::vector<std::uint8_t>& out, std::uint32_t type, std::uint64_t size) {
+    schema::StoreLE<std::uint32_t>(out, type);
+    schema::StoreLE<std::uint32_t>(out, 0);      // ch_reserved
+    schema::StoreLE<std::uint64_t>(out, size);
+    schema::StoreLE<std::uint64_t>(out, 1);      // ch_addralign
+}
+
+struct Chunking {
+    std::size_t size = 0;
+    std::size_t count = 0;
+};
+
+Chunking ChunksOf(std::size_t total, std::size_t chunkBytes) {
+    Chunking c;
+    c.size = std::min(std::max(chunkBytes, kMinChunk), kMaxChunk);
+    c.count = total ? (total + c.size - 1) / c.size : 1;
+    return c;
+}
+
+// Runs 'compress(i, out)' for every chunk in parallel and appends the
+// outputs in order. The first failing chunk's error wins.
+template <typename F>
+bool CompressChunks(std::size_t count, unsigned jobs, std::vector<std::uint8_t>& out,
+                    std::string& error, F&& compress) {
+    std::vector<std::vector<std::uint8_t>> parts(count);
+    std::vector<std::string> errors(count);
+    ParallelFor(count, jobs, [&](std::size_t i) { compress(i, parts[i], errors[i]); });
+    std::size_t total = out.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!errors[i].empty()) {
+            error = errors[i];
+            return false;
+        }
+        total += parts[i].size();
+    }
+    out.reserve(total);
+    for (const auto& p : parts) out.insert(out.end(), p.begin(), p.end());
+    return true;
+}
+
+#endif
+
+#ifdef DWARF_PDB_HAVE_ZLIB
+
+constexpr std::size_t kDeflateWindow = 32 * 1024;
+
+bool DeflateChunk(IRBytes whole, std::size_t begin, std::size_t end, bool last, int level,
+                  std::vector<std::uint8_t>& out, std::string& error) {
+    z_stream zs{};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        error = "zlib: deflateInit2 failed";
+        return false;
+    }
+    std::size_t dict = std::min(begin, kDeflateWindow);
+    if (dict) deflateSetDictionary(&zs, whole.data + begin - dict, static_cast<uInt>(dict));
+
+    zs.next_in = const_cast<Bytef*>(whole.data + begin);
+    zs.avail_in = static_cast<uInt>(end - begin);
+    out.resize(deflateBound(&zs, static_cast<uLong>(end - begin)) + 16);
+    std::size_t used = 0;
+    int rc = Z_OK;
+    for (;;) {
+        zs.next_out = out.data() + used;
+        zs.avail_out = static_cast<uInt>(out.size() - used);
+        rc = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+        used = out.size() - zs.avail_out;
+        bool done = last ? rc == Z_STREAM_END : (rc == Z_OK && zs.avail_in == 0 && zs.avail_out != 0);
+        if (done || (rc != Z_OK && rc != Z_BUF_ERROR)) break;
+        out.resize(out.size() * 2);
+    }
+    deflateEnd(&zs);
+    out.resize(used);
+    if (last ? rc != Z_STREAM_END : rc != Z_OK) {
+        error = "zlib: deflate failed";
+        return false;
+    }
+    return true;
+}
+
+bool CompressZlib(IRBytes in, const DwarfCompressOptions& opts, std::vector<std::uint8_t>& out,
+                  std::string& error) {
+    int level = opts.level ? std::min(std::max(opts.level, 1), 9) : Z_DEFAULT_COMPRESSION;
+    Chunking c = ChunksOf(in.size, opts.chunkBytes);
+
+    // zlib header; FLEVEL is informational only.
+    int effective = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    std::uint8_t cmf = 0x78;
+    std::uint8_t flg = static_cast<std::uint8_t>((effective < 2 ? 0 : effective < 6 ? 1 : effective == 6 ? 2 : 3) << 6);
+    flg = static_cast<std::uint8_t>(flg + (31 - (cmf * 256 + flg) % 31) % 31);
+    out.push_back(cmf);
+    out.push_back(flg);
+
+    std::vector<uLong> adlers(c.count);
+    bool ok = CompressChunks(c.count, opts.jobs, out, error,
+        [&](std::size_t i, std::vector<std::uint8_t>& part, std::string& err) {
+            std::size_t begin = i * c.size;
+            std::size_t end = std::min(in.size, begin + c.size);
+            adlers[i] = adler32(adler32(0, nullptr, 0), in.data + begin, static_cast<uInt>(end - begin));
+            DeflateChunk(in, begin, end, i + 1 == c.count, level, part, err);
+        });
+    if (!ok) return false;
+
+    uLong adler = adler32(0, nullptr, 0);
+    for (std::size_t i = 0; i < c.count; ++i) {
+        std::size_t len = std::min(in.size - std::min(in.size, i * c.size), c.size);
+        adler = adler32_combine(adler, adlers[i], static_cast<z_off_t>(len));
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<std::uint8_t>(adler >> shift));
+    return true;
+}
+
+bool DecompressZlib(IRBytes in, std::vector<std::uint8_t>& out, std::string& error) {
+    z_stream zs{};
+    if (inflateInit(&zs) != Z_OK) {
+        error = "zlib: inflateInit failed";
+        return false;
+    }
+    zs.next_in = const_cast<Bytef*>(in.data);
+    zs.avail_in = static_cast<uInt>(in.size);
+    // An empty section has no buffer; inflate rejects a null next_out, so
+    // give it one spare byte, which total_out then shows was not used.
+    std::uint8_t spare = 0;
+    zs.next_out = out.empty() ? &spare : out.data();
+    zs.avail_out = out.empty() ? 1 : static_cast<uInt>(out.size());
+    int rc = inflate(&zs, Z_FINISH);
+    bool ok = rc == Z_STREAM_END && zs.total_out == out.size() && zs.avail_in == 0;
+    inflateEnd(&zs);
+    if (!ok) error = "zlib stream is corrupt or does not match ch_size";
+    return ok;
+}
+
+#endif
+
+#ifdef DWARF_PDB_HAVE_ZSTD
+
+bool CompressZstd(IRBytes in, const DwarfCompressOptions& opts, std::vector<std::uint8_t>& out,
+                  std::string& error) {
+    int level = opts.level ? std::min(std::max(opts.level, 1), ZSTD_maxCLevel()) : ZSTD_CLEVEL_DEFAULT;
+    Chunking c = ChunksOf(in.size, opts.chunkBytes);
+    return CompressChunks(c.count, opts.jobs, out, error,
+        [&](std::size_t i, std::vector<std::uint8_t>& part, std::string& err) {
+            std::size_t begin = i * c.size;
+            std::size_t size = std::min(in.size - std::min(in.size, begin), c.size);
+            part.resize(ZSTD_compressBound(size));
+            std::size_t n = ZSTD_compress(part.data(), part.size(), in.data + begin, size, level);
+            if (ZSTD_isError(n)) {
+                err = std::string("zstd: ") + ZSTD_getErrorName(n);
+                return;
+            }
+            part.resize(n);
+        });
+}
+
+bool DecompressZstd(IRBytes in, std::vector<std::uint8_t>& out, std::string& error) {
+    std::size_t n = ZSTD_decompress(out.data(), out.size(), in.data, in.size);
+    if (ZSTD_isError(n) || n != out.size()) {
+        error = "zstd stream is corrupt or does not match ch_size";
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+} // namespace
+
+bool DwarfCompressionAvailable(DwarfCompression kind) {
+    switch (kind) {
+    case DwarfCompression::None: return true;
+#ifdef DWARF_PDB_HAVE_ZLIB
+    case DwarfCompression::Zlib: return true;
+#endif
+#ifdef DWARF_PDB_HAVE_ZSTD
+    case DwarfCompression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+const char* DwarfCompressionName(DwarfCompression kind) {
+    switch (kind) {
+    case DwarfCompression::Zlib: return "zlib";
+    case DwarfCompression::Zstd: return "zstd";
+    default: return "none";
+    }
+}
+
+bool ParseDwarfCompression(const std::string& text, DwarfCompression& kind) {
+    for (DwarfCompression k : {DwarfCompression::None, DwarfCompression::Zlib, DwarfCompression::Zstd}) {
+        if (text == DwarfCompressionName(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CompressDwarfSection(IRBytes in, const DwarfCompressOptions& opts,
+                          std::vector<std::uint8_t>& out, std::string& error) {
+    out.clear();
+    if (!DwarfCompressionAvailable(opts.kind) || opts.kind == DwarfCompression::None) {
+        error = std::string(DwarfCompressionName(opts.kind)) + " compression is not available in this build";
+        return false;
+    }
+    if (in.size >= kMaxSection) {
+        error = "section too large to compress";
+        return false;
+    }
+#ifdef DWARF_PDB_HAVE_ZLIB
+    if (opts.kind == DwarfCompression::Zlib) {
+        PutChdr(out, kElfCompressZlib, in.size);
+        return CompressZlib(in, opts, out, error);
+    }
+#endif
+#ifdef DWARF_PDB_HAVE_ZSTD
+    if (opts.kind == DwarfCompression::Zstd) {
+        PutChdr(out, kElfCompressZstd, in.size);
+        return CompressZstd(in, opts, out, error);
+    }
+#endif
+    return false;
+}
+
+bool DecompressDwarfSection(IRBytes in, std::vector<std::uint8_t>& out, std::string& error) {
+    if (in.size < kChdrSize) {
+        error = "compressed section has no Elf64_Chdr";
+        return false;
+    }
+    std::uint32_t type = schema::LoadLE<std::uint32_t>(in.data);
+    std::uint64_t size = schema::LoadLE<std::uint64_t>(in.data + 8);
+    if (size >= kMaxSection) {
+        error = "compressed section claims " + std::to_string(size) + " bytes";
+        return false;
+    }
+    IRBytes stream{in.data + kChdrSize, in.size - kChdrSize};
+#ifdef DWARF_PDB_HAVE_ZLIB
+    if (type == kElfCompressZlib) {
+        out.assign(static_cast<std::size_t>(size), 0);
+        return DecompressZlib(stream, out, error);
+    }
+#endif
+#ifdef DWARF_PDB_HAVE_ZSTD
+    if (type == kElfCompressZstd) {
+        out.assign(static_cast<std::size_t>(size), 0);
+        return DecompressZstd(stream, out, error);
+    }
+#endif
+    (void)stream;
+    (void)out;
+    error = "unsupported ch_type " + std::to_string(type);
+    return false;
+}
+
+// ---- DwarfSectionCompressor ----
+
+DwarfSectionCompressor::DwarfSectionCompressor(const DwarfCompressOptions& opts) : opts(opts) {
+    if (opts.kind != DwarfCompression::None) worker = std::thread([this] { run(); });
+}
+
+DwarfSectionCompressor::~DwarfSectionCompressor() {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        closed = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void DwarfSectionCompressor::submit(std::string name, std::vector<std::uint8_t> bytes) {
+    auto s = std::make_unique<DwarfOutputSection>();
+    s->name = std::move(name);
+    s->uncompressedSize = bytes.size();
+    s->bytes = std::move(bytes);
+    bool compress = opts.kind != DwarfCompression::None && s->name.compare(0, 7, ".debug_") == 0;
+    std::lock_guard<std::mutex> lock(mu);
+    if (compress) pending.push_back(s.get());
+    sections.push_back(std::move(s));
+    wake.notify_all();
+}
+
+void DwarfSectionCompressor::run() {
+    for (;;) {
+        DwarfOutputSection* s = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            wake.wait(lock, [&] { return closed || !pending.empty(); });
+            if (pending.empty()) return;
+            s = pending.front();
+        }
+
+        std::vector<std::uint8_t> packed;
+        std::string err;
+        bool ok = CompressDwarfSection(IRBytes{s->bytes.data(), s->bytes.size()}, opts, packed, err);
+
+        std::lock_guard<std::mutex> lock(mu);
+        if (ok && packed.size() < s->bytes.size()) {
+            s->bytes.swap(packed);
+            s->flags |= kShfCompressed;
+        } else if (!ok && firstError.empty()) {
+            firstError = s->name + ": " + err;
+        }
+        pending.pop_front();
+        wake.notify_all();
+    }
+}
+
+std::vector<DwarfOutputSection> DwarfSectionCompressor::finish() {
+    std::unique_lock<std::mutex> lock(mu);
+    wake.wait(lock, [&] { return pending.empty(); });
+    std::vector<DwarfOutputSection> out;
+    out.reserve(sections.size());
+    for (auto& s : sections) out.push_back(std::move(*s));
+    sections.clear();
+    return out;
+}
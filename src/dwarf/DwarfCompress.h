@@ -0,0 +1,91 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../ir/IRLocation.h"
+
+// DwarfCompress:
+// SHF_COMPRESSED .debug_* sections: an Elf64_Chdr followed by the stream.
+//
+//   - a section is cut into fixed-size chunks compressed in parallel;
+//   - zstd: one frame per chunk; concatenated frames decode as one stream;
+//   - zlib: one raw deflate run per chunk, primed with the previous 32 KiB
+//     of input as dictionary and ended by a sync flush (the last one by
+//     Z_FINISH), inside a single zlib header and an Adler-32 combined from
+//     the per-chunk checksums; the result is an ordinary zlib stream;
+//   - DwarfSectionCompressor does this on a background thread, so one
+//     section is compressed while the writer produces the next.
+//
+// Which formats exist depends on the build (DWARF_PDB_HAVE_ZLIB,
+// DWARF_PDB_HAVE_ZSTD).
+enum class DwarfCompression : std::uint8_t {
+    None,
+    Zlib, // ELFCOMPRESS_ZLIB
+    Zstd  // ELFCOMPRESS_ZSTD
+};
+
+struct DwarfCompressOptions {
+    DwarfCompression kind = DwarfCompression::None;
+    int         level = 0;                  // 0 = format default; zlib 1-9, zstd 1-22; higher = smaller, slower
+    std::size_t chunkBytes = std::size_t(1) << 20;
+    unsigned    jobs = 0;                   // 0 = all cores
+};
+
+constexpr std::uint64_t kShfCompressed = 0x800;
+
+bool        DwarfCompressionAvailable(DwarfCompression kind);
+const char* DwarfCompressionName(DwarfCompression kind);
+// "none", "zlib" or "zstd".
+bool        ParseDwarfCompression(const std::string& text, DwarfCompression& kind);
+
+// Compresses 'in' into 'out' (header + stream). False with 'error' set if
+// the format is not built in or the library fails.
+bool CompressDwarfSection(IRBytes in, const DwarfCompressOptions& opts,
+                          std::vector<std::uint8_t>& out, std::string& error);
+
+// Inverse of the above, for either format that is built in.
+bool DecompressDwarfSection(IRBytes in, std::vector<std::uint8_t>& out, std::string& error);
+
+struct DwarfOutputSection {
+    std::string               name;
+    std::uint64_t             flags = 0; // kShfCompressed when compressed
+    std::vector<std::uint8_t> bytes;
+    std::uint64_t             uncompressedSize = 0;
+};
+
+// Compresses submitted .debug_* sections in order on one worker (which
+// fans each section out over 'jobs' threads). Other sections, sections
+// that would not shrink and sections that fail to compress are kept as
+// they are; the first failure is reported by error().
+class DwarfSectionCompressor {
+public:
+    explicit DwarfSectionCompressor(const DwarfCompressOptions& opts);
+    ~DwarfSectionCompressor();
+    DwarfSectionCompressor(const DwarfSectionCompressor&) = delete;
+    DwarfSectionCompressor& operator=(const DwarfSectionCompressor&) = delete;
+
+    void submit(std::string name, std::vector<std::uint8_t> bytes);
+
+    // Waits for the worker; sections come back in submission order.
+    std::vector<DwarfOutputSection> finish();
+
+    const std::string& error() const { return firstError; }
+
+private:
+    void run();
+
+    DwarfCompressOptions opts;
+    std::vector<std::unique_ptr<DwarfOutputSection>> sections;
+    std::deque<DwarfOutputSection*> pending;
+    bool closed = false;
+    std::string firstError;
+    std::mutex mu;
+    std::condition_variable wake;
+    std::thread worker;
+};
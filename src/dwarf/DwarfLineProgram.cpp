@@ -0,0 +1,521 @@
+#include "DwarfLineProgram.h"
+#include <cstring>
+#include "../util/ParallelFor.h"
+
+namespace {
+
+// Standard opcodes
+constexpr std::uint8_t DW_LNS_copy               = 0x01;
+constexpr std::uint8_t DW_LNS_advance_pc         = 0x02;
+constexpr std::uint8_t DW_LNS_advance_line       = 0x03;
+constexpr std::uint8_t DW_LNS_set_file           = 0x04;
+constexpr std::uint8_t DW_LNS_set_column         = 0x05;
+constexpr std::uint8_t DW_LNS_negate_stmt        = 0x06;
+constexpr std::uint8_t DW_LNS_set_basic_block    = 0x07;
+constexpr std::uint8_t DW_LNS_const_add_pc       = 0x08;
+constexpr std::uint8_t DW_LNS_fixed_advance_pc   = 0x09;
+constexpr std::uint8_t DW_LNS_set_prologue_end   = 0x0a;
+constexpr std::uint8_t DW_LNS_set_epilogue_begin = 0x0b;
+constexpr std::uint8_t DW_LNS_set_isa            = 0x0c;
+
+// Extended opcodes
+constexpr std::uint8_t DW_LNE_end_sequence      = 0x01;
+constexpr std::uint8_t DW_LNE_set_address       = 0x02;
+constexpr std::uint8_t DW_LNE_define_file       = 0x03;
+
+// DWARF 5 entry formats
+constexpr std::uint16_t DW_LNCT_path            = 0x1;
+constexpr std::uint16_t DW_LNCT_directory_index = 0x2;
+constexpr std::uint16_t DW_LNCT_MD5             = 0x5;
+
+constexpr std::uint16_t DW_FORM_block2    = 0x03;
+constexpr std::uint16_t DW_FORM_block4    = 0x04;
+constexpr std::uint16_t DW_FORM_data2     = 0x05;
+constexpr std::uint16_t DW_FORM_data4     = 0x06;
+constexpr std::uint16_t DW_FORM_data8     = 0x07;
+constexpr std::uint16_t DW_FORM_string    = 0x08;
+constexpr std::uint16_t DW_FORM_block     = 0x09;
+constexpr std::uint16_t DW_FORM_block1    = 0x0a;
+constexpr std::uint16_t DW_FORM_data1     = 0x0b;
+constexpr std::uint16_t DW_FORM_strp      = 0x0e;
+constexpr std::uint16_t DW_FORM_udata     = 0x0f;
+constexpr std::uint16_t DW_FORM_data16    = 0x1e;
+constexpr std::uint16_t DW_FORM_line_strp = 0x1f;
+
+// Encoder parameters (same as GCC/Clang defaults).
+constexpr std::int8_t  kLineBase   = -5;
+constexpr std::uint8_t kLineRange  = 14;
+constexpr std::uint8_t kOpcodeBase = 13;
+
+// Bounds-checked little-endian cursor over the section bytes.
+struct Cursor {
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+    bool ok = true;
+
+    bool has(std::size_t n) {
+        if (static_cast<std::size_t>(end - p) < n) ok = false;
+        return ok;
+    }
+    std::uint64_t fixed(unsigned n) {
+        if (!has(n)) return 0;
+        std::uint64_t v = 0;
+        for (unsigned i = 0; i < n; ++i) v |= std::uint64_t(p[i]) << (8 * i);
+        p += n;
+        return v;
+    }
+    std::uint8_t  u8()  { return static_cast<std::uint8_t>(fixed(1)); }
+    std::uint16_t u16() { return static_cast<std::uint16_t>(fixed(2)); }
+    std::uint32_t u32() { return static_cast<std::uint32_t>(fixed(4)); }
+    std::uint64_t u64() { return fixed(8); }
+    std::uint64_t uleb() {
+        std::uint64_t v = 0;
+        unsigned shift = 0;
+        for (;;) {
+            if (!has(1)) return 0;
+            std::uint8_t b = *p++;
+            if (shift < 64) v |= std::uint64_t(b & 0x7f) << shift;
+            shift += 7;
+            if (!(b & 0x80)) return v;
+        }
+    }
+    std::int64_t sleb() {
+        std::uint64_t v = 0;
+        unsigned shift = 0;
+        std::uint8_t b = 0;
+        do {
+            if (!has(1)) return 0;
+            b = *p++;
+            if (shift < 64) v |= std::uint64_t(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        if (shift < 64 && (b & 0x40)) v |= ~std::uint64_t(0) << shift;
+        return static_cast<std::int64_t>(v);
+    }
+    const char* cstr() {
+        const std::uint8_t* nul = static_cast<const std::uint8_t*>(
+            std::memchr(p, 0, static_cast<std::size_t>(end - p)));
+        if (!nul) { ok = false; return ""; }
+        const char* s = reinterpret_cast<const char*>(p);
+        p = nul + 1;
+        return s;
+    }
+    void skip(std::uint64_t n) {
+        if (has(static_cast<std::size_t>(n))) p += n;
+    }
+};
+
+const char* StringAt(IRBytes sec, std::uint64_t off) {
+    if (!sec.data || off >= sec.size) return "";
+    if (!std::memchr(sec.data + off, 0, sec.size - off)) return "";
+    return reinterpret_cast<const char*>(sec.data + off);
+}
+
+std::string JoinPath(const std::string& dir, const char* name) {
+    if (dir.empty() || name[0] == '/' || name[0] == '\\' ||
+        (name[0] && name[1] == ':')) {
+        return name;
+    }
+    char last = dir.back();
+    return dir + (last == '/' || last == '\\' ? "" : "/") + name;
+}
+
+struct EntryFormat {
+    std::uint16_t content;
+    std::uint16_t form;
+};
+
+// One DWARF 5 directory/file entry; only path, dir index and MD5 are kept.
+struct Entry {
+    const char*         path = "";
+    std::uint64_t       dirIndex = 0;
+    const std::uint8_t* md5 = nullptr;
+};
+
+bool ReadEntry(Cursor& c, const std::vector<EntryFormat>& fmts,
+               const DwarfLineStrings& strings, bool is64, Entry& e) {
+    for (const EntryFormat& f : fmts) {
+        std::uint64_t v = 0;
+        const char* s = nullptr;
+        switch (f.form) {
+        case DW_FORM_string:    s = c.cstr(); break;
+        case DW_FORM_strp:      s = StringAt(strings.debugStr, c.fixed(is64 ? 8 : 4)); break;
+        case DW_FORM_line_strp: s = StringAt(strings.debugLineStr, c.fixed(is64 ? 8 : 4)); break;
+        case DW_FORM_udata:     v = c.uleb(); break;
+        case DW_FORM_data1:     v = c.u8(); break;
+        case DW_FORM_data2:     v = c.u16(); break;
+        case DW_FORM_data4:     v = c.u32(); break;
+        case DW_FORM_data8:     v = c.u64(); break;
+        case DW_FORM_data16:
+            if (f.content == DW_LNCT_MD5 && c.has(16)) e.md5 = c.p;
+            c.skip(16);
+            break;
+        case DW_FORM_block:  c.skip(c.uleb()); break;
+        case DW_FORM_block1: c.skip(c.u8()); break;
+        case DW_FORM_block2: c.skip(c.u16()); break;
+        case DW_FORM_block4: c.skip(c.u32()); break;
+        default:
+            return false; // unknown form: cannot find the next entry
+        }
+        if (f.content == DW_LNCT_path && s) e.path = s;
+        if (f.content == DW_LNCT_directory_index) e.dirIndex = v;
+    }
+    return c.ok;
+}
+
+bool ReadEntryFormats(Cursor& c, std::vector<EntryFormat>& fmts) {
+    std::uint8_t n = c.u8();
+    fmts.clear();
+    for (std::uint8_t i = 0; i < n && c.ok; ++i) {
+        EntryFormat f;
+        f.content = static_cast<std::uint16_t>(c.uleb());
+        f.form    = static_cast<std::uint16_t>(c.uleb());
+        fmts.push_back(f);
+    }
+    return c.ok;
+}
+
+void PutULEB(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    do {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        if (v) b |= 0x80;
+        out.push_back(b);
+    } while (v);
+}
+
+void PutSLEB(std::vector<std::uint8_t>& out, std::int64_t v) {
+    bool more = true;
+    while (more) {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        more = !((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40)));
+        if (more) b |= 0x80;
+        out.push_back(b);
+    }
+}
+
+void PutFixed(std::vector<std::uint8_t>& out, std::uint64_t v, unsigned n) {
+    for (unsigned i = 0; i < n; ++i) out.push_back((v >> (8 * i)) & 0xff);
+}
+
+void PatchU32(std::vector<std::uint8_t>& out, std::size_t at, std::uint32_t v) {
+    for (unsigned i = 0; i < 4; ++i) out[at + i] = (v >> (8 * i)) & 0xff;
+}
+
+} // namespace
+
+std::size_t DecodeLineProgram(IRBytes unit,
+                              const DwarfLineStrings& strings,
+                              IRLineTable& out) {
+    Cursor c{unit.data, unit.data + unit.size};
+
+    // ---- unit header ----
+    bool is64 = false;
+    std::uint64_t unitLength = c.u32();
+    if (unitLength == 0xffffffffu) {
+        is64 = true;
+        unitLength = c.u64();
+    }
+    if (!c.ok || unitLength > static_cast<std::uint64_t>(c.end - c.p)) return 0;
+    const std::uint8_t* unitEnd = c.p + unitLength;
+    c.end = unitEnd;
+    std::size_t consumed = static_cast<std::size_t>(unitEnd - unit.data);
+
+    std::uint16_t version = c.u16();
+    if (version < 2 || version > 5) return 0;
+    // DWARF 5 states the address size; before that only DW_LNE_set_address
+    // does, through its length.
+    auto usableAddrSize = [](std::uint64_t n) { return n == 1 || n == 2 || n == 4 || n == 8; };
+    std::uint8_t addrSize = 0;
+    if (version >= 5) {
+        addrSize = c.u8();
+        c.u8(); // segment_selector_size
+        if (!usableAddrSize(addrSize)) return 0;
+    }
+    std::uint64_t headerLength = c.fixed(is64 ? 8 : 4);
+    if (!c.ok || headerLength > static_cast<std::uint64_t>(c.end - c.p)) return 0;
+    const std::uint8_t* program = c.p + headerLength;
+
+    std::uint8_t minInstLength = c.u8();
+    if (version >= 4) c.u8(); // maximum_operations_per_instruction (non-VLIW: 1)
+    bool defaultIsStmt = c.u8() != 0;
+    std::int8_t lineBase = static_cast<std::int8_t>(c.u8());
+    std::uint8_t lineRange = c.u8();
+    std::uint8_t opcodeBase = c.u8();
+    if (!c.ok || lineRange == 0 || opcodeBase == 0) return 0;
+    std::uint8_t stdLengths[256] = {};
+    for (unsigned i = 1; i < opcodeBase; ++i) stdLengths[i] = c.u8();
+
+    // ---- directory / file tables ----
+    const std::uint32_t fileBase = static_cast<std::uint32_t>(out.files.size());
+    std::vector<std::string> dirs;
+    if (version >= 5) {
+        std::vector<EntryFormat> fmts;
+        if (!ReadEntryFormats(c, fmts)) return 0;
+        std::uint64_t nDirs = c.uleb();
+        for (std::uint64_t i = 0; i < nDirs && c.ok; ++i) {
+            Entry e;
+            if (!ReadEntry(c, fmts, strings, is64, e)) return 0;
+            dirs.emplace_back(e.path);
+        }
+        if (!ReadEntryFormats(c, fmts)) return 0;
+        std::uint64_t nFiles = c.uleb();
+        for (std::uint64_t i = 0; i < nFiles && c.ok; ++i) {
+            Entry e;
+            if (!ReadEntry(c, fmts, strings, is64, e)) return 0;
+            IRLineFile f;
+            f.path = JoinPath(e.dirIndex < dirs.size() ? dirs[e.dirIndex] : "", e.path);
+            if (e.md5) {
+                f.checksumKind = 1;
+                std::memcpy(f.checksum, e.md5, 16);
+            }
+            out.files.push_back(std::move(f));
+        }
+    } else {
+        dirs.emplace_back(""); // index 0 = compilation directory
+        for (;;) {
+            const char* d = c.cstr();
+            if (!c.ok || !*d) break;
+            dirs.emplace_back(d);
+        }
+        for (;;) {
+            const char* name = c.cstr();
+            if (!c.ok || !*name) break;
+            std::uint64_t dir = c.uleb();
+            c.uleb(); // mtime
+            c.uleb(); // length
+            IRLineFile f;
+            f.path = JoinPath(dir < dirs.size() ? dirs[dir] : "", name);
+            out.files.push_back(std::move(f));
+        }
+    }
+    if (!c.ok) return 0;
+
+    // ---- line-number program ----
+    // DWARF 5 file register is 0-based, earlier versions are 1-based.
+    const std::uint32_t fileBias = version >= 5 ? 0 : 1;
+    c.p = program;
+    out.reserveRows(out.rowCount() + static_cast<std::size_t>(unitEnd - program) / 2);
+
+    std::uint64_t addr = 0;
+    std::uint64_t fileReg = 1;
+    std::uint32_t lineReg = 1;
+    std::uint16_t colReg = 0;
+    bool isStmt = defaultIsStmt;
+    std::uint8_t pending = 0; // prologue_end / epilogue_begin for next row
+    std::uint32_t seqStart = static_cast<std::uint32_t>(out.rowCount());
+
+    auto emitRow = [&] {
+        std::uint32_t f = fileReg >= fileBias
+            ? fileBase + static_cast<std::uint32_t>(fileReg - fileBias) : fileBase;
+        out.appendRow(addr, f, lineReg, colReg,
+                      static_cast<std::uint8_t>((isStmt ? IRLineIsStmt : 0) | pending));
+        pending = 0;
+    };
+    auto resetState = [&] {
+        addr = 0;
+        fileReg = 1;
+        lineReg = 1;
+        colReg = 0;
+        isStmt = defaultIsStmt;
+        pending = 0;
+        seqStart = static_cast<std::uint32_t>(out.rowCount());
+    };
+
+    while (c.p < c.end && c.ok) {
+        std::uint8_t op = c.u8();
+        if (op >= opcodeBase) {
+            std::uint8_t adj = op - opcodeBase;
+            addr += std::uint64_t(minInstLength) * (adj / lineRange);
+            lineReg += lineBase + (adj % lineRange);
+            emitRow();
+            continue;
+        }
+        switch (op) {
+        case 0: { // extended
+            std::uint64_t len = c.uleb();
+            if (!len || !c.has(static_cast<std::size_t>(len))) break;
+            const std::uint8_t* next = c.p + len;
+            std::uint8_t sub = c.u8();
+            if (sub == DW_LNE_end_sequence) {
+                out.endSequence(seqStart, addr);
+                resetState();
+            } else if (sub == DW_LNE_set_address) {
+                std::uint64_t width = len - 1;
+                if (!usableAddrSize(width) || (addrSize && width != addrSize)) {
+                    c.ok = false; // malformed: keep only the finished sequences
+                    break;
+                }
+                addr = c.fixed(static_cast<unsigned>(width));
+            } else if (sub == DW_LNE_define_file && version < 5) {
+                const char* name = c.cstr();
+                std::uint64_t dir = c.uleb();
+                IRLineFile f;
+                f.path = JoinPath(dir < dirs.size() ? dirs[dir] : "", name);
+                out.files.push_back(std::move(f));
+            }
+            c.p = next; // also skips set_discriminator and vendor opcodes
+            break;
+        }
+        case DW_LNS_copy:             emitRow(); break;
+        case DW_LNS_advance_pc:       addr += std::uint64_t(minInstLength) * c.uleb(); break;
+        case DW_LNS_advance_line:     lineReg += static_cast<std::uint32_t>(c.sleb()); break;
+        case DW_LNS_set_file:         fileReg = c.uleb(); break;
+        case DW_LNS_set_column:       colReg = static_cast<std::uint16_t>(c.uleb()); break;
+        case DW_LNS_negate_stmt:      isStmt = !isStmt; break;
+        case DW_LNS_set_basic_block:  break;
+        case DW_LNS_const_add_pc:
+            addr += std::uint64_t(minInstLength) * ((255 - opcodeBase) / lineRange);
+            break;
+        case DW_LNS_fixed_advance_pc: addr += c.u16(); break;
+        case DW_LNS_set_prologue_end:   pending |= IRLinePrologueEnd; break;
+        case DW_LNS_set_epilogue_begin: pending |= IRLineEpilogueBegin; break;
+        case DW_LNS_set_isa:          c.uleb(); break;
+        default:
+            // Unknown standard opcode: skip its declared ULEB operands.
+            for (unsigned i = 0; i < stdLengths[op]; ++i) c.uleb();
+            break;
+        }
+    }
+
+    // Rows after the last end_sequence are malformed; drop them.
+    while (out.rowCount() > seqStart) {
+        out.address.pop_back();
+        out.file.pop_back();
+        out.line.pop_back();
+        out.column.pop_back();
+        out.flags.pop_back();
+    }
+    return consumed;
+}
+
+void DecodeLineProgramsParallel(const std::vector<IRBytes>& units,
+                                const DwarfLineStrings& strings,
+                                std::vector<IRLineTable>& out,
+                                unsigned jobs) {
+    out.clear();
+    out.resize(units.size());
+    ParallelFor(units.size(), jobs, [&](std::size_t i) {
+        DecodeLineProgram(units[i], strings, out[i]);
+    });
+}
+
+void EncodeLineProgram(const IRLineTable& table, std::vector<std::uint8_t>& out) {
+    static const std::uint8_t kStdLengths[kOpcodeBase - 1] = {
+        0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1
+    };
+
+    bool allMD5 = !table.files.empty();
+    for (const IRLineFile& f : table.files) {
+        if (f.checksumKind != 1) allMD5 = false;
+    }
+
+    const std::size_t unitStart = out.size();
+    PutFixed(out, 0, 4);            // unit_length, patched below
+    PutFixed(out, 5, 2);            // version
+    out.push_back(8);               // address_size
+    out.push_back(0);               // segment_selector_size
+    const std::size_t headerLenAt = out.size();
+    PutFixed(out, 0, 4);            // header_length, patched below
+    const std::size_t headerStart = out.size();
+    out.push_back(1);               // minimum_instruction_length
+    out.push_back(1);               // maximum_operations_per_instruction
+    out.push_back(1);               // default_is_stmt
+    out.push_back(static_cast<std::uint8_t>(kLineBase));
+    out.push_back(kLineRange);
+    out.push_back(kOpcodeBase);
+    out.insert(out.end(), kStdLengths, kStdLengths + sizeof(kStdLengths));
+
+    // Paths in the IR are already joined, so one empty directory suffices.
+    out.push_back(1);
+    PutULEB(out, DW_LNCT_path);
+    PutULEB(out, DW_FORM_string);
+    PutULEB(out, 1);
+    out.push_back(0);
+
+    out.push_back(allMD5 ? 3 : 2);
+    PutULEB(out, DW_LNCT_path);
+    PutULEB(out, DW_FORM_string);
+    PutULEB(out, DW_LNCT_directory_index);
+    PutULEB(out, DW_FORM_udata);
+    if (allMD5) {
+        PutULEB(out, DW_LNCT_MD5);
+        PutULEB(out, DW_FORM_data16);
+    }
+    PutULEB(out, table.files.size());
+    for (const IRLineFile& f : table.files) {
+        out.insert(out.end(), f.path.begin(), f.path.end());
+        out.push_back(0);
+        PutULEB(out, 0);
+        if (allMD5) out.insert(out.end(), f.checksum, f.checksum + 16);
+    }
+    PatchU32(out, headerLenAt, static_cast<std::uint32_t>(out.size() - headerStart));
+
+    for (const IRLineSequence& seq : table.sequences) {
+        std::uint64_t addr = seq.lowPC;
+        std::uint32_t fileReg = 1, lineReg = 1;
+        std::uint16_t colReg = 0;
+        bool isStmt = true;
+
+        out.push_back(0);
+        PutULEB(out, 9);
+        out.push_back(DW_LNE_set_address);
+        PutFixed(out, addr, 8);
+
+        const std::uint32_t last = seq.firstRow + seq.rowCount - 1;
+        for (std::uint32_t r = seq.firstRow; r < last; ++r) {
+            if (table.file[r] != fileReg) {
+                fileReg = table.file[r];
+                out.push_back(DW_LNS_set_file);
+                PutULEB(out, fileReg);
+            }
+            if (table.column[r] != colReg) {
+                colReg = table.column[r];
+                out.push_back(DW_LNS_set_column);
+                PutULEB(out, colReg);
+            }
+            bool stmt = (table.flags[r] & IRLineIsStmt) != 0;
+            if (stmt != isStmt) {
+                isStmt = stmt;
+                out.push_back(DW_LNS_negate_stmt);
+            }
+            if (table.flags[r] & IRLinePrologueEnd)   out.push_back(DW_LNS_set_prologue_end);
+            if (table.flags[r] & IRLineEpilogueBegin) out.push_back(DW_LNS_set_epilogue_begin);
+
+            std::int64_t lineDelta = std::int64_t(table.line[r]) - lineReg;
+            std::uint64_t addrDelta = table.address[r] - addr;
+            lineReg = table.line[r];
+            addr = table.address[r];
+
+            if (lineDelta < kLineBase || lineDelta >= kLineBase + kLineRange) {
+                out.push_back(DW_LNS_advance_line);
+                PutSLEB(out, lineDelta);
+                lineDelta = 0;
+            }
+            std::uint64_t special = (lineDelta - kLineBase) +
+                                    std::uint64_t(kLineRange) * addrDelta + kOpcodeBase;
+            if (special <= 255) {
+                out.push_back(static_cast<std::uint8_t>(special));
+            } else {
+                out.push_back(DW_LNS_advance_pc);
+                PutULEB(out, addrDelta);
+                if (lineDelta) {
+                    out.push_back(DW_LNS_advance_line);
+                    PutSLEB(out, lineDelta);
+                }
+                out.push_back(DW_LNS_copy);
+            }
+        }
+
+        if (seq.highPC > addr) {
+            out.push_back(DW_LNS_advance_pc);
+            PutULEB(out, seq.highPC - addr);
+        }
+        out.push_back(0);
+        PutULEB(out, 1);
+        out.push_back(DW_LNE_end_sequence);
+    }
+
+    PatchU32(out, unitStart, static_cast<std::uint32_t>(out.size() - unitStart - 4));
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../ir/IRLocation.h"
+#include "../ir/IRLineTable.h"
+
+// DwarfLineProgram:
+// .debug_line <-> IRLineTable.
+//
+// Decoding runs the line-number state machine directly over the section
+// bytes and appends rows into the table's columns; the only allocations are
+// the amortized column growth and the file-name strings.
+// Versions 2-5 are accepted; encoding always produces DWARF 5.
+
+// String sections referenced by DW_FORM_strp / DW_FORM_line_strp entries
+// in a DWARF 5 header. Either may be empty.
+struct DwarfLineStrings {
+    IRBytes debugStr;
+    IRBytes debugLineStr;
+};
+
+// Decodes one line-number program unit starting at unit.data into 'out'.
+// Returns the number of bytes the unit occupies (0 if the header is bad).
+std::size_t DecodeLineProgram(IRBytes unit,
+                              const DwarfLineStrings& strings,
+                              IRLineTable& out);
+
+// Decodes independent units (one per CU) on up to 'jobs' threads;
+// out[i] receives units[i]. jobs == 0 uses every core.
+void DecodeLineProgramsParallel(const std::vector<IRBytes>& units,
+                                const DwarfLineStrings& strings,
+                                std::vector<IRLineTable>& out,
+                                unsigned jobs);
+
+// Appends a DWARF 5 line-number program (8-byte addresses, inline path
+// strings, MD5 column when every file has one) describing 'table'.
+void EncodeLineProgram(const IRLineTable& table, std::vector<std::uint8_t>& out);
@@ -16,4 +16,8 @@ struct DwarfNode {
 
     // For debugging/round-trip
     std::uint64_t originalDieOffset = 0;
+
+    // DW_TAG_compile_unit only: encoded .debug_line contribution that
+    // DW_AT_stmt_list will point at once the writer places it.
+    std::vector<std::uint8_t> lineProgram;
 };
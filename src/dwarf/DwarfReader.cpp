@@ -1,24 +1,60 @@
 #include "DwarfReader.h"
 #include <iostream>
 
-// Stub: Build a fake IR tree with one CU scope and one dummy struct type.
+// Non-streaming entry point: collects every streamed CU into one tree.
 std::unique_ptr<IRScope> DwarfReader::readObject(
     const std::string& path,
     IRTypeTable& typeTable,
     IRMaps& maps
+) {
+    std::unique_ptr<IRScope> root;
+    bool wrapped = false;
+    readObjectStreaming(path, typeTable, maps,
+        [&](std::unique_ptr<IRScope> cu) {
+            if (!root) {
+                root = std::move(cu);
+                return;
+            }
+            // More than one CU: hang them all under a synthetic root.
+            if (!wrapped) {
+                wrapped = true;
+                auto top = std::make_unique<IRScope>();
+                top->kind = IRScopeKind::CompileUnit;
+                top->name = path;
+                root->parent = top.get();
+                top->children.push_back(std::move(root));
+                root = std::move(top);
+            }
+            cu->parent = root.get();
+            root->children.push_back(std::move(cu));
+        });
+    return root;
+}
+
+// Stub: Build a fake IR tree with one CU scope and one dummy struct type.
+void DwarfReader::readObjectStreaming(
+    const std::string& path,
+    IRTypeTable& typeTable,
+    IRMaps& maps,
+    const std::function<void(std::unique_ptr<IRScope>)>& onUnit
 ) {
     std::cout << "[DwarfReader] reading DWARF from " << path << " (stub)\n";
+    filterState = IRFilterState();
 
+    // TODO: iterate real .debug_info unit headers; the stub has one CU.
+    // A real scanner checks keepUnit on DW_AT_name and jumps to the next
+    // unit header, and skips pruned namespaces through DW_AT_sibling.
     auto root = std::make_unique<IRScope>();
     root->kind = IRScopeKind::CompileUnit;
     root->name = path;
+    if (filter && !filter->keepUnit(root->name)) return;
 
     // Create a dummy struct type in IR
     IRType* t = typeTable.createType(IRTypeKind::StructOrUnion);
     t->name = "DummyFromDwarf";
     t->isUnion = false;
     t->sizeBytes = 16;
-    t->fields.push_back(IRField{
+    typeTable.addField(t, IRField{
         "fieldA",
         t->id, // self-type just for circular demo (nonsense, but ok stub)
         0,0,0,false
@@ -35,10 +71,10 @@ std::unique_ptr<IRScope> DwarfReader::readObject(
     root->declaredSymbols.push_back(varSym);
 
     // Fill ID maps with fake DIE offset 0x1234
-    maps.dwarfDieToIR[0x1234] = t->id;
-    maps.irToDwarfDie[t->id]  = 0x1234;
+    maps.linkDwarf(t->id, 0x1234);
 
-    return root;
+    if (filter && !ApplyFilter(*root, typeTable, *filter, &filterState)) return;
+    onUnit(std::move(root));
 }
 
 std::unique_ptr<IRScope> DwarfReader::readFromModel(
@@ -67,7 +103,7 @@ std::unique_ptr<IRScope> DwarfReader::readFromModel(
     f.name = "self";
     f.type = t->id;
     f.byteOffset = 0;
-    t->fields.push_back(f);
+    typeTable.addField(t, f);
 
     root->declaredTypes.push_back(t->id);
 
@@ -77,8 +113,7 @@ std::unique_ptr<IRScope> DwarfReader::readFromModel(
     s.type = t->id;
     root->declaredSymbols.push_back(s);
 
-    maps.dwarfDieToIR[model.originalDieOffset] = t->id;
-    maps.irToDwarfDie[t->id] = model.originalDieOffset;
+    maps.linkDwarf(t->id, model.originalDieOffset);
     return root;
 }
 
@@ -1,9 +1,11 @@
 #pragma once
+#include <functional>
 #include <memory>
 #include <string>
 #include "../ir/IRNode.h"
 #include "../ir/IRTypeTable.h"
 #include "../ir/IRMaps.h"
+#include "../ir/IRFilter.h"
 #include "DwarfNode.h"
 
 // DwarfReader:
@@ -12,12 +14,26 @@
 // 3. fill IRMaps.dwarfDieToIR
 class DwarfReader {
 public:
+    // Optional; must outlive the reads. Filtered-out units are skipped
+    // before they are decoded and the rest are pruned before onUnit.
+    void setFilter(const IRFilter* f) { filter = f; }
+
     std::unique_ptr<IRScope> readObject(
         const std::string& path,
         IRTypeTable& typeTable,
         IRMaps& maps
     );
 
+    // Streaming variant: hands each compile unit to onUnit as soon as it is
+    // decoded, so translation of CU 1 can overlap decoding of CU 2.
+    // Types still go into the shared typeTable; only the scope trees stream.
+    void readObjectStreaming(
+        const std::string& path,
+        IRTypeTable& typeTable,
+        IRMaps& maps,
+        const std::function<void(std::unique_ptr<IRScope>)>& onUnit
+    );
+
     // NEW: Build IR from an already-existing DwarfNode tree (for tests).
     std::unique_ptr<IRScope> readFromModel(
         const DwarfNode& model,
@@ -26,6 +42,9 @@ public:
     );
 
 private:
+    const IRFilter* filter = nullptr;
+    IRFilterState   filterState; // per streaming read
+
     // internal helpers (future)
     std::unique_ptr<DwarfNode> parseRawDwarf(const std::string& path);
     void importCompileUnit(DwarfNode* cuNode,
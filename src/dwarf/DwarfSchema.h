@@ -0,0 +1,205 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "../util/RecordSchema.h"
+
+// DwarfSchema:
+// DW_TAG_* layouts described once as (attribute, form) lists. One schema
+// yields both the .debug_abbrev declaration and a typed DIE body codec,
+// so the writer emits DIEs with no per-attribute switch, and a reader that
+// sees an abbrev matching a schema (matchesAbbrev) can take the same fast
+// path instead of the generic form-by-form walk, as DwarfVerifier does.
+//
+// Assumes 32-bit DWARF and 8-byte addresses.
+namespace dw {
+
+template <std::uint16_t Form, typename Codec>
+struct FormSpec {
+    static constexpr std::uint16_t kForm = Form;
+    using codec = Codec;
+};
+
+using FormAddr        = FormSpec<0x01, schema::Fixed<std::uint64_t>>;
+using FormData2       = FormSpec<0x05, schema::Fixed<std::uint16_t>>;
+using FormData4       = FormSpec<0x06, schema::Fixed<std::uint32_t>>;
+using FormData8       = FormSpec<0x07, schema::Fixed<std::uint64_t>>;
+using FormString      = FormSpec<0x08, schema::CString>;
+using FormData1       = FormSpec<0x0b, schema::Fixed<std::uint8_t>>;
+using FormSdata       = FormSpec<0x0d, schema::Sleb>;
+using FormStrp        = FormSpec<0x0e, schema::Fixed<std::uint32_t>>;
+using FormUdata       = FormSpec<0x0f, schema::Uleb>;
+using FormRef4        = FormSpec<0x13, schema::Fixed<std::uint32_t>>;
+using FormExprloc     = FormSpec<0x18, schema::UlebBlock>;
+using FormFlagPresent = FormSpec<0x19, schema::Present>;
+
+template <std::uint16_t At, typename Form>
+struct Attr {
+    static constexpr std::uint16_t kAttr = At;
+    static constexpr std::uint16_t kForm = Form::kForm;
+    using Codec = typename Form::codec;
+};
+
+template <std::uint16_t Tag, bool HasChildren, typename... Attrs>
+struct Die {
+    static constexpr std::uint16_t kTag = Tag;
+    static constexpr bool kHasChildren = HasChildren;
+    using Fields = schema::FieldList<typename Attrs::Codec...>;
+    using Values = typename Fields::Values;
+
+    // Abbrev declaration: code, tag, children flag, (attr, form)*, 0, 0.
+    static void appendAbbrev(std::uint64_t code, std::vector<std::uint8_t>& out) {
+        schema::Uleb::write(out, code);
+        schema::Uleb::write(out, Tag);
+        out.push_back(HasChildren ? 1 : 0);
+        ((schema::Uleb::write(out, Attrs::kAttr), schema::Uleb::write(out, Attrs::kForm)), ...);
+        out.push_back(0);
+        out.push_back(0);
+    }
+
+    // True when the (attr, form) pairs following an abbrev's tag and
+    // children byte are exactly this schema's.
+    static bool matchesAbbrev(IRBytes attrSpecs) {
+        const std::uint8_t* p = attrSpecs.data;
+        const std::uint8_t* end = p + attrSpecs.size;
+        bool ok = (true && ... && matchOne(p, end, Attrs::kAttr, Attrs::kForm));
+        std::uint64_t a = 0, f = 0;
+        return ok && schema::Uleb::read(p, end, a) && schema::Uleb::read(p, end, f) &&
+               a == 0 && f == 0;
+    }
+
+    // DIE = ULEB abbrev code + attribute values.
+    static void encode(std::uint64_t code, const Values& v, std::vector<std::uint8_t>& out) {
+        schema::Uleb::write(out, code);
+        Fields::encode(v, out);
+    }
+
+    // 'body' starts right after the abbrev code.
+    static bool decode(IRBytes body, Values& v, std::size_t* consumed = nullptr) {
+        return Fields::decode(body, v, consumed);
+    }
+
+    // Calls f(attr, form, value) for each decoded attribute, in order.
+    template <typename F>
+    static void forEachAttr(const Values& v, F&& f) {
+        forEachImpl(v, f, std::index_sequence_for<Attrs...>{});
+    }
+
+private:
+    template <typename F, std::size_t... I>
+    static void forEachImpl(const Values& v, F& f, std::index_sequence<I...>) {
+        (f(Attrs::kAttr, Attrs::kForm, std::get<I>(v)), ...);
+    }
+
+    static bool matchOne(const std::uint8_t*& p, const std::uint8_t* end,
+                         std::uint16_t at, std::uint16_t form) {
+        std::uint64_t a = 0, f = 0;
+        return schema::Uleb::read(p, end, a) && schema::Uleb::read(p, end, f) &&
+               a == at && f == form;
+    }
+};
+
+// DW_AT_* used below
+constexpr std::uint16_t DW_AT_location             = 0x02;
+constexpr std::uint16_t DW_AT_name                 = 0x03;
+constexpr std::uint16_t DW_AT_byte_size            = 0x0b;
+constexpr std::uint16_t DW_AT_bit_size             = 0x0d;
+constexpr std::uint16_t DW_AT_low_pc               = 0x11;
+constexpr std::uint16_t DW_AT_high_pc              = 0x12;
+constexpr std::uint16_t DW_AT_count                = 0x37;
+constexpr std::uint16_t DW_AT_data_member_location = 0x38;
+constexpr std::uint16_t DW_AT_decl_file            = 0x3a;
+constexpr std::uint16_t DW_AT_decl_line            = 0x3b;
+constexpr std::uint16_t DW_AT_declaration          = 0x3c;
+constexpr std::uint16_t DW_AT_encoding             = 0x3e;
+constexpr std::uint16_t DW_AT_frame_base           = 0x40;
+constexpr std::uint16_t DW_AT_type                 = 0x49;
+constexpr std::uint16_t DW_AT_abstract_origin      = 0x31;
+constexpr std::uint16_t DW_AT_call_column          = 0x57;
+constexpr std::uint16_t DW_AT_call_file            = 0x58;
+constexpr std::uint16_t DW_AT_call_line            = 0x59;
+constexpr std::uint16_t DW_AT_data_bit_offset      = 0x6b;
+
+struct ArrayType : Die<0x01, true, Attr<DW_AT_type, FormRef4>> {
+    enum { Type };
+};
+
+struct FormalParameter : Die<0x05, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_type, FormRef4>,
+        Attr<DW_AT_location, FormExprloc>> {
+    enum { Name, Type, Location };
+};
+
+struct Member : Die<0x0d, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_type, FormRef4>,
+        Attr<DW_AT_data_member_location, FormUdata>> {
+    enum { Name, Type, DataMemberLocation };
+};
+
+// DWARF 5 bitfield member: position in bits from the start of the struct.
+struct BitfieldMember : Die<0x0d, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_type, FormRef4>,
+        Attr<DW_AT_data_bit_offset, FormUdata>, Attr<DW_AT_bit_size, FormData1>> {
+    enum { Name, Type, DataBitOffset, BitSize };
+};
+
+struct PointerType : Die<0x0f, false,
+        Attr<DW_AT_byte_size, FormData1>, Attr<DW_AT_type, FormRef4>> {
+    enum { ByteSize, Type };
+};
+
+struct StructureType : Die<0x13, true,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_byte_size, FormUdata>,
+        Attr<DW_AT_decl_file, FormUdata>, Attr<DW_AT_decl_line, FormUdata>> {
+    enum { Name, ByteSize, DeclFile, DeclLine };
+};
+
+struct StructureDecl : Die<0x13, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_declaration, FormFlagPresent>> {
+    enum { Name, Declaration };
+};
+
+struct Typedef : Die<0x16, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_type, FormRef4>> {
+    enum { Name, Type };
+};
+
+struct UnionType : Die<0x17, true,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_byte_size, FormUdata>,
+        Attr<DW_AT_decl_file, FormUdata>, Attr<DW_AT_decl_line, FormUdata>> {
+    enum { Name, ByteSize, DeclFile, DeclLine };
+};
+
+struct InlinedSubroutine : Die<0x1d, true,
+        Attr<DW_AT_abstract_origin, FormRef4>,
+        Attr<DW_AT_low_pc, FormAddr>, Attr<DW_AT_high_pc, FormData8>,
+        Attr<DW_AT_call_file, FormUdata>, Attr<DW_AT_call_line, FormUdata>,
+        Attr<DW_AT_call_column, FormUdata>> {
+    enum { AbstractOrigin, LowPC, HighPC, CallFile, CallLine, CallColumn };
+};
+
+struct SubrangeType : Die<0x21, false,
+        Attr<DW_AT_type, FormRef4>, Attr<DW_AT_count, FormUdata>> {
+    enum { Type, Count };
+};
+
+struct BaseType : Die<0x24, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_encoding, FormData1>,
+        Attr<DW_AT_byte_size, FormData1>> {
+    enum { Name, Encoding, ByteSize };
+};
+
+struct Subprogram : Die<0x2e, true,
+        Attr<DW_AT_name, FormStrp>,
+        Attr<DW_AT_low_pc, FormAddr>, Attr<DW_AT_high_pc, FormData8>,
+        Attr<DW_AT_frame_base, FormExprloc>> {
+    enum { Name, LowPC, HighPC, FrameBase };
+};
+
+struct Variable : Die<0x34, false,
+        Attr<DW_AT_name, FormStrp>, Attr<DW_AT_type, FormRef4>,
+        Attr<DW_AT_location, FormExprloc>> {
+    enum { Name, Type, Location };
+};
+
+} // namespace dw
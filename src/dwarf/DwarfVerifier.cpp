@@ -0,0 +1,762 @@
+#include "DwarfVerifier.h"
+#include "DwarfCompress.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include "DwarfSchema.h"
+#include "../util/ParallelFor.h"
+#include "../util/RecordSchema.h"
+
+namespace {
+
+using schema::LoadLE;
+
+constexpr std::uint16_t DW_FORM_addr           = 0x01;
+constexpr std::uint16_t DW_FORM_block2         = 0x03;
+constexpr std::uint16_t DW_FORM_block4         = 0x04;
+constexpr std::uint16_t DW_FORM_data2          = 0x05;
+constexpr std::uint16_t DW_FORM_data4          = 0x06;
+constexpr std::uint16_t DW_FORM_data8          = 0x07;
+constexpr std::uint16_t DW_FORM_string         = 0x08;
+constexpr std::uint16_t DW_FORM_block          = 0x09;
+constexpr std::uint16_t DW_FORM_block1         = 0x0a;
+constexpr std::uint16_t DW_FORM_data1          = 0x0b;
+constexpr std::uint16_t DW_FORM_flag           = 0x0c;
+constexpr std::uint16_t DW_FORM_sdata          = 0x0d;
+constexpr std::uint16_t DW_FORM_strp           = 0x0e;
+constexpr std::uint16_t DW_FORM_udata          = 0x0f;
+constexpr std::uint16_t DW_FORM_ref_addr       = 0x10;
+constexpr std::uint16_t DW_FORM_ref1           = 0x11;
+constexpr std::uint16_t DW_FORM_ref2           = 0x12;
+constexpr std::uint16_t DW_FORM_ref4           = 0x13;
+constexpr std::uint16_t DW_FORM_ref8           = 0x14;
+constexpr std::uint16_t DW_FORM_ref_udata      = 0x15;
+constexpr std::uint16_t DW_FORM_indirect       = 0x16;
+constexpr std::uint16_t DW_FORM_sec_offset     = 0x17;
+constexpr std::uint16_t DW_FORM_exprloc        = 0x18;
+constexpr std::uint16_t DW_FORM_flag_present   = 0x19;
+constexpr std::uint16_t DW_FORM_strx           = 0x1a;
+constexpr std::uint16_t DW_FORM_addrx          = 0x1b;
+constexpr std::uint16_t DW_FORM_ref_sup4       = 0x1c;
+constexpr std::uint16_t DW_FORM_strp_sup       = 0x1d;
+constexpr std::uint16_t DW_FORM_data16         = 0x1e;
+constexpr std::uint16_t DW_FORM_line_strp      = 0x1f;
+constexpr std::uint16_t DW_FORM_ref_sig8       = 0x20;
+constexpr std::uint16_t DW_FORM_implicit_const = 0x21;
+constexpr std::uint16_t DW_FORM_loclistx       = 0x22;
+constexpr std::uint16_t DW_FORM_rnglistx       = 0x23;
+constexpr std::uint16_t DW_FORM_ref_sup8       = 0x24;
+constexpr std::uint16_t DW_FORM_strx1          = 0x25;
+constexpr std::uint16_t DW_FORM_strx2          = 0x26;
+constexpr std::uint16_t DW_FORM_strx3          = 0x27;
+constexpr std::uint16_t DW_FORM_strx4          = 0x28;
+constexpr std::uint16_t DW_FORM_addrx1         = 0x29;
+constexpr std::uint16_t DW_FORM_addrx2         = 0x2a;
+constexpr std::uint16_t DW_FORM_addrx3         = 0x2b;
+constexpr std::uint16_t DW_FORM_addrx4         = 0x2c;
+constexpr std::uint16_t DW_FORM_GNU_addr_index = 0x1f01;
+constexpr std::uint16_t DW_FORM_GNU_str_index  = 0x1f02;
+constexpr std::uint16_t DW_FORM_GNU_ref_alt    = 0x1f20;
+constexpr std::uint16_t DW_FORM_GNU_strp_alt   = 0x1f21;
+
+constexpr std::uint32_t DW_AT_sibling          = 0x01;
+constexpr std::uint32_t DW_AT_name             = 0x03;
+constexpr std::uint32_t DW_AT_stmt_list        = 0x10;
+constexpr std::uint32_t DW_AT_import           = 0x18;
+constexpr std::uint32_t DW_AT_comp_dir         = 0x1b;
+constexpr std::uint32_t DW_AT_containing_type  = 0x1d;
+constexpr std::uint32_t DW_AT_producer         = 0x25;
+constexpr std::uint32_t DW_AT_abstract_origin  = 0x31;
+constexpr std::uint32_t DW_AT_specification    = 0x47;
+constexpr std::uint32_t DW_AT_type             = 0x49;
+constexpr std::uint32_t DW_AT_linkage_name     = 0x6e;
+
+enum class FormClass : std::uint8_t { Unknown, String, Reference, Other };
+
+struct FormInfo {
+    FormClass    cls = FormClass::Unknown;
+    std::uint8_t minVersion = 2;
+};
+
+FormInfo DescribeForm(std::uint64_t form) {
+    switch (form) {
+    case DW_FORM_string: case DW_FORM_strp:
+        return {FormClass::String, 2};
+    case DW_FORM_ref_addr: case DW_FORM_ref1: case DW_FORM_ref2: case DW_FORM_ref4:
+    case DW_FORM_ref8: case DW_FORM_ref_udata:
+        return {FormClass::Reference, 2};
+    case DW_FORM_addr: case DW_FORM_block2: case DW_FORM_block4: case DW_FORM_data2:
+    case DW_FORM_data4: case DW_FORM_data8: case DW_FORM_block: case DW_FORM_block1:
+    case DW_FORM_data1: case DW_FORM_flag: case DW_FORM_sdata: case DW_FORM_udata:
+    case DW_FORM_indirect:
+        return {FormClass::Other, 2};
+    case DW_FORM_ref_sig8:
+        return {FormClass::Reference, 4};
+    case DW_FORM_sec_offset: case DW_FORM_exprloc: case DW_FORM_flag_present:
+        return {FormClass::Other, 4};
+    case DW_FORM_strx: case DW_FORM_strp_sup: case DW_FORM_line_strp:
+    case DW_FORM_strx1: case DW_FORM_strx2: case DW_FORM_strx3: case DW_FORM_strx4:
+        return {FormClass::String, 5};
+    case DW_FORM_ref_sup4: case DW_FORM_ref_sup8:
+        return {FormClass::Reference, 5};
+    case DW_FORM_addrx: case DW_FORM_data16: case DW_FORM_implicit_const:
+    case DW_FORM_loclistx: case DW_FORM_rnglistx: case DW_FORM_addrx1: case DW_FORM_addrx2:
+    case DW_FORM_addrx3: case DW_FORM_addrx4:
+        return {FormClass::Other, 5};
+    // GNU extensions predate DWARF 5 and appear in version 4 units.
+    case DW_FORM_GNU_str_index: case DW_FORM_GNU_strp_alt:
+        return {FormClass::String, 4};
+    case DW_FORM_GNU_ref_alt:
+        return {FormClass::Reference, 4};
+    case DW_FORM_GNU_addr_index:
+        return {FormClass::Other, 4};
+    default:
+        return {};
+    }
+}
+
+// The form class an attribute requires, or Other when any form will do.
+FormClass RequiredClass(std::uint64_t attr) {
+    switch (attr) {
+    case DW_AT_name: case DW_AT_linkage_name: case DW_AT_producer: case DW_AT_comp_dir:
+        return FormClass::String;
+    case DW_AT_sibling: case DW_AT_type: case DW_AT_abstract_origin: case DW_AT_specification:
+    case DW_AT_containing_type: case DW_AT_import:
+        return FormClass::Reference;
+    default:
+        return FormClass::Other;
+    }
+}
+
+bool ReadUleb(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v) {
+    return schema::Uleb::read(p, end, v);
+}
+
+bool SkipLeb(const std::uint8_t*& p, const std::uint8_t* end) {
+    while (p < end) {
+        if (!(*p++ & 0x80)) return true;
+    }
+    return false;
+}
+
+std::uint64_t LoadSized(const std::uint8_t* p, unsigned size) {
+    switch (size) {
+    case 1:  return *p;
+    case 2:  return LoadLE<std::uint16_t>(p);
+    case 3:  return std::uint64_t(p[0]) | (std::uint64_t(p[1]) << 8) | (std::uint64_t(p[2]) << 16);
+    case 4:  return LoadLE<std::uint32_t>(p);
+    default: return LoadLE<std::uint64_t>(p);
+    }
+}
+
+std::string Hex(std::uint64_t v) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s;
+    do {
+        s.insert(s.begin(), digits[v & 0xf]);
+        v >>= 4;
+    } while (v);
+    return "0x" + s;
+}
+
+// DIE layouts with a dw:: schema. DIEs whose abbrev matches one are decoded
+// in a single bounds-checked pass instead of form by form.
+template <typename... Dies>
+struct KnownDieList {
+    // 1 + the index of the schema the abbrev declares, or 0.
+    static std::uint8_t match(std::uint32_t tag, bool hasChildren, IRBytes specs) {
+        std::uint8_t index = 0, found = 0;
+        ((++index, found = !found && Dies::kTag == tag && Dies::kHasChildren == hasChildren &&
+                                   Dies::matchesAbbrev(specs) ? index : found), ...);
+        return found;
+    }
+
+    // Calls f(Die{}) for schema 'known' (from match); false when f is not called.
+    template <typename F>
+    static bool with(std::uint8_t known, F&& f) {
+        std::uint8_t index = 0;
+        bool result = false;
+        ((++index == known && (result = f(Dies{}), true)), ...);
+        return result;
+    }
+};
+
+using KnownDies = KnownDieList<dw::ArrayType, dw::FormalParameter, dw::Member, dw::BitfieldMember,
+                               dw::PointerType, dw::StructureType, dw::StructureDecl, dw::Typedef,
+                               dw::UnionType, dw::InlinedSubroutine, dw::SubrangeType, dw::BaseType,
+                               dw::Subprogram, dw::Variable>;
+
+struct AttrSpec {
+    std::uint32_t attr = 0;
+    std::uint32_t form = 0;
+};
+
+struct Abbrev {
+    std::uint64_t code = 0;
+    std::uint32_t tag = 0;
+    bool          hasChildren = false;
+    std::uint32_t firstSpec = 0;
+    std::uint32_t specCount = 0;
+    std::uint8_t  known = 0;       // KnownDies::match result
+};
+
+struct AbbrevTable {
+    std::uint64_t       offset = 0;
+    std::vector<Abbrev>   abbrevs; // sorted by code
+    std::vector<AttrSpec> specs;
+    bool         dense = true;     // abbrevs[i].code == i + 1
+    bool         usable = false;   // parsed far enough to walk DIEs with
+    std::uint8_t minVersion = 2;   // newest form's DWARF version
+
+    const Abbrev* find(std::uint64_t code) const {
+        if (dense) return code - 1 < abbrevs.size() ? &abbrevs[code - 1] : nullptr;
+        auto it = std::lower_bound(abbrevs.begin(), abbrevs.end(), code,
+                                   [](const Abbrev& a, std::uint64_t c) { return a.code < c; });
+        return it != abbrevs.end() && it->code == code ? &*it : nullptr;
+    }
+};
+
+void ParseAbbrevTable(IRBytes section, AbbrevTable& table, VerifyReport& report) {
+    const char* where = ".debug_abbrev";
+    if (table.offset >= section.size) {
+        report.fail(where, table.offset, "abbrev table offset past the end of .debug_abbrev");
+        return;
+    }
+    const std::uint8_t* base = section.data;
+    const std::uint8_t* p = base + table.offset;
+    const std::uint8_t* end = base + section.size;
+
+    for (;;) {
+        std::uint64_t at = static_cast<std::uint64_t>(p - base);
+        std::uint64_t code = 0, tag = 0;
+        if (!ReadUleb(p, end, code)) return report.fail(where, at, "truncated abbrev code");
+        if (code == 0) break;
+        if (!ReadUleb(p, end, tag) || p >= end) return report.fail(where, at, "truncated abbrev declaration");
+        if (tag == 0 || tag > 0xffff) report.fail(where, at, "invalid tag " + Hex(tag));
+        std::uint8_t children = *p++;
+        if (children > 1) report.fail(where, at, "children flag is " + std::to_string(children));
+
+        Abbrev a;
+        a.code = code;
+        a.tag = static_cast<std::uint32_t>(tag);
+        a.hasChildren = children == 1;
+        a.firstSpec = static_cast<std::uint32_t>(table.specs.size());
+        const std::uint8_t* specStart = p;
+        for (;;) {
+            std::uint64_t specAt = static_cast<std::uint64_t>(p - base);
+            std::uint64_t attr = 0, form = 0;
+            if (!ReadUleb(p, end, attr) || !ReadUleb(p, end, form)) {
+                return report.fail(where, specAt, "truncated attribute specification");
+            }
+            if (attr == 0 && form == 0) break;
+            if (attr == 0 || form == 0) {
+                report.fail(where, specAt, "attribute or form is zero");
+                return;
+            }
+            FormInfo info = DescribeForm(form);
+            if (info.cls == FormClass::Unknown) {
+                report.fail(where, specAt, "unknown form " + Hex(form));
+                return; // DIE sizes are unknown from here on
+            }
+            if (form == DW_FORM_implicit_const && !SkipLeb(p, end)) {
+                return report.fail(where, specAt, "truncated implicit_const value");
+            }
+            FormClass required = RequiredClass(attr);
+            if (required != FormClass::Other && info.cls != required && form != DW_FORM_indirect) {
+                report.fail(where, specAt, "attribute " + Hex(attr) + " cannot use form " + Hex(form));
+            }
+            table.minVersion = std::max(table.minVersion, info.minVersion);
+            table.specs.push_back({static_cast<std::uint32_t>(attr), static_cast<std::uint32_t>(form)});
+        }
+        a.specCount = static_cast<std::uint32_t>(table.specs.size()) - a.firstSpec;
+        a.known = KnownDies::match(a.tag, a.hasChildren,
+                                   IRBytes{specStart, static_cast<std::size_t>(p - specStart)});
+        table.abbrevs.push_back(a);
+    }
+
+    std::stable_sort(table.abbrevs.begin(), table.abbrevs.end(),
+                     [](const Abbrev& l, const Abbrev& r) { return l.code < r.code; });
+    for (std::size_t i = 0; i < table.abbrevs.size(); ++i) {
+        if (i && table.abbrevs[i].code == table.abbrevs[i - 1].code) {
+            report.fail(where, table.offset, "duplicate abbrev code " + std::to_string(table.abbrevs[i].code));
+        }
+        table.dense = table.dense && table.abbrevs[i].code == i + 1;
+    }
+    table.usable = true;
+    ++report.itemsChecked;
+}
+
+struct Unit {
+    std::uint64_t offset = 0;    // header start in .debug_info
+    std::uint64_t dieStart = 0;
+    std::uint64_t end = 0;
+    std::uint64_t abbrevOffset = 0;
+    std::uint8_t  version = 0;
+    std::uint8_t  addrSize = 8;
+    std::uint8_t  offsetSize = 4;
+    std::size_t   table = 0;     // index into the parsed abbrev tables
+};
+
+// Reads every unit header; stops at the first unit whose length is unusable.
+std::vector<Unit> ScanUnits(IRBytes info, VerifyReport& report) {
+    const char* where = ".debug_info";
+    std::vector<Unit> units;
+    const std::uint8_t* base = info.data;
+    std::uint64_t pos = 0;
+    while (pos < info.size) {
+        Unit u;
+        u.offset = pos;
+        if (info.size - pos < 4) {
+            report.fail(where, pos, "truncated unit length");
+            break;
+        }
+        std::uint64_t length = LoadLE<std::uint32_t>(base + pos);
+        std::uint64_t p = pos + 4;
+        if (length == 0xffffffff) {
+            if (info.size - p < 8) {
+                report.fail(where, pos, "truncated 64-bit unit length");
+                break;
+            }
+            length = LoadLE<std::uint64_t>(base + p);
+            p += 8;
+            u.offsetSize = 8;
+        } else if (length >= 0xfffffff0) {
+            report.fail(where, pos, "reserved unit length " + Hex(length));
+            break;
+        }
+        if (length > info.size - p) {
+            report.fail(where, pos, "unit extends past the end of .debug_info");
+            break;
+        }
+        u.end = p + length;
+        pos = u.end;
+
+        if (length < 2) {
+            report.fail(where, u.offset, "unit too short for a header");
+            continue;
+        }
+        std::uint16_t version = LoadLE<std::uint16_t>(base + p);
+        p += 2;
+        if (version < 2 || version > 5) {
+            report.fail(where, u.offset, "unsupported DWARF version " + std::to_string(version));
+            continue;
+        }
+        u.version = static_cast<std::uint8_t>(version);
+
+        // v5: unit_type, address_size, abbrev offset; v2-4: abbrev offset, address_size.
+        std::uint64_t need = version >= 5 ? 2 + u.offsetSize : u.offsetSize + 1;
+        if (u.end - p < need) {
+            report.fail(where, u.offset, "truncated unit header");
+            continue;
+        }
+        std::uint8_t unitType = 1;
+        if (version >= 5) {
+            unitType = base[p];
+            u.addrSize = base[p + 1];
+            u.abbrevOffset = LoadSized(base + p + 2, u.offsetSize);
+            p += need;
+            std::uint64_t extra = 0;
+            switch (unitType) {
+            case 1: case 3:  break;                         // compile, partial
+            case 2: case 6:  extra = 8 + u.offsetSize; break; // type: signature + type offset
+            case 4: case 5:  extra = 8; break;               // skeleton, split: dwo_id
+            default:
+                report.fail(where, u.offset, "unknown unit type " + Hex(unitType));
+                continue;
+            }
+            if (u.end - p < extra) {
+                report.fail(where, u.offset, "truncated unit header");
+                continue;
+            }
+            p += extra;
+        } else {
+            u.abbrevOffset = LoadSized(base + p, u.offsetSize);
+            u.addrSize = base[p + u.offsetSize];
+            p += need;
+        }
+        if (u.addrSize != 4 && u.addrSize != 8) {
+            report.fail(where, u.offset, "address size " + std::to_string(u.addrSize));
+            continue;
+        }
+        u.dieStart = p;
+        units.push_back(u);
+    }
+    return units;
+}
+
+struct Ref {
+    std::uint64_t from;   // DIE holding the reference
+    std::uint64_t target; // .debug_info offset
+    bool          sibling;
+};
+
+struct UnitResult {
+    VerifyReport               report;
+    std::vector<std::uint64_t> dies;      // DIE offsets, ascending
+    std::vector<Ref>           globalRefs; // DW_FORM_ref_addr
+};
+
+class UnitWalker {
+public:
+    UnitWalker(const DwarfSections& s, const Unit& u, const AbbrevTable& t, UnitResult& r)
+        : sec(s), unit(u), table(t), out(r) {}
+
+    void run() {
+        const char* where = ".debug_info";
+        if (table.minVersion > unit.version) {
+            out.report.fail(where, unit.offset, "abbrev table uses DWARF " +
+                            std::to_string(table.minVersion) + " forms in a version " +
+                            std::to_string(unit.version) + " unit");
+        }
+
+        const std::uint8_t* base = sec.info.data;
+        const std::uint8_t* p = base + unit.dieStart;
+        end = base + unit.end;
+        std::size_t depth = 0;
+        bool closed = false; // the unit DIE and its children are complete
+        // The schemas are laid out for 32-bit DWARF with 8-byte addresses.
+        const bool schemaLayout = unit.offsetSize == 4 && unit.addrSize == 8;
+        std::vector<Ref> localRefs;
+
+        while (p < end) {
+            std::uint64_t dieOffset = static_cast<std::uint64_t>(p - base);
+            std::uint64_t code = 0;
+            if (!ReadUleb(p, end, code)) {
+                out.report.fail(where, dieOffset, "truncated abbrev code");
+                break;
+            }
+            if (code == 0) {
+                if (depth == 0) continue; // trailing padding
+                if (--depth == 0) closed = true;
+                continue;
+            }
+            if (closed) {
+                out.report.fail(where, dieOffset, "DIE after the unit DIE's children ended");
+                break;
+            }
+            const Abbrev* abbrev = table.find(code);
+            if (!abbrev) {
+                out.report.fail(where, dieOffset, "abbrev code " + std::to_string(code) +
+                                " not in table at " + Hex(unit.abbrevOffset));
+                break;
+            }
+            out.dies.push_back(dieOffset);
+
+            bool ok = true;
+            if (abbrev->known && schemaLayout) {
+                ok = knownDie(p, dieOffset, abbrev->known, localRefs);
+            } else {
+                for (std::uint32_t i = 0; i < abbrev->specCount && ok; ++i) {
+                    const AttrSpec& spec = table.specs[abbrev->firstSpec + i];
+                    ok = attribute(p, dieOffset, spec.attr, spec.form, localRefs);
+                }
+            }
+            if (!ok) break;
+
+            if (abbrev->hasChildren) ++depth;
+            else if (depth == 0) closed = true;
+        }
+        if (depth) out.report.fail(where, unit.offset, "children list not terminated before unit end");
+
+        for (const Ref& r : localRefs) {
+            if (!std::binary_search(out.dies.begin(), out.dies.end(), r.target)) {
+                out.report.fail(where, r.from, "reference " + Hex(r.target) + " is not a DIE in this unit");
+            } else if (r.sibling && r.target <= r.from) {
+                out.report.fail(where, r.from, "DW_AT_sibling points backwards");
+            }
+        }
+        out.report.itemsChecked += out.dies.size();
+    }
+
+private:
+    bool truncated(std::uint64_t dieOffset) {
+        out.report.fail(".debug_info", dieOffset, "attribute value runs past the unit end");
+        return false;
+    }
+
+    bool need(const std::uint8_t* p, std::uint64_t n, std::uint64_t dieOffset) {
+        return static_cast<std::uint64_t>(end - p) >= n || truncated(dieOffset);
+    }
+
+    bool offsetInto(IRBytes target, const char* name, std::uint64_t v, std::uint64_t dieOffset) {
+        if (v < target.size) return true;
+        out.report.fail(".debug_info", dieOffset, std::string("offset ") + Hex(v) + " past the end of " + name);
+        return true; // value size was fine; keep walking
+    }
+
+    void localRef(std::uint64_t dieOffset, std::uint32_t attr, std::uint64_t v, std::vector<Ref>& localRefs) {
+        std::uint64_t target = unit.offset + v;
+        if (v >= unit.end - unit.offset || target < unit.dieStart) {
+            out.report.fail(".debug_info", dieOffset, "reference " + Hex(v) + " outside its unit");
+        } else {
+            localRefs.push_back({dieOffset, target, attr == DW_AT_sibling});
+        }
+    }
+
+    // A DIE laid out as a dw:: schema: decoded at once, then given the same
+    // reference and string offset checks as attribute().
+    bool knownDie(const std::uint8_t*& p, std::uint64_t dieOffset, std::uint8_t known,
+                  std::vector<Ref>& localRefs) {
+        return KnownDies::with(known, [&](auto die) {
+            using Die = decltype(die);
+            typename Die::Values v;
+            std::size_t used = 0;
+            if (!Die::decode(IRBytes{p, static_cast<std::size_t>(end - p)}, v, &used)) {
+                return truncated(dieOffset);
+            }
+            p += used;
+            Die::forEachAttr(v, [&](std::uint16_t attr, std::uint16_t form, const auto& value) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::uint32_t>) {
+                    if (form == DW_FORM_ref4) localRef(dieOffset, attr, value, localRefs);
+                    if (form == DW_FORM_strp) offsetInto(sec.str, ".debug_str", value, dieOffset);
+                }
+            });
+            return true;
+        });
+    }
+
+    bool attribute(const std::uint8_t*& p, std::uint64_t dieOffset, std::uint32_t attr,
+                   std::uint64_t form, std::vector<Ref>& localRefs) {
+        for (int hops = 0; form == DW_FORM_indirect; ++hops) {
+            if (hops == 8 || !ReadUleb(p, end, form)) {
+                out.report.fail(".debug_info", dieOffset, "bad DW_FORM_indirect");
+                return false;
+            }
+        }
+
+        unsigned fixed = 0;
+        switch (form) {
+        case DW_FORM_flag_present: case DW_FORM_implicit_const:
+            return true;
+        case DW_FORM_data1: case DW_FORM_flag: case DW_FORM_strx1: case DW_FORM_addrx1:
+            fixed = 1; break;
+        case DW_FORM_data2: case DW_FORM_strx2: case DW_FORM_addrx2:
+            fixed = 2; break;
+        case DW_FORM_strx3: case DW_FORM_addrx3:
+            fixed = 3; break;
+        case DW_FORM_data4: case DW_FORM_strx4: case DW_FORM_addrx4: case DW_FORM_ref_sup4:
+            fixed = 4; break;
+        case DW_FORM_data8: case DW_FORM_ref_sig8: case DW_FORM_ref_sup8:
+            fixed = 8; break;
+        case DW_FORM_data16:
+            fixed = 16; break;
+        case DW_FORM_addr:
+            fixed = unit.addrSize; break;
+        case DW_FORM_strp_sup: case DW_FORM_GNU_ref_alt: case DW_FORM_GNU_strp_alt:
+            fixed = unit.offsetSize; break;
+        case DW_FORM_sdata: case DW_FORM_udata: case DW_FORM_strx: case DW_FORM_addrx:
+        case DW_FORM_loclistx: case DW_FORM_rnglistx: case DW_FORM_GNU_addr_index:
+        case DW_FORM_GNU_str_index:
+            if (SkipLeb(p, end)) return true;
+            return truncated(dieOffset);
+        case DW_FORM_string: {
+            const void* nul = std::memchr(p, 0, static_cast<std::size_t>(end - p));
+            if (!nul) return truncated(dieOffset);
+            p = static_cast<const std::uint8_t*>(nul) + 1;
+            return true;
+        }
+        case DW_FORM_block1: case DW_FORM_block2: case DW_FORM_block4:
+        case DW_FORM_block: case DW_FORM_exprloc: {
+            std::uint64_t len = 0;
+            if (form == DW_FORM_block1 || form == DW_FORM_block2 || form == DW_FORM_block4) {
+                unsigned n = form == DW_FORM_block1 ? 1 : form == DW_FORM_block2 ? 2 : 4;
+                if (!need(p, n, dieOffset)) return false;
+                len = LoadSized(p, n);
+                p += n;
+            } else if (!ReadUleb(p, end, len)) {
+                return truncated(dieOffset);
+            }
+            if (!need(p, len, dieOffset)) return false;
+            p += len;
+            return true;
+        }
+        case DW_FORM_ref1: case DW_FORM_ref2: case DW_FORM_ref4: case DW_FORM_ref8:
+        case DW_FORM_ref_udata: {
+            std::uint64_t v = 0;
+            if (form == DW_FORM_ref_udata) {
+                if (!ReadUleb(p, end, v)) return truncated(dieOffset);
+            } else {
+                unsigned n = form == DW_FORM_ref1 ? 1 : form == DW_FORM_ref2 ? 2 : form == DW_FORM_ref4 ? 4 : 8;
+                if (!need(p, n, dieOffset)) return false;
+                v = LoadSized(p, n);
+                p += n;
+            }
+            localRef(dieOffset, attr, v, localRefs);
+            return true;
+        }
+        case DW_FORM_ref_addr: {
+            unsigned n = unit.version == 2 ? unit.addrSize : unit.offsetSize;
+            if (!need(p, n, dieOffset)) return false;
+            out.globalRefs.push_back({dieOffset, LoadSized(p, n), attr == DW_AT_sibling});
+            p += n;
+            return true;
+        }
+        case DW_FORM_strp: case DW_FORM_line_strp: case DW_FORM_sec_offset: {
+            if (!need(p, unit.offsetSize, dieOffset)) return false;
+            std::uint64_t v = LoadSized(p, unit.offsetSize);
+            p += unit.offsetSize;
+            if (form == DW_FORM_strp) return offsetInto(sec.str, ".debug_str", v, dieOffset);
+            if (form == DW_FORM_line_strp) return offsetInto(sec.lineStr, ".debug_line_str", v, dieOffset);
+            if (attr == DW_AT_stmt_list && sec.line.data) return offsetInto(sec.line, ".debug_line", v, dieOffset);
+            return true;
+        }
+        default:
+            out.report.fail(".debug_info", dieOffset, "unknown form " + Hex(form));
+            return false;
+        }
+
+        if (!need(p, fixed, dieOffset)) return false;
+        if (attr == DW_AT_stmt_list && form == DW_FORM_data4 && sec.line.data) {
+            offsetInto(sec.line, ".debug_line", LoadSized(p, 4), dieOffset);
+        }
+        p += fixed;
+        return true;
+    }
+
+    const DwarfSections& sec;
+    const Unit&          unit;
+    const AbbrevTable&   table;
+    UnitResult&          out;
+    const std::uint8_t*  end = nullptr;
+};
+
+// Strings are read up to their NUL, so a string section must end in one.
+void CheckStringSection(IRBytes s, const char* name, VerifyReport& report) {
+    if (s.size && s.data[s.size - 1] != 0) report.fail(name, s.size - 1, "section does not end in NUL");
+}
+
+} // namespace
+
+bool FindDwarfSections(IRBytes file, DwarfSections& out, std::string& error) {
+    out = DwarfSections{};
+    const std::uint8_t* b = file.data;
+    if (file.size < 64 || std::memcmp(b, "\x7f" "ELF", 4) != 0) {
+        error = "not an ELF file";
+        return false;
+    }
+    if (b[4] != 2 || b[5] != 1) {
+        error = "only little-endian ELF64 is supported";
+        return false;
+    }
+    std::uint64_t shoff = LoadLE<std::uint64_t>(b + 0x28);
+    std::uint16_t shentsize = LoadLE<std::uint16_t>(b + 0x3a);
+    std::uint16_t shnum = LoadLE<std::uint16_t>(b + 0x3c);
+    std::uint16_t shstrndx = LoadLE<std::uint16_t>(b + 0x3e);
+    if (shentsize < 64 || shstrndx >= shnum || shoff > file.size ||
+        std::uint64_t(shnum) * shentsize > file.size - shoff) {
+        error = "bad section header table";
+        return false;
+    }
+
+    auto header = [&](std::uint16_t i) { return b + shoff + std::uint64_t(i) * shentsize; };
+    auto bytes = [&](const std::uint8_t* sh, IRBytes& view) {
+        std::uint64_t off = LoadLE<std::uint64_t>(sh + 24);
+        std::uint64_t size = LoadLE<std::uint64_t>(sh + 32);
+        if (off > file.size || size > file.size - off) return false;
+        view = IRBytes{b + off, static_cast<std::size_t>(size)};
+        return true;
+    };
+    IRBytes names;
+    if (!bytes(header(shstrndx), names)) {
+        error = "bad section name table";
+        return false;
+    }
+
+    for (std::uint16_t i = 0; i < shnum; ++i) {
+        const std::uint8_t* sh = header(i);
+        std::uint32_t nameOff = LoadLE<std::uint32_t>(sh);
+        if (nameOff >= names.size) continue;
+        const char* n = reinterpret_cast<const char*>(names.data + nameOff);
+        std::string_view name(n, strnlen(n, names.size - nameOff));
+
+        IRBytes* slot = name == ".debug_info"     ? &out.info
+                      : name == ".debug_abbrev"   ? &out.abbrev
+                      : name == ".debug_str"      ? &out.str
+                      : name == ".debug_line_str" ? &out.lineStr
+                      : name == ".debug_line"     ? &out.line
+                      : nullptr;
+        if (!slot) continue;
+        if (!bytes(sh, *slot)) {
+            error = std::string(name) + " lies outside the file";
+            return false;
+        }
+        if (LoadLE<std::uint64_t>(sh + 8) & kShfCompressed) {
+            std::vector<std::uint8_t> plain;
+            std::string why;
+            if (!DecompressDwarfSection(*slot, plain, why)) {
+                error = std::string(name) + ": " + why;
+                return false;
+            }
+            out.decompressed.push_back(std::move(plain));
+            *slot = IRBytes{out.decompressed.back().data(), out.decompressed.back().size()};
+        }
+    }
+    if (!out.info.data) {
+        error = "no .debug_info section";
+        return false;
+    }
+    return true;
+}
+
+VerifyReport VerifyDwarf(const DwarfSections& sections, const IRMaps* maps, unsigned jobs) {
+    VerifyReport report;
+    CheckStringSection(sections.str, ".debug_str", report);
+    CheckStringSection(sections.lineStr, ".debug_line_str", report);
+
+    std::vector<Unit> units = ScanUnits(sections.info, report);
+
+    // Each distinct abbrev table is parsed once, in parallel.
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(units.size());
+    for (const Unit& u : units) offsets.push_back(u.abbrevOffset);
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+
+    std::vector<AbbrevTable> tables(offsets.size());
+    std::vector<VerifyReport> tableReports(offsets.size());
+    ParallelFor(offsets.size(), jobs, [&](std::size_t i) {
+        tables[i].offset = offsets[i];
+        ParseAbbrevTable(sections.abbrev, tables[i], tableReports[i]);
+    });
+    for (auto& r : tableReports) report.merge(std::move(r));
+
+    std::vector<UnitResult> results(units.size());
+    ParallelFor(units.size(), jobs, [&](std::size_t i) {
+        Unit& u = units[i];
+        u.table = static_cast<std::size_t>(
+            std::lower_bound(offsets.begin(), offsets.end(), u.abbrevOffset) - offsets.begin());
+        if (!tables[u.table].usable) return; // already reported
+        UnitWalker(sections, u, tables[u.table], results[i]).run();
+    });
+
+    // A DIE start anywhere in .debug_info: find the unit, then the DIE.
+    auto isDie = [&](std::uint64_t offset) {
+        auto it = std::upper_bound(units.begin(), units.end(), offset,
+                                   [](std::uint64_t o, const Unit& u) { return o < u.offset; });
+        if (it == units.begin()) return false;
+        const auto& dies = results[static_cast<std::size_t>(it - units.begin()) - 1].dies;
+        return std::binary_search(dies.begin(), dies.end(), offset);
+    };
+
+    ParallelFor(units.size(), jobs, [&](std::size_t i) {
+        for (const Ref& r : results[i].globalRefs) {
+            if (!isDie(r.target)) {
+                results[i].report.fail(".debug_info", r.from, "DW_FORM_ref_addr " + Hex(r.target) + " is not a DIE");
+            }
+        }
+    });
+    report.itemsChecked += units.size();
+    for (auto& r : results) report.merge(std::move(r.report));
+
+    if (maps) {
+        maps->irToDwarfDie.forEach([&](IRTypeID id, std::uint64_t off) {
+            if (!isDie(off)) {
+                report.fail("IRMaps", off, "IR type " + std::to_string(id) +
+                            " maps to an offset that is not a DIE");
+            }
+        });
+    }
+    report.sort();
+    return report;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <deque>
+#include <string>
+#include <vector>
+#include "../ir/IRLocation.h"
+#include "../ir/IRMaps.h"
+#include "../util/VerifyReport.h"
+
+// DwarfVerifier:
+// Structural checks of produced DWARF, run by --verify. Works on views into
+// the loaded object file; nothing is decoded into DwarfNode/IR.
+//
+//   - unit headers (version 2-5, unit type, address size, abbrev offset);
+//   - each abbrev table once: unique codes, known forms, children flag;
+//   - every DIE: abbrev code exists, forms fit the unit version, name/ref
+//     attributes use forms of the right class, values stay in bounds,
+//     children lists are terminated;
+//   - references: CU-relative refs and DW_AT_sibling land on a DIE start in
+//     the same unit, DW_FORM_ref_addr on one anywhere in .debug_info;
+//     .debug_str / .debug_line_str / .debug_line offsets are in range;
+//   - IRMaps: every irToDwarfDie offset is a DIE start.
+//
+// Abbrev tables and units are checked in parallel; cross-unit references
+// in a final parallel pass.
+struct DwarfSections {
+    IRBytes info;
+    IRBytes abbrev;
+    IRBytes str;      // optional
+    IRBytes lineStr;  // optional
+    IRBytes line;     // optional
+
+    // Inflated SHF_COMPRESSED sections; the views above point into it.
+    std::deque<std::vector<std::uint8_t>> decompressed;
+};
+
+// Locates the .debug_* sections of a little-endian ELF64 object. Returns
+// false with 'error' set when the file is not one or .debug_info is missing.
+// Compressed sections are inflated into out.decompressed.
+bool FindDwarfSections(IRBytes file, DwarfSections& out, std::string& error);
+
+// 'maps' is optional; pass the maps the writer filled.
+VerifyReport VerifyDwarf(const DwarfSections& sections, const IRMaps* maps, unsigned jobs = 0);
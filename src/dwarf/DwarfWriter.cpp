@@ -14,3 +14,53 @@ void DwarfWriter::writeObject(
     // - emit .debug_info, .debug_abbrev, .debug_str, etc.
     (void)dwarfModel;
 }
+
+void DwarfWriter::beginStreaming(const std::string& outPath) {
+    streamPath = outPath;
+    unitsWritten = 0;
+    diesWritten = 0;
+    debugLine.clear();
+    sections.clear();
+    compressor = std::make_unique<DwarfSectionCompressor>(compress);
+    std::cout << "[DwarfWriter] streaming DWARF to " << outPath << " (stub)\n";
+    // TODO: open the output and start the .debug_info section buffer.
+}
+
+void DwarfWriter::writeUnit(const DwarfNode& cuNode) {
+    // TODO: emit the unit header + DIEs, interning abbrevs and strings;
+    // the CU node can then be freed by the caller.
+    ++unitsWritten;
+    diesWritten += 1 + cuNode.children.size();
+    debugLine.insert(debugLine.end(), cuNode.lineProgram.begin(), cuNode.lineProgram.end());
+}
+
+void DwarfWriter::emitSection(const std::string& name, std::vector<std::uint8_t> bytes) {
+    if (compressor) compressor->submit(name, std::move(bytes));
+}
+
+void DwarfWriter::finishStreaming() {
+    if (!debugLine.empty()) emitSection(".debug_line", std::move(debugLine));
+    debugLine.clear();
+    // TODO: emit .debug_info/.debug_abbrev/.debug_str the same way, then
+    // the ELF/COFF container from outputSections().
+    if (compressor) {
+        sections = compressor->finish();
+        if (!compressor->error().empty()) {
+            std::cerr << "[DwarfWriter] left uncompressed: " << compressor->error() << "\n";
+        }
+        compressor.reset();
+    }
+
+    std::uint64_t raw = 0, stored = 0;
+    for (const DwarfOutputSection& s : sections) {
+        raw += s.uncompressedSize;
+        stored += s.bytes.size();
+    }
+    std::cout << "[DwarfWriter] finished " << streamPath << ": "
+              << unitsWritten << " unit(s), "
+              << diesWritten << " DIE(s), "
+              << sections.size() << " section(s) " << raw << " -> " << stored << " bytes"
+              << (compress.kind != DwarfCompression::None
+                      ? std::string(" (") + DwarfCompressionName(compress.kind) + ")" : std::string())
+              << " (stub)\n";
+}
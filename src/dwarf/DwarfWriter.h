@@ -1,20 +1,52 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 #include "../ir/IRNode.h"
 #include "../ir/IRTypeTable.h"
 #include "../ir/IRMaps.h"
 #include "DwarfNode.h"
+#include "DwarfCompress.h"
 
 // DwarfWriter:
 // 1. take IRScope/IRTypeTable
 // 2. assign DIE offsets (update maps.irToDwarfDie)
 // 3. serialize to DWARF in an object or .dwo/etc.
+//
+// Finished sections go through emitSection(); with compression enabled the
+// .debug_* ones are compressed (SHF_COMPRESSED) in the background while
+// the next sections are built.
 class DwarfWriter {
 public:
+    DwarfWriter() = default;
+    explicit DwarfWriter(const DwarfCompressOptions& compress) : compress(compress) {}
+
     // dwarfModel is optional pre-built DwarfNode view.
     void writeObject(
         const std::string& outPath,
         const DwarfNode* dwarfModel /* can be null */
     );
+
+    // Streaming API: append each CU to .debug_info/.debug_abbrev as soon as
+    // its translation is finished, then emit the object container in finish.
+    void beginStreaming(const std::string& outPath);
+    void writeUnit(const DwarfNode& cuNode);
+    void finishStreaming();
+
+    // Hands over a complete section; valid between begin/finishStreaming.
+    void emitSection(const std::string& name, std::vector<std::uint8_t> bytes);
+
+    // Sections of the last finishStreaming(), in emission order.
+    const std::vector<DwarfOutputSection>& outputSections() const { return sections; }
+
+private:
+    DwarfCompressOptions compress;
+    std::unique_ptr<DwarfSectionCompressor> compressor;
+    std::vector<DwarfOutputSection> sections;
+
+    std::string   streamPath;
+    std::uint32_t unitsWritten = 0;
+    std::uint64_t diesWritten = 0;
+    std::vector<std::uint8_t> debugLine; // units' line programs, in unit order
 };
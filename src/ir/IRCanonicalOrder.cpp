@@ -0,0 +1,338 @@
+#include "IRCanonicalOrder.h"
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <utility>
+#include "../util/ParallelFor.h"
+
+namespace {
+
+constexpr std::size_t kChunk  = 4096;
+constexpr int         kRounds = 4; // reference depth folded into each hash
+
+// FNV-1a; stable across runs and platforms, unlike std::hash.
+std::uint64_t HashText(const std::string& s) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+template <typename F>
+void ForEachChunk(std::size_t n, unsigned jobs, F&& body) {
+    ParallelFor((n + kChunk - 1) / kChunk, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(n, (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) body(i);
+    });
+}
+
+void CollectUnits(const IRScope* scope, std::vector<const IRScope*>& out) {
+    bool nestedUnits = false;
+    for (const auto& child : scope->children) nestedUnits |= child->kind == IRScopeKind::CompileUnit;
+    if (scope->kind == IRScopeKind::CompileUnit && !nestedUnits) {
+        out.push_back(scope);
+        return;
+    }
+    for (const auto& child : scope->children) CollectUnits(child.get(), out);
+}
+
+void CollectDeclared(const IRScope& scope, std::vector<IRTypeID>& out) {
+    out.insert(out.end(), scope.declaredTypes.begin(), scope.declaredTypes.end());
+    for (const auto& child : scope.children) CollectDeclared(*child, out);
+}
+
+void RemapScope(IRScope& scope, const std::vector<IRTypeID>& remap) {
+    auto map = [&](std::uint32_t& id) {
+        if (id && id < remap.size()) id = remap[id];
+    };
+    for (IRTypeID& id : scope.declaredTypes) map(id);
+    std::sort(scope.declaredTypes.begin(), scope.declaredTypes.end());
+    for (IRSymbol& sym : scope.declaredSymbols) map(sym.type);
+    if (scope.inlinees) {
+        for (std::size_t i = 1; i <= scope.inlinees->size(); ++i) {
+            map(scope.inlinees->get(static_cast<IRInlineeID>(i)).type);
+        }
+    }
+    for (auto& child : scope.children) RemapScope(*child, remap);
+}
+
+// group[t] = position of the first type of t's run in 'order', where a run
+// is a maximal sequence that 'same' holds across. Returns the run count.
+template <typename Same>
+std::size_t NumberGroups(const std::vector<IRTypeID>& order, std::vector<std::uint64_t>& group, Same&& same) {
+    std::size_t groups = 0;
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        if (k == 0 || !same(order[k - 1], order[k])) {
+            group[order[k]] = k;
+            ++groups;
+        } else {
+            group[order[k]] = group[order[k - 1]];
+        }
+    }
+    return groups;
+}
+
+// One reference to a tied type: from type 'from' (slot = field index, then
+// element, index and pointee type), or from a symbol when from == 0 (slot =
+// unit << 32 | position of the symbol in that unit).
+struct Referrer {
+    IRTypeID      target;
+    IRTypeID      from;
+    std::uint64_t slot;
+};
+
+using RefKey = std::pair<std::uint64_t, std::uint64_t>;
+
+void CollectSymbolRefs(const IRScope& scope, std::uint64_t unit, std::uint64_t& pos,
+                       const std::vector<char>& tied, std::vector<Referrer>& out) {
+    for (const IRSymbol& sym : scope.declaredSymbols) {
+        if (sym.type < tied.size() && tied[sym.type]) out.push_back({sym.type, 0, (unit << 32) | pos});
+        ++pos;
+    }
+    for (const auto& child : scope.children) CollectSymbolRefs(*child, unit, pos, tied, out);
+}
+
+std::vector<Referrer> CollectReferrers(const std::vector<IRType*>& types,
+                                       const std::vector<const IRScope*>& units,
+                                       const std::vector<char>& tied, unsigned jobs) {
+    const std::size_t n = types.size();
+    const std::size_t chunks = (n + kChunk - 1) / kChunk;
+    std::vector<std::vector<Referrer>> found(chunks + units.size());
+    ParallelFor(chunks, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(n, (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) {
+            const IRType* t = types[i];
+            if (!t) continue;
+            std::uint64_t slot = 0;
+            auto add = [&](IRTypeID target) {
+                if (target && target < n && tied[target]) {
+                    found[c].push_back({target, static_cast<IRTypeID>(i), slot});
+                }
+                ++slot;
+            };
+            for (const IRField& f : t->fields) add(f.type);
+            add(t->elementType);
+            add(t->indexType);
+            add(t->pointeeType);
+        }
+    });
+    ParallelFor(units.size(), jobs, [&](std::size_t u) {
+        std::uint64_t pos = 0;
+        CollectSymbolRefs(*units[u], u, pos, tied, found[chunks + u]);
+    });
+    std::vector<Referrer> refs;
+    for (auto& f : found) refs.insert(refs.end(), f.begin(), f.end());
+    return refs;
+}
+
+// The type referenced at 'slot' of 't': fields in order, then element,
+// index and pointee type; 0 past the last slot or for an empty one.
+IRTypeID ReferentAt(const IRType& t, std::size_t slot, bool& end) {
+    end = false;
+    if (slot < t.fields.size()) return t.fields[slot].type;
+    switch (slot - t.fields.size()) {
+    case 0:  return t.elementType;
+    case 1:  return t.indexType;
+    case 2:  return t.pointeeType;
+    default: end = true; return 0;
+    }
+}
+
+// Depth-first post-order over references, starting from 'ranked' in turn.
+// Reference cycles always run through a pointer into a struct; the walk
+// enters such a cycle at the struct, so the pointer is the one reference
+// left pointing forward (PDB writers reach the struct through a forward
+// ref there). Iterative, as type chains can be arbitrarily deep.
+std::vector<IRTypeID> PostOrder(const std::vector<IRType*>& types, const std::vector<IRTypeID>& ranked) {
+    enum : char { New, Open, Done };
+    const std::size_t n = types.size();
+    std::vector<char> state(n, New);
+    std::vector<IRTypeID> out;
+    out.reserve(ranked.size());
+
+    struct Frame {
+        IRTypeID    id;
+        std::size_t slot;
+    };
+    std::vector<Frame> stack;
+    auto pending = [&](IRTypeID id) { return id && id < n && types[id] && state[id] == New; };
+    // Opens 'id', or first the struct it points to when that is unvisited.
+    auto open = [&](IRTypeID id) {
+        const IRType& t = *types[id];
+        IRTypeID udt = t.kind == IRTypeKind::Pointer ? t.pointeeType : 0;
+        if (pending(udt) && types[udt]->kind == IRTypeKind::StructOrUnion) id = udt;
+        state[id] = Open;
+        stack.push_back({id, 0});
+    };
+
+    for (IRTypeID root : ranked) {
+        while (pending(root)) {
+            open(root);
+            while (!stack.empty()) {
+                Frame& f = stack.back();
+                bool end = false;
+                IRTypeID ref = ReferentAt(*types[f.id], f.slot, end);
+                if (end) {
+                    state[f.id] = Done;
+                    out.push_back(f.id);
+                    stack.pop_back();
+                } else if (pending(ref)) {
+                    open(ref); // the slot is revisited once 'ref' is done
+                } else {
+                    ++f.slot;  // done, open (a back edge) or no type
+                }
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+std::uint64_t MixTypeHash(std::uint64_t h, std::uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9ull;
+    return h ^ (h >> 29);
+}
+
+std::uint64_t LocalTypeHash(const IRType& t) {
+    std::uint64_t h = MixTypeHash(static_cast<std::uint64_t>(t.kind), t.name.hash());
+    h = MixTypeHash(h, (t.isForwardDecl ? 1 : 0) | (t.isUnion ? 2 : 0));
+    h = MixTypeHash(h, t.sizeBytes);
+    h = MixTypeHash(h, t.ptrSizeBytes);
+    for (const IRArrayDim& d : t.dims) h = MixTypeHash(MixTypeHash(h, static_cast<std::uint64_t>(d.lowerBound)), d.count);
+    for (const IRField& f : t.fields) {
+        h = MixTypeHash(h, HashText(f.name));
+        h = MixTypeHash(h, f.byteOffset);
+        h = MixTypeHash(h, (std::uint64_t(f.bitOffset) << 17) | (std::uint64_t(f.bitSize) << 1) | f.isAnonymousArm);
+    }
+    return h;
+}
+
+std::vector<const IRScope*> CompileUnitsOf(const IRScope* root) {
+    std::vector<const IRScope*> units;
+    if (root) CollectUnits(root, units);
+    return units;
+}
+
+IRCanonicalOrder ComputeCanonicalOrder(IRTypeTable& typeTable,
+                                       const std::vector<const IRScope*>& units,
+                                       unsigned jobs) {
+    IRCanonicalOrder result;
+    std::vector<IRType*> types = typeTable.denseView();
+    const std::size_t n = types.size();
+
+    // 1) Structural hashes, refined through references round by round.
+    std::vector<std::uint64_t> local(n, 0), next(n, 0);
+    ForEachChunk(n, jobs, [&](std::size_t i) {
+        if (types[i]) local[i] = LocalTypeHash(*types[i]);
+    });
+    result.hash = local;
+    for (int round = 0; round < kRounds; ++round) {
+        const std::vector<std::uint64_t>& prev = result.hash;
+        auto ref = [&](IRTypeID id) { return id && id < n ? prev[id] : 0; };
+        ForEachChunk(n, jobs, [&](std::size_t i) {
+            const IRType* t = types[i];
+            if (!t) return;
+            std::uint64_t h = local[i];
+            for (const IRField& f : t->fields) h = MixTypeHash(h, ref(f.type));
+            h = MixTypeHash(h, ref(t->elementType));
+            h = MixTypeHash(h, ref(t->indexType));
+            next[i] = MixTypeHash(h, ref(t->pointeeType));
+        });
+        result.hash.swap(next);
+    }
+
+    // 2) First unit / position declaring each type; units are scanned in
+    //    parallel and merged in unit order.
+    std::vector<std::vector<IRTypeID>> declared(units.size());
+    ParallelFor(units.size(), jobs, [&](std::size_t u) { CollectDeclared(*units[u], declared[u]); });
+    constexpr std::uint64_t kUnseen = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::uint64_t> firstSeen(n, kUnseen); // unit << 32 | position
+    for (std::size_t u = 0; u < units.size(); ++u) {
+        for (std::size_t pos = 0; pos < declared[u].size(); ++pos) {
+            IRTypeID id = declared[u][pos];
+            if (id < n && firstSeen[id] == kUnseen) firstSeen[id] = (std::uint64_t(u) << 32) | pos;
+        }
+    }
+
+    // 3) Sort by (hash, first declaration) and number the groups of equal
+    //    keys by their first position; nothing here depends on old IDs.
+    std::vector<IRTypeID> order;
+    order.reserve(n);
+    for (std::size_t i = 1; i < n; ++i) {
+        if (types[i]) order.push_back(static_cast<IRTypeID>(i));
+    }
+    ParallelSort(order.begin(), order.end(), jobs, [&](IRTypeID a, IRTypeID b) {
+        if (result.hash[a] != result.hash[b]) return result.hash[a] < result.hash[b];
+        if (firstSeen[a] != firstSeen[b]) return firstSeen[a] < firstSeen[b];
+        return a < b;
+    });
+    std::vector<std::uint64_t> group(n, 0);
+    std::size_t groups = NumberGroups(order, group, [&](IRTypeID a, IRTypeID b) {
+        return result.hash[a] == result.hash[b] && firstSeen[a] == firstSeen[b];
+    });
+
+    // 4) Groups of several types are structurally identical types no unit
+    //    declares, e.g. two undeclared Node* used by different structs.
+    //    They are not interchangeable (their referrers would change with
+    //    creation order), so split them by their first referrer: a symbol
+    //    (by unit and position) or a field/element/index/pointee slot of a
+    //    type (by that type's group). Refined until no group splits.
+    if (groups < order.size()) {
+        std::vector<char> tied(n, 0);
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            bool prevSame = k > 0 && group[order[k - 1]] == group[order[k]];
+            bool nextSame = k + 1 < order.size() && group[order[k + 1]] == group[order[k]];
+            if (prevSame || nextSame) tied[order[k]] = 1;
+        }
+        std::vector<Referrer> refs = CollectReferrers(types, units, tied, jobs);
+
+        constexpr RefKey kUnreferenced{kUnseen, kUnseen};
+        std::vector<RefKey> first(n, kUnreferenced);
+        for (;;) {
+            std::fill(first.begin(), first.end(), kUnreferenced);
+            for (const Referrer& r : refs) {
+                RefKey key = r.from ? RefKey{1 + group[r.from], r.slot} : RefKey{0, r.slot};
+                if (key < first[r.target]) first[r.target] = key;
+            }
+            ParallelSort(order.begin(), order.end(), jobs, [&](IRTypeID a, IRTypeID b) {
+                if (group[a] != group[b]) return group[a] < group[b];
+                if (first[a] != first[b]) return first[a] < first[b];
+                return a < b; // only types nothing tells apart, not even referrers
+            });
+            std::vector<std::uint64_t> refined(n, 0);
+            std::size_t count = NumberGroups(order, refined, [&](IRTypeID a, IRTypeID b) {
+                return group[a] == group[b] && first[a] == first[b];
+            });
+            group.swap(refined);
+            if (count == groups) break;
+            groups = count;
+        }
+    }
+
+    // 5) 'order' only ranks the types; IDs follow a post-order walk from
+    //    each type in rank order, so every type comes after what it
+    //    references and TIs handed out by ID never point forward.
+    std::vector<IRTypeID> topo = PostOrder(types, order);
+    result.remap.assign(n, 0);
+    for (std::size_t k = 0; k < topo.size(); ++k) {
+        result.remap[topo[k]] = static_cast<IRTypeID>(k + 1);
+    }
+    return result;
+}
+
+void ApplyCanonicalOrder(const IRCanonicalOrder& order, IRTypeTable& typeTable,
+                         IRScope* root, IRMaps& maps, unsigned jobs) {
+    const std::vector<IRTypeID>& remap = order.remap;
+    typeTable.renumber(remap, jobs);
+    if (root) RemapScope(*root, remap);
+
+    maps.dwarfDieToIR.remapValues(remap);
+    maps.pdbTIToIR.remapValues(remap);
+    maps.irToDwarfDie.remapKeys(remap);
+    maps.irToPdbTI.remapKeys(remap);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "IRNode.h"
+#include "IRTypeTable.h"
+#include "IRMaps.h"
+
+// Canonical type order:
+// IRTypeIDs come from IRTypeTable::createType in creation order, which
+// stops being reproducible as soon as more than one thread creates types.
+// Since TIs and DIE offsets are handed out by walking IRTypeIDs, the
+// output bytes would then depend on scheduling. This pass derives an
+// order from content only and renumbers the IR to it:
+//
+//   1. a structural hash per type: kind, name, layout and fields, refined
+//      over a few rounds with the hashes of referenced types (so cycles
+//      through pointers are fine); computed in parallel per round;
+//   2. types sorted by (structural hash, first compile unit declaring it,
+//      position in that unit); a parallel sort. Identical types no unit
+//      declares are then split by their first referrer (a symbol, or a
+//      slot of a type by that type's place in the order), repeated until
+//      no group splits;
+//   3. IDs are handed out by a post-order walk over references, started
+//      from each type in that order: a type gets its ID after the types it
+//      references, so TIs assigned in ID order only point backwards. A
+//      reference cycle is entered at its struct, leaving the pointer to it
+//      as the one forward reference (a PDB forward ref stands in there);
+//   4. every ID held by the table, the scope tree and IRMaps is rewritten;
+//      declaredTypes lists are sorted so writers emit them in canonical
+//      order.
+//
+// Nothing depends on the job count or on the IDs the readers assigned, so
+// the same input always yields the same IDs, TIs and DIE offsets.
+struct IRCanonicalOrder {
+    std::vector<std::uint64_t> hash;  // hash[id], structural hash by old ID
+    std::vector<IRTypeID>      remap; // remap[old id] = canonical ID (0 stays 0)
+};
+
+// 'units' are the compile-unit scopes in input order.
+IRCanonicalOrder ComputeCanonicalOrder(IRTypeTable& typeTable,
+                                       const std::vector<const IRScope*>& units,
+                                       unsigned jobs = 0);
+
+// Renumbers 'typeTable', the scopes below 'root' and 'maps' to 'order'.
+void ApplyCanonicalOrder(const IRCanonicalOrder& order, IRTypeTable& typeTable,
+                         IRScope* root, IRMaps& maps, unsigned jobs = 0);
+
+// Building blocks of the structural hash, shared with IRTypeMerge: the
+// hash of everything about a type except the types it references, and
+// the step that folds a referenced type's hash in.
+std::uint64_t LocalTypeHash(const IRType& t);
+std::uint64_t MixTypeHash(std::uint64_t h, std::uint64_t v);
+
+// Compile units below (or at) 'root' in tree order.
+std::vector<const IRScope*> CompileUnitsOf(const IRScope* root);
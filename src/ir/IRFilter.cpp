@@ -0,0 +1,271 @@
+#include "IRFilter.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <unordered_set>
+
+namespace {
+
+// Greedy match with backtracking to the most recent '*', over any forward
+// range of characters.
+template <typename It>
+bool GlobMatchRange(std::string_view pattern, It n, It end) {
+    std::size_t p = 0;
+    std::size_t starP = std::string_view::npos;
+    It starN = n;
+    while (n != end) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == *n)) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starN = n;
+        } else if (starP != std::string_view::npos) {
+            p = starP + 1;
+            n = ++starN;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+// The characters of a name's (non-empty) fragments as one bidirectional
+// range, for GlobMatchRange and std::regex_match.
+class FragmentChars {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = char;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const char*;
+    using reference         = const char&;
+
+    FragmentChars() = default;
+    FragmentChars(const std::vector<std::string_view>* frags, std::size_t frag)
+        : frags(frags), frag(frag) {}
+
+    reference operator*() const { return (*frags)[frag][off]; }
+    FragmentChars& operator++() {
+        if (++off == (*frags)[frag].size()) {
+            ++frag;
+            off = 0;
+        }
+        return *this;
+    }
+    FragmentChars operator++(int) { FragmentChars old = *this; ++*this; return old; }
+    FragmentChars& operator--() {
+        if (off == 0) off = (*frags)[--frag].size();
+        --off;
+        return *this;
+    }
+    FragmentChars operator--(int) { FragmentChars old = *this; --*this; return old; }
+    bool operator==(const FragmentChars& o) const { return frag == o.frag && off == o.off; }
+    bool operator!=(const FragmentChars& o) const { return !(*this == o); }
+
+private:
+    const std::vector<std::string_view>* frags = nullptr;
+    std::size_t frag = 0;
+    std::size_t off  = 0;
+};
+
+} // namespace
+
+NamePattern::NamePattern(const std::string& spec) {
+    if (spec.compare(0, 3, "re:") == 0) {
+        isRegex = true;
+        re = std::regex(spec.substr(3), std::regex::ECMAScript | std::regex::optimize);
+    } else {
+        glob = spec;
+    }
+}
+
+bool NamePattern::matches(std::string_view name) const {
+    if (isRegex) return std::regex_match(name.begin(), name.end(), re);
+    return GlobMatch(glob, name);
+}
+
+bool NamePattern::matchesName(const IRName& name) const {
+    std::vector<std::string_view> frags;
+    name.forEachFragment([&](std::string_view f) { frags.push_back(f); });
+    if (frags.size() <= 1) return matches(frags.empty() ? std::string_view() : frags[0]);
+    FragmentChars begin(&frags, 0), end(&frags, frags.size());
+    if (isRegex) return std::regex_match(begin, end, re);
+    return GlobMatchRange(glob, begin, end);
+}
+
+bool GlobMatch(std::string_view pattern, std::string_view name) {
+    return GlobMatchRange(pattern, name.begin(), name.end());
+}
+
+bool NameRule::excluded(std::string_view name) const {
+    for (const NamePattern& pat : exclude) {
+        if (pat.matches(name)) return true;
+    }
+    return false;
+}
+
+bool NameRule::included(std::string_view name) const {
+    if (include.empty()) return true;
+    for (const NamePattern& pat : include) {
+        if (pat.matches(name)) return true;
+    }
+    return false;
+}
+
+bool NameRule::excludesName(const IRName& name) const {
+    for (const NamePattern& pat : exclude) {
+        if (pat.matchesName(name)) return true;
+    }
+    return false;
+}
+
+bool NameRule::includesName(const IRName& name) const {
+    if (include.empty()) return true;
+    for (const NamePattern& pat : include) {
+        if (pat.matchesName(name)) return true;
+    }
+    return false;
+}
+
+NamespaceVerdict IRFilter::namespaceVerdict(std::string_view qualified, bool enclosingKept) const {
+    if (namespaces.excluded(qualified)) return NamespaceVerdict::Prune;
+    if (enclosingKept || namespaces.included(qualified)) return NamespaceVerdict::Keep;
+    return NamespaceVerdict::Descend;
+}
+
+namespace {
+
+std::string Qualify(const std::string& prefix, const std::string& name) {
+    return prefix.empty() ? name : prefix + "::" + name;
+}
+
+struct Pruner {
+    const IRFilter& filter;
+    std::vector<IRTypeID> roots;
+
+    // Returns false when the scope ended up empty.
+    bool pruneNamespaceLevel(IRScope& scope, const std::string& prefix, bool kept) {
+        std::unordered_set<std::string> droppedFunctions;
+        auto& syms = scope.declaredSymbols;
+        syms.erase(std::remove_if(syms.begin(), syms.end(), [&](const IRSymbol& s) {
+            bool keep = kept && filter.symbols.passes(Qualify(prefix, s.name));
+            if (!keep && s.kind == IRSymbolKind::Function) droppedFunctions.insert(s.name);
+            return !keep;
+        }), syms.end());
+        for (const IRSymbol& s : syms) roots.push_back(s.type);
+
+        auto& kids = scope.children;
+        kids.erase(std::remove_if(kids.begin(), kids.end(), [&](std::unique_ptr<IRScope>& child) {
+            switch (child->kind) {
+            case IRScopeKind::Namespace: {
+                std::string q = Qualify(prefix, child->name);
+                NamespaceVerdict v = filter.namespaceVerdict(q, kept);
+                if (v == NamespaceVerdict::Prune) return true;
+                return !pruneNamespaceLevel(*child, q, v == NamespaceVerdict::Keep);
+            }
+            case IRScopeKind::FileStatic:
+                return !pruneNamespaceLevel(*child, prefix, kept);
+            case IRScopeKind::Function:
+                // Code scopes go with their function symbol; locals are not
+                // filtered by name, but their types are still roots.
+                if (!kept || droppedFunctions.count(child->name) ||
+                    !filter.symbols.passes(Qualify(prefix, child->name))) {
+                    return true;
+                }
+                collectCodeRoots(*child);
+                return false;
+            default:
+                collectCodeRoots(*child);
+                return false;
+            }
+        }), kids.end());
+
+        return !syms.empty() || !kids.empty() || !scope.declaredTypes.empty();
+    }
+
+    void collectCodeRoots(const IRScope& scope) {
+        for (const IRSymbol& s : scope.declaredSymbols) roots.push_back(s.type);
+        for (const auto& child : scope.children) collectCodeRoots(*child);
+    }
+
+    void collectIncludedTypes(const IRScope& scope, const IRTypeTable& typeTable) {
+        for (IRTypeID id : scope.declaredTypes) {
+            const IRType* t = typeTable.lookup(id);
+            if (t && filter.types.passesName(t->name)) roots.push_back(id);
+        }
+        for (const auto& child : scope.children) collectIncludedTypes(*child, typeTable);
+    }
+};
+
+// 'keep' decides per declared type; the rest are removed.
+template <typename Keep>
+void RetainTypes(IRScope& scope, const Keep& keep) {
+    auto& ids = scope.declaredTypes;
+    ids.erase(std::remove_if(ids.begin(), ids.end(), [&](IRTypeID id) { return !keep(id); }),
+              ids.end());
+    for (auto& child : scope.children) RetainTypes(*child, keep);
+}
+
+// Namespace levels are first kept for their declared types; drop the ones
+// RetainTypes then left empty, innermost first.
+void DropEmptyNamespaces(IRScope& scope) {
+    auto& kids = scope.children;
+    kids.erase(std::remove_if(kids.begin(), kids.end(), [](std::unique_ptr<IRScope>& child) {
+        if (child->kind != IRScopeKind::Namespace && child->kind != IRScopeKind::FileStatic) {
+            return false;
+        }
+        DropEmptyNamespaces(*child);
+        return child->declaredSymbols.empty() && child->children.empty() &&
+               child->declaredTypes.empty();
+    }), kids.end());
+}
+
+} // namespace
+
+bool ApplyFilter(IRScope& unit, const IRTypeTable& typeTable, const IRFilter& filter,
+                 IRFilterState* state) {
+    if (!filter.keepUnit(unit.name)) return false;
+    if (filter.namespaces.empty() && filter.symbols.empty() && filter.types.empty()) return true;
+
+    Pruner pruner{filter, {}};
+    // The global namespace counts as kept only when no namespace is selected.
+    pruner.pruneNamespaceLevel(unit, std::string(), filter.namespaces.include.empty());
+    if (!filter.types.include.empty()) pruner.collectIncludedTypes(unit, typeTable);
+
+    std::unordered_set<IRTypeID> reached;
+    // The walk holds the table lock; only test names when something can
+    // exclude them.
+    std::function<bool(const IRType&)> follow;
+    if (!filter.types.exclude.empty()) {
+        follow = [&](const IRType& t) { return !filter.types.excludesName(t.name); };
+    }
+    typeTable.collectReachable(pruner.roots, reached, follow);
+    if (!state) {
+        RetainTypes(unit, [&](IRTypeID id) { return reached.count(id) != 0; });
+    } else {
+        state->reached.insert(reached.begin(), reached.end());
+        RetainTypes(unit, [&](IRTypeID id) {
+            if (!state->reached.count(id)) {
+                if (!state->declared.count(id)) state->dropped.insert(id);
+                return false;
+            }
+            state->dropped.erase(id);
+            return state->declared.insert(id).second;
+        });
+        // Types an earlier unit declared but did not reach itself.
+        std::vector<IRTypeID> adopted;
+        for (IRTypeID id : reached) {
+            if (state->dropped.count(id)) adopted.push_back(id);
+        }
+        std::sort(adopted.begin(), adopted.end());
+        for (IRTypeID id : adopted) {
+            state->dropped.erase(id);
+            state->declared.insert(id);
+            unit.declaredTypes.push_back(id);
+        }
+    }
+    DropEmptyNamespaces(unit);
+
+    return !unit.declaredSymbols.empty() || !unit.children.empty() || !unit.declaredTypes.empty();
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "IRNode.h"
+#include "IRTypeTable.h"
+
+// IRFilter:
+// Include/exclude rules that select which compile units, namespaces,
+// symbols and types are converted. Readers check them while scanning:
+// excluded units are skipped before any of their DIEs/records are decoded,
+// and each surviving unit is pruned (ApplyFilter) before it is handed to
+// the translator, so later stages only ever see what is kept.
+
+// "re:<ECMAScript regex>" (whole-name match) or a glob with '*' and '?'.
+class NamePattern {
+public:
+    explicit NamePattern(const std::string& spec);
+
+    bool matches(std::string_view name) const;
+    // Matches an interned name fragment by fragment, without flattening it.
+    bool matchesName(const IRName& name) const;
+
+private:
+    std::string glob;
+    bool        isRegex = false;
+    std::regex  re;
+};
+
+bool GlobMatch(std::string_view pattern, std::string_view name);
+
+// A name passes when no exclude matches and either there are no includes
+// or one of them matches.
+struct NameRule {
+    std::vector<NamePattern> include;
+    std::vector<NamePattern> exclude;
+
+    void addInclude(const std::string& spec) { include.emplace_back(spec); }
+    void addExclude(const std::string& spec) { exclude.emplace_back(spec); }
+
+    bool empty() const { return include.empty() && exclude.empty(); }
+    bool excluded(std::string_view name) const;
+    bool included(std::string_view name) const; // true when there are no includes
+    bool passes(std::string_view name) const { return !excluded(name) && included(name); }
+
+    // The same over an interned name (see NamePattern::matchesName).
+    bool excludesName(const IRName& name) const;
+    bool includesName(const IRName& name) const;
+    bool passesName(const IRName& name) const { return !excludesName(name) && includesName(name); }
+};
+
+enum class NamespaceVerdict {
+    Keep,     // converted, subject to the symbol/type rules
+    Descend,  // not selected itself, but a nested namespace may be
+    Prune     // skipped with everything below it
+};
+
+struct IRFilter {
+    NameRule units;       // CU / module name
+    NameRule namespaces;  // qualified namespace ("a::b"); includes cover nested namespaces
+    NameRule symbols;     // qualified global / function name
+    NameRule types;       // type name; includes add roots beside the symbols' types
+
+    bool empty() const {
+        return units.empty() && namespaces.empty() && symbols.empty() && types.empty();
+    }
+
+    bool keepUnit(std::string_view name) const { return units.passes(name); }
+
+    // 'enclosingKept': whether the parent namespace was Keep.
+    NamespaceVerdict namespaceVerdict(std::string_view qualified, bool enclosingKept) const;
+};
+
+// What the units filtered so far (of one input) kept, so that a type one
+// unit declares and only another unit uses is still declared once: by the
+// declaring unit when the type was reached before it, else by the first
+// unit that reaches it afterwards.
+struct IRFilterState {
+    std::unordered_set<IRTypeID> reached;  // reachable from any kept unit so far
+    std::unordered_set<IRTypeID> declared; // declared by a kept unit
+    std::unordered_set<IRTypeID> dropped;  // declared, but not reached yet
+};
+
+// Prunes 'unit' in place: excluded namespaces, filtered globals and the
+// function scopes of filtered functions, then every declared type not
+// reachable from the types of the remaining symbols (or an included type).
+// With 'state', reachability spans every unit passed in with it, in order.
+// Returns false when nothing is left and the unit should be dropped.
+bool ApplyFilter(IRScope& unit, const IRTypeTable& typeTable, const IRFilter& filter,
+                 IRFilterState* state = nullptr);
@@ -0,0 +1,207 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "IRNode.h"
+
+// IRFlatMap:
+// The two directions of an IRMaps side.
+//
+//   IRDenseMap<V> : IR -> external. IRTypeIDs are dense, so a plain vector
+//                   indexed by ID; a hole holds kAbsent.
+//   IRFlatMap<K>  : external -> IR. Open addressing with linear probing over
+//                   parallel key/ID arrays (ID 0 = empty slot), at most
+//                   three quarters full. Keys are DIE offsets or TIs, mostly
+//                   sequential, so a multiplicative hash spreads them well.
+//
+// Neither keeps per-entry heap nodes; lookups return values, not iterators.
+template <typename V>
+class IRDenseMap {
+public:
+    static constexpr V kAbsent = std::numeric_limits<V>::max();
+
+    bool        empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    bool contains(IRTypeID id) const { return id < values.size() && values[id] != kAbsent; }
+
+    // Pointer to the value, or null. Invalidated by set().
+    const V* find(IRTypeID id) const { return contains(id) ? &values[id] : nullptr; }
+
+    // Throws std::out_of_range when 'id' is not mapped.
+    V at(IRTypeID id) const {
+        if (!contains(id)) throw std::out_of_range("IRDenseMap: unmapped IR type");
+        return values[id];
+    }
+
+    // 'value' must not be kAbsent.
+    void set(IRTypeID id, V value) {
+        if (id >= values.size()) values.resize(std::size_t(id) + 1, kAbsent);
+        count += values[id] == kAbsent;
+        values[id] = value;
+    }
+
+    void erase(IRTypeID id) {
+        if (!contains(id)) return;
+        values[id] = kAbsent;
+        --count;
+    }
+
+    void clear() {
+        values.clear();
+        count = 0;
+    }
+
+    // Room for IDs below 'idEnd' without reallocating.
+    void reserve(std::size_t idEnd) { values.reserve(idEnd); }
+
+    // f(IRTypeID, V) for every entry, in ID order.
+    template <typename F>
+    void forEach(F&& f) const {
+        for (std::size_t id = 0; id < values.size(); ++id) {
+            if (values[id] != kAbsent) f(static_cast<IRTypeID>(id), values[id]);
+        }
+    }
+
+    // Moves entry 'id' to remap[id] (IDs past the end keep theirs). The
+    // remap must be injective over the mapped IDs.
+    void remapKeys(const std::vector<IRTypeID>& remap) {
+        std::vector<V> out(values.size(), kAbsent);
+        std::size_t moved = 0;
+        forEach([&](IRTypeID id, V v) {
+            IRTypeID to = id < remap.size() ? remap[id] : id;
+            if (to >= out.size()) out.resize(std::size_t(to) + 1, kAbsent);
+            out[to] = v;
+            ++moved;
+        });
+        values.swap(out);
+        count = moved;
+    }
+
+    std::size_t memoryBytes() const { return values.capacity() * sizeof(V); }
+
+    bool operator==(const IRDenseMap& other) const {
+        if (count != other.count) return false;
+        bool same = true;
+        forEach([&](IRTypeID id, V v) { same = same && other.contains(id) && other.values[id] == v; });
+        return same;
+    }
+    bool operator!=(const IRDenseMap& other) const { return !(*this == other); }
+
+private:
+    std::vector<V> values; // values[id]
+    std::size_t    count = 0;
+};
+
+template <typename K>
+class IRFlatMap {
+public:
+    bool        empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    // The mapped ID, or 0.
+    IRTypeID find(K key) const {
+        if (ids.empty()) return 0;
+        for (std::size_t slot = home(key);; slot = (slot + 1) & mask()) {
+            if (!ids[slot] || keys[slot] == key) return ids[slot];
+        }
+    }
+
+    bool contains(K key) const { return find(key) != 0; }
+
+    // Throws std::out_of_range when 'key' is not mapped.
+    IRTypeID at(K key) const {
+        IRTypeID id = find(key);
+        if (!id) throw std::out_of_range("IRFlatMap: unmapped key");
+        return id;
+    }
+
+    // Inserts or overwrites; 'id' must not be 0.
+    void set(K key, IRTypeID id) {
+        if ((count + 1) * 4 > ids.size() * 3) rehash(ids.empty() ? 64 : ids.size() * 2);
+        place(key, id);
+    }
+
+    // Bulk load for readers that collect a batch of pairs first: sizes the
+    // table once instead of doubling along the way. Later pairs win.
+    void build(const std::vector<std::pair<K, IRTypeID>>& pairs) {
+        reserve(count + pairs.size());
+        for (const auto& p : pairs) place(p.first, p.second);
+    }
+
+    void clear() {
+        keys.clear();
+        ids.clear();
+        count = 0;
+    }
+
+    void reserve(std::size_t entries) {
+        std::size_t slots = ids.empty() ? 64 : ids.size();
+        while (entries * 4 > slots * 3) slots *= 2;
+        if (slots != ids.size()) rehash(slots);
+    }
+
+    // f(K, IRTypeID) for every entry, in unspecified order.
+    template <typename F>
+    void forEach(F&& f) const {
+        for (std::size_t slot = 0; slot < ids.size(); ++slot) {
+            if (ids[slot]) f(keys[slot], ids[slot]);
+        }
+    }
+
+    // Replaces each mapped ID by remap[id] (IDs past the end are kept).
+    void remapValues(const std::vector<IRTypeID>& remap) {
+        for (IRTypeID& id : ids) {
+            if (id && id < remap.size()) id = remap[id];
+        }
+    }
+
+    std::size_t memoryBytes() const {
+        return keys.capacity() * sizeof(K) + ids.capacity() * sizeof(IRTypeID);
+    }
+
+    bool operator==(const IRFlatMap& other) const {
+        if (count != other.count) return false;
+        bool same = true;
+        forEach([&](K key, IRTypeID id) { same = same && other.find(key) == id; });
+        return same;
+    }
+    bool operator!=(const IRFlatMap& other) const { return !(*this == other); }
+
+private:
+    std::size_t mask() const { return ids.size() - 1; }
+
+    // Fibonacci hashing; 'shift' keeps the top log2(slots) bits.
+    std::size_t home(K key) const {
+        return static_cast<std::size_t>((std::uint64_t(key) * 0x9e3779b97f4a7c15ull) >> shift);
+    }
+
+    void place(K key, IRTypeID id) {
+        std::size_t slot = home(key);
+        while (ids[slot] && keys[slot] != key) slot = (slot + 1) & mask();
+        count += ids[slot] == 0;
+        keys[slot] = key;
+        ids[slot] = id;
+    }
+
+    void rehash(std::size_t slots) {
+        std::vector<K> oldKeys(slots);
+        std::vector<IRTypeID> oldIds(slots, 0);
+        oldKeys.swap(keys);
+        oldIds.swap(ids);
+        shift = 64;
+        for (std::size_t s = slots; s > 1; s >>= 1) --shift;
+        count = 0;
+        for (std::size_t i = 0; i < oldIds.size(); ++i) {
+            if (oldIds[i]) place(oldKeys[i], oldIds[i]);
+        }
+    }
+
+    std::vector<K>        keys;
+    std::vector<IRTypeID> ids;   // 0 = empty slot
+    std::size_t           count = 0;
+    unsigned              shift = 64;
+};
@@ -0,0 +1,272 @@
+#include "IRForwardDecls.h"
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include "../util/ParallelFor.h"
+
+namespace {
+
+constexpr std::size_t kChunk      = 4096;
+constexpr std::size_t kPartitions = 1024;
+
+constexpr std::string_view kAnonymousMarkers[] = {
+    "anonymous$", "<unnamed", "__unnamed", "<anonymous", "(anonymous"};
+constexpr std::size_t kMarkerTail = 9; // longest marker minus one
+
+// Looks for the markers fragment by fragment, without flattening the name.
+// A marker can straddle fragments ("<" + "unnamed-tag>"), so the last few
+// characters of what came before are checked together with the next
+// fragment's head.
+class AnonymousScan {
+public:
+    bool visit(const IRNameNode* n) {
+        if (n->kind == IRNameNode::Atom) {
+            return atom(std::string_view(n->text, static_cast<std::size_t>(n->length)));
+        }
+        for (std::uint32_t i = 0; i < n->count; ++i) {
+            if (visit(n->children[i])) return true;
+        }
+        return false;
+    }
+
+private:
+    static bool hasMarker(std::string_view text) {
+        for (std::string_view marker : kAnonymousMarkers) {
+            if (text.find(marker) != std::string_view::npos) return true;
+        }
+        return false;
+    }
+
+    bool atom(std::string_view text) {
+        if (text.empty()) return false;
+        if (hasMarker(text)) return true;
+        if (tailLen) {
+            char seam[2 * kMarkerTail];
+            std::size_t head = std::min(text.size(), kMarkerTail);
+            std::copy(tail, tail + tailLen, seam);
+            std::copy(text.begin(), text.begin() + head, seam + tailLen);
+            if (hasMarker(std::string_view(seam, tailLen + head))) return true;
+        }
+        if (text.size() >= kMarkerTail) {
+            std::copy(text.end() - kMarkerTail, text.end(), tail);
+            tailLen = kMarkerTail;
+        } else {
+            std::size_t keep = std::min(tailLen, kMarkerTail - text.size());
+            std::copy(tail + tailLen - keep, tail + tailLen, tail);
+            std::copy(text.begin(), text.end(), tail + keep);
+            tailLen = keep + text.size();
+        }
+        return false;
+    }
+
+    char        tail[kMarkerTail];
+    std::size_t tailLen = 0;
+};
+
+bool IsAnonymous(const IRName& name) {
+    if (name.empty()) return true;
+    return AnonymousScan().visit(name.root());
+}
+
+struct Candidate {
+    std::uint64_t hash;
+    IRType*       type;
+};
+
+// Same name and struct/union kind; definitions by size, then decls, each
+// by ID. Groups are contiguous and the order does not depend on 'jobs'.
+bool CandidateLess(const Candidate& a, const Candidate& b) {
+    if (a.hash != b.hash) return a.hash < b.hash;
+    if (a.type->name.root() != b.type->name.root()) {
+        int cmp = IRName::compare(a.type->name, b.type->name);
+        if (cmp != 0) return cmp < 0;
+    }
+    if (a.type->isUnion != b.type->isUnion) return b.type->isUnion;
+    if (a.type->isForwardDecl != b.type->isForwardDecl) return b.type->isForwardDecl;
+    if (!a.type->isForwardDecl && a.type->sizeBytes != b.type->sizeBytes) {
+        return a.type->sizeBytes < b.type->sizeBytes;
+    }
+    return a.type->id < b.type->id;
+}
+
+bool SameGroup(const Candidate& a, const Candidate& b) {
+    return a.hash == b.hash && a.type->isUnion == b.type->isUnion && a.type->name == b.type->name;
+}
+
+// Union-find over positions in one partition. The root remembers the
+// smallest position of its set, which is a definition whenever the set has
+// one (definitions sort first within a group).
+class DisjointSets {
+public:
+    explicit DisjointSets(std::size_t n) : parent(n), rank(n, 0), first(n) {
+        std::iota(parent.begin(), parent.end(), 0u);
+        std::iota(first.begin(), first.end(), 0u);
+    }
+
+    std::uint32_t find(std::uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(std::uint32_t a, std::uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (rank[a] < rank[b]) std::swap(a, b);
+        parent[b] = a;
+        if (rank[a] == rank[b]) ++rank[a];
+        first[a] = std::min(first[a], first[b]);
+    }
+
+    std::uint32_t representative(std::uint32_t x) { return first[find(x)]; }
+
+private:
+    std::vector<std::uint32_t> parent;
+    std::vector<std::uint8_t>  rank;
+    std::vector<std::uint32_t> first;
+};
+
+// Unifies the decls of group [begin, end) with its definitions.
+void UniteGroup(const Candidate* part, std::uint32_t begin, std::uint32_t end,
+                DisjointSets& sets) {
+    std::uint32_t defsEnd = begin;
+    while (defsEnd < end && !part[defsEnd].type->isForwardDecl) ++defsEnd;
+    const bool uniformSize = defsEnd > begin &&
+        part[begin].type->sizeBytes == part[defsEnd - 1].type->sizeBytes;
+
+    std::uint32_t unmatched = end; // first decl without a definition
+    for (std::uint32_t i = defsEnd; i < end; ++i) {
+        std::uint64_t size = part[i].type->sizeBytes;
+        std::uint32_t def = defsEnd;
+        if (size == 0) {
+            if (uniformSize) def = begin;
+        } else {
+            // Definitions are sorted by size: take the first of that size.
+            const Candidate* it = std::lower_bound(part + begin, part + defsEnd, size,
+                [](const Candidate& c, std::uint64_t s) { return c.type->sizeBytes < s; });
+            if (it != part + defsEnd && it->type->sizeBytes == size) {
+                def = static_cast<std::uint32_t>(it - part);
+            }
+        }
+
+        if (def != defsEnd) {
+            sets.unite(def, i);
+        } else if (unmatched == end) {
+            unmatched = i;
+        } else {
+            sets.unite(unmatched, i);
+        }
+    }
+}
+
+} // namespace
+
+IRForwardResolution ResolveForwardDecls(IRTypeTable& typeTable, unsigned jobs) {
+    IRForwardResolution result;
+    std::vector<IRType*> types = typeTable.denseView();
+    const std::size_t n = types.size();
+    const std::size_t chunks = (n + kChunk - 1) / kChunk;
+
+    result.remap.resize(n);
+    std::iota(result.remap.begin(), result.remap.end(), IRTypeID(0));
+
+    // 1) Named struct/union types, hashed per chunk.
+    std::vector<std::vector<Candidate>> found(chunks);
+    std::vector<std::size_t> declCount(chunks, 0);
+    ParallelFor(chunks, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(n, (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) {
+            IRType* t = types[i];
+            if (!t || t->kind != IRTypeKind::StructOrUnion || IsAnonymous(t->name)) continue;
+            found[c].push_back({t->name.hash(), t});
+            if (t->isForwardDecl) ++declCount[c];
+        }
+    });
+    for (std::size_t c : declCount) result.forwardDecls += c;
+    if (!result.forwardDecls) return result;
+
+    // 2) Counting sort into partitions by name hash; same-named types
+    //    always land in the same partition.
+    std::vector<std::size_t> partStart(kPartitions + 1, 0);
+    for (const auto& chunk : found) {
+        for (const Candidate& c : chunk) ++partStart[(c.hash >> 32) % kPartitions + 1];
+    }
+    for (std::size_t p = 0; p < kPartitions; ++p) partStart[p + 1] += partStart[p];
+    std::vector<Candidate> all(partStart[kPartitions]);
+    {
+        std::vector<std::size_t> cursor(partStart.begin(), partStart.end() - 1);
+        for (auto& chunk : found) {
+            for (const Candidate& c : chunk) all[cursor[(c.hash >> 32) % kPartitions]++] = c;
+            std::vector<Candidate>().swap(chunk);
+        }
+    }
+
+    // 3) Union-find per partition; each type ID is written by one partition.
+    std::vector<std::size_t> resolved(kPartitions, 0);
+    ParallelFor(kPartitions, jobs, [&](std::size_t p) {
+        Candidate* part = all.data() + partStart[p];
+        const auto size = static_cast<std::uint32_t>(partStart[p + 1] - partStart[p]);
+        if (!size) return;
+        std::sort(part, part + size, CandidateLess);
+
+        DisjointSets sets(size);
+        for (std::uint32_t begin = 0, end; begin < size; begin = end) {
+            end = begin + 1;
+            while (end < size && SameGroup(part[begin], part[end])) ++end;
+            if (part[end - 1].type->isForwardDecl) UniteGroup(part, begin, end, sets);
+        }
+
+        for (std::uint32_t i = 0; i < size; ++i) {
+            const IRType* t = part[i].type;
+            if (!t->isForwardDecl) continue;
+            const IRType* canon = part[sets.representative(i)].type;
+            result.remap[t->id] = canon->id;
+            if (!canon->isForwardDecl) ++resolved[p];
+        }
+    });
+    for (std::size_t r : resolved) result.resolved += r;
+
+    // 4) Rewrite references in place.
+    std::vector<std::size_t> rewritten(chunks, 0);
+    const std::vector<IRTypeID>& remap = result.remap;
+    ParallelFor(chunks, jobs, [&](std::size_t c) {
+        auto fix = [&](IRTypeID& id) {
+            if (id < remap.size() && remap[id] != id) {
+                id = remap[id];
+                ++rewritten[c];
+            }
+        };
+        std::size_t end = std::min(n, (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) {
+            IRType* t = types[i];
+            if (!t) continue;
+            for (IRField& f : t->fields) fix(f.type);
+            fix(t->pointeeType);
+            fix(t->elementType);
+        }
+    });
+    for (std::size_t r : rewritten) result.references += r;
+    return result;
+}
+
+std::size_t IRForwardResolution::rewrite(IRScope& scope) const {
+    std::size_t changed = 0;
+    auto fix = [&](std::uint32_t& id) {
+        IRTypeID to = canonical(id);
+        if (to != id) {
+            id = to;
+            ++changed;
+        }
+    };
+    for (IRSymbol& sym : scope.declaredSymbols) fix(sym.type);
+    if (scope.inlinees) {
+        for (std::size_t i = 1; i <= scope.inlinees->size(); ++i) {
+            fix(scope.inlinees->get(static_cast<IRInlineeID>(i)).type);
+        }
+    }
+    for (auto& child : scope.children) changed += rewrite(*child);
+    return changed;
+}
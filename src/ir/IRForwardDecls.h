@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "IRNode.h"
+#include "IRTypeTable.h"
+
+// Forward-declaration resolution:
+// Readers create one IRType per DWARF DW_AT_declaration DIE and per PDB
+// LF_STRUCTURE/LF_UNION with the forward-ref bit, and pointers and fields
+// keep pointing at it ("struct Node { Node* next; }", or a type that is only
+// defined in another CU). ResolveForwardDecls unifies each forward decl with
+// the definition of the same qualified name, struct/union kind and size, and
+// rewrites IRField::type, pointeeType and elementType in place.
+//
+//   - a sized decl takes the (first) definition of that size;
+//   - a size-0 decl takes the definition when all same-named definitions
+//     agree on the size, otherwise it stays a decl;
+//   - decls left without a definition collapse onto one of them;
+//   - anonymous aggregates ("", "anonymous$N", "<unnamed-tag>", ...) are
+//     never matched by name.
+//
+// Types are hash-partitioned by name and each partition runs its own
+// union-find; the rewrite is a parallel sweep over a dense ID remap, so the
+// pass is linear in types + references. It must run while nothing else is
+// creating types, i.e. between reading and translating.
+struct IRForwardResolution {
+    std::vector<IRTypeID> remap;   // remap[id] = canonical ID (identity when untouched)
+    std::size_t forwardDecls = 0;  // named struct/union decls seen
+    std::size_t resolved     = 0;  // decls now pointing at a definition
+    std::size_t references   = 0;  // type references rewritten in the table
+
+    IRTypeID canonical(IRTypeID id) const { return id < remap.size() ? remap[id] : id; }
+
+    // Rewrites symbol and inlinee types below 'scope'; returns how many changed.
+    std::size_t rewrite(IRScope& scope) const;
+};
+
+IRForwardResolution ResolveForwardDecls(IRTypeTable& typeTable, unsigned jobs = 0);
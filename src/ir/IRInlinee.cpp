@@ -0,0 +1,31 @@
+#include "IRInlinee.h"
+
+IRInlineeID IRInlineeTable::intern(std::uint64_t originKey, const std::string& name, std::uint32_t type) {
+    auto it = byOrigin.find(originKey);
+    if (it != byOrigin.end()) return it->second;
+
+    IRInlinee e;
+    e.name = name;
+    e.type = type;
+    e.originKey = originKey;
+    entries.push_back(std::move(e));
+
+    IRInlineeID id = static_cast<IRInlineeID>(entries.size());
+    byOrigin.emplace(originKey, id);
+    return id;
+}
+
+IRInlineeID IRInlineeTable::find(std::uint64_t originKey) const {
+    auto it = byOrigin.find(originKey);
+    return it == byOrigin.end() ? 0 : it->second;
+}
+
+std::size_t IRInlineeTable::memoryBytes() const {
+    std::size_t bytes = entries.capacity() * sizeof(IRInlinee)
+                      + byOrigin.bucket_count() * sizeof(void*)
+                      + byOrigin.size() * (sizeof(std::uint64_t) + sizeof(IRInlineeID) + 2 * sizeof(void*));
+    for (const IRInlinee& e : entries) {
+        if (e.name.capacity() > 15) bytes += e.name.capacity() + 1;
+    }
+    return bytes;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Inlinee table: one entry per inlined *origin* (the abstract subprogram a
+// DW_TAG_inlined_subroutine points at via DW_AT_abstract_origin, or the
+// LF_FUNC_ID an S_INLINESITE names). An -O2 build may have millions of
+// inline sites but only thousands of distinct origins, so sites store a
+// 32-bit IRInlineeID and the name/type live here exactly once.
+using IRInlineeID = std::uint32_t; // 0 = none
+
+struct IRInlinee {
+    std::string   name;
+    std::uint32_t type = 0;       // IRTypeID of the function type
+    std::uint64_t originKey = 0;  // DIE offset of the abstract origin / LF_FUNC_ID item
+    std::uint32_t declFile = 0;   // index into the CU's IRLineTable::files
+    std::uint32_t declLine = 0;
+};
+
+class IRInlineeTable {
+public:
+    // Returns the existing entry for originKey, or adds a new one.
+    IRInlineeID intern(std::uint64_t originKey, const std::string& name, std::uint32_t type);
+
+    IRInlineeID find(std::uint64_t originKey) const;
+
+    IRInlinee&       get(IRInlineeID id)       { return entries[id - 1]; }
+    const IRInlinee& get(IRInlineeID id) const { return entries[id - 1]; }
+    std::size_t size() const { return entries.size(); }
+    std::size_t memoryBytes() const;
+
+private:
+    std::vector<IRInlinee> entries; // entries[id - 1]
+    std::unordered_map<std::uint64_t, IRInlineeID> byOrigin;
+};
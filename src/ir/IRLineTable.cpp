@@ -0,0 +1,80 @@
+#include "IRLineTable.h"
+#include <algorithm>
+
+void IRLineTable::reserveRows(std::size_t n) {
+    address.reserve(n);
+    file.reserve(n);
+    line.reserve(n);
+    column.reserve(n);
+    flags.reserve(n);
+}
+
+void IRLineTable::appendRow(std::uint64_t addr, std::uint32_t fileIndex,
+                            std::uint32_t lineNo, std::uint16_t col,
+                            std::uint8_t rowFlags) {
+    address.push_back(addr);
+    file.push_back(fileIndex);
+    line.push_back(lineNo);
+    column.push_back(col);
+    flags.push_back(rowFlags);
+}
+
+void IRLineTable::endSequence(std::uint32_t firstRow, std::uint64_t endAddr) {
+    std::uint32_t fileIndex = firstRow < file.size() ? file.back() : 0;
+    appendRow(endAddr, fileIndex, 0, 0, IRLineEndSequence);
+
+    IRLineSequence seq;
+    seq.firstRow = firstRow;
+    seq.rowCount = static_cast<std::uint32_t>(address.size() - firstRow);
+    seq.lowPC    = address[firstRow];
+    seq.highPC   = endAddr;
+    sequences.push_back(seq);
+}
+
+bool IRLineTable::findRows(std::uint64_t lo, std::uint64_t hi,
+                           std::uint32_t& first, std::uint32_t& count) const {
+    for (const IRLineSequence& seq : sequences) {
+        if (lo >= seq.highPC || hi <= seq.lowPC) continue;
+
+        // Rows inside a sequence are address-ordered; the last one is the
+        // EndSequence marker, which never counts as a row of its own.
+        auto begin = address.begin() + seq.firstRow;
+        auto end   = begin + (seq.rowCount - 1);
+        auto a = std::lower_bound(begin, end, lo);
+        auto b = std::lower_bound(a, end, hi);
+        if (a == b) continue; // no row starts in range here; try the next sequence
+        first = static_cast<std::uint32_t>(a - address.begin());
+        count = static_cast<std::uint32_t>(b - a);
+        return true;
+    }
+    return false;
+}
+
+bool IRLineTable::rowAt(std::uint64_t addr, std::uint32_t& row, std::uint32_t& seqEndRow) const {
+    for (const IRLineSequence& seq : sequences) {
+        if (addr < seq.lowPC || addr >= seq.highPC) continue;
+
+        auto begin = address.begin() + seq.firstRow;
+        auto end   = begin + (seq.rowCount - 1);
+        auto it = std::upper_bound(begin, end, addr);
+        if (it == begin) return false;
+        row = static_cast<std::uint32_t>((it - 1) - address.begin());
+        seqEndRow = seq.firstRow + seq.rowCount - 1;
+        return true;
+    }
+    return false;
+}
+
+std::size_t IRLineTable::memoryBytes() const {
+    std::size_t bytes = files.capacity() * sizeof(IRLineFile)
+                      + address.capacity() * sizeof(std::uint64_t)
+                      + file.capacity() * sizeof(std::uint32_t)
+                      + line.capacity() * sizeof(std::uint32_t)
+                      + column.capacity() * sizeof(std::uint16_t)
+                      + flags.capacity()
+                      + sequences.capacity() * sizeof(IRLineSequence);
+    for (const IRLineFile& f : files) {
+        if (f.path.capacity() > 15) bytes += f.path.capacity() + 1;
+    }
+    return bytes;
+}
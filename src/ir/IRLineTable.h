@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Line information for one compile unit, stored column-wise so a CU with
+// millions of rows costs ~19 bytes/row and no per-row allocation.
+//
+// Rows are grouped into sequences (a DWARF end_sequence run, or one
+// CodeView DEBUG_S_LINES block). Each sequence ends with an EndSequence row
+// whose address is the first byte past the sequence.
+
+enum IRLineFlags : std::uint8_t {
+    IRLineIsStmt        = 1 << 0,
+    IRLineEndSequence   = 1 << 1,
+    IRLinePrologueEnd   = 1 << 2,
+    IRLineEpilogueBegin = 1 << 3
+};
+
+struct IRLineFile {
+    std::string  path;               // full path as the producer recorded it
+    std::uint8_t checksumKind = 0;   // 0 = none, 1 = MD5 (CodeView numbering)
+    std::uint8_t checksum[16] = {};
+};
+
+struct IRLineSequence {
+    std::uint32_t firstRow = 0;
+    std::uint32_t rowCount = 0;      // includes the EndSequence row
+    std::uint64_t lowPC    = 0;
+    std::uint64_t highPC   = 0;
+};
+
+struct IRLineTable {
+    std::vector<IRLineFile> files;
+
+    // Row columns; all the same length.
+    std::vector<std::uint64_t> address;
+    std::vector<std::uint32_t> file;    // index into files
+    std::vector<std::uint32_t> line;    // 0 = no source line
+    std::vector<std::uint16_t> column;
+    std::vector<std::uint8_t>  flags;   // IRLineFlags
+
+    std::vector<IRLineSequence> sequences;
+
+    std::size_t rowCount() const { return address.size(); }
+    void reserveRows(std::size_t n);
+
+    void appendRow(std::uint64_t addr, std::uint32_t fileIndex,
+                   std::uint32_t lineNo, std::uint16_t col, std::uint8_t rowFlags);
+
+    // Closes the sequence begun at row 'firstRow' with an EndSequence row.
+    void endSequence(std::uint32_t firstRow, std::uint64_t endAddr);
+
+    // Rows (excluding EndSequence rows) with lo <= address < hi, as a
+    // contiguous run inside one sequence. Returns false if none.
+    bool findRows(std::uint64_t lo, std::uint64_t hi,
+                  std::uint32_t& first, std::uint32_t& count) const;
+
+    // The row in effect at 'addr' (last non-EndSequence row with
+    // address <= addr) and the end of its sequence. False if none.
+    bool rowAt(std::uint64_t addr, std::uint32_t& row, std::uint32_t& seqEndRow) const;
+
+    std::size_t memoryBytes() const;
+};
@@ -0,0 +1,183 @@
+#include "IRLocation.h"
+#include <cstring>
+
+namespace {
+
+std::uint64_t HashBytes(IRLocFormat fmt, const std::uint8_t* data, std::size_t size) {
+    // FNV-1a; location blobs are short (typically 1-10 bytes).
+    std::uint64_t h = 0xcbf29ce484222325ull ^ static_cast<std::uint8_t>(fmt);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+void PutULEB(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    do {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        if (v) b |= 0x80;
+        out.push_back(b);
+    } while (v);
+}
+
+std::uint64_t GetULEB(const std::uint8_t*& p, const std::uint8_t* end) {
+    std::uint64_t v = 0;
+    unsigned shift = 0;
+    while (p < end) {
+        std::uint8_t b = *p++;
+        if (shift < 64) v |= std::uint64_t(b & 0x7f) << shift;
+        shift += 7;
+        if (!(b & 0x80)) break;
+    }
+    return v;
+}
+
+} // namespace
+
+IRLocID IRLocationPool::intern(IRLocFormat fmt, const std::uint8_t* data, std::size_t size) {
+    if (hashSlots.empty() || (entries.size() + 1) * 2 > hashSlots.size()) {
+        growHashTable();
+    }
+
+    std::size_t mask = hashSlots.size() - 1;
+    std::size_t slot = HashBytes(fmt, data, size) & mask;
+    while (IRLocID id = hashSlots[slot]) {
+        const Entry& e = entries[id - 1];
+        if (e.fmt == fmt && e.size == size &&
+            (size == 0 || std::memcmp(&blobBytes[e.offset], data, size) == 0)) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    Entry e;
+    e.offset = static_cast<std::uint32_t>(blobBytes.size());
+    e.size   = static_cast<std::uint32_t>(size);
+    e.fmt    = fmt;
+    blobBytes.insert(blobBytes.end(), data, data + size);
+    entries.push_back(e);
+
+    IRLocID id = static_cast<IRLocID>(entries.size());
+    hashSlots[slot] = id;
+    return id;
+}
+
+void IRLocationPool::growHashTable() {
+    std::size_t newSize = hashSlots.empty() ? 64 : hashSlots.size() * 2;
+    std::vector<IRLocID> slots(newSize, 0);
+    std::size_t mask = newSize - 1;
+    for (IRLocID id = 1; id <= entries.size(); ++id) {
+        const Entry& e = entries[id - 1];
+        std::size_t slot = HashBytes(e.fmt, blobBytes.data() + e.offset, e.size) & mask;
+        while (slots[slot]) slot = (slot + 1) & mask;
+        slots[slot] = id;
+    }
+    hashSlots.swap(slots);
+}
+
+IRBytes IRLocationPool::bytes(IRLocID id) const {
+    if (id == 0 || id > entries.size()) return {};
+    const Entry& e = entries[id - 1];
+    return IRBytes{blobBytes.data() + e.offset, e.size};
+}
+
+IRLocFormat IRLocationPool::format(IRLocID id) const {
+    if (id == 0 || id > entries.size()) return IRLocFormat::DwarfExpr;
+    return entries[id - 1].fmt;
+}
+
+IRSymbolStorage IRLocationPool::addRanges(std::uint64_t functionLowPC,
+                                          const IRLiveRange* ranges,
+                                          std::size_t count) {
+    IRSymbolStorage s;
+    s.rangeOffset = static_cast<std::uint32_t>(rangeBytes.size());
+    s.rangeCount  = static_cast<std::uint32_t>(count);
+
+    // Each range: ULEB(begin - prevBegin), ULEB(end - begin), ULEB(loc).
+    // Deltas from the previous *begin* keep overlapping loclist entries legal.
+    std::uint64_t prevBegin = functionLowPC;
+    for (std::size_t i = 0; i < count; ++i) {
+        const IRLiveRange& r = ranges[i];
+        PutULEB(rangeBytes, r.begin - prevBegin);
+        PutULEB(rangeBytes, r.end - r.begin);
+        PutULEB(rangeBytes, r.loc);
+        prevBegin = r.begin;
+    }
+    return s;
+}
+
+IRLocationPool::RangeCursor IRLocationPool::ranges(const IRSymbolStorage& storage,
+                                                   std::uint64_t functionLowPC) const {
+    RangeCursor c;
+    c.p = rangeBytes.data() + storage.rangeOffset;
+    c.end = rangeBytes.data() + rangeBytes.size();
+    c.remaining = storage.rangeCount;
+    c.prevBegin = functionLowPC;
+    return c;
+}
+
+bool IRLocationPool::RangeCursor::next(IRLiveRange& out) {
+    if (remaining == 0 || p >= end) return false;
+    --remaining;
+    out.begin = prevBegin + GetULEB(p, end);
+    out.end   = out.begin + GetULEB(p, end);
+    out.loc   = static_cast<IRLocID>(GetULEB(p, end));
+    prevBegin = out.begin;
+    return true;
+}
+
+std::size_t IRLocationPool::memoryBytes() const {
+    return blobBytes.capacity()
+         + entries.capacity() * sizeof(Entry)
+         + hashSlots.capacity() * sizeof(IRLocID)
+         + rangeBytes.capacity();
+}
+
+void IRLocationPool::save(std::vector<std::uint8_t>& out) const {
+    PutULEB(out, entries.size());
+    for (const Entry& e : entries) {
+        out.push_back(static_cast<std::uint8_t>(e.fmt));
+        PutULEB(out, e.offset);
+        PutULEB(out, e.size);
+    }
+    PutULEB(out, blobBytes.size());
+    out.insert(out.end(), blobBytes.begin(), blobBytes.end());
+    PutULEB(out, rangeBytes.size());
+    out.insert(out.end(), rangeBytes.begin(), rangeBytes.end());
+}
+
+bool IRLocationPool::load(const std::uint8_t*& p, const std::uint8_t* end) {
+    if (!entries.empty() || !rangeBytes.empty()) return false;
+    // On failure the pool is left empty rather than half-filled.
+    auto fail = [&] {
+        entries.clear();
+        blobBytes.clear();
+        rangeBytes.clear();
+        hashSlots.clear();
+        return false;
+    };
+    // Every entry takes at least 3 bytes, so 'count' cannot exceed the input.
+    std::uint64_t count = GetULEB(p, end);
+    if (count > static_cast<std::uint64_t>(end - p) / 3) return fail();
+    entries.resize(count);
+    for (Entry& e : entries) {
+        if (p >= end || *p > static_cast<std::uint8_t>(IRLocFormat::CodeViewDefRange)) return fail();
+        e.fmt    = static_cast<IRLocFormat>(*p++);
+        e.offset = static_cast<std::uint32_t>(GetULEB(p, end));
+        e.size   = static_cast<std::uint32_t>(GetULEB(p, end));
+    }
+    for (std::vector<std::uint8_t>* bytes : {&blobBytes, &rangeBytes}) {
+        std::uint64_t n = GetULEB(p, end);
+        if (n > static_cast<std::uint64_t>(end - p)) return fail();
+        bytes->assign(p, p + n);
+        p += n;
+    }
+    for (const Entry& e : entries) {
+        if (std::uint64_t(e.offset) + e.size > blobBytes.size()) return fail();
+    }
+    hashSlots.clear();
+    while (hashSlots.size() < (entries.size() + 1) * 2) growHashTable();
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Storage info / live ranges for IRSymbol.
+//
+// Optimized code gives every local many (range, location) pairs, so nothing
+// here is allocated per symbol:
+//   - location bytes (DWARF DW_OP_* expressions or CodeView S_DEFRANGE_*
+//     records) are interned once per unit in IRLocationPool and referred to
+//     by a 32-bit IRLocID;
+//   - live ranges are ULEB128 triples in one shared byte stream, delta
+//     encoded against the enclosing function's lowPC.
+// An IRSymbol only carries a 12-byte IRSymbolStorage handle.
+
+using IRLocID = std::uint32_t; // 0 = no location
+
+enum class IRLocFormat : std::uint8_t {
+    DwarfExpr,        // raw DW_OP_* bytes, as found in DW_AT_location / loclists
+    CodeViewDefRange  // one complete S_DEFRANGE_* record (header included)
+};
+
+// Non-owning view of bytes that live in a pool or input buffer.
+struct IRBytes {
+    const std::uint8_t* data = nullptr;
+    std::size_t         size = 0;
+};
+
+// One absolute live range [begin, end) with the location valid there.
+struct IRLiveRange {
+    std::uint64_t begin = 0;
+    std::uint64_t end   = 0;
+    IRLocID       loc   = 0;
+};
+
+struct IRSymbolStorage {
+    IRLocID       loc = 0;          // location valid for the whole scope
+    std::uint32_t rangeOffset = 0;  // byte offset into the pool's range stream
+    std::uint32_t rangeCount  = 0;  // 0 => use 'loc' everywhere
+};
+
+class IRLocationPool {
+public:
+    // Returns the existing ID when identical bytes were interned before.
+    IRLocID intern(IRLocFormat fmt, const std::uint8_t* data, std::size_t size);
+
+    IRBytes     bytes(IRLocID id) const;
+    IRLocFormat format(IRLocID id) const;
+    std::size_t size() const { return entries.size(); }
+
+    // Append one symbol's ranges (sorted by begin, begin >= functionLowPC).
+    IRSymbolStorage addRanges(std::uint64_t functionLowPC,
+                              const IRLiveRange* ranges,
+                              std::size_t count);
+
+    // Decodes ranges back to absolute addresses without allocating.
+    class RangeCursor {
+    public:
+        bool next(IRLiveRange& out);
+    private:
+        friend class IRLocationPool;
+        const std::uint8_t* p = nullptr;
+        const std::uint8_t* end = nullptr;
+        std::uint32_t remaining = 0;
+        std::uint64_t prevBegin = 0;
+    };
+    RangeCursor ranges(const IRSymbolStorage& storage,
+                       std::uint64_t functionLowPC) const;
+
+    std::size_t memoryBytes() const;
+
+    // Spill support (--max-memory): save() appends the pool to 'out';
+    // load() rebuilds an empty pool from it, same IDs and range offsets.
+    // Returns false on truncated or inconsistent input.
+    void save(std::vector<std::uint8_t>& out) const;
+    bool load(const std::uint8_t*& p, const std::uint8_t* end);
+
+private:
+    struct Entry {
+        std::uint32_t offset = 0;
+        std::uint32_t size   = 0;
+        IRLocFormat   fmt    = IRLocFormat::DwarfExpr;
+    };
+
+    void growHashTable();
+
+    std::vector<std::uint8_t> blobBytes;
+    std::vector<Entry>        entries;   // entries[id - 1]
+    std::vector<IRLocID>      hashSlots; // open addressing, 0 = empty
+    std::vector<std::uint8_t> rangeBytes;
+};
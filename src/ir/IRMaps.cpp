@@ -1,2 +1,30 @@
 #include "IRMaps.h"
-// currently empty, placeholder for helper funcs
+
+namespace {
+
+template <typename K, typename V>
+void LinkAll(const std::vector<std::pair<K, IRTypeID>>& pairs, IRFlatMap<K>& toIR, IRDenseMap<V>& fromIR) {
+    toIR.build(pairs);
+    IRTypeID maxID = 0;
+    for (const auto& p : pairs) maxID = p.second > maxID ? p.second : maxID;
+    fromIR.reserve(std::size_t(maxID) + 1);
+    for (const auto& p : pairs) fromIR.set(p.second, p.first);
+}
+
+} // namespace
+
+void IRMaps::linkDwarf(const std::vector<std::pair<std::uint64_t, IRTypeID>>& pairs) {
+    LinkAll(pairs, dwarfDieToIR, irToDwarfDie);
+}
+
+void IRMaps::linkPdb(const std::vector<std::pair<std::uint32_t, IRTypeID>>& pairs) {
+    LinkAll(pairs, pdbTIToIR, irToPdbTI);
+}
+
+std::size_t IRMaps::dwarfSideBytes() const {
+    return dwarfDieToIR.memoryBytes() + irToDwarfDie.memoryBytes();
+}
+
+std::size_t IRMaps::pdbSideBytes() const {
+    return pdbTIToIR.memoryBytes() + irToPdbTI.memoryBytes();
+}
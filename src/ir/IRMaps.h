@@ -1,17 +1,43 @@
 #pragma once
 #include <cstdint>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "IRNode.h"
+#include "IRFlatMap.h"
 
+// In the streaming pipeline the reader stage only touches its own side
+// (e.g. dwarfDie*) and the translator stage only the other side (pdbTI*),
+// so the two halves may be filled concurrently without locking.
+//
+// IR -> external is a dense vector by IRTypeID; external -> IR a flat hash
+// table (see IRFlatMap.h). link*() fills both directions of a side.
 class IRMaps {
 public:
     // DWARF side
     // key: DWARF DIE offset (or some CU-relative ID you assign)
-    std::unordered_map<std::uint64_t, IRTypeID> dwarfDieToIR;
-    std::unordered_map<IRTypeID, std::uint64_t> irToDwarfDie;
+    IRFlatMap<std::uint64_t>  dwarfDieToIR;
+    IRDenseMap<std::uint64_t> irToDwarfDie;
 
     // PDB side
     // key: CodeView type index
-    std::unordered_map<std::uint32_t, IRTypeID> pdbTIToIR;
-    std::unordered_map<IRTypeID, std::uint32_t> irToPdbTI;
+    IRFlatMap<std::uint32_t>  pdbTIToIR;
+    IRDenseMap<std::uint32_t> irToPdbTI;
+
+    void linkDwarf(IRTypeID id, std::uint64_t die) {
+        irToDwarfDie.set(id, die);
+        dwarfDieToIR.set(die, id);
+    }
+    void linkPdb(IRTypeID id, std::uint32_t ti) {
+        irToPdbTI.set(id, ti);
+        pdbTIToIR.set(ti, id);
+    }
+
+    // Bulk forms for readers that hand over a whole unit's pairs at once.
+    void linkDwarf(const std::vector<std::pair<std::uint64_t, IRTypeID>>& pairs);
+    void linkPdb(const std::vector<std::pair<std::uint32_t, IRTypeID>>& pairs);
+
+    // Approximate heap footprint of each half; each may be called by the
+    // stage that owns that half while the other half is being filled.
+    std::size_t dwarfSideBytes() const;
+    std::size_t pdbSideBytes() const;
 };
@@ -0,0 +1,511 @@
+#include "IRName.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+
+constexpr std::uint64_t kHashBase = 0x100000001b3ull; // odd, so powers never vanish
+
+std::uint64_t Mix(std::uint64_t h, std::uint64_t len) {
+    h ^= len * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+// Bump allocator; nodes, child arrays and atom text never move.
+class Arena {
+public:
+    void* alloc(std::size_t n, std::size_t align) {
+        std::size_t pad = (align - reinterpret_cast<std::uintptr_t>(cur) % align) % align;
+        if (!cur || pad + n > left) {
+            std::size_t size = std::max<std::size_t>(kBlock, n + align);
+            blocks.emplace_back(new char[size]);
+            cur = blocks.back().get();
+            left = size;
+            total += size;
+            pad = (align - reinterpret_cast<std::uintptr_t>(cur) % align) % align;
+        }
+        char* p = cur + pad;
+        cur += pad + n;
+        left -= pad + n;
+        return p;
+    }
+    std::size_t bytes() const { return total; }
+
+private:
+    static constexpr std::size_t kBlock = 16 * 1024; // one arena per shard
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char*       cur = nullptr;
+    std::size_t left = 0;
+    std::size_t total = 0;
+};
+
+// Leaf-by-leaf walk over a name, used by compare(). The node stack lives
+// inline for the usual nesting depths.
+class Cursor {
+public:
+    explicit Cursor(const IRNameNode* n) {
+        if (n) push(n);
+    }
+    bool aligned() const { return cur.empty(); }
+    bool done() const { return cur.empty() && depth == 0; }
+    const IRNameNode* top() const { return depth ? at(depth - 1) : nullptr; }
+    void skipTop() { --depth; }
+
+    // Expands the top node one level; loads the next atom's text.
+    void step() {
+        const IRNameNode* n = at(--depth);
+        if (n->kind == IRNameNode::Atom) {
+            cur = std::string_view(n->text, static_cast<std::size_t>(n->length));
+        } else {
+            for (std::uint32_t i = n->count; i-- > 0;) push(n->children[i]);
+        }
+    }
+    // Makes 'cur' non-empty unless the name is exhausted.
+    void fill() {
+        while (cur.empty() && depth) step();
+    }
+
+    std::string_view cur;
+
+private:
+    static constexpr std::size_t kInline = 48;
+
+    const IRNameNode* at(std::size_t i) const { return i < kInline ? inlineStack[i] : spill[i - kInline]; }
+    void push(const IRNameNode* n) {
+        if (depth < kInline) {
+            inlineStack[depth] = n;
+        } else {
+            spill.resize(depth - kInline + 1);
+            spill[depth - kInline] = n;
+        }
+        ++depth;
+    }
+
+    const IRNameNode* inlineStack[kInline];
+    std::vector<const IRNameNode*> spill;
+    std::size_t depth = 0;
+};
+
+bool IsOpChar(char c) {
+    switch (c) {
+    case '<': case '>': case '=': case '!': case '+': case '-': case '*': case '/':
+    case '%': case '^': case '&': case '|': case '~': case ',': case '(': case ')':
+    case '[': case ']':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool IsIdentChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+// True when s[start, pos) ends with a standalone "operator" keyword.
+bool EndsWithOperator(std::string_view s, std::size_t start, std::size_t pos) {
+    constexpr std::string_view kw = "operator";
+    if (pos - start < kw.size() || s.substr(pos - kw.size(), kw.size()) != kw) return false;
+    std::size_t before = pos - kw.size();
+    return before == start || !IsIdentChar(s[before - 1]);
+}
+
+} // namespace
+
+// The table is split into shards by node hash, each with its own lock,
+// arena and open-addressing slots. Parsing and hashing run outside any
+// lock; a lock is only held to probe or insert one node, so readers of
+// different inputs rarely wait on each other.
+struct IRNameStore::Impl {
+    static constexpr std::size_t kShards = 64; // power of two
+
+    struct alignas(64) Shard {
+        mutable std::mutex mu;
+        Arena arena;
+        std::vector<const IRNameNode*> table = std::vector<const IRNameNode*>(64, nullptr);
+        std::size_t used = 0;
+
+        void grow() {
+            std::vector<const IRNameNode*> old(table.size() * 2, nullptr);
+            old.swap(table);
+            std::size_t mask = table.size() - 1;
+            for (const IRNameNode* n : old) {
+                if (!n) continue;
+                std::size_t i = slotHash(n->hash, n->length) & mask;
+                while (table[i]) i = (i + 1) & mask;
+                table[i] = n;
+            }
+        }
+    };
+    Shard shards[kShards];
+
+    // Separators every template name uses.
+    const IRNameNode* scopeSep = nullptr; // "::"
+    const IRNameNode* open     = nullptr; // "<"
+    const IRNameNode* close    = nullptr; // ">"
+
+    Impl() {
+        scopeSep = atom("::");
+        open = atom("<");
+        close = atom(">");
+    }
+
+    static std::size_t slotHash(std::uint64_t h, std::uint64_t len) { return static_cast<std::size_t>(Mix(h, len)); }
+    // The top bits pick the shard; the slot within it uses the low ones.
+    Shard& shardOf(std::uint64_t h, std::uint64_t len) {
+        return shards[(Mix(h, len) >> 58) & (kShards - 1)];
+    }
+    const Shard& shardOf(std::uint64_t h, std::uint64_t len) const {
+        return shards[(Mix(h, len) >> 58) & (kShards - 1)];
+    }
+
+    template <typename Eq, typename Make>
+    const IRNameNode* findOrInsert(std::uint64_t h, std::uint64_t len, Eq&& eq, Make&& make) {
+        Shard& sh = shardOf(h, len);
+        std::lock_guard<std::mutex> lock(sh.mu);
+        std::size_t mask = sh.table.size() - 1;
+        std::size_t i = slotHash(h, len) & mask;
+        for (; sh.table[i]; i = (i + 1) & mask) {
+            const IRNameNode* n = sh.table[i];
+            if (n->hash == h && n->length == len && eq(n)) return n;
+        }
+        const IRNameNode* n = make(sh.arena);
+        sh.table[i] = n;
+        if (++sh.used * 10 > sh.table.size() * 7) sh.grow();
+        return n;
+    }
+
+    static void hashText(std::string_view text, std::uint64_t& h, std::uint64_t& power) {
+        h = 0;
+        power = 1;
+        for (char c : text) {
+            h = h * kHashBase + static_cast<unsigned char>(c);
+            power *= kHashBase;
+        }
+    }
+
+    // Any node whose flattened text is 'text'. Names repeat across units far
+    // more often than they are new, so parse() tries this before splitting.
+    const IRNameNode* findText(std::string_view text, std::uint64_t h) const {
+        const Shard& sh = shardOf(h, text.size());
+        std::lock_guard<std::mutex> lock(sh.mu);
+        std::size_t mask = sh.table.size() - 1;
+        for (std::size_t i = slotHash(h, text.size()) & mask; sh.table[i]; i = (i + 1) & mask) {
+            const IRNameNode* n = sh.table[i];
+            if (n->hash == h && n->length == text.size() && IRName::compare(IRName(n), text) == 0) return n;
+        }
+        return nullptr;
+    }
+
+    const IRNameNode* atom(std::string_view text) {
+        std::uint64_t h = 0, power = 1;
+        hashText(text, h, power);
+        return findOrInsert(h, text.size(),
+            [&](const IRNameNode* n) {
+                return n->kind == IRNameNode::Atom && std::memcmp(n->text, text.data(), text.size()) == 0;
+            },
+            [&](Arena& arena) {
+                char* buf = static_cast<char*>(arena.alloc(text.size() + 1, 1));
+                std::memcpy(buf, text.data(), text.size());
+                buf[text.size()] = '\0';
+                auto* n = new (arena.alloc(sizeof(IRNameNode), alignof(IRNameNode))) IRNameNode();
+                n->kind = IRNameNode::Atom;
+                n->length = text.size();
+                n->hash = h;
+                n->power = power;
+                n->text = buf;
+                return n;
+            });
+    }
+
+    const IRNameNode* concat(const IRNameNode* const* parts, std::size_t count) {
+        // Empty parts contribute nothing; a single part is itself.
+        const IRNameNode* kept[64];
+        std::vector<const IRNameNode*> spill;
+        const IRNameNode** kids = kept;
+        if (count > 64) {
+            spill.resize(count);
+            kids = spill.data();
+        }
+        std::size_t n = 0;
+        std::uint64_t h = 0, power = 1, len = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const IRNameNode* p = parts[i];
+            if (!p || p->length == 0) continue;
+            kids[n++] = p;
+            h = h * p->power + p->hash;
+            power *= p->power;
+            len += p->length;
+        }
+        if (n == 0) return nullptr;
+        if (n == 1) return kids[0];
+
+        return findOrInsert(h, len,
+            [&](const IRNameNode* node) {
+                return node->kind == IRNameNode::Concat && node->count == n &&
+                       std::equal(kids, kids + n, node->children);
+            },
+            [&](Arena& arena) {
+                auto** arr = static_cast<const IRNameNode**>(
+                    arena.alloc(n * sizeof(const IRNameNode*), alignof(const IRNameNode*)));
+                std::copy(kids, kids + n, arr);
+                auto* node = new (arena.alloc(sizeof(IRNameNode), alignof(IRNameNode))) IRNameNode();
+                node->kind = IRNameNode::Concat;
+                node->count = static_cast<std::uint32_t>(n);
+                node->length = len;
+                node->hash = h;
+                node->power = power;
+                node->children = arr;
+                return node;
+            });
+    }
+
+    const IRNameNode* concat(std::initializer_list<const IRNameNode*> parts) {
+        return concat(parts.begin(), parts.size());
+    }
+};
+
+namespace {
+
+// Template nesting deeper than this is kept as one atom rather than
+// recursing further.
+constexpr int kMaxParseDepth = 64;
+
+// Recursive-descent split of a flat name. Every input byte lands in exactly
+// one atom, in order, so the flattened result equals the input; 'ok' goes
+// false on unbalanced brackets or nesting past kMaxParseDepth, and the
+// caller falls back to one atom.
+template <typename Store>
+struct Parser {
+    Store& st;
+    std::string_view s;
+    std::size_t pos = 0;
+    bool ok = true;
+    // Pieces of every open comp/args, as one stack to avoid allocating.
+    std::vector<const IRNameNode*> stack;
+
+    const IRNameNode* finish(std::size_t mark) {
+        const IRNameNode* n = st.concat(stack.data() + mark, stack.size() - mark);
+        stack.resize(mark);
+        return n;
+    }
+
+    // expr := comp ("::" comp)*, left-nested like IRNameStore::qualified.
+    const IRNameNode* expr(int depth) {
+        const IRNameNode* left = comp(depth);
+        while (ok && s.compare(pos, 2, "::") == 0) {
+            pos += 2;
+            const IRNameNode* right = comp(depth);
+            left = st.concat({left, st.scopeSep, right});
+        }
+        return left;
+    }
+
+    // comp := (text | "<" args ">")+
+    const IRNameNode* comp(int depth) {
+        const std::size_t mark = stack.size();
+        std::size_t textStart = pos;
+        auto flush = [&] {
+            if (pos > textStart) stack.push_back(st.atom(s.substr(textStart, pos - textStart)));
+        };
+        while (pos < s.size()) {
+            char c = s[pos];
+            if (!IsOpChar(c) && c != ':') {
+                ++pos;
+                continue;
+            }
+            if (c == ':') {
+                if (pos + 1 < s.size() && s[pos + 1] == ':') break;
+                ++pos;
+                continue;
+            }
+            if (EndsWithOperator(s, textStart, pos)) {
+                while (pos < s.size() && IsOpChar(s[pos])) ++pos;
+                continue;
+            }
+            if (c == ',' || c == '>') {
+                if (depth == 0) ok = false;
+                break;
+            }
+            if (c == '<') {
+                if (depth == kMaxParseDepth) {
+                    ok = false;
+                    return nullptr;
+                }
+                flush();
+                const IRNameNode* a = args(depth + 1);
+                if (!ok) return nullptr;
+                stack.push_back(a);
+                textStart = pos;
+                continue;
+            }
+            ++pos;
+        }
+        flush();
+        return finish(mark);
+    }
+
+    // args := "<" [expr ("," " "* expr)*] ">"
+    const IRNameNode* args(int depth) {
+        const std::size_t mark = stack.size();
+        stack.push_back(st.open);
+        ++pos;
+        if (pos < s.size() && s[pos] == '>') {
+            ++pos;
+            stack.push_back(st.close);
+            return finish(mark);
+        }
+        for (;;) {
+            const IRNameNode* arg = expr(depth);
+            if (!ok) return nullptr;
+            stack.push_back(arg);
+            if (pos >= s.size()) {
+                ok = false;
+                return nullptr;
+            }
+            if (s[pos] == '>') {
+                ++pos;
+                stack.push_back(st.close);
+                break;
+            }
+            std::size_t sepStart = pos++;
+            while (pos < s.size() && s[pos] == ' ') ++pos;
+            stack.push_back(st.atom(s.substr(sepStart, pos - sepStart)));
+        }
+        return finish(mark);
+    }
+};
+
+} // namespace
+
+// ---- IRName ----
+
+IRName::IRName(const char* s) : IRName(std::string_view(s ? s : "")) {}
+IRName::IRName(const std::string& s) : IRName(std::string_view(s)) {}
+IRName::IRName(std::string_view s) : node(IRNameStore::shared().parse(s).node) {}
+
+std::uint64_t IRName::hash() const {
+    return node ? Mix(node->hash, node->length) : Mix(0, 0);
+}
+
+std::string IRName::str() const {
+    std::string out;
+    appendTo(out);
+    return out;
+}
+
+void IRName::appendTo(std::string& out) const {
+    out.reserve(out.size() + size());
+    forEachFragment([&](std::string_view f) { out.append(f.data(), f.size()); });
+}
+
+int IRName::compare(const IRName& a, const IRName& b) {
+    if (a.node == b.node) return 0;
+    Cursor ca(a.node), cb(b.node);
+    for (;;) {
+        // At a fragment boundary on both sides: drop identical sub-trees.
+        while (ca.aligned() && cb.aligned() && ca.top() && ca.top() == cb.top()) {
+            ca.skipTop();
+            cb.skipTop();
+        }
+        if (ca.aligned() && cb.aligned() && ca.top() && cb.top() &&
+            (ca.top()->kind == IRNameNode::Concat || cb.top()->kind == IRNameNode::Concat)) {
+            if (ca.top()->kind == IRNameNode::Concat) ca.step();
+            else cb.step();
+            continue;
+        }
+        ca.fill();
+        cb.fill();
+        if (ca.done() || cb.done()) return ca.done() ? (cb.done() ? 0 : -1) : 1;
+
+        std::size_t n = std::min(ca.cur.size(), cb.cur.size());
+        int c = std::memcmp(ca.cur.data(), cb.cur.data(), n);
+        if (c) return c < 0 ? -1 : 1;
+        ca.cur.remove_prefix(n);
+        cb.cur.remove_prefix(n);
+    }
+}
+
+int IRName::compare(const IRName& a, std::string_view b) {
+    Cursor ca(a.node);
+    for (;;) {
+        ca.fill();
+        if (ca.done() || b.empty()) return ca.done() ? (b.empty() ? 0 : -1) : 1;
+        std::size_t n = std::min(ca.cur.size(), b.size());
+        int c = std::memcmp(ca.cur.data(), b.data(), n);
+        if (c) return c < 0 ? -1 : 1;
+        ca.cur.remove_prefix(n);
+        b.remove_prefix(n);
+    }
+}
+
+// ---- IRNameStore ----
+
+IRNameStore::IRNameStore() : impl(std::make_unique<Impl>()) {}
+IRNameStore::~IRNameStore() = default;
+
+IRNameStore& IRNameStore::shared() {
+    static IRNameStore store;
+    return store;
+}
+
+IRName IRNameStore::atom(std::string_view text) {
+    return IRName(text.empty() ? nullptr : impl->atom(text));
+}
+
+IRName IRNameStore::concat(const IRName* parts, std::size_t count) {
+    std::vector<const IRNameNode*> nodes(count);
+    for (std::size_t i = 0; i < count; ++i) nodes[i] = parts[i].root();
+    return IRName(impl->concat(nodes.data(), nodes.size()));
+}
+
+IRName IRNameStore::qualified(const IRName& scope, const IRName& leaf) {
+    if (scope.empty()) return leaf;
+    return IRName(impl->concat({scope.root(), impl->scopeSep, leaf.root()}));
+}
+
+IRName IRNameStore::templated(const IRName& base, const std::vector<IRName>& args,
+                              std::string_view separator) {
+    std::vector<const IRNameNode*> list{impl->open};
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        if (i) list.push_back(impl->atom(separator));
+        list.push_back(args[i].root());
+    }
+    list.push_back(impl->close);
+    const IRNameNode* argNode = impl->concat(list.data(), list.size());
+    return IRName(impl->concat({base.root(), argNode}));
+}
+
+IRName IRNameStore::parse(std::string_view text) {
+    if (text.empty()) return IRName();
+    std::uint64_t h = 0, power = 1;
+    Impl::hashText(text, h, power);
+    if (const IRNameNode* seen = impl->findText(text, h)) return IRName(seen);
+
+    Parser<Impl> p{*impl, text, 0, true, {}};
+    p.stack.reserve(64);
+    const IRNameNode* n = p.expr(0);
+    if (!p.ok || p.pos != text.size() || !n) n = impl->atom(text);
+    return IRName(n);
+}
+
+std::size_t IRNameStore::nodeCount() const {
+    std::size_t n = 0;
+    for (const Impl::Shard& sh : impl->shards) {
+        std::lock_guard<std::mutex> lock(sh.mu);
+        n += sh.used;
+    }
+    return n;
+}
+
+std::size_t IRNameStore::memoryBytes() const {
+    std::size_t n = 0;
+    for (const Impl::Shard& sh : impl->shards) {
+        std::lock_guard<std::mutex> lock(sh.mu);
+        n += sh.arena.bytes() + sh.table.capacity() * sizeof(const IRNameNode*);
+    }
+    return n;
+}
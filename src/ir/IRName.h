@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// IRName:
+// Qualified / template type names as a DAG of interned fragments instead of
+// flat strings. "std::map<std::basic_string<char>, int>" is stored as
+//
+//   Concat[ "std", "::", Concat[ "map", "<", <basic_string...>, ", ", "int", ">" ] ]
+//
+// where every fragment and sub-tree is interned once per store, so the
+// std::basic_string<char> node is shared by every name that mentions it.
+//
+// Each node caches the length and a polynomial hash of its flattened text,
+// composed from its children, so hashing never touches characters and the
+// hash of a parsed name equals the hash of the same text however it was
+// split. Comparison walks fragments and skips sub-trees both sides share.
+// Text is only materialized by str()/appendTo(), i.e. when a writer emits
+// the bytes of LF_* names or DW_AT_name.
+
+struct IRNameNode {
+    enum Kind : std::uint8_t { Atom, Concat };
+
+    Kind          kind   = Atom;
+    std::uint32_t count  = 0;       // Concat: number of children
+    std::uint64_t length = 0;       // flattened length
+    std::uint64_t hash   = 0;       // polynomial hash of the flattened text
+    std::uint64_t power  = 1;       // kHashBase^length, for composing hashes
+    const char*               text = nullptr;     // Atom
+    const IRNameNode* const*  children = nullptr; // Concat
+};
+
+class IRNameStore;
+
+class IRName {
+public:
+    IRName() = default;
+    // Parse + intern into IRNameStore::shared().
+    IRName(const char* s);
+    IRName(const std::string& s);
+    IRName(std::string_view s);
+    explicit IRName(const IRNameNode* n) : node(n) {}
+
+    bool          empty() const { return !node || node->length == 0; }
+    std::size_t   size()  const { return node ? static_cast<std::size_t>(node->length) : 0; }
+    std::uint64_t hash()  const;
+    const IRNameNode* root() const { return node; }
+
+    std::string str() const;
+    void appendTo(std::string& out) const;
+
+    // Calls f(std::string_view) for each fragment, in order.
+    template <typename F>
+    void forEachFragment(F&& f) const;
+
+    // Lexicographic order of the flattened text.
+    static int compare(const IRName& a, const IRName& b);
+    static int compare(const IRName& a, std::string_view b);
+    static int compare(const IRName& a, const char* b) { return compare(a, std::string_view(b)); }
+    static int compare(const IRName& a, const std::string& b) { return compare(a, std::string_view(b)); }
+
+    friend bool operator==(const IRName& a, const IRName& b) {
+        if (a.node == b.node) return true;
+        if (a.size() != b.size() || a.hash() != b.hash()) return false;
+        return compare(a, b) == 0;
+    }
+    friend bool operator!=(const IRName& a, const IRName& b) { return !(a == b); }
+    friend bool operator<(const IRName& a, const IRName& b) { return compare(a, b) < 0; }
+
+    friend bool operator==(const IRName& a, std::string_view b) { return a.size() == b.size() && compare(a, b) == 0; }
+    friend bool operator==(const IRName& a, const char* b) { return a == std::string_view(b); }
+    friend bool operator==(const IRName& a, const std::string& b) { return a == std::string_view(b); }
+    friend bool operator!=(const IRName& a, std::string_view b) { return !(a == b); }
+    friend bool operator!=(const IRName& a, const char* b) { return !(a == b); }
+    friend bool operator!=(const IRName& a, const std::string& b) { return !(a == b); }
+
+private:
+    const IRNameNode* node = nullptr;
+};
+
+struct IRNameHash {
+    std::size_t operator()(const IRName& n) const { return static_cast<std::size_t>(n.hash()); }
+};
+
+// Owns interned nodes; nodes never move or die before the store does.
+// Thread-safe: the table is sharded by hash and only one shard is locked at
+// a time, never while parsing. The returned nodes are immutable.
+class IRNameStore {
+public:
+    IRNameStore();
+    ~IRNameStore();
+    IRNameStore(const IRNameStore&) = delete;
+    IRNameStore& operator=(const IRNameStore&) = delete;
+
+    // Process-wide store used by IRName's string constructors.
+    static IRNameStore& shared();
+
+    IRName atom(std::string_view text);
+    IRName concat(const IRName* parts, std::size_t count);
+
+    // Builders for the two shapes readers see most.
+    IRName qualified(const IRName& scope, const IRName& leaf);                  // scope::leaf
+    IRName templated(const IRName& base, const std::vector<IRName>& args,
+                     std::string_view separator = ", ");                        // base<a, b>
+
+    // Splits a flat name at "::", template brackets and argument separators
+    // so that repeated sub-names are shared. Text that does not parse
+    // cleanly (operator names, lambdas, ...) or nests templates too deeply
+    // is kept as one atom; the flattened result is always byte-identical
+    // to the input.
+    IRName parse(std::string_view text);
+
+    std::size_t nodeCount() const;
+    std::size_t memoryBytes() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// ---- implementation of the template member ----
+
+template <typename F>
+void IRName::forEachFragment(F&& f) const {
+    if (!node) return;
+    std::vector<const IRNameNode*> stack{node};
+    while (!stack.empty()) {
+        const IRNameNode* n = stack.back();
+        stack.pop_back();
+        if (n->kind == IRNameNode::Atom) {
+            if (n->length) f(std::string_view(n->text, static_cast<std::size_t>(n->length)));
+            continue;
+        }
+        for (std::uint32_t i = n->count; i-- > 0;) stack.push_back(n->children[i]);
+    }
+}
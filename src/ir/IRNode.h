@@ -4,6 +4,10 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include "IRLocation.h"
+#include "IRLineTable.h"
+#include "IRInlinee.h"
+#include "IRName.h"
 
 struct IRType;
 struct IRStructType;
@@ -37,7 +41,7 @@ struct IRArrayDim {
 struct IRType {
     IRTypeID     id = 0;
     IRTypeKind   kind = IRTypeKind::Unknown;
-    std::string  name;          // "Node", "anonymous$1", "int*", "int[10]"
+    IRName       name;          // "Node", "anonymous$1", "int*", "int[10]"; interned fragments
     bool         isForwardDecl = false;
     bool         isUnion = false; // For StructOrUnion
     std::uint64_t sizeBytes = 0;  // total sizeof(T)
@@ -66,7 +70,10 @@ struct IRSymbol {
     std::string   name;
     IRSymbolKind  kind = IRSymbolKind::Variable;
     IRTypeID      type = 0;
-    // TODO: storage info, live ranges
+
+    // Location / live ranges, resolved through the owning CU's locations
+    // pool; ranges are relative to the enclosing function's lowPC.
+    IRSymbolStorage storage;
 };
 
 // Lexical scopes: CU, namespace, function, block, etc.
@@ -75,7 +82,8 @@ enum class IRScopeKind {
     Namespace,
     Function,
     Block,
-    FileStatic
+    FileStatic,
+    Inlined      // DW_TAG_inlined_subroutine / S_INLINESITE
 };
 
 struct IRScope {
@@ -85,6 +93,36 @@ struct IRScope {
     IRScope* parent = nullptr;
     std::vector<std::unique_ptr<IRScope>> children;
 
+    // Code range for Function/Block/Inlined scopes (0,0 when not applicable).
+    std::uint64_t lowPC  = 0;
+    std::uint64_t highPC = 0;
+
+    // Discontiguous scopes (DW_AT_ranges): ranges in the CU's locations
+    // pool, relative to the enclosing function's lowPC; 'loc' is unused.
+    IRSymbolStorage codeRanges;
+
+    // Inlined only: what was inlined and where it was called from. The
+    // name lives in the CU's inlinee table, so 'name' stays empty.
+    IRInlineeID   inlinee    = 0;
+    std::uint32_t callFile   = 0; // index into the CU's IRLineTable::files
+    std::uint32_t callLine   = 0;
+    std::uint16_t callColumn = 0;
+
+    // CompileUnit only: which input of a merge the unit came from (0 when
+    // there is one input). Addresses below the unit are relative to that
+    // input's image.
+    std::uint16_t image = 0;
+
+    // CompileUnit only: interned location expressions and live ranges for
+    // every symbol below this CU. Dropped together with the CU.
+    std::unique_ptr<IRLocationPool> locations;
+
+    // CompileUnit only: the unit's line table (.debug_line / C13 lines).
+    std::unique_ptr<IRLineTable> lines;
+
+    // CompileUnit only: inlined origins referenced by Inlined scopes.
+    std::unique_ptr<IRInlineeTable> inlinees;
+
     std::vector<IRTypeID> declaredTypes;  // types primarily "introduced" here
     std::vector<IRSymbol> declaredSymbols;
 };
@@ -0,0 +1,219 @@
+#include "IRTypeMerge.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include "IRCanonicalOrder.h"
+#include "../util/ParallelFor.h"
+
+namespace {
+
+constexpr std::size_t kChunk = 4096;
+
+template <typename F>
+void ForEachChunk(std::size_t n, unsigned jobs, F&& body) {
+    ParallelFor((n + kChunk - 1) / kChunk, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(n, (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) body(i);
+    });
+}
+
+// Everything LocalTypeHash covers, compared exactly.
+bool SameLocal(const IRType& a, const IRType& b) {
+    if (a.kind != b.kind || a.isForwardDecl != b.isForwardDecl || a.isUnion != b.isUnion ||
+        a.sizeBytes != b.sizeBytes || a.ptrSizeBytes != b.ptrSizeBytes || !(a.name == b.name) ||
+        a.dims.size() != b.dims.size() || a.fields.size() != b.fields.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.dims.size(); ++i) {
+        if (a.dims[i].lowerBound != b.dims[i].lowerBound || a.dims[i].count != b.dims[i].count) return false;
+    }
+    for (std::size_t i = 0; i < a.fields.size(); ++i) {
+        const IRField& x = a.fields[i];
+        const IRField& y = b.fields[i];
+        if (x.name != y.name || x.byteOffset != y.byteOffset || x.bitOffset != y.bitOffset ||
+            x.bitSize != y.bitSize || x.isAnonymousArm != y.isAnonymousArm) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t CountDistinct(const std::vector<std::size_t>& present,
+                          const std::vector<std::uint64_t>& hash, unsigned jobs) {
+    std::vector<std::uint64_t> values(present.size());
+    ForEachChunk(present.size(), jobs, [&](std::size_t k) { values[k] = hash[present[k]]; });
+    ParallelSort(values.begin(), values.end(), jobs, [](std::uint64_t a, std::uint64_t b) { return a < b; });
+    return static_cast<std::size_t>(std::unique(values.begin(), values.end()) - values.begin());
+}
+
+} // namespace
+
+IRTypeMerge MergeTypeTables(const std::vector<IRTypeTable*>& inputs,
+                            IRTypeTable& merged, unsigned jobs) {
+    IRTypeMerge result;
+    const std::size_t n = inputs.size();
+
+    // Every input's types side by side: input i owns [base[i], base[i+1]).
+    std::vector<std::vector<IRType*>> views(n);
+    ParallelFor(n, jobs, [&](std::size_t i) { views[i] = inputs[i]->denseView(); });
+    std::vector<std::size_t> base(n + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) base[i + 1] = base[i] + views[i].size();
+    const std::size_t total = base[n];
+    std::vector<const IRType*> all(total, nullptr);
+    std::vector<std::uint32_t> owner(total, 0);
+    ParallelFor(n, jobs, [&](std::size_t i) {
+        std::copy(views[i].begin(), views[i].end(), all.begin() + base[i]);
+        std::fill(owner.begin() + base[i], owner.begin() + base[i + 1], static_cast<std::uint32_t>(i));
+    });
+    std::vector<std::size_t> present;
+    for (std::size_t g = 0; g < total; ++g) {
+        if (all[g]) present.push_back(g);
+    }
+    result.typesIn = present.size();
+
+    // 1) Refine until no class splits any more. Each round folds the
+    //    previous hash in, so rounds only ever split classes.
+    std::vector<std::uint64_t> hash(total, 0), next(total, 0);
+    ForEachChunk(present.size(), jobs, [&](std::size_t k) { hash[present[k]] = LocalTypeHash(*all[present[k]]); });
+    std::size_t classes = CountDistinct(present, hash, jobs);
+    for (;;) {
+        ++result.rounds;
+        ForEachChunk(present.size(), jobs, [&](std::size_t k) {
+            std::size_t g = present[k];
+            const IRType& t = *all[g];
+            const std::size_t in = owner[g];
+            auto ref = [&](IRTypeID id) { return id && id < views[in].size() ? hash[base[in] + id] : 0; };
+            std::uint64_t h = hash[g];
+            for (const IRField& f : t.fields) h = MixTypeHash(h, ref(f.type));
+            h = MixTypeHash(h, ref(t.elementType));
+            h = MixTypeHash(h, ref(t.indexType));
+            next[g] = MixTypeHash(h, ref(t.pointeeType));
+        });
+        hash.swap(next);
+        std::size_t refined = CountDistinct(present, hash, jobs);
+        if (refined == classes) break;
+        classes = refined;
+    }
+
+    // 2) Group equal hashes; within a group the first type that matches
+    //    locally is the representative. Equal hashes can still be a
+    //    collision somewhere down the graph, so groups are then split
+    //    wherever a member's references land in other groups than its
+    //    head's, until no group splits. Heads are always the lowest index
+    //    of their group.
+    std::vector<std::size_t> order = present;
+    ParallelSort(order.begin(), order.end(), jobs, [&](std::size_t a, std::size_t b) {
+        return hash[a] != hash[b] ? hash[a] < hash[b] : a < b;
+    });
+    std::vector<std::size_t> rep(total, 0);
+    auto split = [&](auto&& sameGroup, auto&& alike, std::vector<std::size_t>& out) {
+        std::vector<std::size_t> runs;
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            if (k == 0 || !sameGroup(order[k], order[k - 1])) runs.push_back(k);
+        }
+        runs.push_back(order.size());
+        std::vector<char> splits(runs.size() - 1, 0);
+        ParallelFor(runs.size() - 1, jobs, [&](std::size_t r) {
+            std::vector<std::size_t> heads;
+            for (std::size_t k = runs[r]; k < runs[r + 1]; ++k) {
+                std::size_t g = order[k];
+                auto head = std::find_if(heads.begin(), heads.end(),
+                                         [&](std::size_t h) { return alike(h, g); });
+                if (head == heads.end()) {
+                    heads.push_back(g);
+                    out[g] = g;
+                } else {
+                    out[g] = *head;
+                }
+            }
+            splits[r] = heads.size() > 1;
+        });
+        return std::find(splits.begin(), splits.end(), 1) != splits.end();
+    };
+    split([&](std::size_t a, std::size_t b) { return hash[a] == hash[b]; },
+          [&](std::size_t a, std::size_t b) { return SameLocal(*all[a], *all[b]); }, rep);
+
+    // Group of the type input 'in' calls 'id'; unknown IDs share one.
+    auto refGroup = [&](std::size_t in, IRTypeID id) {
+        std::size_t g = base[in] + id;
+        return id && id < views[in].size() && all[g] ? rep[g] : total;
+    };
+    auto sameRefs = [&](std::size_t a, std::size_t b) {
+        const IRType& x = *all[a];
+        const IRType& y = *all[b];
+        const std::size_t ia = owner[a], ib = owner[b];
+        for (std::size_t i = 0; i < x.fields.size(); ++i) {
+            if (refGroup(ia, x.fields[i].type) != refGroup(ib, y.fields[i].type)) return false;
+        }
+        return refGroup(ia, x.elementType) == refGroup(ib, y.elementType) &&
+               refGroup(ia, x.indexType) == refGroup(ib, y.indexType) &&
+               refGroup(ia, x.pointeeType) == refGroup(ib, y.pointeeType);
+    };
+    std::vector<std::size_t> nextRep(total, 0);
+    for (;;) {
+        ParallelSort(order.begin(), order.end(), jobs, [&](std::size_t a, std::size_t b) {
+            return rep[a] != rep[b] ? rep[a] < rep[b] : a < b;
+        });
+        bool splitAny = split([&](std::size_t a, std::size_t b) { return rep[a] == rep[b]; },
+                              sameRefs, nextRep);
+        if (!splitAny) break;
+        rep.swap(nextRep);
+    }
+
+    // 3) Representatives become merged types in input order; then the
+    //    per-input remaps and the copies are filled in parallel.
+    std::vector<std::size_t> heads;
+    std::vector<IRType*> created;
+    std::vector<IRTypeID> mergedID(total, 0);
+    for (std::size_t g : present) {
+        if (rep[g] != g) continue;
+        IRType* t = merged.createType(all[g]->kind);
+        mergedID[g] = t->id;
+        heads.push_back(g);
+        created.push_back(t);
+    }
+    result.typesOut = heads.size();
+
+    result.remap.resize(n);
+    ParallelFor(n, jobs, [&](std::size_t i) {
+        std::vector<IRTypeID>& m = result.remap[i];
+        m.assign(views[i].size(), 0);
+        for (std::size_t id = 1; id < m.size(); ++id) {
+            if (all[base[i] + id]) m[id] = mergedID[rep[base[i] + id]];
+        }
+    });
+
+    ForEachChunk(heads.size(), jobs, [&](std::size_t k) {
+        const std::vector<IRTypeID>& m = result.remap[owner[heads[k]]];
+        auto map = [&](IRTypeID& id) {
+            if (id) id = id < m.size() ? m[id] : 0;
+        };
+        IRType* t = created[k];
+        merged.copyType(t, *all[heads[k]]);
+        for (IRField& f : t->fields) map(f.type);
+        map(t->elementType);
+        map(t->indexType);
+        map(t->pointeeType);
+    });
+    return result;
+}
+
+void RemapScopeTypes(IRScope& scope, const std::vector<IRTypeID>& remap) {
+    auto map = [&](IRTypeID& id) {
+        if (id) id = id < remap.size() ? remap[id] : 0;
+    };
+    for (IRTypeID& id : scope.declaredTypes) map(id);
+    std::sort(scope.declaredTypes.begin(), scope.declaredTypes.end());
+    scope.declaredTypes.erase(std::unique(scope.declaredTypes.begin(), scope.declaredTypes.end()),
+                              scope.declaredTypes.end());
+    if (!scope.declaredTypes.empty() && scope.declaredTypes.front() == 0) {
+        scope.declaredTypes.erase(scope.declaredTypes.begin());
+    }
+    for (IRSymbol& sym : scope.declaredSymbols) map(sym.type);
+    if (scope.inlinees) {
+        for (std::size_t i = 1; i <= scope.inlinees->size(); ++i) {
+            map(scope.inlinees->get(static_cast<IRInlineeID>(i)).type);
+        }
+    }
+    for (auto& child : scope.children) RemapScopeTypes(*child, remap);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "IRNode.h"
+#include "IRTypeTable.h"
+
+// Type merging (merge mode):
+// Each input (object file or PDB) is read into its own IRTypeTable, so
+// headers shared between DLLs show up once per input. MergeTypeTables
+// folds all of them into one table with every structurally identical type
+// stored once:
+//
+//   1. a structural hash per type of every input (LocalTypeHash), refined
+//      in parallel with the hashes of the types it references until the
+//      number of distinct hashes stops growing. Equal final hashes mean
+//      the two type graphs are the same as far as they go, cycles
+//      included;
+//   2. types are sorted by (hash, input, ID) with a parallel sort; every
+//      run of equal hashes is one candidate group, checked with a local
+//      comparison and then split wherever a member references types in
+//      other groups than the first member does, until nothing splits. A
+//      64-bit collision therefore cannot merge unlike types;
+//   3. the first member of each group becomes a type of the merged table
+//      (in input order, so the result does not depend on the job count)
+//      and its references are rewritten to merged IDs in parallel.
+//
+// Work is linear in the total number of types and references per round
+// plus the sort; the number of rounds is the nesting depth that tells
+// types apart, usually a handful, and is not capped. Without a collision
+// the split check in step 2 finds nothing after one pass.
+struct IRTypeMerge {
+    // remap[input][id] = merged ID (0 for IDs the input never used).
+    std::vector<std::vector<IRTypeID>> remap;
+    std::size_t typesIn  = 0;
+    std::size_t typesOut = 0;
+    unsigned    rounds   = 0;
+};
+
+// Adds the merged types to 'merged'. Inputs are only read; nothing may
+// create types in any of the tables while this runs.
+IRTypeMerge MergeTypeTables(const std::vector<IRTypeTable*>& inputs,
+                            IRTypeTable& merged, unsigned jobs = 0);
+
+// Rewrites declared types, symbol and inlinee types below 'scope' through
+// 'remap'; declaredTypes lists drop the duplicates a merge can create.
+void RemapScopeTypes(IRScope& scope, const std::vector<IRTypeID>& remap);
@@ -1,23 +1,125 @@
 #include "IRTypeTable.h"
+#include "../util/ParallelFor.h"
+
+namespace {
+
+// Heap bytes of a type's own vectors and out-of-line field names.
+std::size_t HeldBytes(const IRType& t) {
+    std::size_t n = t.fields.capacity() * sizeof(IRField) + t.dims.capacity() * sizeof(IRArrayDim);
+    for (const IRField& f : t.fields) {
+        if (f.name.capacity() > 15) n += f.name.capacity() + 1;
+    }
+    return n;
+}
+
+} // namespace
 
 IRType* IRTypeTable::createType(IRTypeKind k) {
+    std::lock_guard<std::mutex> lock(mu);
     IRTypeID id = nextID++;
     auto t = std::make_unique<IRType>();
     t->id = id;
     t->kind = k;
     IRType* raw = t.get();
     types[id] = std::move(t);
+    // Node + bucket per map entry, as libstdc++ lays them out.
+    bytes += sizeof(IRType) + 4 * sizeof(void*);
     return raw;
 }
 
+void IRTypeTable::addField(IRType* t, IRField f) {
+    std::size_t before = t->fields.capacity() * sizeof(IRField);
+    t->fields.push_back(std::move(f));
+    std::size_t name = t->fields.back().name.capacity();
+    bytes += t->fields.capacity() * sizeof(IRField) - before + (name > 15 ? name + 1 : 0);
+}
+
+void IRTypeTable::addDim(IRType* t, IRArrayDim d) {
+    std::size_t before = t->dims.capacity();
+    t->dims.push_back(d);
+    bytes += (t->dims.capacity() - before) * sizeof(IRArrayDim);
+}
+
+void IRTypeTable::copyType(IRType* t, const IRType& from) {
+    std::size_t before = HeldBytes(*t);
+    IRTypeID id = t->id;
+    *t = from;
+    t->id = id;
+    bytes += HeldBytes(*t) - before;
+}
+
 IRType* IRTypeTable::lookup(IRTypeID id) {
+    std::lock_guard<std::mutex> lock(mu);
     auto it = types.find(id);
     if (it == types.end()) return nullptr;
     return it->second.get();
 }
 
 const IRType* IRTypeTable::lookup(IRTypeID id) const {
+    std::lock_guard<std::mutex> lock(mu);
     auto it = types.find(id);
     if (it == types.end()) return nullptr;
     return it->second.get();
 }
+
+std::vector<IRType*> IRTypeTable::denseView() {
+    std::lock_guard<std::mutex> lock(mu);
+    std::vector<IRType*> view(nextID, nullptr);
+    for (auto& kv : types) view[kv.first] = kv.second.get();
+    return view;
+}
+
+void IRTypeTable::renumber(const std::vector<IRTypeID>& remap, unsigned jobs) {
+    std::lock_guard<std::mutex> lock(mu);
+    std::vector<std::unique_ptr<IRType>> all;
+    all.reserve(types.size());
+    for (auto& kv : types) all.push_back(std::move(kv.second));
+    types.clear();
+
+    auto map = [&](IRTypeID& id) {
+        if (id && id < remap.size()) id = remap[id];
+    };
+    constexpr std::size_t kChunk = 4096;
+    ParallelFor((all.size() + kChunk - 1) / kChunk, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(all.size(), (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) {
+            IRType& t = *all[i];
+            map(t.id);
+            for (IRField& f : t.fields) map(f.type);
+            map(t.elementType);
+            map(t.indexType);
+            map(t.pointeeType);
+        }
+    });
+
+    types.reserve(all.size());
+    for (auto& t : all) types[t->id] = std::move(t);
+    nextID = static_cast<IRTypeID>(types.size()) + 1;
+}
+
+void IRTypeTable::collectReachable(const std::vector<IRTypeID>& roots,
+                                   std::unordered_set<IRTypeID>& reached,
+                                   const std::function<bool(const IRType&)>& follow) const {
+    std::lock_guard<std::mutex> lock(mu);
+    std::vector<IRTypeID> work(roots.begin(), roots.end());
+    while (!work.empty()) {
+        IRTypeID id = work.back();
+        work.pop_back();
+        if (!id || reached.count(id)) continue;
+        auto it = types.find(id);
+        if (it == types.end()) continue;
+        const IRType& t = *it->second;
+        if (follow && !follow(t)) continue;
+        reached.insert(id);
+
+        for (const IRField& f : t.fields) work.push_back(f.type);
+        work.push_back(t.elementType);
+        work.push_back(t.indexType);
+        work.push_back(t.pointeeType);
+    }
+}
+
+std::size_t IRTypeTable::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mu);
+    return types.bucket_count() * sizeof(void*) + bytes.load();
+}
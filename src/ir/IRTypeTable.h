@@ -1,19 +1,57 @@
 #pragma once
 #include "IRNode.h"
+#include <atomic>
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <memory>
+#include <mutex>
 
+// Thread-safe for one writer (the reader stage) running concurrently with
+// readers (the translator stage). IRType objects never move once created,
+// so returned pointers stay valid for the lifetime of the table.
 class IRTypeTable {
 public:
     IRTypeTable() = default;
 
     IRType* createType(IRTypeKind k);
 
+    // Fill a type through these (rather than its vectors directly) so that
+    // memoryBytes() sees what it holds. Safe to call for different types
+    // from several threads.
+    void addField(IRType* t, IRField f);
+    void addDim(IRType* t, IRArrayDim d);
+    // Copies everything but the ID of 'from' into 't'.
+    void copyType(IRType* t, const IRType& from);
+
     IRType* lookup(IRTypeID id);
     const IRType* lookup(IRTypeID id) const;
 
-    // TODO: implement structural interning / dedup later.
+    // Adds to 'reached' every type reachable from 'roots' through field,
+    // element, index and pointee references. 'follow' (optional) stops the
+    // walk at a type; stopped types are not added. Unknown IDs are ignored.
+    void collectReachable(const std::vector<IRTypeID>& roots,
+                          std::unordered_set<IRTypeID>& reached,
+                          const std::function<bool(const IRType&)>& follow = nullptr) const;
+
+    // Every type indexed by its ID (index 0 and unused IDs are null). For
+    // whole-table passes; callers must not create types while using it.
+    std::vector<IRType*> denseView();
+
+    // Gives every type the ID remap[id] and rewrites the references between
+    // types. 'remap' must map the current IDs one-to-one onto 1..N; IDs held
+    // outside the table (scopes, IRMaps) are the caller's to rewrite.
+    void renumber(const std::vector<IRTypeID>& remap, unsigned jobs = 0);
+
+    // Approximate heap footprint of the table and its types: a running
+    // count kept by createType and the fill calls above, so it is cheap.
+    std::size_t memoryBytes() const;
+
+    // Structural dedup across tables: see IRTypeMerge.h.
 private:
+    mutable std::mutex mu;
     IRTypeID nextID = 1;
     std::unordered_map<IRTypeID, std::unique_ptr<IRType>> types;
+    std::atomic<std::size_t> bytes{0}; // types and what they hold; buckets are added on read
 };
@@ -1,31 +1,213 @@
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <regex>
 #include <string>
+#include <vector>
 
-#include "dwarf/DwarfReader.h"
-#include "dwarf/DwarfWriter.h"
-#include "pdb/PdbReader.h"
-#include "pdb/PdbWriter.h"
-#include "pipeline/DwarfToPdb.h"
-#include "pipeline/PdbToDwarf.h"
+#include "pipeline/StreamingPipeline.h"
+#include "pipeline/OutputVerify.h"
 #include "ir/IRTypeTable.h"
 #include "ir/IRMaps.h"
 
 // global variable 'a'
 int a = 0;
 
+// --include-cu / --exclude-cu, --include-ns / --exclude-ns,
+// --include-symbol / --exclude-symbol, --include-type / --exclude-type
+static bool ParseFilterOption(const std::string& opt, const std::string& value, IRFilter& f) {
+    struct { const char* suffix; NameRule* rule; } rules[] = {
+        {"cu", &f.units}, {"ns", &f.namespaces}, {"symbol", &f.symbols}, {"type", &f.types},
+    };
+    for (const auto& r : rules) {
+        if (opt == std::string("--include-") + r.suffix) { r.rule->addInclude(value); return true; }
+        if (opt == std::string("--exclude-") + r.suffix) { r.rule->addExclude(value); return true; }
+    }
+    return false;
+}
+
+// Plain decimal digits; false when empty or too large for 64 bits.
+static bool ParseDigits(const std::string& digits, unsigned long long& value) {
+    if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos) return false;
+    errno = 0;
+    value = std::strtoull(digits.c_str(), nullptr, 10);
+    return errno != ERANGE;
+}
+
+static bool ParseJobs(const std::string& value, unsigned& jobs) {
+    unsigned long long parsed = 0;
+    if (!ParseDigits(value, parsed) || parsed > std::numeric_limits<unsigned>::max()) return false;
+    jobs = static_cast<unsigned>(parsed);
+    return true;
+}
+
+// <digits>[K|M|G], binary multiples.
+static bool ParseSize(const std::string& value, std::size_t& bytes) {
+    std::size_t digits = value.find_first_not_of("0123456789");
+    if (value.empty() || digits == 0) return false;
+    unsigned shift = 0;
+    if (digits != std::string::npos) {
+        if (digits + 1 != value.size()) return false;
+        switch (value[digits] | 0x20) {
+        case 'k': shift = 10; break;
+        case 'm': shift = 20; break;
+        case 'g': shift = 30; break;
+        default: return false;
+        }
+    }
+    unsigned long long parsed = 0;
+    if (!ParseDigits(value.substr(0, digits), parsed) ||
+        parsed > (std::numeric_limits<std::size_t>::max() >> shift)) {
+        return false;
+    }
+    bytes = static_cast<std::size_t>(parsed) << shift;
+    return true;
+}
+
+// A format this build can write; 'none' always parses.
+static bool ParseCompression(const std::string& value, DwarfCompression& kind) {
+    return ParseDwarfCompression(value, kind) && DwarfCompressionAvailable(kind);
+}
+
+static bool ParseLevel(const std::string& value, int& level) {
+    unsigned parsed = 0;
+    if (!ParseJobs(value, parsed) || parsed > 22) return false;
+    level = static_cast<int>(parsed);
+    return true;
+}
+
+static void PrintSpillStats(const StreamingPipeline& pipeline) {
+    const SpillStats& s = pipeline.spillStats();
+    std::cout << "[memory] peak budgeted " << s.peakResident << " bytes; spilled "
+              << s.unitsSpilled << " units, " << s.modelsSpilled << " translated units ("
+              << s.bytesSpilled << " bytes)\n";
+}
+
+static void PrintMergeStats(const StreamingPipeline& pipeline) {
+    const MergeStats& m = pipeline.mergeStats();
+    std::cout << "[merge] " << m.inputs << " inputs, " << m.units << " units; " << m.typesIn
+              << " types -> " << m.typesOut << " after dedupe (" << m.rounds << " hash rounds)\n";
+}
+
 // Very simple CLI:
 //
 //   mode:
-//     --dwarf-to-pdb <in.dwarf.obj> <out.pdb>
-//     --pdb-to-dwarf <in.pdb>       <out.dwarf.obj>
+//     --dwarf-to-pdb <in.dwarf.obj> <out.pdb>       [--verify] [--jobs N] [--max-memory S] [filters]
+//     --pdb-to-dwarf <in.pdb>       <out.dwarf.obj> [--verify] [--jobs N] [--max-memory S]
+//                                                   [--compress-debug-sections F] [--compress-level N] [filters]
+//     --merge-to-pdb   <out.pdb>       <in.dwarf.obj>... [options as above]
+//     --merge-to-dwarf <out.dwarf.obj> <in.pdb>...       [options as above]
+//
+//   merge modes: types shared between the inputs are stored once, and the
+//   units of all inputs land in the one output, in input order. In a PDB
+//   each input's symbols get a section of their own (the first input's in
+//   section 1, the next in 2, ...) since their addresses are relative to
+//   different images. Symbols repeated by the units of one input are
+//   written once; each input keeps its own.
+//
+//   --verify: re-read the output and check its structure (and the writer's
+//   IRMaps entries); problems are listed and the exit code becomes 1.
+//
+//   --jobs N: worker threads for the parallel phases (0 = all cores). The
+//   output does not depend on N.
+//
+//   forward decls: --pdb-to-dwarf and the merge modes point references to
+//   forward-declared structs at their definitions; --dwarf-to-pdb streams
+//   types unit by unit and writes such references as they are.
+//
+//   --max-memory S: budget for resident IR (e.g. 512M, 4G); units beyond it
+//   are spilled to a file in the temp directory and read back when needed.
+//   In the merge modes it only applies once all inputs are read and their
+//   types merged; reading holds every input in memory at once.
+//
+//   --compress-debug-sections none|zlib|zstd: write the .debug_* sections
+//   SHF_COMPRESSED (formats depend on the build). --compress-level N picks
+//   the library level (0 = its default).
+//
+//   filters (repeatable; <pattern> is a glob or "re:<regex>"):
+//     --include-cu <pattern>     --exclude-cu <pattern>
+//     --include-ns <pattern>     --exclude-ns <pattern>
+//     --include-symbol <pattern> --exclude-symbol <pattern>
+//     --include-type <pattern>   --exclude-type <pattern>
 //
 // For now we just exercise the call graph and print TODOs.
 // Return code is 'a' per your request.
 int main(int argc, char** argv) {
+    StreamingOptions opts;
+    bool verify = false;
+    bool badOption = false;
+
+    // Merge modes take inputs up to the first option.
+    std::string mode = argc >= 2 ? argv[1] : "";
+    bool merge = mode == "--merge-to-pdb" || mode == "--merge-to-dwarf";
+    std::vector<std::string> inputs;
+    int firstOption = 4;
+    if (merge) {
+        for (firstOption = 3; firstOption < argc; ++firstOption) {
+            std::string arg = argv[firstOption];
+            if (arg.rfind("--", 0) == 0) break;
+            inputs.push_back(arg);
+        }
+    }
+
+    for (int i = firstOption; i < argc && !badOption; ++i) {
+        if (std::string(argv[i]) == "--verify") {
+            verify = true;
+            continue;
+        }
+        if (std::string(argv[i]) == "--jobs" || std::string(argv[i]) == "--max-memory") {
+            badOption = i + 1 >= argc ||
+                        !(std::string(argv[i]) == "--jobs" ? ParseJobs(argv[i + 1], opts.jobs)
+                                                          : ParseSize(argv[i + 1], opts.maxMemory));
+            if (badOption) std::cerr << "Bad option: " << argv[i] << "\n";
+            ++i;
+            continue;
+        }
+        if (std::string(argv[i]) == "--compress-debug-sections" || std::string(argv[i]) == "--compress-level") {
+            badOption = i + 1 >= argc ||
+                        !(std::string(argv[i]) == "--compress-level" ? ParseLevel(argv[i + 1], opts.compress.level)
+                                                                    : ParseCompression(argv[i + 1], opts.compress.kind));
+            if (badOption) std::cerr << "Bad option: " << argv[i] << "\n";
+            ++i;
+            continue;
+        }
+        try {
+            badOption = i + 1 >= argc || !ParseFilterOption(argv[i], argv[i + 1], opts.filter);
+        } catch (const std::regex_error&) {
+            badOption = true;
+        }
+        if (badOption) std::cerr << "Bad option: " << argv[i] << "\n";
+        ++i;
+    }
+
     if (argc >= 2) {
-        std::string mode = argv[1];
+        if (!badOption && merge && argc >= 4 && !inputs.empty()) {
+            std::string output = argv[2];
+            bool toPdb = mode == "--merge-to-pdb";
+
+            IRTypeTable typeTable;
+            IRMaps      maps;
+
+            StreamingPipeline pipeline(opts);
+            if (toPdb) {
+                pipeline.mergeDwarfToPdb(inputs, output, typeTable, maps);
+            } else {
+                pipeline.mergePdbToDwarf(inputs, output, typeTable, maps);
+            }
+            PrintMergeStats(pipeline);
+            if (opts.maxMemory) PrintSpillStats(pipeline);
 
-        if (mode == "--dwarf-to-pdb" && argc == 4) {
+            if (verify) {
+                VerifyReport report = toPdb ? VerifyPdbOutput(output, &maps, opts.jobs)
+                                            : VerifyDwarfOutput(output, &maps, opts.jobs);
+                PrintVerifyReport(std::cout, output, report);
+                if (!report.ok()) a = 1;
+            }
+
+            std::cout << "[OK] merge stub done\n";
+        }
+        else if (!badOption && mode == "--dwarf-to-pdb" && argc >= 4) {
             std::string dwarfInput  = argv[2];
             std::string pdbOutput   = argv[3];
 
@@ -33,37 +215,47 @@ int main(int argc, char** argv) {
             IRTypeTable typeTable;
             IRMaps      maps;
 
-            DwarfReader dreader;
-            auto irRootScope = dreader.readObject(dwarfInput, typeTable, maps);
+            // Reader, translator and writer overlap at CU granularity.
+            StreamingPipeline pipeline(opts);
+            pipeline.runDwarfToPdb(dwarfInput, pdbOutput, typeTable, maps);
+            if (opts.maxMemory) PrintSpillStats(pipeline);
 
-            DwarfToPdb d2p;
-            PdbWriter  pwriter;
-            auto pdbModel = d2p.translate(irRootScope.get(), typeTable, maps);
-            pwriter.writePdb(pdbOutput, pdbModel.get());
+            if (verify) {
+                VerifyReport report = VerifyPdbOutput(pdbOutput, &maps, opts.jobs);
+                PrintVerifyReport(std::cout, pdbOutput, report);
+                if (!report.ok()) a = 1;
+            }
 
             std::cout << "[OK] DWARF->PDB stub done\n";
         }
-        else if (mode == "--pdb-to-dwarf" && argc == 4) {
+        else if (!badOption && mode == "--pdb-to-dwarf" && argc >= 4) {
             std::string pdbInput     = argv[2];
             std::string dwarfOutput  = argv[3];
 
             IRTypeTable typeTable;
             IRMaps      maps;
 
-            PdbReader preader;
-            auto irRootScope = preader.readPdb(pdbInput, typeTable, maps);
+            StreamingPipeline pipeline(opts);
+            pipeline.runPdbToDwarf(pdbInput, dwarfOutput, typeTable, maps);
+            if (opts.maxMemory) PrintSpillStats(pipeline);
 
-            PdbToDwarf p2d;
-            DwarfWriter dwriter;
-            auto dwarfModel = p2d.translate(irRootScope.get(), typeTable, maps);
-            dwriter.writeObject(dwarfOutput, dwarfModel.get());
+            if (verify) {
+                VerifyReport report = VerifyDwarfOutput(dwarfOutput, &maps, opts.jobs);
+                PrintVerifyReport(std::cout, dwarfOutput, report);
+                if (!report.ok()) a = 1;
+            }
 
             std::cout << "[OK] PDB->DWARF stub done\n";
         }
         else {
             std::cerr << "Usage:\n"
-                      << "  " << argv[0] << " --dwarf-to-pdb <in.obj> <out.pdb>\n"
-                      << "  " << argv[0] << " --pdb-to-dwarf <in.pdb> <out.obj>\n";
+                      << "  " << argv[0] << " --dwarf-to-pdb <in.obj> <out.pdb> [--verify] [--jobs N] [--max-memory S] [filters]\n"
+                      << "  " << argv[0] << " --pdb-to-dwarf <in.pdb> <out.obj> [--verify] [--jobs N] [--max-memory S]"
+                      << " [--compress-debug-sections none|zlib|zstd] [--compress-level N] [filters]\n"
+                      << "  " << argv[0] << " --merge-to-pdb <out.pdb> <in.obj>... [options]\n"
+                      << "  " << argv[0] << " --merge-to-dwarf <out.obj> <in.pdb>... [options]\n"
+                      << "filters: --include-/--exclude- cu|ns|symbol|type <glob | re:regex>\n"
+                      << "merge modes hold every input in memory while reading; --max-memory applies after\n";
         }
     } else {
         std::cerr << "No args. Nothing done.\n";
@@ -0,0 +1,296 @@
+#include "CodeViewInlinees.h"
+#include <algorithm>
+#include "CodeViewSchema.h"
+
+namespace {
+
+struct Interval {
+    std::uint64_t lo;
+    std::uint64_t hi;
+};
+
+void Put32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xff);
+}
+
+void Patch32(std::vector<std::uint8_t>& out, std::size_t at, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out[at + i] = (v >> (8 * i)) & 0xff;
+}
+
+// CodeView "compressed unsigned": 1, 2 or 4 bytes, big-endian payload.
+void PutCompressed(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    if (v <= 0x7F) {
+        out.push_back(static_cast<std::uint8_t>(v));
+    } else if (v <= 0x3FFF) {
+        out.push_back(static_cast<std::uint8_t>((v >> 8) | 0x80));
+        out.push_back(static_cast<std::uint8_t>(v & 0xff));
+    } else {
+        out.push_back(static_cast<std::uint8_t>(((v >> 24) & 0x1F) | 0xC0));
+        out.push_back(static_cast<std::uint8_t>((v >> 16) & 0xff));
+        out.push_back(static_cast<std::uint8_t>((v >> 8) & 0xff));
+        out.push_back(static_cast<std::uint8_t>(v & 0xff));
+    }
+}
+
+bool GetCompressed(const std::uint8_t*& p, const std::uint8_t* end, std::uint32_t& v) {
+    if (p >= end) return false;
+    std::uint8_t b0 = *p++;
+    if ((b0 & 0x80) == 0) {
+        v = b0;
+        return true;
+    }
+    if ((b0 & 0xC0) == 0x80) {
+        if (p >= end) return false;
+        v = (std::uint32_t(b0 & 0x3F) << 8) | *p++;
+        return true;
+    }
+    if ((b0 & 0xE0) == 0xC0) {
+        if (end - p < 3) return false;
+        v = (std::uint32_t(b0 & 0x1F) << 24) | (std::uint32_t(p[0]) << 16) |
+            (std::uint32_t(p[1]) << 8) | p[2];
+        p += 3;
+        return true;
+    }
+    return false;
+}
+
+std::uint32_t EncodeSigned(std::int32_t v) {
+    return v >= 0 ? std::uint32_t(v) << 1 : (std::uint32_t(-v) << 1) | 1;
+}
+
+std::int32_t DecodeSigned(std::uint32_t v) {
+    return (v & 1) ? -static_cast<std::int32_t>(v >> 1) : static_cast<std::int32_t>(v >> 1);
+}
+
+void Op(std::vector<std::uint8_t>& out, BinaryAnnotationOp op, std::uint32_t operand) {
+    out.push_back(static_cast<std::uint8_t>(op));
+    PutCompressed(out, operand);
+}
+
+void ScopeIntervals(const IRScope& s, const IRScope& fn,
+                    const IRLocationPool* pool, std::vector<Interval>& out) {
+    if (s.codeRanges.rangeCount && pool) {
+        auto cursor = pool->ranges(s.codeRanges, fn.lowPC);
+        IRLiveRange r;
+        while (cursor.next(r)) out.push_back(Interval{r.begin, r.end});
+    } else if (s.highPC > s.lowPC) {
+        out.push_back(Interval{s.lowPC, s.highPC});
+    }
+}
+
+void PushRange(std::vector<InlineSiteRange>& out, std::size_t firstOfSite,
+               std::uint32_t offset, std::uint32_t length,
+               std::uint32_t fileId, std::uint32_t line) {
+    if (out.size() > firstOfSite) {
+        InlineSiteRange& prev = out.back();
+        if (prev.codeOffset + prev.length == offset &&
+            prev.fileId == fileId && prev.line == line) {
+            prev.length += length;
+            return;
+        }
+    }
+    out.push_back(InlineSiteRange{offset, length, fileId, line});
+}
+
+} // namespace
+
+void CollectInlineSites(const IRScope& scope, std::vector<const IRScope*>& out) {
+    for (const auto& child : scope.children) {
+        if (child->kind == IRScopeKind::Inlined) {
+            out.push_back(child.get());
+        } else if (child->kind == IRScopeKind::Block) {
+            CollectInlineSites(*child, out);
+        }
+    }
+}
+
+void CollectInlineSiteRanges(const IRScope& site,
+                             const IRScope& function,
+                             const IRLocationPool* pool,
+                             const IRLineTable* lines,
+                             const std::vector<std::uint32_t>& checksumOffsets,
+                             std::uint32_t defaultFileId,
+                             std::uint32_t defaultLine,
+                             std::vector<InlineSiteRange>& out) {
+    std::vector<Interval> own, nested;
+    ScopeIntervals(site, function, pool, own);
+    std::vector<const IRScope*> sites;
+    CollectInlineSites(site, sites);
+    for (const IRScope* child : sites) ScopeIntervals(*child, function, pool, nested);
+    auto byLo = [](const Interval& a, const Interval& b) { return a.lo < b.lo; };
+    std::sort(own.begin(), own.end(), byLo);
+    std::sort(nested.begin(), nested.end(), byLo);
+
+    const std::size_t firstOfSite = out.size();
+    auto emitPiece = [&](std::uint64_t lo, std::uint64_t hi) {
+        std::uint32_t row = 0, seqEnd = 0;
+        if (!lines || !lines->rowAt(lo, row, seqEnd)) {
+            PushRange(out, firstOfSite, static_cast<std::uint32_t>(lo - function.lowPC),
+                      static_cast<std::uint32_t>(hi - lo), defaultFileId, defaultLine);
+            return;
+        }
+        std::uint64_t cur = lo;
+        while (cur < hi) {
+            while (row + 1 < seqEnd && lines->address[row + 1] <= cur) ++row;
+            std::uint64_t next = hi;
+            if (row + 1 < seqEnd && lines->address[row + 1] < hi) {
+                next = lines->address[row + 1];
+            }
+            std::uint32_t f = lines->file[row];
+            PushRange(out, firstOfSite, static_cast<std::uint32_t>(cur - function.lowPC),
+                      static_cast<std::uint32_t>(next - cur),
+                      f < checksumOffsets.size() ? checksumOffsets[f] : defaultFileId,
+                      lines->line[row]);
+            cur = next;
+        }
+    };
+
+    // own minus nested, both sorted
+    std::size_t n = 0;
+    for (const Interval& iv : own) {
+        std::uint64_t lo = iv.lo;
+        while (n < nested.size() && nested[n].hi <= lo) ++n;
+        for (std::size_t k = n; k < nested.size() && nested[k].lo < iv.hi; ++k) {
+            if (nested[k].lo > lo) emitPiece(lo, nested[k].lo);
+            lo = std::max(lo, nested[k].hi);
+        }
+        if (lo < iv.hi) emitPiece(lo, iv.hi);
+    }
+}
+
+void AppendInlineAnnotations(const InlineSiteRange* ranges,
+                             std::size_t count,
+                             std::uint32_t startFileId,
+                             std::uint32_t startLine,
+                             std::vector<std::uint8_t>& out) {
+    std::uint32_t curOffset = 0;
+    std::uint32_t curFile = startFileId;
+    std::uint32_t curLine = startLine;
+    std::uint32_t prevEnd = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const InlineSiteRange& r = ranges[i];
+        if (r.fileId != curFile) {
+            Op(out, BinaryAnnotationOp::ChangeFile, r.fileId);
+            curFile = r.fileId;
+        }
+        // A gap closes the previous range with an explicit length.
+        if (i > 0 && prevEnd != r.codeOffset) {
+            Op(out, BinaryAnnotationOp::ChangeCodeLength, prevEnd - curOffset);
+            curOffset = prevEnd;
+        }
+
+        std::uint32_t codeDelta = r.codeOffset - curOffset;
+        std::uint32_t lineDelta = EncodeSigned(static_cast<std::int32_t>(r.line - curLine));
+        if (codeDelta <= 0xF && lineDelta <= 0xF) {
+            Op(out, BinaryAnnotationOp::ChangeCodeOffsetAndLineOffset,
+               (lineDelta << 4) | codeDelta);
+        } else {
+            if (r.line != curLine) Op(out, BinaryAnnotationOp::ChangeLineOffset, lineDelta);
+            Op(out, BinaryAnnotationOp::ChangeCodeOffset, codeDelta);
+        }
+
+        curOffset = r.codeOffset;
+        curLine = r.line;
+        prevEnd = r.codeOffset + r.length;
+    }
+    if (count) Op(out, BinaryAnnotationOp::ChangeCodeLength, prevEnd - curOffset);
+}
+
+bool DecodeInlineAnnotations(IRBytes annotations,
+                             std::uint32_t startFileId,
+                             std::uint32_t startLine,
+                             std::vector<InlineSiteRange>& out) {
+    const std::uint8_t* p = annotations.data;
+    const std::uint8_t* end = p + annotations.size;
+    std::uint32_t codeOffset = 0;
+    std::uint32_t file = startFileId;
+    std::uint32_t line = startLine;
+    const std::size_t first = out.size();
+    bool lastHasLength = true;
+
+    auto emit = [&] {
+        if (out.size() > first && !lastHasLength) {
+            out.back().length = codeOffset - out.back().codeOffset;
+        }
+        out.push_back(InlineSiteRange{codeOffset, 0, file, line});
+        lastHasLength = false;
+    };
+
+    while (p < end) {
+        auto op = static_cast<BinaryAnnotationOp>(*p++);
+        if (op == BinaryAnnotationOp::Invalid) break; // trailing padding
+        std::uint32_t a = 0, b = 0;
+        if (!GetCompressed(p, end, a)) return false;
+
+        switch (op) {
+        case BinaryAnnotationOp::CodeOffset:
+            codeOffset = a;
+            break;
+        case BinaryAnnotationOp::ChangeCodeOffset:
+            codeOffset += a;
+            emit();
+            break;
+        case BinaryAnnotationOp::ChangeCodeLength:
+            if (out.size() > first) {
+                out.back().length = a;
+                lastHasLength = true;
+            }
+            codeOffset += a;
+            break;
+        case BinaryAnnotationOp::ChangeFile:
+            file = a;
+            break;
+        case BinaryAnnotationOp::ChangeLineOffset:
+            line += DecodeSigned(a);
+            break;
+        case BinaryAnnotationOp::ChangeCodeOffsetAndLineOffset:
+            line += DecodeSigned(a >> 4);
+            codeOffset += a & 0xF;
+            emit();
+            break;
+        case BinaryAnnotationOp::ChangeCodeLengthAndCodeOffset:
+            if (!GetCompressed(p, end, b)) return false;
+            if (out.size() > first) {
+                out.back().length = a;
+                lastHasLength = true;
+            }
+            codeOffset += b;
+            emit();
+            break;
+        default:
+            // Column / range-kind / base changes carry no data we keep.
+            break;
+        }
+    }
+    return true;
+}
+
+void AppendInlineSiteRecord(std::uint32_t inlineeItem,
+                            const std::vector<std::uint8_t>& annotations,
+                            std::vector<std::uint8_t>& out) {
+    // pParent/pEnd are fixed up by the linker; zero padding reads as BA_OP_Invalid
+    cv::SInlineSite::encode({0, 0, inlineeItem, IRBytes{annotations.data(), annotations.size()}}, out);
+}
+
+void AppendFuncIdRecord(std::uint32_t scopeId,
+                        std::uint32_t typeIndex,
+                        const std::string& name,
+                        std::vector<std::uint8_t>& out) {
+    cv::LfFuncId::encode({scopeId, typeIndex, name}, out);
+}
+
+void AppendInlineeLinesSubsection(const std::vector<InlineeSourceLine>& entries,
+                                  std::vector<std::uint8_t>& out) {
+    while (out.size() % 4) out.push_back(0);
+    Put32(out, DEBUG_S_INLINEELINES);
+    std::size_t lenAt = out.size();
+    Put32(out, 0);
+    Put32(out, 0); // CV_INLINEE_SOURCE_LINE_SIGNATURE
+    for (const InlineeSourceLine& e : entries) {
+        Put32(out, e.inlinee);
+        Put32(out, e.fileId);
+        Put32(out, e.line);
+    }
+    Patch32(out, lenAt, static_cast<std::uint32_t>(out.size() - lenAt - 4));
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../ir/IRNode.h"
+
+// CodeViewInlinees:
+// S_INLINESITE records with compressed binary annotations, LF_FUNC_ID IPI
+// records and the DEBUG_S_INLINEELINES subsection.
+//
+// Annotations describe an inline site's code ranges relative to the start
+// of the enclosing S_[GL]PROC32, each tagged with file (checksum offset)
+// and line; the starting file/line are the inlinee's declaration.
+
+constexpr std::uint16_t S_INLINESITE     = 0x114d;
+constexpr std::uint16_t S_INLINESITE_END = 0x114e;
+constexpr std::uint16_t LF_FUNC_ID       = 0x1601;
+constexpr std::uint32_t DEBUG_S_INLINEELINES = 0xF6;
+
+enum class BinaryAnnotationOp : std::uint8_t {
+    Invalid = 0,
+    CodeOffset,
+    ChangeCodeOffsetBase,
+    ChangeCodeOffset,
+    ChangeCodeLength,
+    ChangeFile,
+    ChangeLineOffset,
+    ChangeLineEndDelta,
+    ChangeRangeKind,
+    ChangeColumnStart,
+    ChangeColumnEndDelta,
+    ChangeCodeOffsetAndLineOffset,
+    ChangeCodeLengthAndCodeOffset,
+    ChangeColumnEnd
+};
+
+// One code range of an inline site, function-relative.
+struct InlineSiteRange {
+    std::uint32_t codeOffset = 0;
+    std::uint32_t length     = 0;
+    std::uint32_t fileId     = 0; // DEBUG_S_FILECHKSMS entry offset
+    std::uint32_t line       = 0;
+};
+
+struct InlineeSourceLine {
+    std::uint32_t inlinee = 0; // LF_FUNC_ID item index
+    std::uint32_t fileId  = 0;
+    std::uint32_t line    = 0;
+};
+
+// The inline sites directly below 'scope', looking through lexical blocks:
+// the top-level sites of a function, or the sites nested in an inlined body.
+void CollectInlineSites(const IRScope& scope, std::vector<const IRScope*>& out);
+
+// Code ranges owned by 'site' (its ranges minus nested inline sites), split
+// where the line table changes file/line. Pieces without line rows get
+// the default file/line (normally the inlinee's declaration).
+void CollectInlineSiteRanges(const IRScope& site,
+                             const IRScope& function,
+                             const IRLocationPool* pool,
+                             const IRLineTable* lines,
+                             const std::vector<std::uint32_t>& checksumOffsets,
+                             std::uint32_t defaultFileId,
+                             std::uint32_t defaultLine,
+                             std::vector<InlineSiteRange>& out);
+
+void AppendInlineAnnotations(const InlineSiteRange* ranges,
+                             std::size_t count,
+                             std::uint32_t startFileId,
+                             std::uint32_t startLine,
+                             std::vector<std::uint8_t>& out);
+
+// Appends the ranges described by 'annotations' to 'out'.
+bool DecodeInlineAnnotations(IRBytes annotations,
+                             std::uint32_t startFileId,
+                             std::uint32_t startLine,
+                             std::vector<InlineSiteRange>& out);
+
+// Complete S_INLINESITE record; pParent/pEnd are left 0 for the writer.
+void AppendInlineSiteRecord(std::uint32_t inlineeItem,
+                            const std::vector<std::uint8_t>& annotations,
+                            std::vector<std::uint8_t>& out);
+
+// Complete LF_FUNC_ID record.
+void AppendFuncIdRecord(std::uint32_t scopeId,
+                        std::uint32_t typeIndex,
+                        const std::string& name,
+                        std::vector<std::uint8_t>& out);
+
+void AppendInlineeLinesSubsection(const std::vector<InlineeSourceLine>& entries,
+                                  std::vector<std::uint8_t>& out);
@@ -0,0 +1,199 @@
+#include "CodeViewLines.h"
+#include <cstring>
+
+namespace {
+
+constexpr std::uint16_t CV_LINES_HAVE_COLUMNS = 0x0001;
+constexpr std::uint32_t kHiddenLine = 0xFEEFEE;
+constexpr std::uint8_t  CHKSUM_TYPE_MD5 = 1;
+
+void Put16(std::vector<std::uint8_t>& out, std::uint16_t v) {
+    out.push_back(v & 0xff);
+    out.push_back(v >> 8);
+}
+
+void Put32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xff);
+}
+
+void Patch32(std::vector<std::uint8_t>& out, std::size_t at, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out[at + i] = (v >> (8 * i)) & 0xff;
+}
+
+std::uint16_t Get16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t Get32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+           (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+}
+
+void PadTo4(std::vector<std::uint8_t>& out) {
+    while (out.size() % 4) out.push_back(0);
+}
+
+// Writes the subsection header; returns where the length must be patched.
+std::size_t BeginSubsection(std::vector<std::uint8_t>& out, std::uint32_t kind) {
+    PadTo4(out);
+    Put32(out, kind);
+    Put32(out, 0);
+    return out.size() - 4;
+}
+
+void EndSubsection(std::vector<std::uint8_t>& out, std::size_t lenAt) {
+    Patch32(out, lenAt, static_cast<std::uint32_t>(out.size() - lenAt - 4));
+    PadTo4(out);
+}
+
+} // namespace
+
+std::uint32_t PdbStringTable::add(const std::string& s) {
+    if (s.empty()) return 0;
+    auto it = offsets.find(s);
+    if (it != offsets.end()) return it->second;
+    std::uint32_t off = static_cast<std::uint32_t>(bytes.size());
+    bytes.insert(bytes.end(), s.begin(), s.end());
+    bytes.push_back('\0');
+    offsets.emplace(s, off);
+    return off;
+}
+
+void AppendFileChecksums(const IRLineTable& table,
+                         PdbStringTable& names,
+                         std::vector<std::uint8_t>& out,
+                         std::vector<std::uint32_t>& checksumOffsets) {
+    checksumOffsets.clear();
+    checksumOffsets.reserve(table.files.size());
+
+    std::size_t lenAt = BeginSubsection(out, DEBUG_S_FILECHKSMS);
+    const std::size_t base = out.size();
+    for (const IRLineFile& f : table.files) {
+        checksumOffsets.push_back(static_cast<std::uint32_t>(out.size() - base));
+        Put32(out, names.add(f.path));
+        bool md5 = f.checksumKind == CHKSUM_TYPE_MD5;
+        out.push_back(md5 ? 16 : 0);
+        out.push_back(md5 ? CHKSUM_TYPE_MD5 : 0);
+        if (md5) out.insert(out.end(), f.checksum, f.checksum + 16);
+        PadTo4(out);
+    }
+    EndSubsection(out, lenAt);
+}
+
+bool AppendLinesSubsection(const IRLineTable& table,
+                           std::uint64_t lowPC,
+                           std::uint64_t highPC,
+                           std::uint16_t section,
+                           const std::vector<std::uint32_t>& checksumOffsets,
+                           std::vector<std::uint8_t>& out) {
+    std::uint32_t first = 0, count = 0;
+    if (!table.findRows(lowPC, highPC, first, count)) return false;
+
+    std::size_t lenAt = BeginSubsection(out, DEBUG_S_LINES);
+    Put32(out, 0);        // offCon: relocated against the function symbol
+    Put16(out, section);  // segCon
+    Put16(out, CV_LINES_HAVE_COLUMNS);
+    Put32(out, static_cast<std::uint32_t>(highPC - lowPC));
+
+    // One block per run of rows from the same file.
+    std::uint32_t r = first;
+    const std::uint32_t end = first + count;
+    while (r < end) {
+        std::uint32_t runEnd = r + 1;
+        while (runEnd < end && table.file[runEnd] == table.file[r]) ++runEnd;
+        std::uint32_t n = runEnd - r;
+        std::uint32_t fileIndex = table.file[r];
+
+        Put32(out, fileIndex < checksumOffsets.size() ? checksumOffsets[fileIndex] : 0);
+        Put32(out, n);
+        Put32(out, 12 + n * 8 + n * 4); // cbBlock incl. columns
+        for (std::uint32_t i = r; i < runEnd; ++i) {
+            std::uint32_t line = table.line[i] ? table.line[i] : kHiddenLine;
+            std::uint32_t bits = (line & 0xFFFFFF) |
+                                 ((table.flags[i] & IRLineIsStmt) ? 0x80000000u : 0);
+            Put32(out, static_cast<std::uint32_t>(table.address[i] - lowPC));
+            Put32(out, bits);
+        }
+        for (std::uint32_t i = r; i < runEnd; ++i) {
+            Put16(out, table.column[i]); // offColumnStart
+            Put16(out, 0);               // offColumnEnd: unknown
+        }
+        r = runEnd;
+    }
+    EndSubsection(out, lenAt);
+    return true;
+}
+
+bool DecodeFileChecksums(IRBytes subsectionData,
+                         IRBytes names,
+                         IRLineTable& out,
+                         std::unordered_map<std::uint32_t, std::uint32_t>& checksumOffsetToFile) {
+    const std::uint8_t* p = subsectionData.data;
+    const std::uint8_t* end = p + subsectionData.size;
+    while (p + 6 <= end) {
+        std::uint32_t entryOffset = static_cast<std::uint32_t>(p - subsectionData.data);
+        std::uint32_t nameOff = Get32(p);
+        std::uint8_t cb = p[4];
+        std::uint8_t kind = p[5];
+        if (p + 6 + cb > end) return false;
+
+        IRLineFile f;
+        if (names.data && nameOff < names.size &&
+            std::memchr(names.data + nameOff, 0, names.size - nameOff)) {
+            f.path = reinterpret_cast<const char*>(names.data + nameOff);
+        }
+        if (kind == CHKSUM_TYPE_MD5 && cb == 16) {
+            f.checksumKind = CHKSUM_TYPE_MD5;
+            std::memcpy(f.checksum, p + 6, 16);
+        }
+        checksumOffsetToFile[entryOffset] = static_cast<std::uint32_t>(out.files.size());
+        out.files.push_back(std::move(f));
+
+        std::size_t entrySize = (6 + cb + 3) & ~std::size_t(3);
+        p += entrySize;
+    }
+    return true;
+}
+
+bool DecodeLinesSubsection(IRBytes subsectionData,
+                           const std::unordered_map<std::uint32_t, std::uint32_t>& checksumOffsetToFile,
+                           IRLineTable& out) {
+    const std::uint8_t* p = subsectionData.data;
+    const std::uint8_t* end = p + subsectionData.size;
+    if (p + 12 > end) return false;
+
+    std::uint32_t offCon = Get32(p);
+    std::uint16_t flags  = Get16(p + 6);
+    std::uint32_t cbCon  = Get32(p + 8);
+    bool hasColumns = (flags & CV_LINES_HAVE_COLUMNS) != 0;
+    p += 12;
+
+    std::uint32_t seqStart = static_cast<std::uint32_t>(out.rowCount());
+    while (p + 12 <= end) {
+        std::uint32_t fileId  = Get32(p);
+        std::uint32_t nLines  = Get32(p + 4);
+        std::uint32_t cbBlock = Get32(p + 8);
+        std::size_t need = 12 + std::size_t(nLines) * (hasColumns ? 12 : 8);
+        if (cbBlock < need || p + cbBlock > end) return false;
+
+        auto it = checksumOffsetToFile.find(fileId);
+        std::uint32_t fileIndex = it != checksumOffsetToFile.end() ? it->second : 0;
+
+        const std::uint8_t* lines = p + 12;
+        const std::uint8_t* cols  = lines + std::size_t(nLines) * 8;
+        for (std::uint32_t i = 0; i < nLines; ++i) {
+            std::uint32_t off  = Get32(lines + i * 8);
+            std::uint32_t bits = Get32(lines + i * 8 + 4);
+            std::uint32_t line = bits & 0xFFFFFF;
+            if (line == kHiddenLine) line = 0;
+            std::uint16_t col = hasColumns ? Get16(cols + i * 4) : 0;
+            out.appendRow(std::uint64_t(offCon) + off, fileIndex, line, col,
+                          (bits & 0x80000000u) ? IRLineIsStmt : 0);
+        }
+        p += cbBlock;
+    }
+
+    if (out.rowCount() == seqStart) return true;
+    out.endSequence(seqStart, std::uint64_t(offCon) + cbCon);
+    return true;
+}
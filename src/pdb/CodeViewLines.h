@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../ir/IRLocation.h"
+#include "../ir/IRLineTable.h"
+
+// CodeViewLines:
+// IRLineTable <-> C13 debug subsections of a module stream:
+//   DEBUG_S_FILECHKSMS (one per module) and DEBUG_S_LINES (one per function).
+// Line 0 ("no source line") is written as the 0xFEEFEE hidden-line marker
+// MSVC uses, and mapped back to 0 on decode.
+
+constexpr std::uint32_t DEBUG_S_LINES      = 0xF2;
+constexpr std::uint32_t DEBUG_S_FILECHKSMS = 0xF4;
+
+// The PDB /names stream: NUL-terminated strings, deduplicated, offset 0
+// reserved for the empty string.
+class PdbStringTable {
+public:
+    PdbStringTable() : bytes(1, '\0') {}
+
+    std::uint32_t add(const std::string& s);
+    const std::vector<char>& data() const { return bytes; }
+
+private:
+    std::vector<char> bytes;
+    std::unordered_map<std::string, std::uint32_t> offsets;
+};
+
+// Appends a DEBUG_S_FILECHKSMS subsection for table.files. On return
+// checksumOffsets[i] is the offset of file i's entry, which DEBUG_S_LINES
+// blocks use as their file id.
+void AppendFileChecksums(const IRLineTable& table,
+                         PdbStringTable& names,
+                         std::vector<std::uint8_t>& out,
+                         std::vector<std::uint32_t>& checksumOffsets);
+
+// Appends a DEBUG_S_LINES subsection for the function [lowPC, highPC),
+// with columns. 'section' is the PE section the function lives in and
+// offsets are written relative to lowPC. Returns false if no rows fall in
+// the range (nothing is appended then).
+bool AppendLinesSubsection(const IRLineTable& table,
+                           std::uint64_t lowPC,
+                           std::uint64_t highPC,
+                           std::uint16_t section,
+                           const std::vector<std::uint32_t>& checksumOffsets,
+                           std::vector<std::uint8_t>& out);
+
+// Reverse direction. 'names' is the /names stream content. Files are
+// appended to out.files; checksumOffsetToFile maps the subsection's entry
+// offsets to their new indices for DecodeLinesSubsection.
+bool DecodeFileChecksums(IRBytes subsectionData,
+                         IRBytes names,
+                         IRLineTable& out,
+                         std::unordered_map<std::uint32_t, std::uint32_t>& checksumOffsetToFile);
+
+// Appends one sequence per DEBUG_S_LINES subsection. Addresses are
+// section-relative (offCon + line offset).
+bool DecodeLinesSubsection(IRBytes subsectionData,
+                           const std::unordered_map<std::uint32_t, std::uint32_t>& checksumOffsetToFile,
+                           IRLineTable& out);
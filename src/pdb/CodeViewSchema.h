@@ -0,0 +1,197 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../util/RecordSchema.h"
+
+// CodeViewSchema:
+// Every LF_* / S_* record we read or write, described once. Each record
+// type exposes decode()/encode() over the complete record (u16 length +
+// u16 kind prefix, padding included) and an enum naming its tuple slots:
+//
+//   cv::LfPointer::Values v;
+//   if (cv::LfPointer::decode(bytes, v)) use(std::get<cv::LfPointer::Referent>(v));
+//
+// Dispatch<Recs...>(kind, f) calls f(Rec{}) for the matching record type,
+// replacing hand-written switch statements over leaf kinds.
+namespace cv {
+
+using schema::Fixed;
+using schema::NumericLeaf;
+using schema::CString;
+using schema::TrailingCString;
+using schema::Rest;
+
+// IsType selects the padding rule: TPI/IPI records pad with LF_PAD
+// (0xF0 | bytes-remaining), symbol records with zeros.
+template <std::uint16_t Kind, bool IsType, typename... Fs>
+struct Record {
+    static constexpr std::uint16_t kKind = Kind;
+    using Fields = schema::FieldList<Fs...>;
+    using Values = typename Fields::Values;
+
+    static bool decode(IRBytes record, Values& v) {
+        if (record.size < 4) return false;
+        std::uint16_t len = schema::LoadLE<std::uint16_t>(record.data);
+        if (len < 2 || std::size_t(len) + 2 > record.size) return false;
+        if (schema::LoadLE<std::uint16_t>(record.data + 2) != Kind) return false;
+        return Fields::decode(IRBytes{record.data + 4, std::size_t(len) - 2}, v);
+    }
+
+    static void encode(const Values& v, std::vector<std::uint8_t>& out) {
+        const std::size_t start = out.size();
+        schema::StoreLE<std::uint16_t>(out, 0);
+        schema::StoreLE<std::uint16_t>(out, Kind);
+        Fields::encode(v, out);
+        while ((out.size() - start) % 4) {
+            std::size_t remaining = 4 - (out.size() - start) % 4;
+            out.push_back(IsType ? static_cast<std::uint8_t>(0xF0 | remaining) : 0);
+        }
+        std::uint16_t len = static_cast<std::uint16_t>(out.size() - start - 2);
+        out[start] = len & 0xff;
+        out[start + 1] = len >> 8;
+    }
+};
+
+// Field-list members (LF_MEMBER, ...) have a u16 leaf prefix but no length.
+template <std::uint16_t Kind, typename... Fs>
+struct SubRecord {
+    static constexpr std::uint16_t kKind = Kind;
+    using Fields = schema::FieldList<Fs...>;
+    using Values = typename Fields::Values;
+
+    static bool decode(IRBytes in, Values& v, std::size_t* consumed) {
+        if (in.size < 2 || schema::LoadLE<std::uint16_t>(in.data) != Kind) return false;
+        std::size_t n = 0;
+        if (!Fields::decode(IRBytes{in.data + 2, in.size - 2}, v, &n)) return false;
+        if (consumed) *consumed = 2 + n;
+        return true;
+    }
+
+    static void encode(const Values& v, std::vector<std::uint8_t>& out) {
+        schema::StoreLE<std::uint16_t>(out, Kind);
+        Fields::encode(v, out);
+    }
+};
+
+template <typename... Recs, typename F>
+bool Dispatch(std::uint16_t kind, F&& f) {
+    return (false || ... || (kind == Recs::kKind ? (f(Recs{}), true) : false));
+}
+
+// ---- type records (TPI / IPI) ----
+
+struct LfModifier : Record<0x1001, true, Fixed<std::uint32_t>, Fixed<std::uint16_t>> {
+    enum { ModifiedType, Modifiers };
+};
+
+struct LfPointer : Record<0x1002, true, Fixed<std::uint32_t>, Fixed<std::uint32_t>> {
+    enum { Referent, Attributes };
+};
+
+struct LfProcedure : Record<0x1008, true,
+        Fixed<std::uint32_t>, Fixed<std::uint8_t>, Fixed<std::uint8_t>,
+        Fixed<std::uint16_t>, Fixed<std::uint32_t>> {
+    enum { ReturnType, CallConv, FuncAttrs, ParamCount, ArgList };
+};
+
+struct LfBitfield : Record<0x1205, true,
+        Fixed<std::uint32_t>, Fixed<std::uint8_t>, Fixed<std::uint8_t>> {
+    enum { Type, Length, Position };
+};
+
+struct LfArray : Record<0x1503, true,
+        Fixed<std::uint32_t>, Fixed<std::uint32_t>, NumericLeaf, CString> {
+    enum { ElementType, IndexType, Size, Name };
+};
+
+template <std::uint16_t Kind>
+struct LfClassLike : Record<Kind, true,
+        Fixed<std::uint16_t>, Fixed<std::uint16_t>, Fixed<std::uint32_t>,
+        Fixed<std::uint32_t>, Fixed<std::uint32_t>, NumericLeaf,
+        CString, TrailingCString> {
+    enum { Count, Property, FieldList, DerivedFrom, VShape, Size, Name, UniqueName };
+};
+struct LfClass     : LfClassLike<0x1504> {};
+struct LfStructure : LfClassLike<0x1505> {};
+
+struct LfUnion : Record<0x1506, true,
+        Fixed<std::uint16_t>, Fixed<std::uint16_t>, Fixed<std::uint32_t>,
+        NumericLeaf, CString, TrailingCString> {
+    enum { Count, Property, FieldList, Size, Name, UniqueName };
+};
+
+struct LfEnum : Record<0x1507, true,
+        Fixed<std::uint16_t>, Fixed<std::uint16_t>, Fixed<std::uint32_t>,
+        Fixed<std::uint32_t>, CString, TrailingCString> {
+    enum { Count, Property, UnderlyingType, FieldList, Name, UniqueName };
+};
+
+struct LfFuncId : Record<0x1601, true,
+        Fixed<std::uint32_t>, Fixed<std::uint32_t>, CString> {
+    enum { Scope, Type, Name };
+};
+
+// ---- field-list members ----
+
+struct LfEnumerate : SubRecord<0x1502, Fixed<std::uint16_t>, NumericLeaf, CString> {
+    enum { Attributes, Value, Name };
+};
+
+struct LfMember : SubRecord<0x150d,
+        Fixed<std::uint16_t>, Fixed<std::uint32_t>, NumericLeaf, CString> {
+    enum { Attributes, Type, Offset, Name };
+};
+
+// ---- symbol records ----
+
+struct SUdt : Record<0x1108, false, Fixed<std::uint32_t>, CString> {
+    enum { Type, Name };
+};
+
+template <std::uint16_t Kind>
+struct SDataLike : Record<Kind, false,
+        Fixed<std::uint32_t>, Fixed<std::uint32_t>, Fixed<std::uint16_t>, CString> {
+    enum { Type, Offset, Segment, Name };
+};
+struct SLData32 : SDataLike<0x110c> {};
+struct SGData32 : SDataLike<0x110d> {};
+
+struct SPub32 : Record<0x110e, false,
+        Fixed<std::uint32_t>, Fixed<std::uint32_t>, Fixed<std::uint16_t>, CString> {
+    enum { Flags, Offset, Segment, Name };
+};
+
+struct SLocal : Record<0x113e, false, Fixed<std::uint32_t>, Fixed<std::uint16_t>, CString> {
+    enum { Type, Flags, Name };
+};
+
+struct SDefRangeRegister : Record<0x1141, false,
+        Fixed<std::uint16_t>, Fixed<std::uint16_t>,
+        Fixed<std::uint32_t>, Fixed<std::uint16_t>, Fixed<std::uint16_t>, Rest> {
+    enum { Register, Attributes, OffsetStart, Section, Length, Gaps };
+};
+
+struct SDefRangeFramePointerRel : Record<0x1142, false,
+        Fixed<std::int32_t>,
+        Fixed<std::uint32_t>, Fixed<std::uint16_t>, Fixed<std::uint16_t>, Rest> {
+    enum { Offset, OffsetStart, Section, Length, Gaps };
+};
+
+struct SDefRangeFramePointerRelFullScope : Record<0x1144, false, Fixed<std::int32_t>> {
+    enum { Offset };
+};
+
+struct SDefRangeRegisterRel : Record<0x1145, false,
+        Fixed<std::uint16_t>, Fixed<std::uint16_t>, Fixed<std::int32_t>,
+        Fixed<std::uint32_t>, Fixed<std::uint16_t>, Fixed<std::uint16_t>, Rest> {
+    enum { Register, Flags, BaseOffset, OffsetStart, Section, Length, Gaps };
+};
+
+struct SInlineSite : Record<0x114d, false,
+        Fixed<std::uint32_t>, Fixed<std::uint32_t>, Fixed<std::uint32_t>, Rest> {
+    enum { Parent, End, Inlinee, Annotations };
+};
+
+struct SInlineSiteEnd : Record<0x114e, false> {};
+
+} // namespace cv
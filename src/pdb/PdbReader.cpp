@@ -1,16 +1,52 @@
 #include "PdbReader.h"
 #include <iostream>
 
+// Non-streaming entry point: collects every streamed module into one tree.
 std::unique_ptr<IRScope> PdbReader::readPdb(
     const std::string& path,
     IRTypeTable& typeTable,
     IRMaps& maps
+) {
+    std::unique_ptr<IRScope> root;
+    bool wrapped = false;
+    readPdbStreaming(path, typeTable, maps,
+        [&](std::unique_ptr<IRScope> mod) {
+            if (!root) {
+                root = std::move(mod);
+                return;
+            }
+            // More than one module: hang them all under a synthetic root.
+            if (!wrapped) {
+                wrapped = true;
+                auto top = std::make_unique<IRScope>();
+                top->kind = IRScopeKind::CompileUnit;
+                top->name = path;
+                root->parent = top.get();
+                top->children.push_back(std::move(root));
+                root = std::move(top);
+            }
+            mod->parent = root.get();
+            root->children.push_back(std::move(mod));
+        });
+    return root;
+}
+
+void PdbReader::readPdbStreaming(
+    const std::string& path,
+    IRTypeTable& typeTable,
+    IRMaps& maps,
+    const std::function<void(std::unique_ptr<IRScope>)>& onUnit
 ) {
     std::cout << "[PdbReader] reading PDB from " << path << " (stub)\n";
+    filterState = IRFilterState();
+
+    // TODO: walk DBI module info; the stub has a single module. A real
+    // reader checks keepUnit on the module name before opening its stream.
 
     auto root = std::make_unique<IRScope>();
     root->kind = IRScopeKind::CompileUnit;
     root->name = path;
+    if (filter && !filter->keepUnit(root->name)) return;
 
     // Create a dummy struct type in IR
     IRType* t = typeTable.createType(IRTypeKind::StructOrUnion);
@@ -22,7 +58,7 @@ std::unique_ptr<IRScope> PdbReader::readPdb(
     f.name = "alt0";
     f.type = t->id;
     f.byteOffset = 0;
-    t->fields.push_back(f);
+    typeTable.addField(t, f);
 
     root->declaredTypes.push_back(t->id);
 
@@ -33,10 +69,10 @@ std::unique_ptr<IRScope> PdbReader::readPdb(
     root->declaredSymbols.push_back(sym);
 
     // map PDB type index 0x1000 <-> our IRTypeID
-    maps.pdbTIToIR[0x1000] = t->id;
-    maps.irToPdbTI[t->id]  = 0x1000;
+    maps.linkPdb(t->id, 0x1000);
 
-    return root;
+    if (filter && !ApplyFilter(*root, typeTable, *filter, &filterState)) return;
+    onUnit(std::move(root));
 }
 
 std::unique_ptr<IRScope> PdbReader::readFromModel(
@@ -57,7 +93,7 @@ std::unique_ptr<IRScope> PdbReader::readFromModel(
     f.name = "alt0";
     f.type = t->id;
     f.byteOffset = 0;
-    t->fields.push_back(f);
+    typeTable.addField(t, f);
 
     root->declaredTypes.push_back(t->id);
 
@@ -67,8 +103,7 @@ std::unique_ptr<IRScope> PdbReader::readFromModel(
     s.type = t->id;
     root->declaredSymbols.push_back(s);
 
-    maps.pdbTIToIR[model.typeIndexOrSymOffset] = t->id;
-    maps.irToPdbTI[t->id] = model.typeIndexOrSymOffset;
+    maps.linkPdb(t->id, model.typeIndexOrSymOffset);
     return root;
 }
 
@@ -1,9 +1,11 @@
 #pragma once
+#include <functional>
 #include <memory>
 #include <string>
 #include "../ir/IRNode.h"
 #include "../ir/IRTypeTable.h"
 #include "../ir/IRMaps.h"
+#include "../ir/IRFilter.h"
 #include "PdbNode.h"
 
 // PdbReader:
@@ -13,12 +15,25 @@
 // 4. fill maps.pdbTIToIR
 class PdbReader {
 public:
+    // Optional; must outlive the reads. Filtered-out units are skipped
+    // before they are decoded and the rest are pruned before onUnit.
+    void setFilter(const IRFilter* f) { filter = f; }
+
     std::unique_ptr<IRScope> readPdb(
         const std::string& path,
         IRTypeTable& typeTable,
         IRMaps& maps
     );
 
+    // Streaming variant: hands each module (DBI module stream) to onUnit as
+    // soon as its symbols are decoded. TPI records go into typeTable first.
+    void readPdbStreaming(
+        const std::string& path,
+        IRTypeTable& typeTable,
+        IRMaps& maps,
+        const std::function<void(std::unique_ptr<IRScope>)>& onUnit
+    );
+
     // NEW: Build IR from an existing PdbNode (for tests)
     std::unique_ptr<IRScope> readFromModel(
         const PdbNode& model,
@@ -27,6 +42,9 @@ public:
     );
 
 private:
+    const IRFilter* filter = nullptr;
+    IRFilterState   filterState; // per streaming read
+
     // TODO: parse MSF, read TPI stream, etc.
     std::unique_ptr<PdbNode> parseRawPdb(const std::string& path);
 };
@@ -0,0 +1,198 @@
+#include "PdbSymbolHash.h"
+#include <algorithm>
+#include <cstring>
+#include "CodeViewSchema.h"
+#include "../util/ParallelFor.h"
+
+namespace {
+
+constexpr std::uint32_t GSI_VERSION_SIGNATURE = 0xFFFFFFFF;
+constexpr std::uint32_t GSI_VERSION_HDR       = 0xEFFE0000 + 19990810;
+// Bucket offsets are in units of the 12-byte in-memory record MSVC uses.
+constexpr std::uint32_t GSI_HR_MEMORY_SIZE    = 12;
+// Hashing and record serialization work in fixed-size chunks.
+constexpr std::size_t   kChunk                = 4096;
+
+void Put16(std::vector<std::uint8_t>& out, std::uint16_t v) {
+    out.push_back(v & 0xff);
+    out.push_back(v >> 8);
+}
+
+void Put32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xff);
+}
+
+bool IsAscii(std::string_view s) {
+    for (char c : s) {
+        if (static_cast<unsigned char>(c) & 0x80) return false;
+    }
+    return true;
+}
+
+void AppendRecord(const PdbGlobalSymbol& sym, std::vector<std::uint8_t>& out) {
+    if (sym.kind == S_PUB32) {
+        cv::SPub32::encode({sym.flags, sym.offset, sym.segment, sym.name}, out);
+    } else if (sym.kind == S_LDATA32) {
+        cv::SLData32::encode({sym.type, sym.offset, sym.segment, sym.name}, out);
+    } else {
+        cv::SGData32::encode({sym.type, sym.offset, sym.segment, sym.name}, out);
+    }
+}
+
+// Appends every record and returns its offset in the stream.
+std::vector<std::uint32_t> AppendRecords(const std::vector<PdbGlobalSymbol>& syms,
+                                         unsigned jobs,
+                                         std::vector<std::uint8_t>& stream) {
+    // Each chunk is serialized on its own, then the chunks are concatenated.
+    std::size_t chunks = (syms.size() + kChunk - 1) / kChunk;
+    std::vector<std::vector<std::uint8_t>> bytes(chunks);
+    std::vector<std::vector<std::uint32_t>> local(chunks);
+    ParallelFor(chunks, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(syms.size(), (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) {
+            local[c].push_back(static_cast<std::uint32_t>(bytes[c].size()));
+            AppendRecord(syms[i], bytes[c]);
+        }
+    });
+
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(syms.size());
+    for (std::size_t c = 0; c < chunks; ++c) {
+        std::uint32_t base = static_cast<std::uint32_t>(stream.size());
+        for (std::uint32_t off : local[c]) offsets.push_back(base + off);
+        stream.insert(stream.end(), bytes[c].begin(), bytes[c].end());
+    }
+    return offsets;
+}
+
+} // namespace
+
+std::uint32_t HashStringV1(std::string_view s) {
+    const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(s.data());
+    std::size_t n = s.size();
+    std::uint32_t result = 0;
+
+    for (; n >= 4; p += 4, n -= 4) {
+        result ^= std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+                  (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+    }
+    if (n >= 2) {
+        result ^= std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8);
+        p += 2;
+        n -= 2;
+    }
+    if (n == 1) result ^= p[0];
+
+    result |= 0x20202020; // fold case
+    result ^= result >> 11;
+    return result ^ (result >> 16);
+}
+
+int GsiRecordCompare(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    if (!IsAscii(a) || !IsAscii(b)) return std::memcmp(a.data(), b.data(), a.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        unsigned char ca = static_cast<unsigned char>(a[i]);
+        unsigned char cb = static_cast<unsigned char>(b[i]);
+        if (ca >= 'A' && ca <= 'Z') ca += 'a' - 'A';
+        if (cb >= 'A' && cb <= 'Z') cb += 'a' - 'A';
+        if (ca != cb) return ca < cb ? -1 : 1;
+    }
+    return 0;
+}
+
+void AppendGsiHash(const std::vector<GsiHashEntry>& entries,
+                   unsigned jobs,
+                   std::vector<std::uint8_t>& out) {
+    const std::size_t n = entries.size();
+
+    std::vector<std::uint16_t> bucketOf(n);
+    ParallelFor((n + kChunk - 1) / kChunk, jobs, [&](std::size_t c) {
+        std::size_t end = std::min(n, (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < end; ++i) {
+            bucketOf[i] = static_cast<std::uint16_t>(HashStringV1(entries[i].name) % IPHR_HASH);
+        }
+    });
+
+    // Counting sort by bucket, then sort each bucket on its own.
+    std::vector<std::uint32_t> bucketStart(IPHR_HASH + 1, 0);
+    for (std::uint16_t b : bucketOf) ++bucketStart[b + 1];
+    for (std::uint32_t b = 0; b < IPHR_HASH; ++b) bucketStart[b + 1] += bucketStart[b];
+
+    std::vector<const GsiHashEntry*> sorted(n);
+    {
+        std::vector<std::uint32_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::size_t i = 0; i < n; ++i) sorted[cursor[bucketOf[i]]++] = &entries[i];
+    }
+    ParallelFor(IPHR_HASH, jobs, [&](std::size_t b) {
+        // Same-named statics from different modules are ordered by offset.
+        std::sort(sorted.begin() + bucketStart[b], sorted.begin() + bucketStart[b + 1],
+                  [](const GsiHashEntry* l, const GsiHashEntry* r) {
+                      int cmp = GsiRecordCompare(l->name, r->name);
+                      return cmp != 0 ? cmp < 0 : l->symOffset < r->symOffset;
+                  });
+    });
+
+    std::vector<std::uint32_t> bitmap((IPHR_HASH + 32) / 32, 0);
+    std::vector<std::uint32_t> bucketOffsets;
+    for (std::uint32_t b = 0; b < IPHR_HASH; ++b) {
+        if (bucketStart[b] == bucketStart[b + 1]) continue;
+        bitmap[b / 32] |= 1u << (b % 32);
+        bucketOffsets.push_back(bucketStart[b] * GSI_HR_MEMORY_SIZE);
+    }
+
+    Put32(out, GSI_VERSION_SIGNATURE);
+    Put32(out, GSI_VERSION_HDR);
+    Put32(out, static_cast<std::uint32_t>(n * 8));
+    Put32(out, static_cast<std::uint32_t>((bitmap.size() + bucketOffsets.size()) * 4));
+    out.reserve(out.size() + n * 8 + (bitmap.size() + bucketOffsets.size()) * 4);
+    for (const GsiHashEntry* e : sorted) {
+        Put32(out, e->symOffset + 1); // 0 means "no record"
+        Put32(out, 1);                // cRef
+    }
+    for (std::uint32_t w : bitmap) Put32(out, w);
+    for (std::uint32_t off : bucketOffsets) Put32(out, off);
+}
+
+PdbSymbolStreams BuildSymbolStreams(const std::vector<PdbGlobalSymbol>& globals,
+                                    const std::vector<PdbGlobalSymbol>& publics,
+                                    unsigned jobs) {
+    PdbSymbolStreams s;
+    std::vector<std::uint32_t> globalOffsets = AppendRecords(globals, jobs, s.symbolRecords);
+    std::vector<std::uint32_t> publicOffsets = AppendRecords(publics, jobs, s.symbolRecords);
+
+    std::vector<GsiHashEntry> entries(globals.size());
+    for (std::size_t i = 0; i < globals.size(); ++i) entries[i] = {globals[i].name, globalOffsets[i]};
+    AppendGsiHash(entries, jobs, s.globals);
+
+    entries.resize(publics.size());
+    for (std::size_t i = 0; i < publics.size(); ++i) entries[i] = {publics[i].name, publicOffsets[i]};
+    std::vector<std::uint8_t> publicsHash;
+    AppendGsiHash(entries, jobs, publicsHash);
+
+    // Address map: publics by (segment, offset); the name breaks ties so
+    // aliases come out the same way every run.
+    std::vector<std::uint32_t> byAddress(publics.size());
+    for (std::size_t i = 0; i < publics.size(); ++i) byAddress[i] = static_cast<std::uint32_t>(i);
+    ParallelSort(byAddress.begin(), byAddress.end(), jobs, [&](std::uint32_t l, std::uint32_t r) {
+        const PdbGlobalSymbol& a = publics[l];
+        const PdbGlobalSymbol& b = publics[r];
+        if (a.segment != b.segment) return a.segment < b.segment;
+        if (a.offset != b.offset) return a.offset < b.offset;
+        if (a.name != b.name) return a.name < b.name;
+        return l < r;
+    });
+
+    // PublicsStreamHeader
+    Put32(s.publics, static_cast<std::uint32_t>(publicsHash.size())); // SymHash
+    Put32(s.publics, static_cast<std::uint32_t>(byAddress.size() * 4)); // AddrMap
+    Put32(s.publics, 0);   // NumThunks
+    Put32(s.publics, 0);   // SizeOfThunk
+    Put16(s.publics, 0);   // ISectThunkTable
+    Put16(s.publics, 0);   // padding
+    Put32(s.publics, 0);   // OffThunkTable
+    Put32(s.publics, 0);   // NumSections
+    s.publics.insert(s.publics.end(), publicsHash.begin(), publicsHash.end());
+    for (std::uint32_t i : byAddress) Put32(s.publics, publicOffsets[i]);
+    return s;
+}
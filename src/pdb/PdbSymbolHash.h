@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// PdbSymbolHash:
+// The global (GSI) and public (PSI) symbol hash streams and the symbol
+// record stream they index. Debuggers look names up through the hash
+// buckets and addresses through the PSI address map instead of scanning
+// every module.
+//
+// Buckets are built by sorting, not by chained insertion: hashes are
+// computed in parallel, records are counting-sorted by bucket, and each
+// bucket is then sorted independently. The address map is a parallel sort
+// on (segment, offset, name). The output does not depend on the job count.
+
+constexpr std::uint16_t S_PUB32   = 0x110e;
+constexpr std::uint16_t S_GDATA32 = 0x110d;
+constexpr std::uint16_t S_LDATA32 = 0x110c;
+
+constexpr std::uint32_t IPHR_HASH = 4096;
+
+// CV_PUBSYMFLAGS
+constexpr std::uint32_t CV_PUBSYMFLAGS_FUNCTION = 0x2;
+
+// One record destined for the symbol record stream.
+struct PdbGlobalSymbol {
+    std::string   name;
+    std::uint16_t kind    = S_GDATA32;
+    std::uint32_t type    = 0; // data symbols only
+    std::uint32_t flags   = 0; // S_PUB32 only
+    std::uint16_t segment = 0;
+    std::uint32_t offset  = 0;
+};
+
+struct PdbSymbolStreams {
+    std::vector<std::uint8_t> symbolRecords; // SymRecordStream
+    std::vector<std::uint8_t> globals;       // GSI hash
+    std::vector<std::uint8_t> publics;       // PSI header + GSI hash + address map
+};
+
+// The name hash both tables use (hashStringV1), before reduction mod IPHR_HASH.
+std::uint32_t HashStringV1(std::string_view s);
+
+// In-bucket order: shorter names first, then case-insensitive for ASCII.
+int GsiRecordCompare(std::string_view a, std::string_view b);
+
+struct GsiHashEntry {
+    std::string_view name;
+    std::uint32_t    symOffset = 0; // into the symbol record stream
+};
+
+// Appends a GSI hash table: header, hash records, bucket bitmap and
+// bucket offsets.
+void AppendGsiHash(const std::vector<GsiHashEntry>& entries,
+                   unsigned jobs,
+                   std::vector<std::uint8_t>& out);
+
+// Serializes globals then publics into the symbol record stream and builds
+// both hash streams over them.
+PdbSymbolStreams BuildSymbolStreams(const std::vector<PdbGlobalSymbol>& globals,
+                                    const std::vector<PdbGlobalSymbol>& publics,
+                                    unsigned jobs);
@@ -0,0 +1,405 @@
+#include "PdbVerifier.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+#include "CodeViewSchema.h"
+#include "../util/ParallelFor.h"
+
+namespace {
+
+using schema::LoadLE;
+
+constexpr char          kMsfMagic[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0"; // 32 bytes with the NUL
+constexpr std::size_t   kSuperBlockSize = 56;
+constexpr std::uint32_t kNilStream = 0xffffffff;
+constexpr std::uint32_t kTpiStream = 2;
+
+constexpr std::uint32_t kTpiVersionV80 = 20040203;
+constexpr std::uint32_t kTpiHeaderSize = 56;
+constexpr std::uint32_t kFirstTI = 0x1000;
+
+constexpr std::uint16_t kPropFwdRef = 0x0080;
+constexpr std::uint16_t kPropHasUniqueName = 0x0200;
+
+constexpr std::size_t kChunk = 4096;
+
+std::string Hex(std::uint64_t v) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s;
+    do {
+        s.insert(s.begin(), digits[v & 0xf]);
+        v >>= 4;
+    } while (v);
+    return "0x" + s;
+}
+
+struct Msf {
+    IRBytes       file;
+    std::uint32_t blockSize = 0;
+    std::uint32_t fpmBlock = 0;
+    std::uint32_t numBlocks = 0;
+    std::vector<std::uint32_t>              streamSizes;
+    std::vector<std::vector<std::uint32_t>> streamBlocks;
+
+    std::uint64_t blocksFor(std::uint64_t bytes) const { return (bytes + blockSize - 1) / blockSize; }
+
+    bool markedFree(std::uint32_t b) const {
+        std::uint64_t byte = b / 8;
+        std::uint64_t physical = (byte / blockSize) * blockSize + fpmBlock;
+        if (physical >= numBlocks) return false;
+        return (file.data[physical * blockSize + byte % blockSize] >> (b % 8)) & 1;
+    }
+
+    // A view of the stream, copied into 'scratch' only when its blocks are
+    // not contiguous in the file.
+    IRBytes stream(std::uint32_t index, std::vector<std::uint8_t>& scratch) const {
+        const auto& blocks = streamBlocks[index];
+        const std::uint32_t size = streamSizes[index] == kNilStream ? 0 : streamSizes[index];
+        if (blocks.empty()) return IRBytes{file.data, 0};
+        bool contiguous = true;
+        for (std::size_t i = 1; i < blocks.size() && contiguous; ++i) contiguous = blocks[i] == blocks[i - 1] + 1;
+        if (contiguous) return IRBytes{file.data + std::uint64_t(blocks[0]) * blockSize, size};
+
+        scratch.resize(size);
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            std::size_t at = i * blockSize;
+            std::size_t n = std::min<std::size_t>(blockSize, size - at);
+            std::memcpy(scratch.data() + at, file.data + std::uint64_t(blocks[i]) * blockSize, n);
+        }
+        return IRBytes{scratch.data(), size};
+    }
+};
+
+// Superblock, directory and block ownership. Returns false when the
+// stream layout cannot be trusted enough to read streams.
+bool VerifyMsf(IRBytes file, Msf& msf, VerifyReport& report) {
+    const char* where = "MSF";
+    const std::uint8_t* b = file.data;
+    if (file.size < kSuperBlockSize || std::memcmp(b, kMsfMagic, sizeof(kMsfMagic)) != 0) {
+        report.fail(where, 0, "not an MSF 7.00 file");
+        return false;
+    }
+    msf.file = file;
+    msf.blockSize = LoadLE<std::uint32_t>(b + 32);
+    msf.fpmBlock = LoadLE<std::uint32_t>(b + 36);
+    msf.numBlocks = LoadLE<std::uint32_t>(b + 40);
+    const std::uint32_t dirBytes = LoadLE<std::uint32_t>(b + 44);
+    const std::uint32_t blockMapAddr = LoadLE<std::uint32_t>(b + 52);
+
+    const std::uint32_t bs = msf.blockSize;
+    if (bs != 512 && bs != 1024 && bs != 2048 && bs != 4096) {
+        report.fail(where, 32, "block size " + std::to_string(bs));
+        return false;
+    }
+    if (msf.fpmBlock != 1 && msf.fpmBlock != 2) report.fail(where, 36, "free page map block " + std::to_string(msf.fpmBlock));
+    if (std::uint64_t(msf.numBlocks) * bs > file.size) {
+        report.fail(where, 40, "file is shorter than " + std::to_string(msf.numBlocks) + " blocks");
+        return false;
+    }
+    if (std::uint64_t(msf.numBlocks) * bs != file.size) report.fail(where, 40, "file size is not numBlocks * blockSize");
+
+    const std::uint64_t dirBlocks = msf.blocksFor(dirBytes);
+    if (blockMapAddr == 0 || blockMapAddr >= msf.numBlocks || dirBlocks * 4 > bs) {
+        report.fail(where, 52, "directory block map out of range");
+        return false;
+    }
+
+    // Block owners: 0 = free, 1 = superblock/FPM, 2 = directory, 3+s = stream s.
+    // Blocks 1 and 2 of every blockSize-block interval hold the two FPMs.
+    std::vector<std::uint32_t> owner(msf.numBlocks, 0);
+    owner[0] = 1;
+    for (std::uint64_t i = 0; i < msf.numBlocks; i += bs) {
+        for (std::uint64_t f = i + 1; f <= i + 2 && f < msf.numBlocks; ++f) owner[f] = 1;
+    }
+    auto name = [](std::uint32_t who) {
+        return who == 2 ? std::string("directory") : "stream " + std::to_string(who - 3);
+    };
+    auto claim = [&](std::uint32_t block, std::uint32_t who) {
+        const std::uint64_t at = std::uint64_t(block) * bs;
+        if (block >= msf.numBlocks) {
+            report.fail(where, at, name(who) + " uses block " + std::to_string(block) + " past the end");
+            return false;
+        }
+        if (owner[block] == 1) {
+            report.fail(where, at, name(who) + " uses reserved block " + std::to_string(block));
+        } else if (owner[block]) {
+            report.fail(where, at, name(who) + " reuses block " + std::to_string(block));
+        }
+        if (msf.markedFree(block)) {
+            report.fail(where, at, name(who) + " uses block " + std::to_string(block) + " marked free");
+        }
+        owner[block] = who;
+        return true;
+    };
+
+    bool ok = claim(blockMapAddr, 2);
+    std::vector<std::uint8_t> dir(dirBlocks * bs);
+    for (std::uint64_t i = 0; i < dirBlocks; ++i) {
+        std::uint32_t db = LoadLE<std::uint32_t>(b + std::uint64_t(blockMapAddr) * bs + i * 4);
+        if (!claim(db, 2)) return false;
+        std::memcpy(dir.data() + i * bs, b + std::uint64_t(db) * bs, bs);
+    }
+    if (!ok) return false;
+
+    // Directory: numStreams, sizes[numStreams], then each stream's blocks.
+    if (dirBytes < 4) {
+        report.fail(where, 44, "directory too small");
+        return false;
+    }
+    const std::uint32_t numStreams = LoadLE<std::uint32_t>(dir.data());
+    std::uint64_t pos = 4;
+    if ((dirBytes - pos) / 4 < numStreams) {
+        report.fail(where, 44, "directory too small for " + std::to_string(numStreams) + " streams");
+        return false;
+    }
+    msf.streamSizes.resize(numStreams);
+    msf.streamBlocks.resize(numStreams);
+    for (std::uint32_t s = 0; s < numStreams; ++s, pos += 4) msf.streamSizes[s] = LoadLE<std::uint32_t>(dir.data() + pos);
+
+    for (std::uint32_t s = 0; s < numStreams; ++s) {
+        std::uint32_t size = msf.streamSizes[s];
+        std::uint64_t n = size == kNilStream ? 0 : msf.blocksFor(size);
+        if ((dirBytes - pos) / 4 < n) {
+            report.fail(where, 44, "directory too small for the blocks of stream " + std::to_string(s));
+            return false;
+        }
+        auto& blocks = msf.streamBlocks[s];
+        blocks.reserve(n);
+        for (std::uint64_t i = 0; i < n; ++i, pos += 4) {
+            std::uint32_t block = LoadLE<std::uint32_t>(dir.data() + pos);
+            if (!claim(block, 3 + s)) return false;
+            blocks.push_back(block);
+        }
+    }
+    if (pos != dirBytes) report.fail(where, 44, "directory has " + std::to_string(dirBytes - pos) + " trailing bytes");
+    report.itemsChecked += numStreams;
+    return true;
+}
+
+struct TpiHeader {
+    std::uint32_t version = 0;
+    std::uint32_t headerSize = 0;
+    std::uint32_t tiBegin = 0;
+    std::uint32_t tiEnd = 0;
+    std::uint32_t recordBytes = 0;
+    std::uint16_t hashStream = 0xffff;
+    std::uint32_t hashKeySize = 0;
+    std::uint32_t hashBuckets = 0;
+    std::uint32_t hashValuesOffset = 0;
+    std::uint32_t hashValuesLength = 0;
+};
+
+// class/struct, union and enum forward refs each resolve within their family.
+struct Udt {
+    std::uint32_t    ti = 0;
+    std::uint8_t     family = 0;
+    std::string_view name;
+    std::uint64_t    at = 0; // record offset in the stream
+};
+
+struct ChunkResult {
+    VerifyReport     report;
+    std::vector<Udt> definitions;
+    std::vector<Udt> forwardRefs;
+};
+
+void CheckRef(std::uint32_t self, std::uint32_t ref, const char* field, std::uint64_t at,
+              const TpiHeader& h, VerifyReport& report) {
+    if (ref < kFirstTI) return; // primitive
+    if (ref >= h.tiEnd) {
+        report.fail("TPI", at, std::string(field) + " " + Hex(ref) + " past the last TI");
+    } else if (ref >= self) {
+        report.fail("TPI", at, std::string(field) + " " + Hex(ref) + " is not before " + Hex(self));
+    }
+}
+
+template <typename Rec>
+void CheckUdt(const typename Rec::Values& v, std::uint8_t family, std::uint32_t ti, std::uint64_t at,
+              ChunkResult& out) {
+    std::uint16_t props = std::get<Rec::Property>(v);
+    std::string_view name = std::get<Rec::Name>(v);
+    if ((props & kPropHasUniqueName) && !std::get<Rec::UniqueName>(v).empty()) name = std::get<Rec::UniqueName>(v);
+    ((props & kPropFwdRef) ? out.forwardRefs : out.definitions).push_back({ti, family, name, at});
+}
+
+void CheckRecord(IRBytes rec, std::uint32_t ti, std::uint64_t at, const TpiHeader& h, ChunkResult& out) {
+    VerifyReport& report = out.report;
+    const std::uint16_t kind = LoadLE<std::uint16_t>(rec.data + 2);
+    auto bad = [&] { report.fail("TPI", at, "malformed record of kind " + Hex(kind)); };
+
+    cv::Dispatch<cv::LfModifier, cv::LfPointer, cv::LfProcedure, cv::LfBitfield, cv::LfArray,
+                 cv::LfClass, cv::LfStructure, cv::LfUnion, cv::LfEnum>(kind, [&](auto r) {
+        using Rec = decltype(r);
+        typename Rec::Values v;
+        if (!Rec::decode(rec, v)) return bad();
+        if constexpr (std::is_same_v<Rec, cv::LfModifier>) {
+            CheckRef(ti, std::get<Rec::ModifiedType>(v), "modified type", at, h, report);
+        } else if constexpr (std::is_same_v<Rec, cv::LfPointer>) {
+            CheckRef(ti, std::get<Rec::Referent>(v), "referent", at, h, report);
+        } else if constexpr (std::is_same_v<Rec, cv::LfProcedure>) {
+            CheckRef(ti, std::get<Rec::ReturnType>(v), "return type", at, h, report);
+            CheckRef(ti, std::get<Rec::ArgList>(v), "argument list", at, h, report);
+        } else if constexpr (std::is_same_v<Rec, cv::LfBitfield>) {
+            CheckRef(ti, std::get<Rec::Type>(v), "bitfield type", at, h, report);
+        } else if constexpr (std::is_same_v<Rec, cv::LfArray>) {
+            CheckRef(ti, std::get<Rec::ElementType>(v), "element type", at, h, report);
+            CheckRef(ti, std::get<Rec::IndexType>(v), "index type", at, h, report);
+        } else if constexpr (std::is_same_v<Rec, cv::LfUnion>) {
+            CheckRef(ti, std::get<Rec::FieldList>(v), "field list", at, h, report);
+            CheckUdt<Rec>(v, 1, ti, at, out);
+        } else if constexpr (std::is_same_v<Rec, cv::LfEnum>) {
+            CheckRef(ti, std::get<Rec::UnderlyingType>(v), "underlying type", at, h, report);
+            CheckRef(ti, std::get<Rec::FieldList>(v), "field list", at, h, report);
+            CheckUdt<Rec>(v, 2, ti, at, out);
+        } else {
+            CheckRef(ti, std::get<Rec::FieldList>(v), "field list", at, h, report);
+            CheckRef(ti, std::get<Rec::DerivedFrom>(v), "derived-from list", at, h, report);
+            CheckRef(ti, std::get<Rec::VShape>(v), "vshape", at, h, report);
+            CheckUdt<Rec>(v, 0, ti, at, out);
+        }
+    });
+    ++report.itemsChecked;
+}
+
+struct UdtKeyHash {
+    std::size_t operator()(const Udt& u) const {
+        return std::hash<std::string_view>()(u.name) * 3 + u.family;
+    }
+};
+struct UdtKeyEq {
+    bool operator()(const Udt& a, const Udt& b) const { return a.family == b.family && a.name == b.name; }
+};
+
+void VerifyTpi(const Msf& msf, const IRMaps* maps, unsigned jobs, VerifyReport& report) {
+    const char* where = "TPI";
+    if (msf.streamSizes.size() <= kTpiStream || msf.streamSizes[kTpiStream] == kNilStream) {
+        report.fail(where, 0, "no TPI stream");
+        return;
+    }
+    std::vector<std::uint8_t> scratch;
+    IRBytes tpi = msf.stream(kTpiStream, scratch);
+    if (tpi.size < kTpiHeaderSize) {
+        report.fail(where, 0, "stream shorter than the TPI header");
+        return;
+    }
+
+    const std::uint8_t* p = tpi.data;
+    TpiHeader h;
+    h.version          = LoadLE<std::uint32_t>(p + 0);
+    h.headerSize       = LoadLE<std::uint32_t>(p + 4);
+    h.tiBegin          = LoadLE<std::uint32_t>(p + 8);
+    h.tiEnd            = LoadLE<std::uint32_t>(p + 12);
+    h.recordBytes      = LoadLE<std::uint32_t>(p + 16);
+    h.hashStream       = LoadLE<std::uint16_t>(p + 20);
+    h.hashKeySize      = LoadLE<std::uint32_t>(p + 24);
+    h.hashBuckets      = LoadLE<std::uint32_t>(p + 28);
+    h.hashValuesOffset = LoadLE<std::uint32_t>(p + 32);
+    h.hashValuesLength = LoadLE<std::uint32_t>(p + 36);
+
+    if (h.version != kTpiVersionV80) report.fail(where, 0, "version " + std::to_string(h.version));
+    if (h.headerSize != kTpiHeaderSize || h.tiBegin != kFirstTI || h.tiEnd < h.tiBegin) {
+        report.fail(where, 4, "bad header (size, TI range)");
+        return;
+    }
+    if (std::uint64_t(h.headerSize) + h.recordBytes > tpi.size) {
+        report.fail(where, 16, "records run past the end of the stream");
+        return;
+    }
+
+    // Record framing is sequential; everything else runs per chunk.
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(h.tiEnd - h.tiBegin);
+    const std::uint64_t end = std::uint64_t(h.headerSize) + h.recordBytes;
+    for (std::uint64_t at = h.headerSize; at < end;) {
+        if (end - at < 4) {
+            report.fail(where, at, "truncated record header");
+            break;
+        }
+        std::uint32_t len = LoadLE<std::uint16_t>(p + at);
+        if (len < 2 || at + 2 + len > end) {
+            report.fail(where, at, "record length " + std::to_string(len) + " out of range");
+            break;
+        }
+        if ((len + 2) % 4) report.fail(where, at, "record not padded to 4 bytes");
+        offsets.push_back(static_cast<std::uint32_t>(at));
+        at += 2 + len;
+    }
+    if (offsets.size() != std::uint64_t(h.tiEnd - h.tiBegin)) {
+        report.fail(where, 12, std::to_string(offsets.size()) + " records for " +
+                    std::to_string(h.tiEnd - h.tiBegin) + " type indices");
+    }
+
+    const std::size_t chunks = (offsets.size() + kChunk - 1) / kChunk;
+    std::vector<ChunkResult> results(chunks);
+    ParallelFor(chunks, jobs, [&](std::size_t c) {
+        std::size_t last = std::min(offsets.size(), (c + 1) * kChunk);
+        for (std::size_t i = c * kChunk; i < last; ++i) {
+            std::uint64_t at = offsets[i];
+            std::size_t size = 2 + LoadLE<std::uint16_t>(p + at);
+            CheckRecord(IRBytes{p + at, size}, h.tiBegin + static_cast<std::uint32_t>(i), at, h, results[c]);
+        }
+    });
+
+    // Forward refs without a same-named definition are opaque types.
+    std::unordered_set<Udt, UdtKeyHash, UdtKeyEq> defined;
+    for (const auto& r : results) defined.insert(r.definitions.begin(), r.definitions.end());
+    ParallelFor(chunks, jobs, [&](std::size_t c) {
+        for (const Udt& fwd : results[c].forwardRefs) {
+            if (!defined.count(fwd)) ++results[c].report.opaqueDecls;
+        }
+    });
+    for (auto& r : results) report.merge(std::move(r.report));
+
+    // Hash values: one per record, each naming a bucket.
+    if (h.hashStream != 0xffff) {
+        if (h.hashStream >= msf.streamSizes.size() || msf.streamSizes[h.hashStream] == kNilStream) {
+            report.fail(where, 20, "hash stream " + std::to_string(h.hashStream) + " does not exist");
+        } else if (h.hashKeySize != 4 || h.hashBuckets == 0) {
+            report.fail(where, 24, "bad hash key size / bucket count");
+        } else {
+            std::vector<std::uint8_t> hashScratch;
+            IRBytes hash = msf.stream(h.hashStream, hashScratch);
+            if (std::uint64_t(h.hashValuesOffset) + h.hashValuesLength > hash.size ||
+                h.hashValuesLength != 4ull * (h.tiEnd - h.tiBegin)) {
+                report.fail(where, 32, "hash value buffer does not cover every record");
+            } else {
+                const std::uint8_t* values = hash.data + h.hashValuesOffset;
+                const std::size_t count = h.hashValuesLength / 4;
+                std::vector<std::size_t> outOfRange((count + kChunk - 1) / kChunk, 0);
+                ParallelFor(outOfRange.size(), jobs, [&](std::size_t c) {
+                    std::size_t last = std::min(count, (c + 1) * kChunk);
+                    for (std::size_t i = c * kChunk; i < last; ++i) {
+                        if (LoadLE<std::uint32_t>(values + 4 * i) >= h.hashBuckets) ++outOfRange[c];
+                    }
+                });
+                std::size_t bad = 0;
+                for (std::size_t n : outOfRange) bad += n;
+                if (bad) report.fail(where, 32, std::to_string(bad) + " hash values past the bucket count");
+            }
+        }
+    }
+
+    if (maps) {
+        maps->irToPdbTI.forEach([&](IRTypeID id, std::uint32_t ti) {
+            if (ti >= h.tiEnd) {
+                report.fail("IRMaps", ti, "IR type " + std::to_string(id) +
+                            " maps to TI " + Hex(ti) + " past the TPI range");
+            }
+        });
+    }
+}
+
+} // namespace
+
+VerifyReport VerifyPdb(IRBytes file, const IRMaps* maps, unsigned jobs) {
+    VerifyReport report;
+    Msf msf;
+    if (VerifyMsf(file, msf, report)) VerifyTpi(msf, maps, jobs, report);
+    report.sort();
+    return report;
+}
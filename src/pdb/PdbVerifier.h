@@ -0,0 +1,21 @@
+#pragma once
+#include "../ir/IRLocation.h"
+#include "../ir/IRMaps.h"
+#include "../util/VerifyReport.h"
+
+// PdbVerifier:
+// Structural checks of a produced PDB, run by --verify. Works on the loaded
+// file; a stream is only copied when its blocks are not contiguous.
+//
+//   - MSF: superblock, block size, directory and block map in range, every
+//     stream block in range, used once, not an FPM block and not marked
+//     free in the free page map;
+//   - TPI: header, record framing (length, 4-byte alignment, count matches
+//     the TI range), type references point at earlier TIs, hash values in
+//     range; forward refs (LF_CLASS/STRUCTURE/UNION/ENUM) with no
+//     definition of that name are opaque types and only counted
+//     (opaqueDecls);
+//   - IRMaps: every irToPdbTI value lies in the TPI range.
+//
+// Record checks and forward-ref lookups run in parallel.
+VerifyReport VerifyPdb(IRBytes file, const IRMaps* maps, unsigned jobs = 0);
@@ -1,5 +1,92 @@
 #include "PdbWriter.h"
 #include <iostream>
+#include <unordered_set>
+
+namespace {
+
+constexpr std::uint8_t DW_OP_addr = 0x03;
+// TODO: real section index once the writer knows the PE layout; addresses
+// are image-relative in section 1 for now, as in the module streams. In
+// merge mode every input image gets a section of its own after that.
+constexpr std::uint16_t kCodeSection = 1;
+
+// Static address from a DW_OP_addr location; false for anything else.
+bool StaticAddress(const IRScope& unit, IRLocID loc, std::uint64_t& addr) {
+    if (!loc || !unit.locations || unit.locations->format(loc) != IRLocFormat::DwarfExpr) return false;
+    IRBytes expr = unit.locations->bytes(loc);
+    if (expr.size != 9 || expr.data[0] != DW_OP_addr) return false;
+    addr = 0;
+    for (int i = 0; i < 8; ++i) addr |= std::uint64_t(expr.data[1 + i]) << (8 * i);
+    return true;
+}
+
+const IRScope* FindFunctionScope(const IRScope& scope, const std::string& name) {
+    for (const auto& child : scope.children) {
+        if (child->kind == IRScopeKind::Function && child->name == name) return child.get();
+    }
+    return nullptr;
+}
+
+// Walks CU/namespace/file-static scopes; function bodies only hold locals.
+void CollectScope(const IRScope& unit,
+                  const IRScope& scope,
+                  const std::string& prefix,
+                  const IRMaps& maps,
+                  std::vector<PdbGlobalSymbol>& globals,
+                  std::vector<PdbGlobalSymbol>& publics) {
+    for (const IRSymbol& sym : scope.declaredSymbols) {
+        std::string name = prefix.empty() ? sym.name : prefix + "::" + sym.name;
+        std::uint64_t addr = 0;
+
+        if (sym.kind == IRSymbolKind::Function) {
+            const IRScope* body = FindFunctionScope(scope, sym.name);
+            if (body && body->highPC > body->lowPC) {
+                addr = body->lowPC;
+            } else if (!StaticAddress(unit, sym.storage.loc, addr)) {
+                continue; // declaration only
+            }
+            // TODO: S_PROCREF into the globals once module streams carry S_GPROC32.
+            PdbGlobalSymbol pub;
+            pub.name = name;
+            pub.kind = S_PUB32;
+            pub.flags = CV_PUBSYMFLAGS_FUNCTION;
+            pub.segment = static_cast<std::uint16_t>(kCodeSection + unit.image);
+            pub.offset = static_cast<std::uint32_t>(addr);
+            publics.push_back(std::move(pub));
+        } else if (sym.kind == IRSymbolKind::Variable) {
+            if (!StaticAddress(unit, sym.storage.loc, addr)) continue;
+            const std::uint32_t* ti = maps.irToPdbTI.find(sym.type);
+            bool fileStatic = scope.kind == IRScopeKind::FileStatic;
+
+            PdbGlobalSymbol data;
+            data.name = name;
+            data.kind = fileStatic ? S_LDATA32 : S_GDATA32;
+            data.type = ti ? *ti : 0;
+            data.segment = static_cast<std::uint16_t>(kCodeSection + unit.image);
+            data.offset = static_cast<std::uint32_t>(addr);
+            if (!fileStatic) {
+                PdbGlobalSymbol pub;
+                pub.name = name;
+                pub.kind = S_PUB32;
+                pub.segment = data.segment;
+                pub.offset = data.offset;
+                publics.push_back(std::move(pub));
+            }
+            globals.push_back(std::move(data));
+        }
+    }
+
+    for (const auto& child : scope.children) {
+        if (child->kind == IRScopeKind::Namespace) {
+            CollectScope(unit, *child, prefix.empty() ? child->name : prefix + "::" + child->name,
+                         maps, globals, publics);
+        } else if (child->kind == IRScopeKind::FileStatic) {
+            CollectScope(unit, *child, prefix, maps, globals, publics);
+        }
+    }
+}
+
+} // namespace
 
 void PdbWriter::writePdb(
     const std::string& outPath,
@@ -13,4 +100,79 @@ void PdbWriter::writePdb(
     // - build TPI stream: emit LF_STRUCTURE / LF_UNION / LF_ARRAY / LF_POINTER ...
     // - build symbol streams: S_GPROC32, S_LOCAL, S_UDT, etc.
     (void)pdbModel;
+    buildSymbolStreams();
+}
+
+void PdbWriter::beginStreaming(const std::string& outPath) {
+    streamPath = outPath;
+    modulesWritten = 0;
+    typeRecordsWritten = 0;
+    {
+        std::lock_guard<std::mutex> lock(symbolsMu);
+        globals.clear();
+        publics.clear();
+    }
+    std::cout << "[PdbWriter] streaming PDB to " << outPath << " (stub)\n";
+    // TODO: create the MSF container and reserve the superblock/FPM pages.
+}
+
+void PdbWriter::writeModule(const PdbNode& moduleNode) {
+    // TODO: serialize S_* symbols into this module's stream and buffer the
+    // LF_* children for the TPI stream; the module node can then be freed.
+    ++modulesWritten;
+    typeRecordsWritten += moduleNode.children.size();
+}
+
+void PdbWriter::finishStreaming() {
+    buildSymbolStreams();
+    // TODO: write TPI, DBI (module info), the GSI/PSI/symbol record streams
+    // and the stream directory.
+    std::cout << "[PdbWriter] finished " << streamPath << ": "
+              << modulesWritten << " module(s), "
+              << typeRecordsWritten << " type record(s), "
+              << publics.size() << " public(s), "
+              << globals.size() << " global(s) (stub)\n";
+}
+
+void PdbWriter::addUnitSymbols(const IRScope& unit, const IRMaps& maps) {
+    std::vector<PdbGlobalSymbol> unitGlobals;
+    std::vector<PdbGlobalSymbol> unitPublics;
+    CollectScope(unit, unit, std::string(), maps, unitGlobals, unitPublics);
+
+    std::lock_guard<std::mutex> lock(symbolsMu);
+    for (auto& g : unitGlobals) globals.push_back(std::move(g));
+    for (auto& p : unitPublics) publics.push_back(std::move(p));
+}
+
+void PdbWriter::buildSymbolStreams() {
+    std::lock_guard<std::mutex> lock(symbolsMu);
+
+    // Inline/template definitions repeat across the units of one image, so
+    // keep one public per (image, name) and one S_GDATA32 per (image, name,
+    // type); the section tells the images of a merge apart. Every image has
+    // its own instance of such a symbol, so all images keep theirs. The
+    // first unit's copy wins; units come in order.
+    auto keyOf = [](const PdbGlobalSymbol& s, bool withType) {
+        std::string key = std::to_string(s.segment) + ':' + s.name;
+        if (withType) key += '\0' + std::to_string(s.type);
+        return key;
+    };
+    std::unordered_set<std::string> seen;
+    std::vector<PdbGlobalSymbol> uniquePublics;
+    uniquePublics.reserve(publics.size());
+    for (auto& p : publics) {
+        if (seen.insert(keyOf(p, false)).second) uniquePublics.push_back(std::move(p));
+    }
+    publics = std::move(uniquePublics);
+
+    seen.clear();
+    std::vector<PdbGlobalSymbol> uniqueGlobals;
+    uniqueGlobals.reserve(globals.size());
+    for (auto& g : globals) {
+        if (g.kind == S_GDATA32 && !seen.insert(keyOf(g, true)).second) continue;
+        uniqueGlobals.push_back(std::move(g));
+    }
+    globals = std::move(uniqueGlobals);
+
+    symbols = BuildSymbolStreams(globals, publics, jobs);
 }
@@ -1,7 +1,13 @@
 #pragma once
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include "PdbNode.h"
+#include "PdbSymbolHash.h"
+#include "../ir/IRNode.h"
+#include "../ir/IRMaps.h"
 
 // PdbWriter:
 // 1. take IRScope/IRTypeTable (wrapped upstream)
@@ -9,8 +15,38 @@
 // 3. write MSF/PDB streams.
 class PdbWriter {
 public:
+    // jobs: worker threads for the GSI/PSI build (0 = all cores).
+    explicit PdbWriter(unsigned jobs = 0) : jobs(jobs) {}
+
     void writePdb(
         const std::string& outPath,
         const PdbNode* pdbModel /* can be null */
     );
+
+    // Streaming API: open the MSF once, append each module stream as soon as
+    // its translation is finished, then write TPI/DBI/directory in finish.
+    void beginStreaming(const std::string& outPath);
+    void writeModule(const PdbNode& moduleNode);
+    void finishStreaming();
+
+    // Collects a unit's globals and publics from IRScope::declaredSymbols
+    // for the GSI/PSI streams. Reads maps.irToPdbTI, so call it from the
+    // translator stage after translateUnit; safe while modules are written.
+    void addUnitSymbols(const IRScope& unit, const IRMaps& maps);
+
+    // Built by writePdb/finishStreaming.
+    const PdbSymbolStreams& symbolStreams() const { return symbols; }
+
+private:
+    void buildSymbolStreams();
+
+    unsigned      jobs = 0;
+    std::string   streamPath;
+    std::uint32_t modulesWritten = 0;
+    std::uint64_t typeRecordsWritten = 0;
+
+    std::mutex                   symbolsMu;
+    std::vector<PdbGlobalSymbol> globals;
+    std::vector<PdbGlobalSymbol> publics;
+    PdbSymbolStreams             symbols;
 };
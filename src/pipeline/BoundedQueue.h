@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// BoundedQueue:
+// Blocking single-producer/single-consumer hand-off between pipeline stages.
+// push() blocks while the queue is full, so a fast reader cannot run ahead of
+// the translator and pile up whole-program IR. close() wakes everyone up;
+// after that push() fails and pop() drains what is left, then fails.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity)
+        : cap(capacity ? capacity : 1) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mu);
+        notFull.wait(lock, [&] { return closed || items.size() < cap; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mu);
+        notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mu);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+private:
+    std::size_t cap;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex mu;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
@@ -1,4 +1,8 @@
 #include "DwarfToPdb.h"
+#include "LocationTranslate.h"
+#include "../ir/IRCanonicalOrder.h"
+#include "../ir/IRForwardDecls.h"
+#include "../pdb/CodeViewInlinees.h"
 #include <iostream>
 
 std::unique_ptr<PdbNode> DwarfToPdb::translate(
@@ -7,7 +11,15 @@ std::unique_ptr<PdbNode> DwarfToPdb::translate(
     IRMaps& maps
 ) {
     std::cout << "[DwarfToPdb] translate IR -> PDB model (stub)\n";
-    (void)rootScope;
+    // Whole-program input: point references to forward decls at their
+    // definitions before any type is emitted, then renumber types in a
+    // content-derived order so TIs / DIE offsets are reproducible.
+    IRForwardResolution fwd = ResolveForwardDecls(typeTable);
+    if (rootScope) {
+        fwd.rewrite(*rootScope);
+        ApplyCanonicalOrder(ComputeCanonicalOrder(typeTable, CompileUnitsOf(rootScope)),
+                            typeTable, rootScope, maps);
+    }
     auto pdbRoot = std::make_unique<PdbNode>();
     pdbRoot->leafKind = 0x1234; // fake
     pdbRoot->prettyName = "PdbRootFromDwarf";
@@ -29,3 +41,272 @@ void DwarfToPdb::emitTypesAsPdb(
     //   assign a fresh CodeView TI if not present in maps.irToPdbTI
     //   create child PdbNode for LF_STRUCTURE / LF_UNION / LF_ARRAY / etc.
 }
+
+std::unique_ptr<PdbNode> DwarfToPdb::translateUnit(
+    const IRScope& cuScope,
+    IRTypeTable& typeTable,
+    IRMaps& maps
+) {
+    auto modNode = std::make_unique<PdbNode>();
+    modNode->leafKind = 0x113c; // S_COMPILE3 heads each module stream
+    modNode->prettyName = cuScope.name;
+
+    emitScopeTypesAsPdb(cuScope, typeTable, maps, *modNode);
+    emitScopeLocalsAsPdb(cuScope, nullptr, cuScope.locations.get(), *modNode);
+    std::vector<std::uint32_t> checksumOffsets;
+    emitLinesAsPdb(cuScope, *modNode, checksumOffsets);
+    emitInlineSitesAsPdb(cuScope, maps, checksumOffsets, *modNode);
+    return modNode;
+}
+
+void DwarfToPdb::emitScopeTypesAsPdb(
+    const IRScope& scope,
+    IRTypeTable& typeTable,
+    IRMaps& maps,
+    PdbNode& moduleNode
+) {
+    for (IRTypeID id : scope.declaredTypes) {
+        const IRType* t = typeTable.lookup(id);
+        if (!t) continue;
+
+        const std::uint32_t* known = maps.irToPdbTI.find(id);
+        std::uint32_t ti = 0;
+        if (known) {
+            ti = *known;
+        } else {
+            ti = nextTI++;
+            maps.linkPdb(id, ti);
+        }
+
+        auto rec = std::make_unique<PdbNode>();
+        switch (t->kind) {
+        case IRTypeKind::StructOrUnion:
+            rec->leafKind = t->isUnion ? 0x1506 /* LF_UNION */
+                                       : 0x1505 /* LF_STRUCTURE */;
+            break;
+        case IRTypeKind::Array:   rec->leafKind = 0x1503; break; // LF_ARRAY
+        case IRTypeKind::Pointer: rec->leafKind = 0x1002; break; // LF_POINTER
+        default: break;
+        }
+        rec->typeIndexOrSymOffset = ti;
+        rec->prettyName = t->name.str();
+        rec->parent = &moduleNode;
+        moduleNode.children.push_back(std::move(rec));
+    }
+
+    for (const auto& child : scope.children) {
+        emitScopeTypesAsPdb(*child, typeTable, maps, moduleNode);
+    }
+}
+
+namespace {
+
+// Appends the defrange record(s) for one location over [begin, end).
+// CodeView-format locations (from a PDB input) are copied verbatim.
+void AppendLocation(const IRLocationPool& pool,
+                    IRLocID id,
+                    std::uint64_t begin,
+                    std::uint64_t end,
+                    std::vector<std::uint8_t>& out) {
+    IRBytes b = pool.bytes(id);
+    if (pool.format(id) == IRLocFormat::CodeViewDefRange) {
+        out.insert(out.end(), b.data, b.data + b.size);
+        return;
+    }
+    SimpleLocation loc = DecodeDwarfLocation(b);
+    // TODO: section-relative fixups; offsets are image-relative for now.
+    AppendDefRange(loc, static_cast<std::uint32_t>(begin), 0,
+                   static_cast<std::uint32_t>(end - begin), out);
+}
+
+} // namespace
+
+void DwarfToPdb::emitScopeLocalsAsPdb(
+    const IRScope& scope,
+    const IRScope* function,
+    const IRLocationPool* pool,
+    PdbNode& moduleNode
+) {
+    if (scope.kind == IRScopeKind::Function) function = &scope;
+
+    if (function && pool) {
+        for (const IRSymbol& sym : scope.declaredSymbols) {
+            if (sym.kind == IRSymbolKind::Function) continue;
+
+            auto local = std::make_unique<PdbNode>();
+            local->leafKind = 0x113e; // S_LOCAL
+            local->prettyName = sym.name;
+
+            const IRSymbolStorage& st = sym.storage;
+            if (st.rangeCount == 0) {
+                if (st.loc) {
+                    // Whole-scope location: FULL_SCOPE form when possible.
+                    std::uint64_t len = scope.highPC - scope.lowPC;
+                    if (pool->format(st.loc) == IRLocFormat::DwarfExpr &&
+                        DecodeDwarfLocation(pool->bytes(st.loc)).shape ==
+                            LocationShape::FramePointerRel) {
+                        len = 0;
+                    }
+                    AppendLocation(*pool, st.loc, scope.lowPC, scope.lowPC + len,
+                                   local->payload);
+                }
+            } else {
+                auto cursor = pool->ranges(st, function->lowPC);
+                IRLiveRange r;
+                while (cursor.next(r)) {
+                    AppendLocation(*pool, r.loc, r.begin, r.end, local->payload);
+                }
+            }
+
+            local->parent = &moduleNode;
+            moduleNode.children.push_back(std::move(local));
+        }
+    }
+
+    for (const auto& child : scope.children) {
+        emitScopeLocalsAsPdb(*child, function, pool, moduleNode);
+    }
+}
+
+namespace {
+
+void CollectFunctions(const IRScope& scope, std::vector<const IRScope*>& out) {
+    if (scope.kind == IRScopeKind::Function && scope.highPC > scope.lowPC) {
+        out.push_back(&scope);
+    }
+    for (const auto& child : scope.children) CollectFunctions(*child, out);
+}
+
+} // namespace
+
+void DwarfToPdb::emitLinesAsPdb(
+    const IRScope& cuScope,
+    PdbNode& moduleNode,
+    std::vector<std::uint32_t>& checksumOffsets
+) {
+    if (!cuScope.lines) return;
+    const IRLineTable& table = *cuScope.lines;
+
+    auto checksums = std::make_unique<PdbNode>();
+    checksums->leafKind = DEBUG_S_FILECHKSMS;
+    AppendFileChecksums(table, names, checksums->payload, checksumOffsets);
+    checksums->parent = &moduleNode;
+    moduleNode.children.push_back(std::move(checksums));
+
+    std::vector<const IRScope*> functions;
+    CollectFunctions(cuScope, functions);
+    for (const IRScope* fn : functions) {
+        auto lines = std::make_unique<PdbNode>();
+        lines->leafKind = DEBUG_S_LINES;
+        lines->prettyName = fn->name;
+        // TODO: real section index once the writer knows the PE layout.
+        if (!AppendLinesSubsection(table, fn->lowPC, fn->highPC, 1,
+                                   checksumOffsets, lines->payload)) {
+            continue;
+        }
+        lines->parent = &moduleNode;
+        moduleNode.children.push_back(std::move(lines));
+    }
+}
+
+void DwarfToPdb::emitInlineSitesAsPdb(
+    const IRScope& cuScope,
+    IRMaps& maps,
+    const std::vector<std::uint32_t>& checksumOffsets,
+    PdbNode& moduleNode
+) {
+    if (!cuScope.inlinees || cuScope.inlinees->size() == 0) return;
+    const IRInlineeTable& table = *cuScope.inlinees;
+
+    // Map this CU's inlinees onto program-wide LF_FUNC_ID items.
+    std::vector<std::uint32_t> inlineeItems(table.size() + 1, 0);
+    std::vector<InlineeSourceLine> sourceLines;
+    sourceLines.reserve(table.size());
+    for (IRInlineeID id = 1; id <= table.size(); ++id) {
+        const IRInlinee& e = table.get(id);
+        const std::uint32_t* ti = maps.irToPdbTI.find(e.type);
+        std::uint32_t typeIndex = ti ? *ti : 0;
+
+        std::string key = e.name;
+        key.push_back('\0');
+        key.append(reinterpret_cast<const char*>(&typeIndex), sizeof(typeIndex));
+        auto it = funcIds.find(key);
+        if (it == funcIds.end()) {
+            std::uint32_t item = nextItemId++;
+            it = funcIds.emplace(std::move(key), item).first;
+
+            auto rec = std::make_unique<PdbNode>();
+            rec->leafKind = LF_FUNC_ID;
+            rec->typeIndexOrSymOffset = item;
+            rec->prettyName = e.name;
+            AppendFuncIdRecord(0, typeIndex, e.name, rec->payload);
+            rec->parent = &moduleNode;
+            moduleNode.children.push_back(std::move(rec));
+        }
+        inlineeItems[id] = it->second;
+
+        InlineeSourceLine sl;
+        sl.inlinee = it->second;
+        sl.fileId = e.declFile < checksumOffsets.size() ? checksumOffsets[e.declFile] : 0;
+        sl.line = e.declLine;
+        sourceLines.push_back(sl);
+    }
+
+    auto inlineeLines = std::make_unique<PdbNode>();
+    inlineeLines->leafKind = DEBUG_S_INLINEELINES;
+    AppendInlineeLinesSubsection(sourceLines, inlineeLines->payload);
+    inlineeLines->parent = &moduleNode;
+    moduleNode.children.push_back(std::move(inlineeLines));
+
+    // Top-level sites of each function.
+    std::vector<const IRScope*> functions;
+    CollectFunctions(cuScope, functions);
+    for (const IRScope* fn : functions) {
+        std::vector<const IRScope*> sites;
+        CollectInlineSites(*fn, sites);
+        for (const IRScope* site : sites) {
+            emitInlineSite(*site, *fn, cuScope, inlineeItems, checksumOffsets, moduleNode);
+        }
+    }
+}
+
+void DwarfToPdb::emitInlineSite(
+    const IRScope& site,
+    const IRScope& function,
+    const IRScope& cuScope,
+    const std::vector<std::uint32_t>& inlineeItems,
+    const std::vector<std::uint32_t>& checksumOffsets,
+    PdbNode& parentNode
+) {
+    const IRInlineeTable& table = *cuScope.inlinees;
+    std::uint32_t startFile = 0, startLine = 0;
+    std::uint32_t item = 0;
+    if (site.inlinee && site.inlinee <= table.size()) {
+        const IRInlinee& e = table.get(site.inlinee);
+        startFile = e.declFile < checksumOffsets.size() ? checksumOffsets[e.declFile] : 0;
+        startLine = e.declLine;
+        item = inlineeItems[site.inlinee];
+    }
+
+    std::vector<InlineSiteRange> ranges;
+    CollectInlineSiteRanges(site, function, cuScope.locations.get(), cuScope.lines.get(),
+                            checksumOffsets, startFile, startLine, ranges);
+    std::vector<std::uint8_t> annotations;
+    AppendInlineAnnotations(ranges.data(), ranges.size(), startFile, startLine, annotations);
+
+    auto node = std::make_unique<PdbNode>();
+    node->leafKind = S_INLINESITE;
+    node->typeIndexOrSymOffset = item;
+    AppendInlineSiteRecord(item, annotations, node->payload);
+
+    // Nested sites become children, also those inside a block of the
+    // inlined body; the writer closes each with S_INLINESITE_END.
+    std::vector<const IRScope*> nested;
+    CollectInlineSites(site, nested);
+    for (const IRScope* child : nested) {
+        emitInlineSite(*child, function, cuScope, inlineeItems, checksumOffsets, *node);
+    }
+
+    node->parent = &parentNode;
+    parentNode.children.push_back(std::move(node));
+}
@@ -1,10 +1,13 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "../ir/IRNode.h"
 #include "../ir/IRTypeTable.h"
 #include "../ir/IRMaps.h"
 #include "../pdb/PdbNode.h"
+#include "../pdb/CodeViewLines.h"
 
 // DwarfToPdb:
 // Takes IR (which came from DwarfReader) and builds PdbNode model.
@@ -17,10 +20,71 @@ public:
         IRMaps& maps
     );
 
+    // Per-CU translation used by the streaming pipeline: builds one module
+    // node holding the types and symbols introduced by cuScope (and its
+    // nested scopes), assigning fresh TIs in maps.irToPdbTI as it goes.
+    std::unique_ptr<PdbNode> translateUnit(
+        const IRScope& cuScope,
+        IRTypeTable& typeTable,
+        IRMaps& maps
+    );
+
+    // File names referenced by emitted DEBUG_S_FILECHKSMS (the /names stream).
+    const PdbStringTable& stringTable() const { return names; }
+
 private:
+    void emitScopeTypesAsPdb(
+        const IRScope& scope,
+        IRTypeTable& typeTable,
+        IRMaps& maps,
+        PdbNode& moduleNode
+    );
+
+    // S_LOCAL + S_DEFRANGE_* for variables/parameters of Function and
+    // Block scopes. 'function' is the nearest enclosing Function scope.
+    void emitScopeLocalsAsPdb(
+        const IRScope& scope,
+        const IRScope* function,
+        const IRLocationPool* pool,
+        PdbNode& moduleNode
+    );
+
+    // DEBUG_S_FILECHKSMS + one DEBUG_S_LINES per Function scope.
+    // checksumOffsets[i] receives the file id of line-table file i.
+    void emitLinesAsPdb(
+        const IRScope& cuScope,
+        PdbNode& moduleNode,
+        std::vector<std::uint32_t>& checksumOffsets
+    );
+
+    // LF_FUNC_ID (first use program-wide), DEBUG_S_INLINEELINES and the
+    // nested S_INLINESITE tree of every Function scope in the CU.
+    void emitInlineSitesAsPdb(
+        const IRScope& cuScope,
+        IRMaps& maps,
+        const std::vector<std::uint32_t>& checksumOffsets,
+        PdbNode& moduleNode
+    );
+
+    void emitInlineSite(
+        const IRScope& site,
+        const IRScope& function,
+        const IRScope& cuScope,
+        const std::vector<std::uint32_t>& inlineeItems,
+        const std::vector<std::uint32_t>& checksumOffsets,
+        PdbNode& parentNode
+    );
+
     void emitTypesAsPdb(
         IRTypeTable& typeTable,
         IRMaps& maps,
         PdbNode& pdbRoot
     );
+
+    std::uint32_t nextTI = 0x1000; // first non-primitive CodeView TI
+    PdbStringTable names;
+
+    // IPI: one LF_FUNC_ID per distinct (name, function type) across CUs.
+    std::uint32_t nextItemId = 0x1000;
+    std::unordered_map<std::string, std::uint32_t> funcIds;
 };
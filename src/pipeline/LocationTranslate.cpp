@@ -0,0 +1,265 @@
+#include "LocationTranslate.h"
+#include "../pdb/CodeViewSchema.h"
+#include <type_traits>
+
+namespace {
+
+// DWARF x86-64 register numbers 0..16 in CV_AMD64_* numbering.
+const std::uint16_t kDwarfToCvGpr[] = {
+    328, // rax
+    331, // rdx
+    330, // rcx
+    329, // rbx
+    332, // rsi
+    333, // rdi
+    334, // rbp
+    335, // rsp
+    336, 337, 338, 339, 340, 341, 342, 343, // r8..r15
+};
+constexpr std::uint16_t kDwarfXmm0 = 17;
+constexpr std::uint16_t kCvXmm0    = 154;
+
+constexpr std::uint8_t DW_OP_reg0   = 0x50;
+constexpr std::uint8_t DW_OP_breg0  = 0x70;
+constexpr std::uint8_t DW_OP_regx   = 0x90;
+constexpr std::uint8_t DW_OP_fbreg  = 0x91;
+constexpr std::uint8_t DW_OP_bregx  = 0x92;
+
+bool ReadULEB(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v) {
+    v = 0;
+    unsigned shift = 0;
+    while (p < end) {
+        std::uint8_t b = *p++;
+        if (shift < 64) v |= std::uint64_t(b & 0x7f) << shift;
+        shift += 7;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool ReadSLEB(const std::uint8_t*& p, const std::uint8_t* end, std::int64_t& v) {
+    std::uint64_t r = 0;
+    unsigned shift = 0;
+    std::uint8_t b = 0;
+    do {
+        if (p >= end) return false;
+        b = *p++;
+        if (shift < 64) r |= std::uint64_t(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    if (shift < 64 && (b & 0x40)) r |= ~std::uint64_t(0) << shift;
+    v = static_cast<std::int64_t>(r);
+    return true;
+}
+
+void PutULEB(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    do {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        if (v) b |= 0x80;
+        out.push_back(b);
+    } while (v);
+}
+
+void PutSLEB(std::vector<std::uint8_t>& out, std::int64_t v) {
+    bool more = true;
+    while (more) {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        more = !((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40)));
+        if (more) b |= 0x80;
+        out.push_back(b);
+    }
+}
+
+bool FitsInt32(std::int64_t v) {
+    return v >= INT32_MIN && v <= INT32_MAX;
+}
+
+} // namespace
+
+std::uint16_t DwarfRegToCodeView(std::uint16_t dwarfReg) {
+    if (dwarfReg < sizeof(kDwarfToCvGpr) / sizeof(kDwarfToCvGpr[0]))
+        return kDwarfToCvGpr[dwarfReg];
+    if (dwarfReg >= kDwarfXmm0 && dwarfReg < kDwarfXmm0 + 16)
+        return static_cast<std::uint16_t>(kCvXmm0 + (dwarfReg - kDwarfXmm0));
+    return 0;
+}
+
+std::uint16_t CodeViewRegToDwarf(std::uint16_t cvReg) {
+    for (std::uint16_t i = 0; i < sizeof(kDwarfToCvGpr) / sizeof(kDwarfToCvGpr[0]); ++i) {
+        if (kDwarfToCvGpr[i] == cvReg) return i;
+    }
+    if (cvReg >= kCvXmm0 && cvReg < kCvXmm0 + 16)
+        return static_cast<std::uint16_t>(kDwarfXmm0 + (cvReg - kCvXmm0));
+    return 0xFFFF;
+}
+
+SimpleLocation DecodeDwarfLocation(IRBytes expr) {
+    SimpleLocation loc;
+    if (!expr.data || expr.size == 0) return loc;
+
+    const std::uint8_t* p = expr.data;
+    const std::uint8_t* end = expr.data + expr.size;
+    std::uint8_t op = *p++;
+    std::uint64_t reg = 0;
+    std::int64_t  off = 0;
+    bool ok = true;
+
+    if (op >= DW_OP_reg0 && op < DW_OP_reg0 + 32) {
+        loc.shape = LocationShape::Register;
+        reg = op - DW_OP_reg0;
+    } else if (op == DW_OP_regx) {
+        loc.shape = LocationShape::Register;
+        ok = ReadULEB(p, end, reg);
+    } else if (op == DW_OP_fbreg) {
+        loc.shape = LocationShape::FramePointerRel;
+        ok = ReadSLEB(p, end, off);
+    } else if (op >= DW_OP_breg0 && op < DW_OP_breg0 + 32) {
+        loc.shape = LocationShape::RegisterRel;
+        reg = op - DW_OP_breg0;
+        ok = ReadSLEB(p, end, off);
+    } else if (op == DW_OP_bregx) {
+        loc.shape = LocationShape::RegisterRel;
+        ok = ReadULEB(p, end, reg) && ReadSLEB(p, end, off);
+    } else {
+        ok = false;
+    }
+
+    // Anything with trailing ops (pieces, stack_value, ...) is not simple.
+    if (!ok || p != end || reg > 0xFFFF || !FitsInt32(off)) {
+        loc = SimpleLocation{};
+        loc.shape = LocationShape::Complex;
+        return loc;
+    }
+    loc.dwarfReg = static_cast<std::uint16_t>(reg);
+    loc.offset = static_cast<std::int32_t>(off);
+    return loc;
+}
+
+bool AppendDwarfLocation(const SimpleLocation& loc, std::vector<std::uint8_t>& out) {
+    switch (loc.shape) {
+    case LocationShape::Register:
+        if (loc.dwarfReg < 32) {
+            out.push_back(static_cast<std::uint8_t>(DW_OP_reg0 + loc.dwarfReg));
+        } else {
+            out.push_back(DW_OP_regx);
+            PutULEB(out, loc.dwarfReg);
+        }
+        return true;
+    case LocationShape::FramePointerRel:
+        out.push_back(DW_OP_fbreg);
+        PutSLEB(out, loc.offset);
+        return true;
+    case LocationShape::RegisterRel:
+        if (loc.dwarfReg < 32) {
+            out.push_back(static_cast<std::uint8_t>(DW_OP_breg0 + loc.dwarfReg));
+        } else {
+            out.push_back(DW_OP_bregx);
+            PutULEB(out, loc.dwarfReg);
+        }
+        PutSLEB(out, loc.offset);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool AppendDefRange(const SimpleLocation& loc,
+                    std::uint32_t offStart,
+                    std::uint16_t section,
+                    std::uint32_t length,
+                    std::vector<std::uint8_t>& out) {
+    std::uint16_t cvReg = 0;
+    if (loc.shape == LocationShape::Register || loc.shape == LocationShape::RegisterRel) {
+        cvReg = DwarfRegToCodeView(loc.dwarfReg);
+        if (!cvReg) return false;
+    }
+
+    // DW_OP_fbreg is relative to DW_AT_frame_base; we treat that as the
+    // frame pointer S_FRAMEPROC describes, as the MSVC/LLVM emitters do.
+    if (loc.shape == LocationShape::FramePointerRel && length == 0) {
+        cv::SDefRangeFramePointerRelFullScope::encode({loc.offset}, out);
+        return true;
+    }
+
+    do {
+        std::uint16_t chunk = length > 0xFFFF ? 0xFFFF : static_cast<std::uint16_t>(length);
+        switch (loc.shape) {
+        case LocationShape::Register:
+            // attr 0: not a may-have-no-name
+            cv::SDefRangeRegister::encode({cvReg, std::uint16_t(0), offStart, section, chunk, IRBytes{}}, out);
+            break;
+        case LocationShape::FramePointerRel:
+            cv::SDefRangeFramePointerRel::encode({loc.offset, offStart, section, chunk, IRBytes{}}, out);
+            break;
+        case LocationShape::RegisterRel:
+            // flags 0: no spilled UDT member / parent offset
+            cv::SDefRangeRegisterRel::encode(
+                {cvReg, std::uint16_t(0), loc.offset, offStart, section, chunk, IRBytes{}}, out);
+            break;
+        default:
+            return false;
+        }
+        offStart += chunk;
+        length -= chunk;
+    } while (length > 0);
+    return true;
+}
+
+SimpleLocation DecodeDefRange(IRBytes record,
+                              std::uint32_t* offStart,
+                              std::uint16_t* section,
+                              std::uint16_t* length) {
+    SimpleLocation loc;
+    if (!record.data || record.size < 4) return loc;
+
+    std::uint32_t rangeStart = 0;
+    std::uint16_t rangeSection = 0, rangeLength = 0;
+    auto range = [&](auto rec, const auto& v) {
+        using Rec = decltype(rec);
+        rangeStart = std::get<Rec::OffsetStart>(v);
+        rangeSection = std::get<Rec::Section>(v);
+        rangeLength = std::get<Rec::Length>(v);
+    };
+    bool known = cv::Dispatch<cv::SDefRangeRegister, cv::SDefRangeFramePointerRel,
+                              cv::SDefRangeRegisterRel, cv::SDefRangeFramePointerRelFullScope>(
+        schema::LoadLE<std::uint16_t>(record.data + 2), [&](auto rec) {
+            using Rec = decltype(rec);
+            typename Rec::Values v;
+            if (!Rec::decode(record, v)) return;
+            if constexpr (std::is_same<Rec, cv::SDefRangeRegister>::value) {
+                loc.shape = LocationShape::Register;
+                loc.dwarfReg = CodeViewRegToDwarf(std::get<Rec::Register>(v));
+                range(rec, v);
+            } else if constexpr (std::is_same<Rec, cv::SDefRangeFramePointerRel>::value) {
+                loc.shape = LocationShape::FramePointerRel;
+                loc.offset = std::get<Rec::Offset>(v);
+                range(rec, v);
+            } else if constexpr (std::is_same<Rec, cv::SDefRangeRegisterRel>::value) {
+                loc.shape = LocationShape::RegisterRel;
+                loc.dwarfReg = CodeViewRegToDwarf(std::get<Rec::Register>(v));
+                loc.offset = std::get<Rec::BaseOffset>(v);
+                range(rec, v);
+            } else {
+                loc.shape = LocationShape::FramePointerRel; // FULL_SCOPE: no range
+                loc.offset = std::get<Rec::Offset>(v);
+            }
+        });
+    if (!known) {
+        loc.shape = LocationShape::Complex;
+        return loc;
+    }
+    if (loc.shape == LocationShape::None) return loc; // truncated record
+
+    if (loc.dwarfReg == 0xFFFF) {
+        loc = SimpleLocation{};
+        loc.shape = LocationShape::Complex;
+        return loc;
+    }
+
+    if (offStart) *offStart = rangeStart;
+    if (section)  *section = rangeSection;
+    if (length)   *length = rangeLength;
+    return loc;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../ir/IRLocation.h"
+
+// LocationTranslate:
+// Direct conversion between DWARF location expressions and CodeView
+// S_DEFRANGE_* records for the shapes both formats share. Everything goes
+// through a stack-only SimpleLocation; anything else is reported as
+// Complex and left to the caller (e.g. kept as an opaque DWARF expression).
+//
+// Register numbers are DWARF x86-64 numbers; CodeView uses CV_AMD64_*.
+
+enum class LocationShape : std::uint8_t {
+    None,
+    Register,         // DW_OP_reg*/regx       <-> S_DEFRANGE_REGISTER
+    FramePointerRel,  // DW_OP_fbreg           <-> S_DEFRANGE_FRAMEPOINTER_REL(_FULL_SCOPE)
+    RegisterRel,      // DW_OP_breg*/bregx     <-> S_DEFRANGE_REGISTER_REL
+    Complex
+};
+
+struct SimpleLocation {
+    LocationShape shape    = LocationShape::None;
+    std::uint16_t dwarfReg = 0;
+    std::int32_t  offset   = 0;
+};
+
+// CodeView record kinds handled here.
+constexpr std::uint16_t S_DEFRANGE_REGISTER                   = 0x1141;
+constexpr std::uint16_t S_DEFRANGE_FRAMEPOINTER_REL           = 0x1142;
+constexpr std::uint16_t S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE = 0x1144;
+constexpr std::uint16_t S_DEFRANGE_REGISTER_REL               = 0x1145;
+
+// Returns 0 when the register has no counterpart.
+std::uint16_t DwarfRegToCodeView(std::uint16_t dwarfReg);
+// Returns 0xFFFF when the register has no counterpart.
+std::uint16_t CodeViewRegToDwarf(std::uint16_t cvReg);
+
+SimpleLocation DecodeDwarfLocation(IRBytes expr);
+bool AppendDwarfLocation(const SimpleLocation& loc, std::vector<std::uint8_t>& out);
+
+// Appends S_DEFRANGE_* record(s) covering [offStart, offStart + length) in
+// 'section'. CodeView ranges are 16-bit, so long ranges become several
+// records. length == 0 with FramePointerRel emits the FULL_SCOPE form.
+bool AppendDefRange(const SimpleLocation& loc,
+                    std::uint32_t offStart,
+                    std::uint16_t section,
+                    std::uint32_t length,
+                    std::vector<std::uint8_t>& out);
+
+// Decodes one complete S_DEFRANGE_* record (length prefix included).
+// Range fields are optional outputs; FULL_SCOPE records report length 0.
+SimpleLocation DecodeDefRange(IRBytes record,
+                              std::uint32_t* offStart = nullptr,
+                              std::uint16_t* section  = nullptr,
+                              std::uint16_t* length   = nullptr);
@@ -0,0 +1,61 @@
+#include "OutputVerify.h"
+#include <fstream>
+#include <vector>
+#include "../dwarf/DwarfVerifier.h"
+#include "../pdb/PdbVerifier.h"
+
+namespace {
+
+bool LoadFile(const std::string& path, std::vector<std::uint8_t>& bytes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    bytes.resize(static_cast<std::size_t>(size));
+    in.seekg(0);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(bytes.data()), size));
+}
+
+} // namespace
+
+VerifyReport VerifyDwarfOutput(const std::string& path, const IRMaps* maps, unsigned jobs) {
+    VerifyReport report;
+    std::vector<std::uint8_t> bytes;
+    if (!LoadFile(path, bytes)) {
+        report.fail("file", 0, "cannot read " + path);
+        return report;
+    }
+    DwarfSections sections;
+    std::string error;
+    if (!FindDwarfSections(IRBytes{bytes.data(), bytes.size()}, sections, error)) {
+        report.fail("file", 0, error);
+        return report;
+    }
+    return VerifyDwarf(sections, maps, jobs);
+}
+
+VerifyReport VerifyPdbOutput(const std::string& path, const IRMaps* maps, unsigned jobs) {
+    std::vector<std::uint8_t> bytes;
+    if (!LoadFile(path, bytes)) {
+        VerifyReport report;
+        report.fail("file", 0, "cannot read " + path);
+        return report;
+    }
+    return VerifyPdb(IRBytes{bytes.data(), bytes.size()}, maps, jobs);
+}
+
+void PrintVerifyReport(std::ostream& os, const std::string& path, const VerifyReport& report) {
+    std::string opaque;
+    if (report.opaqueDecls) opaque = ", " + std::to_string(report.opaqueDecls) + " opaque forward decl(s)";
+    if (report.ok()) {
+        os << "[Verify] " << path << ": OK (" << report.itemsChecked << " item(s) checked" << opaque << ")\n";
+        return;
+    }
+    os << "[Verify] " << path << ": " << report.problemCount << " problem(s)" << opaque << "\n";
+    for (const VerifyProblem& p : report.problems) {
+        os << "  " << p.where << "+0x" << std::hex << p.offset << std::dec << ": " << p.message << "\n";
+    }
+    if (report.problemCount > report.problems.size()) {
+        os << "  ... " << (report.problemCount - report.problems.size()) << " more\n";
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include "../ir/IRMaps.h"
+#include "../util/VerifyReport.h"
+
+// --verify: loads a file the pipeline produced and runs DwarfVerifier or
+// PdbVerifier over it, cross-checking the offsets/TIs the writer recorded
+// in 'maps' (optional). A file that cannot be read is reported as a problem.
+VerifyReport VerifyDwarfOutput(const std::string& path, const IRMaps* maps, unsigned jobs = 0);
+VerifyReport VerifyPdbOutput(const std::string& path, const IRMaps* maps, unsigned jobs = 0);
+
+void PrintVerifyReport(std::ostream& os, const std::string& path, const VerifyReport& report);
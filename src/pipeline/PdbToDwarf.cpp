@@ -1,4 +1,7 @@
 #include "PdbToDwarf.h"
+#include "../dwarf/DwarfLineProgram.h"
+#include "../ir/IRCanonicalOrder.h"
+#include "../ir/IRForwardDecls.h"
 #include <iostream>
 
 std::unique_ptr<DwarfNode> PdbToDwarf::translate(
@@ -7,7 +10,15 @@ std::unique_ptr<DwarfNode> PdbToDwarf::translate(
     IRMaps& maps
 ) {
     std::cout << "[PdbToDwarf] translate IR -> DWARF model (stub)\n";
-    (void)rootScope;
+    // Whole-program input: point references to forward decls at their
+    // definitions before any type is emitted, then renumber types in a
+    // content-derived order so TIs / DIE offsets are reproducible.
+    IRForwardResolution fwd = ResolveForwardDecls(typeTable);
+    if (rootScope) {
+        fwd.rewrite(*rootScope);
+        ApplyCanonicalOrder(ComputeCanonicalOrder(typeTable, CompileUnitsOf(rootScope)),
+                            typeTable, rootScope, maps);
+    }
 
     auto cuNode = std::make_unique<DwarfNode>();
     cuNode->tag = 0x11; // pretend DW_TAG_compile_unit
@@ -31,3 +42,171 @@ void PdbToDwarf::emitTypesAsDwarf(
     //   make children DwarfNode for DW_TAG_structure_type / union / array / pointer
     //   attach DW_AT_bit_size, DW_AT_data_member_location, etc.
 }
+
+std::unique_ptr<DwarfNode> PdbToDwarf::translateUnit(
+    const IRScope& unitScope,
+    IRTypeTable& typeTable,
+    IRMaps& maps
+) {
+    auto cuNode = std::make_unique<DwarfNode>();
+    cuNode->tag = 0x11; // DW_TAG_compile_unit
+    cuNode->attrsStr.push_back({0x03, unitScope.name}); // DW_AT_name
+    cuNode->originalDieOffset = nextDieOffset++;
+
+    emitScopeTypesAsDwarf(unitScope, typeTable, maps, *cuNode);
+    emitCodeScopesAsDwarf(unitScope, maps, *cuNode);
+    if (unitScope.lines) {
+        EncodeLineProgram(*unitScope.lines, cuNode->lineProgram);
+    }
+    return cuNode;
+}
+
+void PdbToDwarf::emitScopeTypesAsDwarf(
+    const IRScope& scope,
+    IRTypeTable& typeTable,
+    IRMaps& maps,
+    DwarfNode& dwarfCU
+) {
+    for (IRTypeID id : scope.declaredTypes) {
+        const IRType* t = typeTable.lookup(id);
+        if (!t) continue;
+
+        const std::uint64_t* known = maps.irToDwarfDie.find(id);
+        std::uint64_t off = 0;
+        if (known) {
+            off = *known;
+        } else {
+            off = nextDieOffset++;
+            maps.linkDwarf(id, off);
+        }
+
+        auto die = std::make_unique<DwarfNode>();
+        switch (t->kind) {
+        case IRTypeKind::StructOrUnion:
+            die->tag = t->isUnion ? 0x17 /* DW_TAG_union_type */
+                                  : 0x13 /* DW_TAG_structure_type */;
+            break;
+        case IRTypeKind::Array:   die->tag = 0x01; break; // DW_TAG_array_type
+        case IRTypeKind::Pointer: die->tag = 0x0f; break; // DW_TAG_pointer_type
+        default: break;
+        }
+        die->attrsStr.push_back({0x03, t->name.str()});          // DW_AT_name
+        die->attrsU64.push_back({0x0b, t->sizeBytes});     // DW_AT_byte_size
+        die->originalDieOffset = off;
+        die->parent = &dwarfCU;
+        dwarfCU.children.push_back(std::move(die));
+    }
+
+    for (const auto& child : scope.children) {
+        emitScopeTypesAsDwarf(*child, typeTable, maps, dwarfCU);
+    }
+}
+
+namespace {
+
+// DW_TAG_* / DW_AT_* used for code scopes.
+constexpr std::uint16_t DW_TAG_lexical_block      = 0x0b;
+constexpr std::uint16_t DW_TAG_inlined_subroutine = 0x1d;
+constexpr std::uint16_t DW_TAG_subprogram         = 0x2e;
+constexpr std::uint16_t DW_AT_name                = 0x03;
+constexpr std::uint16_t DW_AT_low_pc              = 0x11;
+constexpr std::uint16_t DW_AT_high_pc             = 0x12;
+constexpr std::uint16_t DW_AT_inline              = 0x20;
+constexpr std::uint16_t DW_AT_abstract_origin     = 0x31;
+constexpr std::uint16_t DW_AT_decl_file           = 0x3a;
+constexpr std::uint16_t DW_AT_decl_line           = 0x3b;
+constexpr std::uint16_t DW_AT_type                = 0x49;
+constexpr std::uint16_t DW_AT_call_column         = 0x57;
+constexpr std::uint16_t DW_AT_call_file           = 0x58;
+constexpr std::uint16_t DW_AT_call_line           = 0x59;
+constexpr std::uint64_t DW_INL_inlined            = 1;
+
+} // namespace
+
+void PdbToDwarf::emitCodeScopesAsDwarf(
+    const IRScope& unitScope,
+    const IRMaps& maps,
+    DwarfNode& dwarfCU
+) {
+    // Abstract origins first so inline sites can reference them by offset.
+    std::vector<std::uint64_t> abstractOrigins;
+    if (unitScope.inlinees) {
+        const IRInlineeTable& table = *unitScope.inlinees;
+        abstractOrigins.resize(table.size() + 1, 0);
+        for (IRInlineeID id = 1; id <= table.size(); ++id) {
+            const IRInlinee& e = table.get(id);
+            auto die = std::make_unique<DwarfNode>();
+            die->tag = DW_TAG_subprogram;
+            die->originalDieOffset = nextDieOffset++;
+            die->attrsStr.push_back({DW_AT_name, e.name});
+            die->attrsU64.push_back({DW_AT_inline, DW_INL_inlined});
+            die->attrsU64.push_back({DW_AT_decl_file, e.declFile});
+            die->attrsU64.push_back({DW_AT_decl_line, e.declLine});
+            if (const std::uint64_t* ty = maps.irToDwarfDie.find(e.type)) {
+                die->attrsU64.push_back({DW_AT_type, *ty});
+            }
+            abstractOrigins[id] = die->originalDieOffset;
+            die->parent = &dwarfCU;
+            dwarfCU.children.push_back(std::move(die));
+        }
+    }
+
+    for (const auto& child : unitScope.children) {
+        emitCodeScope(*child, abstractOrigins, dwarfCU);
+    }
+}
+
+void PdbToDwarf::emitCodeScope(
+    const IRScope& scope,
+    const std::vector<std::uint64_t>& abstractOrigins,
+    DwarfNode& parentDie
+) {
+    DwarfNode* target = &parentDie;
+    std::unique_ptr<DwarfNode> die;
+
+    switch (scope.kind) {
+    case IRScopeKind::Function:
+        die = std::make_unique<DwarfNode>();
+        die->tag = DW_TAG_subprogram;
+        die->attrsStr.push_back({DW_AT_name, scope.name});
+        break;
+    case IRScopeKind::Block:
+        die = std::make_unique<DwarfNode>();
+        die->tag = DW_TAG_lexical_block;
+        break;
+    case IRScopeKind::Inlined:
+        die = std::make_unique<DwarfNode>();
+        if (!scope.inlinee || scope.inlinee >= abstractOrigins.size()) {
+            // Nothing to name as the origin: keep the range as a plain block.
+            die->tag = DW_TAG_lexical_block;
+            break;
+        }
+        die->tag = DW_TAG_inlined_subroutine;
+        die->attrsU64.push_back({DW_AT_abstract_origin, abstractOrigins[scope.inlinee]});
+        die->attrsU64.push_back({DW_AT_call_file, scope.callFile});
+        die->attrsU64.push_back({DW_AT_call_line, scope.callLine});
+        die->attrsU64.push_back({DW_AT_call_column, scope.callColumn});
+        break;
+    default:
+        break; // namespaces etc. carry no code; just descend
+    }
+
+    if (die) {
+        die->originalDieOffset = nextDieOffset++;
+        // TODO: DW_AT_ranges for discontiguous scopes (codeRanges).
+        if (scope.highPC > scope.lowPC) {
+            die->attrsU64.push_back({DW_AT_low_pc, scope.lowPC});
+            die->attrsU64.push_back({DW_AT_high_pc, scope.highPC - scope.lowPC});
+        }
+        target = die.get();
+    }
+
+    for (const auto& child : scope.children) {
+        emitCodeScope(*child, abstractOrigins, *target);
+    }
+
+    if (die) {
+        die->parent = &parentDie;
+        parentDie.children.push_back(std::move(die));
+    }
+}
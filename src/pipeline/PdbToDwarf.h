@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <vector>
 #include "../ir/IRNode.h"
 #include "../ir/IRTypeTable.h"
 #include "../ir/IRMaps.h"
@@ -17,10 +18,44 @@ public:
         IRMaps& maps
     );
 
+    // Per-module translation used by the streaming pipeline: builds one
+    // DW_TAG_compile_unit node for the types introduced by unitScope (and
+    // its nested scopes), assigning DIE offsets in maps.irToDwarfDie.
+    std::unique_ptr<DwarfNode> translateUnit(
+        const IRScope& unitScope,
+        IRTypeTable& typeTable,
+        IRMaps& maps
+    );
+
 private:
+    void emitScopeTypesAsDwarf(
+        const IRScope& scope,
+        IRTypeTable& typeTable,
+        IRMaps& maps,
+        DwarfNode& dwarfCU
+    );
+
+    // One abstract DW_TAG_subprogram (DW_AT_inline) per inlinee, then a
+    // DW_TAG_subprogram per Function scope with its DW_TAG_lexical_block /
+    // DW_TAG_inlined_subroutine tree pointing back via DW_AT_abstract_origin.
+    void emitCodeScopesAsDwarf(
+        const IRScope& unitScope,
+        const IRMaps& maps,
+        DwarfNode& dwarfCU
+    );
+
+    void emitCodeScope(
+        const IRScope& scope,
+        const std::vector<std::uint64_t>& abstractOrigins,
+        DwarfNode& parentDie
+    );
+
     void emitTypesAsDwarf(
         IRTypeTable& typeTable,
         IRMaps& maps,
         DwarfNode& dwarfCU
     );
+
+    // Placeholder offsets; the writer relocates once DIE sizes are known.
+    std::uint64_t nextDieOffset = 0x2000;
 };
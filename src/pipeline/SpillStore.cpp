@@ -0,0 +1,596 @@
+#include "SpillStore.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "../util/RecordSchema.h"
+
+namespace {
+
+// ---- platform layer: one temp file, positional writes, read-only maps ----
+// A file is an fd on POSIX and a HANDLE on Windows, both kept as intptr_t
+// with -1 meaning none.
+
+#ifdef _WIN32
+
+std::string LastErrorText() {
+    return "error " + std::to_string(GetLastError());
+}
+
+std::intptr_t OpenTempFile(const std::string& dir) {
+    std::string d = dir;
+    if (d.empty()) {
+        char buf[MAX_PATH + 1];
+        DWORD n = GetTempPathA(sizeof(buf), buf);
+        if (n == 0 || n > MAX_PATH) return -1;
+        d.assign(buf, n);
+    }
+    char name[MAX_PATH + 1];
+    if (!GetTempFileNameA(d.c_str(), "d2p", 0, name)) return -1;
+    // Deleted by the system when the handle is closed, however the
+    // process ends.
+    HANDLE h = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                           FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    return h == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<std::intptr_t>(h);
+}
+
+void CloseFile(std::intptr_t f) {
+    CloseHandle(reinterpret_cast<HANDLE>(f));
+}
+
+bool WriteAt(std::intptr_t f, const std::uint8_t* data, std::size_t size, std::uint64_t offset) {
+    while (size) {
+        OVERLAPPED ov = {};
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(size < 0x40000000 ? size : 0x40000000);
+        DWORD n = 0;
+        if (!WriteFile(reinterpret_cast<HANDLE>(f), data, chunk, &n, &ov) || n == 0) return false;
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+std::uint64_t MapGranularity() {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwAllocationGranularity;
+}
+
+void* MapRange(std::intptr_t f, std::uint64_t start, std::size_t length) {
+    std::uint64_t last = start + length;
+    HANDLE m = CreateFileMappingA(reinterpret_cast<HANDLE>(f), nullptr, PAGE_READONLY,
+                                  static_cast<DWORD>(last >> 32), static_cast<DWORD>(last), nullptr);
+    if (!m) return nullptr;
+    void* base = MapViewOfFile(m, FILE_MAP_READ, static_cast<DWORD>(start >> 32),
+                               static_cast<DWORD>(start), length);
+    CloseHandle(m); // the view keeps the mapping alive
+    return base;
+}
+
+void UnmapRange(void* base, std::size_t) {
+    UnmapViewOfFile(base);
+}
+
+void PunchHole(std::intptr_t, std::uint64_t, std::uint64_t) {
+    // Not sparse on Windows; the file goes away with the handle.
+}
+
+#else
+
+std::string LastErrorText() {
+    return std::strerror(errno);
+}
+
+std::intptr_t OpenTempFile(const std::string& dir) {
+    std::string d = dir;
+    if (d.empty()) {
+        const char* tmp = std::getenv("TMPDIR");
+        d = tmp && *tmp ? tmp : "/tmp";
+    }
+    std::string path = d + "/dwarf2pdb-spill-XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+    int fd = mkstemp(name.data());
+    // Unlinked right away: the space goes back to the system however the
+    // process ends.
+    if (fd >= 0) unlink(name.data());
+    return fd;
+}
+
+void CloseFile(std::intptr_t f) {
+    close(static_cast<int>(f));
+}
+
+bool WriteAt(std::intptr_t f, const std::uint8_t* data, std::size_t size, std::uint64_t offset) {
+    while (size) {
+        ssize_t n = pwrite(static_cast<int>(f), data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+std::uint64_t MapGranularity() {
+    return static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+void* MapRange(std::intptr_t f, std::uint64_t start, std::size_t length) {
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, static_cast<int>(f), static_cast<off_t>(start));
+    return base == MAP_FAILED ? nullptr : base;
+}
+
+void UnmapRange(void* base, std::size_t length) {
+    munmap(base, length);
+}
+
+void PunchHole(std::intptr_t f, std::uint64_t offset, std::uint64_t size) {
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+    fallocate(static_cast<int>(f), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+              static_cast<off_t>(offset), static_cast<off_t>(size));
+#else
+    (void)f;
+    (void)offset;
+    (void)size;
+#endif
+}
+
+#endif
+
+std::size_t StringHeap(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0; // beyond the SSO buffer
+}
+
+template <typename T>
+std::size_t VectorHeap(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+class SpillWriter {
+public:
+    explicit SpillWriter(std::vector<std::uint8_t>& out) : out(out) {}
+
+    void u(std::uint64_t v) { schema::Uleb::write(out, v); }
+    void s(const std::string& v) {
+        u(v.size());
+        out.insert(out.end(), v.begin(), v.end());
+    }
+    template <typename T>
+    void vec(const std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain arrays only");
+        u(v.size());
+        const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(v.data());
+        out.insert(out.end(), p, p + v.size() * sizeof(T));
+    }
+    void storage(const IRSymbolStorage& st) {
+        u(st.loc);
+        u(st.rangeOffset);
+        u(st.rangeCount);
+    }
+
+    std::vector<std::uint8_t>& out;
+};
+
+class SpillReader {
+public:
+    explicit SpillReader(IRBytes in) : p(in.data), end(in.data + in.size) {}
+
+    std::uint64_t u() {
+        std::uint64_t v = 0;
+        if (!schema::Uleb::read(p, end, v)) fail();
+        return v;
+    }
+    std::uint32_t u32() { return static_cast<std::uint32_t>(u()); }
+    std::string s() {
+        std::uint64_t n = u();
+        if (n > remaining()) fail();
+        std::string v(reinterpret_cast<const char*>(p), static_cast<std::size_t>(n));
+        p += n;
+        return v;
+    }
+    template <typename T>
+    void vec(std::vector<T>& v) {
+        std::uint64_t n = u();
+        if (n > remaining() / sizeof(T)) fail();
+        v.resize(static_cast<std::size_t>(n));
+        if (n) std::memcpy(v.data(), p, v.size() * sizeof(T));
+        p += v.size() * sizeof(T);
+    }
+    IRSymbolStorage storage() {
+        IRSymbolStorage st;
+        st.loc = u32();
+        st.rangeOffset = u32();
+        st.rangeCount = u32();
+        return st;
+    }
+    // Element counts are checked against the bytes left (>= 1 byte each).
+    std::size_t count() {
+        std::uint64_t n = u();
+        if (n > remaining()) fail();
+        return static_cast<std::size_t>(n);
+    }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end - p); }
+    [[noreturn]] static void fail() { throw std::runtime_error("spill: corrupt record"); }
+
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+};
+
+enum ScopeParts : std::uint8_t { HasLocations = 1, HasLines = 2, HasInlinees = 4 };
+
+void EncodeLines(const IRLineTable& t, SpillWriter& w) {
+    w.u(t.files.size());
+    for (const IRLineFile& f : t.files) {
+        w.s(f.path);
+        w.out.push_back(f.checksumKind);
+        w.out.insert(w.out.end(), f.checksum, f.checksum + sizeof(f.checksum));
+    }
+    w.vec(t.address);
+    w.vec(t.file);
+    w.vec(t.line);
+    w.vec(t.column);
+    w.vec(t.flags);
+    w.vec(t.sequences);
+}
+
+void DecodeLines(SpillReader& r, IRLineTable& t) {
+    t.files.resize(r.count());
+    for (IRLineFile& f : t.files) {
+        f.path = r.s();
+        if (r.remaining() < 1 + sizeof(f.checksum)) r.fail();
+        f.checksumKind = *r.p++;
+        std::memcpy(f.checksum, r.p, sizeof(f.checksum));
+        r.p += sizeof(f.checksum);
+    }
+    r.vec(t.address);
+    r.vec(t.file);
+    r.vec(t.line);
+    r.vec(t.column);
+    r.vec(t.flags);
+    r.vec(t.sequences);
+    std::size_t rows = t.address.size();
+    if (t.file.size() != rows || t.line.size() != rows || t.column.size() != rows || t.flags.size() != rows) {
+        r.fail();
+    }
+}
+
+void EncodeScope(const IRScope& scope, SpillWriter& w) {
+    w.u(static_cast<std::uint64_t>(scope.kind));
+    w.s(scope.name);
+    w.u(scope.lowPC);
+    w.u(scope.highPC);
+    w.storage(scope.codeRanges);
+    w.u(scope.inlinee);
+    w.u(scope.callFile);
+    w.u(scope.callLine);
+    w.u(scope.callColumn);
+    w.u(scope.image);
+
+    w.u((scope.locations ? HasLocations : 0) | (scope.lines ? HasLines : 0) |
+        (scope.inlinees ? HasInlinees : 0));
+    if (scope.locations) scope.locations->save(w.out);
+    if (scope.lines) EncodeLines(*scope.lines, w);
+    if (scope.inlinees) {
+        w.u(scope.inlinees->size());
+        for (std::size_t i = 1; i <= scope.inlinees->size(); ++i) {
+            const IRInlinee& e = scope.inlinees->get(static_cast<IRInlineeID>(i));
+            w.s(e.name);
+            w.u(e.type);
+            w.u(e.originKey);
+            w.u(e.declFile);
+            w.u(e.declLine);
+        }
+    }
+
+    w.vec(scope.declaredTypes);
+    w.u(scope.declaredSymbols.size());
+    for (const IRSymbol& sym : scope.declaredSymbols) {
+        w.s(sym.name);
+        w.u(static_cast<std::uint64_t>(sym.kind));
+        w.u(sym.type);
+        w.storage(sym.storage);
+    }
+    w.u(scope.children.size());
+    for (const auto& child : scope.children) EncodeScope(*child, w);
+}
+
+std::unique_ptr<IRScope> DecodeScope(SpillReader& r, IRScope* parent) {
+    auto scope = std::make_unique<IRScope>();
+    scope->parent = parent;
+    scope->kind = static_cast<IRScopeKind>(r.u());
+    scope->name = r.s();
+    scope->lowPC = r.u();
+    scope->highPC = r.u();
+    scope->codeRanges = r.storage();
+    scope->inlinee = r.u32();
+    scope->callFile = r.u32();
+    scope->callLine = r.u32();
+    scope->callColumn = static_cast<std::uint16_t>(r.u());
+    scope->image = static_cast<std::uint16_t>(r.u());
+
+    std::uint64_t parts = r.u();
+    if (parts & HasLocations) {
+        scope->locations = std::make_unique<IRLocationPool>();
+        if (!scope->locations->load(r.p, r.end)) r.fail();
+    }
+    if (parts & HasLines) {
+        scope->lines = std::make_unique<IRLineTable>();
+        DecodeLines(r, *scope->lines);
+    }
+    if (parts & HasInlinees) {
+        scope->inlinees = std::make_unique<IRInlineeTable>();
+        for (std::size_t i = 0, n = r.count(); i < n; ++i) {
+            std::string name = r.s();
+            std::uint32_t type = r.u32();
+            std::uint64_t originKey = r.u();
+            IRInlinee& e = scope->inlinees->get(scope->inlinees->intern(originKey, name, type));
+            e.declFile = r.u32();
+            e.declLine = r.u32();
+        }
+    }
+
+    r.vec(scope->declaredTypes);
+    scope->declaredSymbols.resize(r.count());
+    for (IRSymbol& sym : scope->declaredSymbols) {
+        sym.name = r.s();
+        sym.kind = static_cast<IRSymbolKind>(r.u());
+        sym.type = r.u32();
+        sym.storage = r.storage();
+    }
+    scope->children.resize(r.count());
+    for (auto& child : scope->children) child = DecodeScope(r, scope.get());
+    return scope;
+}
+
+void EncodePdbNode(const PdbNode& node, SpillWriter& w) {
+    w.u(node.leafKind);
+    w.vec(node.payload);
+    w.u(node.typeIndexOrSymOffset);
+    w.s(node.prettyName);
+    w.s(node.uniqueName);
+    w.u(node.children.size());
+    for (const auto& child : node.children) EncodePdbNode(*child, w);
+}
+
+std::unique_ptr<PdbNode> DecodePdbNode(SpillReader& r, PdbNode* parent) {
+    auto node = std::make_unique<PdbNode>();
+    node->parent = parent;
+    node->leafKind = static_cast<std::uint16_t>(r.u());
+    r.vec(node->payload);
+    node->typeIndexOrSymOffset = r.u32();
+    node->prettyName = r.s();
+    node->uniqueName = r.s();
+    node->children.resize(r.count());
+    for (auto& child : node->children) child = DecodePdbNode(r, node.get());
+    return node;
+}
+
+void EncodeDwarfNode(const DwarfNode& node, SpillWriter& w) {
+    w.u(node.tag);
+    w.u(node.attrsStr.size());
+    for (const auto& a : node.attrsStr) {
+        w.u(a.first);
+        w.s(a.second);
+    }
+    w.u(node.attrsU64.size());
+    for (const auto& a : node.attrsU64) {
+        w.u(a.first);
+        w.u(a.second);
+    }
+    w.u(node.originalDieOffset);
+    w.vec(node.lineProgram);
+    w.u(node.children.size());
+    for (const auto& child : node.children) EncodeDwarfNode(*child, w);
+}
+
+std::unique_ptr<DwarfNode> DecodeDwarfNode(SpillReader& r, DwarfNode* parent) {
+    auto node = std::make_unique<DwarfNode>();
+    node->parent = parent;
+    node->tag = static_cast<std::uint16_t>(r.u());
+    node->attrsStr.resize(r.count());
+    for (auto& a : node->attrsStr) {
+        a.first = static_cast<std::uint16_t>(r.u());
+        a.second = r.s();
+    }
+    node->attrsU64.resize(r.count());
+    for (auto& a : node->attrsU64) {
+        a.first = static_cast<std::uint16_t>(r.u());
+        a.second = r.u();
+    }
+    node->originalDieOffset = r.u();
+    r.vec(node->lineProgram);
+    node->children.resize(r.count());
+    for (auto& child : node->children) child = DecodeDwarfNode(r, node.get());
+    return node;
+}
+
+template <typename T, typename DecodeFn>
+void DecodeWhole(IRBytes in, std::unique_ptr<T>& out, DecodeFn decode) {
+    SpillReader r(in);
+    out = decode(r, nullptr);
+    if (r.remaining()) r.fail();
+}
+
+} // namespace
+
+// ---- SpillView / SpillFile ----
+
+SpillView::SpillView(void* base, std::size_t length, std::size_t skip)
+    : base(base), length(length) {
+    bytesView.data = static_cast<const std::uint8_t*>(base) + skip;
+    bytesView.size = length - skip;
+}
+
+SpillView::SpillView(SpillView&& other) noexcept
+    : base(other.base), length(other.length), bytesView(other.bytesView) {
+    other.base = nullptr;
+    other.length = 0;
+    other.bytesView = {};
+}
+
+SpillView& SpillView::operator=(SpillView&& other) noexcept {
+    if (this != &other) {
+        if (base) UnmapRange(base, length);
+        base = other.base;
+        length = other.length;
+        bytesView = other.bytesView;
+        other.base = nullptr;
+        other.length = 0;
+        other.bytesView = {};
+    }
+    return *this;
+}
+
+SpillView::~SpillView() {
+    if (base) UnmapRange(base, length);
+}
+
+SpillFile::SpillFile(const std::string& dir) : fd(OpenTempFile(dir)) {}
+
+SpillFile::~SpillFile() {
+    if (ok()) CloseFile(fd);
+}
+
+SpillRef SpillFile::append(const std::vector<std::uint8_t>& bytes) {
+    if (!ok()) throw std::runtime_error("spill: no spill file");
+    SpillRef ref;
+    ref.size = bytes.size();
+    ref.offset = end.fetch_add(ref.size); // writers own disjoint ranges
+    if (!WriteAt(fd, bytes.data(), bytes.size(), ref.offset)) {
+        throw std::runtime_error("spill: write failed: " + LastErrorText());
+    }
+    return ref;
+}
+
+SpillView SpillFile::map(const SpillRef& ref) const {
+    if (ref.size == 0) return SpillView();
+    static const std::uint64_t granularity = MapGranularity();
+    std::uint64_t start = ref.offset - ref.offset % granularity;
+    std::size_t length = static_cast<std::size_t>(ref.offset + ref.size - start);
+    void* base = MapRange(fd, start, length);
+    if (!base) throw std::runtime_error("spill: cannot map record: " + LastErrorText());
+    return SpillView(base, length, static_cast<std::size_t>(ref.offset - start));
+}
+
+void SpillFile::release(const SpillRef& ref) {
+    if (ok() && ref.size) PunchHole(fd, ref.offset, ref.size);
+}
+
+// ---- MemoryBudget ----
+
+void MemoryBudget::setPinned(unsigned stage, std::size_t bytes) {
+    if (stage >= kStages) return;
+    pinned[stage].store(bytes);
+    notePeak(admitted.load());
+}
+
+std::size_t MemoryBudget::resident() const {
+    std::size_t total = admitted.load();
+    for (const auto& p : pinned) total += p.load();
+    return total;
+}
+
+bool MemoryBudget::admit(std::size_t bytes) {
+    std::size_t fixed = 0;
+    for (const auto& p : pinned) fixed += p.load();
+    std::size_t cur = admitted.load();
+    do {
+        if (fixed + cur + bytes > limit) return false;
+    } while (!admitted.compare_exchange_weak(cur, cur + bytes));
+    notePeak(cur + bytes);
+    return true;
+}
+
+void MemoryBudget::force(std::size_t bytes) {
+    notePeak(admitted.fetch_add(bytes) + bytes);
+}
+
+void MemoryBudget::release(std::size_t bytes) {
+    admitted.fetch_sub(bytes);
+}
+
+void MemoryBudget::notePeak(std::size_t nowAdmitted) {
+    std::size_t total = nowAdmitted;
+    for (const auto& p : pinned) total += p.load();
+    std::size_t prev = peakBytes.load();
+    while (total > prev && !peakBytes.compare_exchange_weak(prev, total)) {
+    }
+}
+
+// ---- footprints ----
+
+std::size_t FootprintOf(const IRScope& scope) {
+    std::size_t bytes = sizeof(IRScope) + StringHeap(scope.name)
+                      + VectorHeap(scope.children)
+                      + VectorHeap(scope.declaredTypes)
+                      + VectorHeap(scope.declaredSymbols);
+    for (const IRSymbol& sym : scope.declaredSymbols) bytes += StringHeap(sym.name);
+    if (scope.locations) bytes += sizeof(IRLocationPool) + scope.locations->memoryBytes();
+    if (scope.lines) bytes += sizeof(IRLineTable) + scope.lines->memoryBytes();
+    if (scope.inlinees) bytes += sizeof(IRInlineeTable) + scope.inlinees->memoryBytes();
+    for (const auto& child : scope.children) bytes += FootprintOf(*child);
+    return bytes;
+}
+
+std::size_t FootprintOf(const PdbNode& node) {
+    std::size_t bytes = sizeof(PdbNode) + VectorHeap(node.payload) + VectorHeap(node.children)
+                      + StringHeap(node.prettyName) + StringHeap(node.uniqueName);
+    for (const auto& child : node.children) bytes += FootprintOf(*child);
+    return bytes;
+}
+
+std::size_t FootprintOf(const DwarfNode& node) {
+    std::size_t bytes = sizeof(DwarfNode) + VectorHeap(node.attrsStr) + VectorHeap(node.attrsU64)
+                      + VectorHeap(node.children) + VectorHeap(node.lineProgram);
+    for (const auto& a : node.attrsStr) bytes += StringHeap(a.second);
+    for (const auto& child : node.children) bytes += FootprintOf(*child);
+    return bytes;
+}
+
+// ---- codecs ----
+
+void EncodeSpill(const IRScope& scope, std::vector<std::uint8_t>& out) {
+    SpillWriter w(out);
+    EncodeScope(scope, w);
+}
+
+void EncodeSpill(const PdbNode& node, std::vector<std::uint8_t>& out) {
+    SpillWriter w(out);
+    EncodePdbNode(node, w);
+}
+
+void EncodeSpill(const DwarfNode& node, std::vector<std::uint8_t>& out) {
+    SpillWriter w(out);
+    EncodeDwarfNode(node, w);
+}
+
+void DecodeSpill(IRBytes in, std::unique_ptr<IRScope>& out) {
+    DecodeWhole(in, out, DecodeScope);
+}
+
+void DecodeSpill(IRBytes in, std::unique_ptr<PdbNode>& out) {
+    DecodeWhole(in, out, DecodePdbNode);
+}
+
+void DecodeSpill(IRBytes in, std::unique_ptr<DwarfNode>& out) {
+    DecodeWhole(in, out, DecodeDwarfNode);
+}
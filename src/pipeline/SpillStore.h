@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../ir/IRNode.h"
+#include "../pdb/PdbNode.h"
+#include "../dwarf/DwarfNode.h"
+
+// SpillStore:
+// Backing store for --max-memory. When the resident IR would exceed the
+// budget, units waiting for the translator and translated units waiting
+// for the writer are serialized into one temporary file and mapped back in
+// when their stage reaches them:
+//
+//   MemoryBudget : pinned bytes (type table, maps, names; never spilled)
+//                  plus admitted bytes (queued units and models);
+//   SpillFile    : anonymous temp file; append() from any thread, map() to
+//                  read a record back, release() returns its disk space;
+//   Encode/DecodeSpill, FootprintOf : codec and size estimate per item.
+//
+// Spill records are only ever read by the process that wrote them, so
+// plain arrays are stored in host byte order.
+struct SpillRef {
+    std::uint64_t offset = 0;
+    std::uint64_t size   = 0;
+};
+
+// Read-only mapping of one spill record; unmapped on destruction.
+class SpillView {
+public:
+    SpillView() = default;
+    SpillView(void* base, std::size_t length, std::size_t skip);
+    SpillView(SpillView&& other) noexcept;
+    SpillView& operator=(SpillView&& other) noexcept;
+    SpillView(const SpillView&) = delete;
+    SpillView& operator=(const SpillView&) = delete;
+    ~SpillView();
+
+    IRBytes bytes() const { return bytesView; }
+
+private:
+    void*       base = nullptr;
+    std::size_t length = 0;
+    IRBytes     bytesView;
+};
+
+class SpillFile {
+public:
+    // 'dir' empty = the system temp directory ($TMPDIR or /tmp, GetTempPath
+    // on Windows). ok() is false if no file could be created; callers then
+    // keep items in memory.
+    explicit SpillFile(const std::string& dir = "");
+    ~SpillFile();
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    bool ok() const { return fd != -1; }
+
+    // Thread-safe. Throws std::runtime_error if the write fails.
+    SpillRef append(const std::vector<std::uint8_t>& bytes);
+    SpillView map(const SpillRef& ref) const;
+    // Best effort: gives the record's blocks back to the file system.
+    void release(const SpillRef& ref);
+
+    std::uint64_t bytesWritten() const { return end.load(); }
+
+private:
+    std::intptr_t fd = -1; // POSIX fd or Windows HANDLE
+    std::atomic<std::uint64_t> end{0};
+};
+
+class MemoryBudget {
+public:
+    static constexpr unsigned kStages = 2; // reader, translator
+
+    explicit MemoryBudget(std::size_t limit = 0) : limit(limit) {}
+
+    bool enabled() const { return limit != 0; }
+
+    // Footprint a stage holds that cannot be spilled; replaces its last value.
+    void setPinned(unsigned stage, std::size_t bytes);
+
+    // Counts 'bytes' as resident if they fit; false means spill the item.
+    bool admit(std::size_t bytes);
+    // Counts 'bytes' as resident unconditionally (nothing to spill to).
+    void force(std::size_t bytes);
+    void release(std::size_t bytes);
+
+    std::size_t resident() const;
+    std::size_t peak() const { return peakBytes.load(); }
+
+private:
+    void notePeak(std::size_t admitted);
+
+    std::size_t limit;
+    std::atomic<std::size_t> pinned[kStages] = {};
+    std::atomic<std::size_t> admitted{0};
+    std::atomic<std::size_t> peakBytes{0};
+};
+
+// Approximate heap footprint, including everything owned below the node.
+std::size_t FootprintOf(const IRScope& scope);
+std::size_t FootprintOf(const PdbNode& node);
+std::size_t FootprintOf(const DwarfNode& node);
+
+// Serialize a whole subtree. Decode throws std::runtime_error on records
+// that do not parse.
+void EncodeSpill(const IRScope& scope, std::vector<std::uint8_t>& out);
+void EncodeSpill(const PdbNode& node, std::vector<std::uint8_t>& out);
+void EncodeSpill(const DwarfNode& node, std::vector<std::uint8_t>& out);
+void DecodeSpill(IRBytes in, std::unique_ptr<IRScope>& out);
+void DecodeSpill(IRBytes in, std::unique_ptr<PdbNode>& out);
+void DecodeSpill(IRBytes in, std::unique_ptr<DwarfNode>& out);
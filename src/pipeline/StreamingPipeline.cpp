@@ -0,0 +1,415 @@
+#include "StreamingPipeline.h"
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "DwarfToPdb.h"
+#include "PdbToDwarf.h"
+#include "SpillStore.h"
+#include "../dwarf/DwarfReader.h"
+#include "../dwarf/DwarfWriter.h"
+#include "../ir/IRCanonicalOrder.h"
+#include "../ir/IRForwardDecls.h"
+#include "../ir/IRName.h"
+#include "../ir/IRTypeMerge.h"
+#include "../pdb/PdbReader.h"
+#include "../pdb/PdbWriter.h"
+#include "../util/ParallelFor.h"
+
+namespace {
+
+// Thrown from inside a reader callback to unwind the reader once a
+// downstream stage has failed and closed the queue.
+struct StageAborted {};
+
+// How often (in units) a stage re-measures its program-wide footprint.
+constexpr std::size_t kPinnedRefresh = 16;
+
+// Merge inputs are told apart by IRScope::image, and in a PDB by their
+// section index after the first, so both must fit 16 bits.
+constexpr std::size_t kMaxImages = 0xfffe;
+
+// Queue item: the unit/model itself, or where it was spilled.
+template <typename T>
+struct Held {
+    std::unique_ptr<T> value;
+    bool        spilled = false;
+    SpillRef    ref;
+    std::size_t bytes = 0; // admitted to the budget while queued
+};
+
+// Budget + spill file shared by the stages of one run.
+class Spiller {
+public:
+    explicit Spiller(const StreamingOptions& opts) : budget(opts.maxMemory), dir(opts.spillDir) {}
+
+    // pinned[stage]() measures what that stage keeps for the whole run.
+    std::function<std::size_t()> pinned[MemoryBudget::kStages];
+
+    void refresh(unsigned stage, std::size_t unitsSeen) {
+        if (budget.enabled() && pinned[stage] && unitsSeen % kPinnedRefresh == 0) {
+            budget.setPinned(stage, pinned[stage]());
+        }
+    }
+
+    template <typename T>
+    Held<T> hold(std::unique_ptr<T> value, std::size_t& spillCount) {
+        Held<T> h;
+        if (!budget.enabled() || !value) {
+            h.value = std::move(value);
+            return h;
+        }
+        std::size_t bytes = FootprintOf(*value);
+        bool fits = budget.admit(bytes);
+        SpillFile* f = fits ? nullptr : file();
+        if (!f) { // fits, or there is nowhere to spill to
+            if (!fits) budget.force(bytes);
+            h.value = std::move(value);
+            h.bytes = bytes;
+            return h;
+        }
+        std::vector<std::uint8_t> buf;
+        EncodeSpill(*value, buf);
+        value.reset();
+        h.spilled = true;
+        h.ref = f->append(buf);
+        ++spillCount;
+        return h;
+    }
+
+    template <typename T>
+    std::unique_ptr<T> take(Held<T>& h) {
+        if (!h.spilled) {
+            budget.release(h.bytes);
+            return std::move(h.value);
+        }
+        std::unique_ptr<T> value;
+        {
+            SpillView view = spill->map(h.ref);
+            DecodeSpill(view.bytes(), value);
+        }
+        spill->release(h.ref);
+        return value;
+    }
+
+    void report(SpillStats& stats) const {
+        stats.bytesSpilled = spill ? spill->bytesWritten() : 0;
+        stats.peakResident = budget.peak();
+    }
+
+private:
+    SpillFile* file() {
+        std::call_once(opened, [&] {
+            auto f = std::make_unique<SpillFile>(dir);
+            if (f->ok()) {
+                spill = std::move(f);
+            } else {
+                std::cerr << "[StreamingPipeline] cannot create a spill file in "
+                          << (dir.empty() ? std::string("the temp directory") : "'" + dir + "'")
+                          << "; continuing over the memory budget\n";
+            }
+        });
+        return spill.get();
+    }
+
+    MemoryBudget budget;
+    std::string dir;
+    std::once_flag opened;
+    std::unique_ptr<SpillFile> spill;
+};
+
+template <typename Model, typename ReadFn, typename TranslateFn, typename WriteFn>
+std::size_t RunStages(std::size_t queueDepth,
+                      Spiller& spiller,
+                      SpillStats& stats,
+                      ReadFn read,
+                      TranslateFn translate,
+                      WriteFn write) {
+    BoundedQueue<Held<IRScope>> irQueue(queueDepth);
+    BoundedQueue<Held<Model>>   modelQueue(queueDepth);
+    std::exception_ptr readErr, translateErr, writeErr;
+
+    std::thread reader([&] {
+        try {
+            std::size_t seen = 0;
+            read([&](std::unique_ptr<IRScope> unit) {
+                spiller.refresh(0, seen++);
+                if (!irQueue.push(spiller.hold(std::move(unit), stats.unitsSpilled))) throw StageAborted{};
+            });
+        } catch (const StageAborted&) {
+        } catch (...) {
+            readErr = std::current_exception();
+        }
+        irQueue.close();
+    });
+
+    std::thread translator([&] {
+        try {
+            std::size_t seen = 0;
+            Held<IRScope> held;
+            while (irQueue.pop(held)) {
+                std::unique_ptr<IRScope> unit = spiller.take(held);
+                spiller.refresh(1, seen++);
+                auto model = translate(*unit);
+                unit.reset(); // this unit's IR is no longer needed
+                if (!modelQueue.push(spiller.hold(std::move(model), stats.modelsSpilled))) break;
+            }
+        } catch (...) {
+            translateErr = std::current_exception();
+            irQueue.close();
+        }
+        modelQueue.close();
+    });
+
+    std::size_t written = 0;
+    try {
+        Held<Model> held;
+        while (modelQueue.pop(held)) {
+            std::unique_ptr<Model> model = spiller.take(held);
+            write(*model);
+            model.reset();
+            ++written;
+        }
+    } catch (...) {
+        writeErr = std::current_exception();
+        modelQueue.close();
+        irQueue.close();
+    }
+
+    reader.join();
+    translator.join();
+    spiller.report(stats);
+
+    if (readErr)      std::rethrow_exception(readErr);
+    if (translateErr) std::rethrow_exception(translateErr);
+    if (writeErr)     std::rethrow_exception(writeErr);
+    return written;
+}
+
+// IR -> PDB half shared by runDwarfToPdb and mergeDwarfToPdb. 'inputSide'
+// measures what the reader stage holds besides the type table and names.
+template <typename ReadFn, typename SideFn>
+std::size_t TranslateToPdb(const StreamingOptions& opts, SpillStats& stats,
+                           const std::string& pdbOutput, IRTypeTable& typeTable, IRMaps& maps,
+                           SideFn inputSide, ReadFn read) {
+    DwarfToPdb d2p;
+    PdbWriter  pwriter(opts.jobs);
+
+    stats = SpillStats();
+    Spiller spiller(opts);
+    spiller.pinned[0] = [&] {
+        return typeTable.memoryBytes() + IRNameStore::shared().memoryBytes() + inputSide();
+    };
+    spiller.pinned[1] = [&] { return maps.pdbSideBytes(); };
+
+    pwriter.beginStreaming(pdbOutput);
+    std::size_t n = RunStages<PdbNode>(
+        opts.queueDepth, spiller, stats, read,
+        [&](const IRScope& unit) {
+            auto mod = d2p.translateUnit(unit, typeTable, maps);
+            pwriter.addUnitSymbols(unit, maps);
+            return mod;
+        },
+        [&](const PdbNode& mod)  { pwriter.writeModule(mod); });
+    pwriter.finishStreaming();
+    return n;
+}
+
+template <typename ReadFn, typename SideFn>
+std::size_t TranslateToDwarf(const StreamingOptions& opts, SpillStats& stats,
+                             const std::string& dwarfOutput, IRTypeTable& typeTable, IRMaps& maps,
+                             SideFn inputSide, ReadFn read) {
+    PdbToDwarf  p2d;
+    DwarfCompressOptions compress = opts.compress;
+    if (!compress.jobs) compress.jobs = opts.jobs;
+    DwarfWriter dwriter(compress);
+
+    stats = SpillStats();
+    Spiller spiller(opts);
+    spiller.pinned[0] = [&] {
+        return typeTable.memoryBytes() + IRNameStore::shared().memoryBytes() + inputSide();
+    };
+    spiller.pinned[1] = [&] { return maps.dwarfSideBytes(); };
+
+    dwriter.beginStreaming(dwarfOutput);
+    std::size_t n = RunStages<DwarfNode>(
+        opts.queueDepth, spiller, stats, read,
+        [&](const IRScope& unit) { return p2d.translateUnit(unit, typeTable, maps); },
+        [&](const DwarfNode& cu) { dwriter.writeUnit(cu); });
+    dwriter.finishStreaming();
+    return n;
+}
+
+// Merge mode before translation: each input is read on its own worker
+// into its own table, the tables are merged into 'typeTable', and the
+// units are remapped and hung below one root in input order. Forward
+// decls are then resolved across inputs and the types put in canonical
+// order, as the single-input translate() does.
+template <typename Reader, typename ReadFn>
+std::unique_ptr<IRScope> ReadAndMerge(const std::vector<std::string>& inputs, const StreamingOptions& opts,
+                                      IRTypeTable& typeTable, IRMaps& maps, MergeStats& info, ReadFn read) {
+    const std::size_t n = inputs.size();
+    if (n > kMaxImages) {
+        throw std::runtime_error("merge: at most " + std::to_string(kMaxImages) + " inputs fit the output's sections");
+    }
+    std::vector<std::unique_ptr<IRTypeTable>> tables(n);
+    std::vector<std::vector<std::unique_ptr<IRScope>>> units(n);
+    ParallelFor(n, opts.jobs, [&](std::size_t i) {
+        tables[i] = std::make_unique<IRTypeTable>();
+        Reader reader;
+        if (!opts.filter.empty()) reader.setFilter(&opts.filter);
+        IRMaps inputMaps; // input-local DIE offsets / TIs
+        read(reader, inputs[i], *tables[i], inputMaps,
+             [&](std::unique_ptr<IRScope> unit) { units[i].push_back(std::move(unit)); });
+    });
+
+    std::vector<IRTypeTable*> raw;
+    for (auto& t : tables) raw.push_back(t.get());
+    IRTypeMerge merge = MergeTypeTables(raw, typeTable, opts.jobs);
+    tables.clear();
+
+    std::vector<std::pair<std::size_t, IRScope*>> all;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (auto& unit : units[i]) all.emplace_back(i, unit.get());
+    }
+    ParallelFor(all.size(), opts.jobs, [&](std::size_t u) {
+        RemapScopeTypes(*all[u].second, merge.remap[all[u].first]);
+    });
+
+    auto root = std::make_unique<IRScope>();
+    root->kind = IRScopeKind::CompileUnit;
+    root->name = "merged";
+    for (std::size_t i = 0; i < n; ++i) {
+        for (auto& unit : units[i]) {
+            unit->image = static_cast<std::uint16_t>(i);
+            unit->parent = root.get();
+            root->children.push_back(std::move(unit));
+        }
+    }
+    IRForwardResolution fwd = ResolveForwardDecls(typeTable, opts.jobs);
+    fwd.rewrite(*root);
+    ApplyCanonicalOrder(ComputeCanonicalOrder(typeTable, CompileUnitsOf(root.get()), opts.jobs),
+                        typeTable, root.get(), maps, opts.jobs);
+
+    info.inputs = n;
+    info.units = root->children.size();
+    info.typesIn = merge.typesIn;
+    info.typesOut = merge.typesOut;
+    info.rounds = merge.rounds;
+    return root;
+}
+
+// Reader stage of merge mode: hands over the merged units in order.
+// 'pending' tracks the footprint of those not handed over yet.
+class MergedUnits {
+public:
+    MergedUnits(std::unique_ptr<IRScope> root, bool measure) : root(std::move(root)) {
+        if (!measure) return;
+        for (const auto& unit : this->root->children) {
+            sizes.push_back(FootprintOf(*unit));
+            pending += sizes.back();
+        }
+    }
+
+    template <typename OnUnit>
+    void forward(const OnUnit& onUnit) {
+        for (std::size_t i = 0; i < root->children.size(); ++i) {
+            if (i < sizes.size()) pending -= sizes[i];
+            root->children[i]->parent = nullptr;
+            onUnit(std::move(root->children[i]));
+        }
+        root->children.clear();
+    }
+
+    std::size_t pendingBytes() const { return pending.load(); }
+
+private:
+    std::unique_ptr<IRScope> root;
+    std::vector<std::size_t> sizes;
+    std::atomic<std::size_t> pending{0};
+};
+
+} // namespace
+
+std::size_t StreamingPipeline::runDwarfToPdb(
+    const std::string& dwarfInput,
+    const std::string& pdbOutput,
+    IRTypeTable& typeTable,
+    IRMaps& maps
+) {
+    DwarfReader dreader;
+    if (!opts.filter.empty()) dreader.setFilter(&opts.filter);
+    return TranslateToPdb(opts, stats, pdbOutput, typeTable, maps,
+        [&] { return maps.dwarfSideBytes(); },
+        [&](const auto& onUnit) {
+            dreader.readObjectStreaming(dwarfInput, typeTable, maps, onUnit);
+        });
+}
+
+std::size_t StreamingPipeline::runPdbToDwarf(
+    const std::string& pdbInput,
+    const std::string& dwarfOutput,
+    IRTypeTable& typeTable,
+    IRMaps& maps
+) {
+    PdbReader preader;
+    if (!opts.filter.empty()) preader.setFilter(&opts.filter);
+    // The TPI is read before the first module, so forward decls can be
+    // resolved once there, before any unit reaches the translator.
+    IRForwardResolution fwd;
+    bool resolved = false;
+    return TranslateToDwarf(opts, stats, dwarfOutput, typeTable, maps,
+        [&] { return maps.pdbSideBytes(); },
+        [&](const auto& onUnit) {
+            preader.readPdbStreaming(pdbInput, typeTable, maps, [&](std::unique_ptr<IRScope> unit) {
+                if (!resolved) {
+                    fwd = ResolveForwardDecls(typeTable, opts.jobs);
+                    resolved = true;
+                }
+                fwd.rewrite(*unit);
+                onUnit(std::move(unit));
+            });
+        });
+}
+
+std::size_t StreamingPipeline::mergeDwarfToPdb(
+    const std::vector<std::string>& dwarfInputs,
+    const std::string& pdbOutput,
+    IRTypeTable& typeTable,
+    IRMaps& maps
+) {
+    mergeInfo = MergeStats();
+    MergedUnits units(
+        ReadAndMerge<DwarfReader>(dwarfInputs, opts, typeTable, maps, mergeInfo,
+            [](DwarfReader& reader, const std::string& path, IRTypeTable& table, IRMaps& inputMaps,
+               const auto& onUnit) { reader.readObjectStreaming(path, table, inputMaps, onUnit); }),
+        opts.maxMemory != 0);
+    return TranslateToPdb(opts, stats, pdbOutput, typeTable, maps,
+        [&] { return units.pendingBytes(); },
+        [&](const auto& onUnit) { units.forward(onUnit); });
+}
+
+std::size_t StreamingPipeline::mergePdbToDwarf(
+    const std::vector<std::string>& pdbInputs,
+    const std::string& dwarfOutput,
+    IRTypeTable& typeTable,
+    IRMaps& maps
+) {
+    mergeInfo = MergeStats();
+    MergedUnits units(
+        ReadAndMerge<PdbReader>(pdbInputs, opts, typeTable, maps, mergeInfo,
+            [](PdbReader& reader, const std::string& path, IRTypeTable& table, IRMaps& inputMaps,
+               const auto& onUnit) { reader.readPdbStreaming(path, table, inputMaps, onUnit); }),
+        opts.maxMemory != 0);
+    return TranslateToDwarf(opts, stats, dwarfOutput, typeTable, maps,
+        [&] { return units.pendingBytes(); },
+        [&](const auto& onUnit) { units.forward(onUnit); });
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../ir/IRTypeTable.h"
+#include "../ir/IRMaps.h"
+#include "../ir/IRFilter.h"
+#include "../dwarf/DwarfCompress.h"
+
+// StreamingPipeline:
+// Runs read -> translate -> write as three concurrent stages connected by
+// bounded queues at CU/module granularity:
+//
+//   reader thread      : DwarfReader/PdbReader emits one IRScope per unit
+//   translator thread  : DwarfToPdb/PdbToDwarf::translateUnit
+//   calling thread     : PdbWriter/DwarfWriter appends the finished unit
+//
+// A unit's IRScope is dropped as soon as it is translated and its model as
+// soon as it is written, so only ~2*queueDepth units are resident at once.
+// The IRTypeTable is still program-wide (types are shared between units).
+// The first exception thrown by any stage is rethrown from run*().
+//
+// Forward decls (IRForwardDecls.h): runPdbToDwarf resolves them once the
+// TPI is read, before the first module is handed on. runDwarfToPdb cannot,
+// because DWARF types arrive unit by unit; references to forward decls are
+// written as read there. merge*() and the whole-program translate() resolve
+// across all inputs.
+//
+// With maxMemory set, queued units and translated models count against a
+// budget together with the program-wide tables (see SpillStore.h); an item
+// that does not fit is written to a temporary spill file and mapped back in
+// when its stage picks it up. If no spill file can be created the run goes
+// on over budget rather than failing.
+//
+// Merge mode (merge*) reads several inputs, one per worker, each into its
+// own type table, merges the tables (IRTypeMerge.h) and then streams the
+// units of all inputs, in input order, into one output. maxMemory does
+// not bound the read and merge: every input's units and type table are
+// resident together until the merged types are in canonical order, which
+// needs all units at once. The budget and spilling apply from then on,
+// with the units not yet translated counted as pinned.
+struct StreamingOptions {
+    std::size_t queueDepth = 4;
+    unsigned    jobs = 0;      // workers for the writers' parallel phases (0 = all cores)
+    IRFilter    filter;        // applied by the reader stage; empty = convert everything
+    std::size_t maxMemory = 0; // resident IR budget in bytes (0 = unlimited)
+    std::string spillDir;      // empty = the system temp directory
+    DwarfCompressOptions compress; // .debug_* compression for PDB->DWARF output
+};
+
+struct SpillStats {
+    std::size_t   unitsSpilled  = 0;
+    std::size_t   modelsSpilled = 0;
+    std::uint64_t bytesSpilled  = 0;
+    std::size_t   peakResident  = 0; // budgeted bytes, high-water mark
+};
+
+struct MergeStats {
+    std::size_t inputs   = 0;
+    std::size_t units    = 0;
+    std::size_t typesIn  = 0; // summed over the inputs
+    std::size_t typesOut = 0; // after dedupe
+    unsigned    rounds   = 0; // structural hash refinement rounds
+};
+
+class StreamingPipeline {
+public:
+    explicit StreamingPipeline(StreamingOptions opts = {}) : opts(opts) {}
+
+    // Returns the number of units that reached the writer.
+    std::size_t runDwarfToPdb(
+        const std::string& dwarfInput,
+        const std::string& pdbOutput,
+        IRTypeTable& typeTable,
+        IRMaps& maps
+    );
+
+    std::size_t runPdbToDwarf(
+        const std::string& pdbInput,
+        const std::string& dwarfOutput,
+        IRTypeTable& typeTable,
+        IRMaps& maps
+    );
+
+    // Merge mode. 'maps' receives the output side only: the inputs' DIE
+    // offsets / TIs overlap between inputs and are dropped after the merge.
+    std::size_t mergeDwarfToPdb(
+        const std::vector<std::string>& dwarfInputs,
+        const std::string& pdbOutput,
+        IRTypeTable& typeTable,
+        IRMaps& maps
+    );
+
+    std::size_t mergePdbToDwarf(
+        const std::vector<std::string>& pdbInputs,
+        const std::string& dwarfOutput,
+        IRTypeTable& typeTable,
+        IRMaps& maps
+    );
+
+    // Spill activity of the last run*()/merge*() (all zero without maxMemory).
+    const SpillStats& spillStats() const { return stats; }
+
+    // Type merge figures of the last merge*().
+    const MergeStats& mergeStats() const { return mergeInfo; }
+
+private:
+    StreamingOptions opts;
+    SpillStats stats;
+    MergeStats mergeInfo;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of workers to use for a requested job count (0 = all cores).
+inline unsigned ResolveJobs(unsigned jobs) {
+    if (jobs) return jobs;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? hw : 1;
+}
+
+// ParallelFor:
+// Calls body(i) for every i in [0, count) on up to 'jobs' threads, handing
+// out indices dynamically so uneven items (one huge CU, many tiny ones)
+// still balance. Runs inline when one job is enough. The first exception
+// thrown by any body is rethrown after all workers stop.
+template <typename F>
+void ParallelFor(std::size_t count, unsigned jobs, F&& body) {
+    unsigned workers = static_cast<unsigned>(
+        std::min<std::size_t>(ResolveJobs(jobs), count));
+    if (workers <= 1) {
+        for (std::size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr firstError;
+    std::mutex errorMu;
+
+    auto worker = [&] {
+        for (;;) {
+            std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count || failed.load(std::memory_order_relaxed)) return;
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMu);
+                if (!firstError) firstError = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+// ParallelSort:
+// Sorts 'jobs' slices concurrently, then merges neighbouring slices in
+// parallel rounds. 'less' must be a total order (break ties explicitly)
+// for the result to be independent of the job count.
+template <typename It, typename Less>
+void ParallelSort(It first, It last, unsigned jobs, Less less) {
+    const std::size_t count = static_cast<std::size_t>(last - first);
+    constexpr std::size_t kMinSlice = 4096;
+    std::size_t slices = std::min<std::size_t>(ResolveJobs(jobs), count / kMinSlice);
+    if (slices <= 1) {
+        std::sort(first, last, less);
+        return;
+    }
+
+    std::vector<std::size_t> bounds(slices + 1);
+    for (std::size_t i = 0; i <= slices; ++i) bounds[i] = count * i / slices;
+
+    ParallelFor(slices, jobs, [&](std::size_t i) {
+        std::sort(first + bounds[i], first + bounds[i + 1], less);
+    });
+    for (std::size_t width = 1; width < slices; width *= 2) {
+        std::size_t pairs = (slices + 2 * width - 1) / (2 * width);
+        ParallelFor(pairs, jobs, [&](std::size_t p) {
+            std::size_t lo  = p * 2 * width;
+            std::size_t mid = std::min(lo + width, slices);
+            std::size_t hi  = std::min(lo + 2 * width, slices);
+            if (mid < hi) std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], less);
+        });
+    }
+}
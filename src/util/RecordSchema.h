@@ -0,0 +1,330 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../ir/IRLocation.h"
+
+// RecordSchema:
+// Compile-time description of binary record layouts shared by the
+// CodeView (LF_*/S_*, see CodeViewSchema.h) and DWARF (DW_TAG_* + forms,
+// see DwarfSchema.h) codecs; the spill file shares its ULEB codec and
+// little-endian loads.
+//
+// A record is described once as a FieldList of field codecs; the decoded
+// value is a std::tuple of the codecs' value types, read straight from (and
+// pointing into) the input bytes. The leading run of fixed-size fields is
+// bounds-checked once and loaded without per-field checks.
+//
+//   using Fields = schema::FieldList<schema::Fixed<std::uint32_t>,
+//                                    schema::NumericLeaf,
+//                                    schema::CString>;
+//   Fields::Values v;
+//   if (Fields::decode(bytes, v)) use(std::get<2>(v));
+namespace schema {
+
+// On little-endian hosts a field is one unaligned load; compilers do not
+// reliably fuse the byte loop into one.
+template <typename T>
+inline T LoadLE(const std::uint8_t* p) {
+    static_assert(std::is_integral<T>::value, "integral fields only");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+#else
+    using U = typename std::make_unsigned<T>::type;
+    U v = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) v |= U(p[i]) << (8 * i);
+    return static_cast<T>(v);
+#endif
+}
+
+template <typename T>
+inline void StoreLE(std::vector<std::uint8_t>& out, T v) {
+    using U = typename std::make_unsigned<T>::type;
+    U u = static_cast<U>(v);
+    for (std::size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<std::uint8_t>(u >> (8 * i)));
+}
+
+// ---- field codecs ----
+
+// Little-endian integer of fixed width.
+template <typename T>
+struct Fixed {
+    using value_type = T;
+    static constexpr bool kFixed = true;
+    static constexpr std::size_t kSize = sizeof(T);
+
+    static void readUnchecked(const std::uint8_t*& p, T& v) {
+        v = LoadLE<T>(p);
+        p += kSize;
+    }
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, T& v) {
+        if (static_cast<std::size_t>(end - p) < kSize) return false;
+        readUnchecked(p, v);
+        return true;
+    }
+    static void write(std::vector<std::uint8_t>& out, T v) { StoreLE<T>(out, v); }
+};
+
+// Zero-byte field (DW_FORM_flag_present).
+struct Present {
+    using value_type = bool;
+    static constexpr bool kFixed = true;
+    static constexpr std::size_t kSize = 0;
+
+    static void readUnchecked(const std::uint8_t*&, bool& v) { v = true; }
+    static bool read(const std::uint8_t*&, const std::uint8_t*, bool& v) { v = true; return true; }
+    static void write(std::vector<std::uint8_t>&, bool) {}
+};
+
+// CodeView numeric leaf: values < 0x8000 inline as u16, otherwise an
+// LF_CHAR/LF_SHORT/.../LF_UQUADWORD prefix followed by the value.
+struct NumericLeaf {
+    using value_type = std::uint64_t;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v) {
+        if (end - p < 2) return false;
+        std::uint16_t leaf = LoadLE<std::uint16_t>(p);
+        if (leaf < 0x8000) { // the common case stays inline
+            v = leaf;
+            p += 2;
+            return true;
+        }
+        const std::uint8_t* next = readPrefixed(p + 2, end, leaf, v);
+        if (!next) return false;
+        p = next;
+        return true;
+    }
+    // The value after prefix 'leaf'; returns the position past it, or null.
+    // Takes and returns the cursor by value so callers keep it in a register.
+    static const std::uint8_t* readPrefixed(const std::uint8_t* p, const std::uint8_t* end,
+                                            std::uint16_t leaf, std::uint64_t& v) {
+        std::size_t avail = static_cast<std::size_t>(end - p);
+        switch (leaf) {
+        case 0x8000: if (avail < 1) return nullptr; v = std::uint64_t(std::int64_t(std::int8_t(*p))); return p + 1;
+        case 0x8001: if (avail < 2) return nullptr; v = std::uint64_t(std::int64_t(LoadLE<std::int16_t>(p))); return p + 2;
+        case 0x8002: if (avail < 2) return nullptr; v = LoadLE<std::uint16_t>(p); return p + 2;
+        case 0x8003: if (avail < 4) return nullptr; v = std::uint64_t(std::int64_t(LoadLE<std::int32_t>(p))); return p + 4;
+        case 0x8004: if (avail < 4) return nullptr; v = LoadLE<std::uint32_t>(p); return p + 4;
+        case 0x8009: if (avail < 8) return nullptr; v = std::uint64_t(LoadLE<std::int64_t>(p)); return p + 8;
+        case 0x800a: if (avail < 8) return nullptr; v = LoadLE<std::uint64_t>(p); return p + 8;
+        default: return nullptr; // real/complex leaves never describe sizes or offsets
+        }
+    }
+    static void write(std::vector<std::uint8_t>& out, std::uint64_t v) {
+        if (v < 0x8000) {
+            StoreLE<std::uint16_t>(out, static_cast<std::uint16_t>(v));
+        } else if (v <= 0xFFFF) {
+            StoreLE<std::uint16_t>(out, 0x8002);
+            StoreLE<std::uint16_t>(out, static_cast<std::uint16_t>(v));
+        } else if (v <= 0xFFFFFFFFull) {
+            StoreLE<std::uint16_t>(out, 0x8004);
+            StoreLE<std::uint32_t>(out, static_cast<std::uint32_t>(v));
+        } else {
+            StoreLE<std::uint16_t>(out, 0x800a);
+            StoreLE<std::uint64_t>(out, v);
+        }
+    }
+};
+
+struct Uleb {
+    using value_type = std::uint64_t;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v) {
+        v = 0;
+        unsigned shift = 0;
+        while (p < end) {
+            std::uint8_t b = *p++;
+            if (shift < 64) v |= std::uint64_t(b & 0x7f) << shift;
+            shift += 7;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+    static void write(std::vector<std::uint8_t>& out, std::uint64_t v) {
+        do {
+            std::uint8_t b = v & 0x7f;
+            v >>= 7;
+            if (v) b |= 0x80;
+            out.push_back(b);
+        } while (v);
+    }
+};
+
+struct Sleb {
+    using value_type = std::int64_t;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, std::int64_t& v) {
+        std::uint64_t r = 0;
+        unsigned shift = 0;
+        std::uint8_t b = 0;
+        do {
+            if (p >= end) return false;
+            b = *p++;
+            if (shift < 64) r |= std::uint64_t(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        if (shift < 64 && (b & 0x40)) r |= ~std::uint64_t(0) << shift;
+        v = static_cast<std::int64_t>(r);
+        return true;
+    }
+    static void write(std::vector<std::uint8_t>& out, std::int64_t v) {
+        bool more = true;
+        while (more) {
+            std::uint8_t b = v & 0x7f;
+            v >>= 7;
+            more = !((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40)));
+            if (more) b |= 0x80;
+            out.push_back(b);
+        }
+    }
+};
+
+// NUL-terminated string; the view points into the input.
+struct CString {
+    using value_type = std::string_view;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, std::string_view& v) {
+        const void* nul = std::memchr(p, 0, static_cast<std::size_t>(end - p));
+        if (!nul) return false;
+        const std::uint8_t* n = static_cast<const std::uint8_t*>(nul);
+        v = std::string_view(reinterpret_cast<const char*>(p), static_cast<std::size_t>(n - p));
+        p = n + 1;
+        return true;
+    }
+    static void write(std::vector<std::uint8_t>& out, std::string_view v) {
+        out.insert(out.end(), v.begin(), v.end());
+        out.push_back(0);
+    }
+};
+
+// Optional trailing string (e.g. LF_STRUCTURE's unique name): empty when
+// only LF_PAD bytes (0xF0..0xFF) or nothing remain.
+struct TrailingCString {
+    using value_type = std::string_view;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, std::string_view& v) {
+        if (p >= end || *p >= 0xF0) {
+            v = std::string_view();
+            return true;
+        }
+        return CString::read(p, end, v);
+    }
+    static void write(std::vector<std::uint8_t>& out, std::string_view v) {
+        if (!v.empty()) CString::write(out, v);
+    }
+};
+
+// ULEB128 length followed by that many bytes (DW_FORM_exprloc / block).
+struct UlebBlock {
+    using value_type = IRBytes;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, IRBytes& v) {
+        std::uint64_t n = 0;
+        if (!Uleb::read(p, end, n) || n > static_cast<std::uint64_t>(end - p)) return false;
+        v = IRBytes{p, static_cast<std::size_t>(n)};
+        p += n;
+        return true;
+    }
+    static void write(std::vector<std::uint8_t>& out, IRBytes v) {
+        Uleb::write(out, v.size);
+        if (v.size) out.insert(out.end(), v.data, v.data + v.size);
+    }
+};
+
+// Whatever is left of the record (gaps, annotations, ...).
+struct Rest {
+    using value_type = IRBytes;
+    static constexpr bool kFixed = false;
+
+    static bool read(const std::uint8_t*& p, const std::uint8_t* end, IRBytes& v) {
+        v = IRBytes{p, static_cast<std::size_t>(end - p)};
+        p = end;
+        return true;
+    }
+    static void write(std::vector<std::uint8_t>& out, IRBytes v) {
+        if (v.size) out.insert(out.end(), v.data, v.data + v.size);
+    }
+};
+
+// ---- field lists ----
+
+template <typename F, bool = F::kFixed>
+struct FixedSizeOf { static constexpr std::size_t value = 0; };
+template <typename F>
+struct FixedSizeOf<F, true> { static constexpr std::size_t value = F::kSize; };
+
+template <typename... Fs>
+struct FieldList {
+    using Values = std::tuple<typename Fs::value_type...>;
+
+    static constexpr bool kFixedLayout = (true && ... && Fs::kFixed);
+    static constexpr std::size_t kFixedSize = (std::size_t(0) + ... + FixedSizeOf<Fs>::value);
+
+    // Decodes the fields from the front of 'in'. 'consumed' (optional)
+    // receives the number of bytes read.
+    static bool decode(IRBytes in, Values& v, std::size_t* consumed = nullptr) {
+        const std::uint8_t* p = in.data;
+        const std::uint8_t* end = in.data + in.size;
+        bool ok = decodeImpl(p, end, v, std::index_sequence_for<Fs...>{});
+        if (ok && consumed) *consumed = static_cast<std::size_t>(p - in.data);
+        return ok;
+    }
+
+    static void encode(const Values& v, std::vector<std::uint8_t>& out) {
+        encodeImpl(v, out, std::index_sequence_for<Fs...>{});
+    }
+
+private:
+    static constexpr bool kIsFixed[] = {Fs::kFixed..., false};
+    static constexpr std::size_t kSizes[] = {FixedSizeOf<Fs>::value..., 0};
+
+    // Leading run of fixed-size fields: checked once, then loaded unchecked.
+    static constexpr std::size_t prefixCount() {
+        std::size_t n = 0;
+        while (kIsFixed[n]) ++n;
+        return n;
+    }
+    static constexpr std::size_t prefixSize() {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < prefixCount(); ++i) size += kSizes[i];
+        return size;
+    }
+
+    template <std::size_t I, typename F>
+    static bool readField(const std::uint8_t*& p, const std::uint8_t* end, Values& v) {
+        if constexpr (I < prefixCount()) {
+            F::readUnchecked(p, std::get<I>(v));
+            return true;
+        } else {
+            return F::read(p, end, std::get<I>(v));
+        }
+    }
+
+    template <std::size_t... I>
+    static bool decodeImpl(const std::uint8_t*& p, const std::uint8_t* end,
+                           Values& v, std::index_sequence<I...>) {
+        if (static_cast<std::size_t>(end - p) < prefixSize()) return false;
+        return (true && ... && readField<I, Fs>(p, end, v));
+    }
+
+    template <std::size_t... I>
+    static void encodeImpl(const Values& v, std::vector<std::uint8_t>& out,
+                           std::index_sequence<I...>) {
+        (Fs::write(out, std::get<I>(v)), ...);
+    }
+};
+
+} // namespace schema
@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// VerifyReport:
+// Findings of a --verify pass. Each problem names the section or stream it
+// was found in and a byte offset there, so it can be located with a dump
+// tool. Verifiers fill one report per worker and merge them; sort() gives
+// an order that does not depend on the job count.
+struct VerifyProblem {
+    std::string   where;    // ".debug_info", "MSF", "TPI", "IRMaps", ...
+    std::uint64_t offset = 0;
+    std::string   message;
+};
+
+struct VerifyReport {
+    // Only the first problems are kept; problemCount keeps counting.
+    static constexpr std::size_t kMaxProblems = 100;
+
+    std::vector<VerifyProblem> problems;
+    std::size_t problemCount = 0;
+    std::size_t itemsChecked = 0; // units, DIEs, streams, type records, ...
+    // Forward declarations with no definition anywhere: opaque types such as
+    // 'struct foo;' used only through pointers. Legal, so only counted.
+    std::size_t opaqueDecls = 0;
+
+    bool ok() const { return problemCount == 0; }
+
+    void fail(std::string where, std::uint64_t offset, std::string message) {
+        if (problemCount++ < kMaxProblems) {
+            problems.push_back({std::move(where), offset, std::move(message)});
+        }
+    }
+
+    void merge(VerifyReport&& other) {
+        problemCount += other.problemCount;
+        itemsChecked += other.itemsChecked;
+        opaqueDecls += other.opaqueDecls;
+        for (auto& p : other.problems) {
+            if (problems.size() < kMaxProblems) problems.push_back(std::move(p));
+        }
+    }
+
+    void sort() {
+        std::sort(problems.begin(), problems.end(), [](const VerifyProblem& l, const VerifyProblem& r) {
+            return std::tie(l.where, l.offset, l.message) < std::tie(r.where, r.offset, r.message);
+        });
+    }
+};
@@ -0,0 +1,218 @@
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ir/IRCanonicalOrder.h"
+
+namespace {
+
+struct Program {
+    IRTypeTable table;
+    IRMaps maps;
+    std::unique_ptr<IRScope> root;
+};
+
+IRScope* AddUnit(IRScope& root, const std::string& name) {
+    auto unit = std::make_unique<IRScope>();
+    unit->kind = IRScopeKind::CompileUnit;
+    unit->name = name;
+    unit->parent = &root;
+    root.children.push_back(std::move(unit));
+    return root.children.back().get();
+}
+
+// Two units: a.cpp { struct Node { Node* next; int vals[4]; }; int }
+//            b.cpp { struct Pair { Node* a; Node* b; }; Node* }
+// 'reversed' creates the same types in the opposite order, the way a
+// different reader schedule would. DIE offsets name each type's role.
+void Build(Program& p, bool reversed) {
+    p.root = std::make_unique<IRScope>();
+    p.root->name = "<program>";
+    IRScope* a = AddUnit(*p.root, "a.cpp");
+    IRScope* b = AddUnit(*p.root, "b.cpp");
+
+    enum { Int, Node, NodePtrA, Arr, Pair, NodePtrB, Count };
+    IRTypeKind kinds[Count] = {IRTypeKind::Unknown, IRTypeKind::StructOrUnion, IRTypeKind::Pointer,
+                               IRTypeKind::Array, IRTypeKind::StructOrUnion, IRTypeKind::Pointer};
+    IRType* t[Count] = {};
+    for (int i = 0; i < Count; ++i) {
+        int role = reversed ? Count - 1 - i : i;
+        t[role] = p.table.createType(kinds[role]);
+        p.maps.dwarfDieToIR.set(0x100 + role, t[role]->id);
+    }
+    t[Int]->name = "int";
+    t[Int]->sizeBytes = 4;
+    t[Node]->name = "Node";
+    t[Node]->sizeBytes = 24;
+    t[Node]->fields = {{"next", t[NodePtrA]->id, 0}, {"vals", t[Arr]->id, 8}};
+    t[NodePtrA]->pointeeType = t[Node]->id;
+    t[NodePtrA]->ptrSizeBytes = 8;
+    t[Arr]->elementType = t[Int]->id;
+    t[Arr]->dims = {{0, 4}};
+    t[Pair]->name = "Pair";
+    t[Pair]->sizeBytes = 16;
+    t[Pair]->fields = {{"a", t[NodePtrB]->id, 0}, {"b", t[NodePtrB]->id, 8}};
+    t[NodePtrB]->pointeeType = t[Node]->id;
+    t[NodePtrB]->ptrSizeBytes = 8;
+
+    a->declaredTypes = {t[Node]->id, t[NodePtrA]->id, t[Arr]->id, t[Int]->id};
+    b->declaredTypes = {t[Pair]->id, t[NodePtrB]->id};
+    IRSymbol head;
+    head.name = "head";
+    head.type = t[NodePtrB]->id;
+    b->declaredSymbols.push_back(head);
+}
+
+void Canonicalize(Program& p, unsigned jobs) {
+    IRCanonicalOrder order = ComputeCanonicalOrder(p.table, CompileUnitsOf(p.root.get()), jobs);
+    ApplyCanonicalOrder(order, p.table, p.root.get(), p.maps, jobs);
+}
+
+bool SameType(const IRType* x, const IRType* y) {
+    if (!x || !y) return x == y;
+    if (x->kind != y->kind || x->name.str() != y->name.str() || x->sizeBytes != y->sizeBytes) return false;
+    if (x->pointeeType != y->pointeeType || x->elementType != y->elementType) return false;
+    if (x->fields.size() != y->fields.size()) return false;
+    for (std::size_t i = 0; i < x->fields.size(); ++i) {
+        if (x->fields[i].type != y->fields[i].type) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Canonical order ignores creation order and job count", "[ut][canonical]") {
+    Program forward, backward;
+    Build(forward, false);
+    Build(backward, true);
+    REQUIRE(forward.maps.dwarfDieToIR.at(0x100) != backward.maps.dwarfDieToIR.at(0x100));
+
+    Canonicalize(forward, 1);
+    Canonicalize(backward, 8);
+
+    for (IRTypeID id = 1; id <= 7; ++id) {
+        CHECK(SameType(forward.table.lookup(id), backward.table.lookup(id)));
+    }
+    CHECK(forward.table.lookup(7) == nullptr);
+    bool sameMaps = forward.maps.dwarfDieToIR == backward.maps.dwarfDieToIR;
+    CHECK(sameMaps);
+    for (std::size_t u = 0; u < 2; ++u) {
+        const IRScope& f = *forward.root->children[u];
+        const IRScope& b = *backward.root->children[u];
+        CHECK(f.declaredTypes == b.declaredTypes);
+        CHECK(std::is_sorted(f.declaredTypes.begin(), f.declaredTypes.end()));
+    }
+    CHECK(forward.root->children[1]->declaredSymbols[0].type ==
+          backward.root->children[1]->declaredSymbols[0].type);
+}
+
+TEST_CASE("Canonical order keeps references and IRMaps consistent", "[ut][canonical]") {
+    Program p;
+    Build(p, true);
+    p.maps.irToPdbTI.set(p.maps.dwarfDieToIR.at(0x101), 0x1000); // Node
+    Canonicalize(p, 4);
+
+    IRTypeID node = p.maps.dwarfDieToIR.at(0x101);
+    IRTypeID ptrA = p.maps.dwarfDieToIR.at(0x102);
+    IRTypeID ptrB = p.maps.dwarfDieToIR.at(0x105);
+    REQUIRE(p.table.lookup(node) != nullptr);
+    CHECK(p.table.lookup(node)->name.str() == "Node");
+    CHECK(p.table.lookup(node)->id == node);
+    CHECK(p.table.lookup(node)->fields[0].type == ptrA);
+    CHECK(p.table.lookup(ptrA)->pointeeType == node);
+    CHECK(p.table.lookup(ptrB)->pointeeType == node);
+    CHECK(p.root->children[1]->declaredSymbols[0].type == ptrB);
+    CHECK(p.maps.irToPdbTI.contains(node));
+
+    // The two Node* are structurally equal. Node's own field comes first and
+    // points forward at it; the other follows Node.
+    CHECK(ptrA < node);
+    CHECK(ptrB > node);
+
+    // New types continue after the renumbered range.
+    CHECK(p.table.createType(IRTypeKind::Pointer)->id == 7);
+}
+
+TEST_CASE("Canonical order tells undeclared twins apart by their referrers", "[ut][canonical]") {
+    // a.cpp { struct Node; struct A { Node* p; }; }  b.cpp { struct B { Node* q; }; }
+    // Neither Node* is declared by a unit; only who uses it differs.
+    auto build = [](Program& p, bool reversed) {
+        p.root = std::make_unique<IRScope>();
+        IRScope* a = AddUnit(*p.root, "a.cpp");
+        IRScope* b = AddUnit(*p.root, "b.cpp");
+        IRType* node = p.table.createType(IRTypeKind::StructOrUnion);
+        node->name = "Node";
+        node->isForwardDecl = true;
+        IRType* ptr[2];
+        for (int i = 0; i < 2; ++i) {
+            ptr[reversed ? 1 - i : i] = p.table.createType(IRTypeKind::Pointer);
+        }
+        for (IRType* q : ptr) {
+            q->pointeeType = node->id;
+            q->ptrSizeBytes = 8;
+        }
+        IRType* sa = p.table.createType(IRTypeKind::StructOrUnion);
+        sa->name = "A";
+        sa->sizeBytes = 8;
+        sa->fields = {{"p", ptr[0]->id, 0}};
+        IRType* sb = p.table.createType(IRTypeKind::StructOrUnion);
+        sb->name = "B";
+        sb->sizeBytes = 8;
+        sb->fields = {{"q", ptr[1]->id, 0}};
+        a->declaredTypes = {node->id, sa->id};
+        b->declaredTypes = {sb->id};
+        p.maps.dwarfDieToIR.set(0x10, sa->id);
+        p.maps.dwarfDieToIR.set(0x20, sb->id);
+    };
+    Program forward, backward;
+    build(forward, false);
+    build(backward, true);
+    Canonicalize(forward, 1);
+    Canonicalize(backward, 4);
+
+    for (std::uint64_t die : {0x10, 0x20}) {
+        IRTypeID f = forward.maps.dwarfDieToIR.at(die);
+        IRTypeID b = backward.maps.dwarfDieToIR.at(die);
+        CHECK(f == b);
+        CHECK(forward.table.lookup(f)->fields[0].type == backward.table.lookup(b)->fields[0].type);
+    }
+    IRTypeID pa = forward.table.lookup(forward.maps.dwarfDieToIR.at(0x10))->fields[0].type;
+    IRTypeID pb = forward.table.lookup(forward.maps.dwarfDieToIR.at(0x20))->fields[0].type;
+    CHECK(pa != pb);
+}
+
+TEST_CASE("Canonical IDs come after the types they reference", "[ut][canonical]") {
+    // The Build program plus struct List { List* next; Node* node; Pair p; }
+    // whose pointer is created first and only reached through List.
+    for (bool reversed : {false, true}) {
+        Program p;
+        Build(p, reversed);
+        IRType* listPtr = p.table.createType(IRTypeKind::Pointer);
+        IRType* list = p.table.createType(IRTypeKind::StructOrUnion);
+        listPtr->pointeeType = list->id;
+        listPtr->ptrSizeBytes = 8;
+        list->name = "List";
+        list->sizeBytes = 32;
+        list->fields = {{"next", listPtr->id, 0},
+                        {"node", p.maps.dwarfDieToIR.at(0x102), 8},
+                        {"p", p.maps.dwarfDieToIR.at(0x104), 16}};
+        p.root->children[0]->declaredTypes.push_back(listPtr->id);
+        p.root->children[0]->declaredTypes.push_back(list->id);
+        Canonicalize(p, 4);
+
+        std::size_t forward = 0;
+        for (IRTypeID id = 1; p.table.lookup(id); ++id) {
+            const IRType& t = *p.table.lookup(id);
+            for (const IRField& f : t.fields) CHECK(f.type < id);
+            CHECK(t.elementType < id);
+            CHECK(t.indexType < id);
+            if (t.pointeeType > id) {
+                // Only a pointer closing a cycle points forward, at a struct.
+                CHECK(p.table.lookup(t.pointeeType)->kind == IRTypeKind::StructOrUnion);
+                ++forward;
+            }
+        }
+        CHECK(forward == 2); // Node::next, List::next
+    }
+}
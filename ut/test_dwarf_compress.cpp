@@ -0,0 +1,224 @@
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "dwarf/DwarfCompress.h"
+#include "dwarf/DwarfVerifier.h"
+#include "dwarf/DwarfWriter.h"
+#ifdef DWARF_PDB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+using Bytes = std::vector<std::uint8_t>;
+
+IRBytes View(const Bytes& b) { return IRBytes{b.data(), b.size()}; }
+
+void Put(Bytes& out, std::uint64_t v, unsigned size) {
+    for (unsigned i = 0; i < size; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+// Compressible but not trivially so: DIE-like records with a running id.
+Bytes SectionLike(std::size_t size) {
+    Bytes b;
+    b.reserve(size);
+    for (std::uint32_t i = 0; b.size() < size; ++i) {
+        const char* name = i % 3 ? "member_variable" : "struct_type";
+        b.push_back(static_cast<std::uint8_t>(1 + i % 5));
+        b.insert(b.end(), name, name + std::strlen(name) + 1);
+        Put(b, i * 2654435761u, 4);
+    }
+    b.resize(size);
+    return b;
+}
+
+std::vector<DwarfCompression> BuiltInFormats() {
+    std::vector<DwarfCompression> kinds;
+    for (DwarfCompression k : {DwarfCompression::Zlib, DwarfCompression::Zstd}) {
+        if (DwarfCompressionAvailable(k)) kinds.push_back(k);
+    }
+    return kinds;
+}
+
+// ELF64 with .debug_info (flags 'infoFlags') and .debug_abbrev.
+Bytes Elf(const Bytes& info, std::uint64_t infoFlags, const Bytes& abbrev) {
+    const char names[] = "\0.shstrtab\0.debug_info\0.debug_abbrev";
+    Bytes f(64, 0);
+    std::memcpy(f.data(), "\x7f" "ELF\x02\x01\x01", 7);
+
+    struct Section { std::uint32_t name; std::uint64_t flags; std::uint64_t off, size; };
+    Section secs[4] = {};
+    auto place = [&](Section& s, const std::uint8_t* data, std::size_t size) {
+        s.off = f.size();
+        s.size = size;
+        f.insert(f.end(), data, data + size);
+    };
+    secs[1].name = 1;
+    place(secs[1], reinterpret_cast<const std::uint8_t*>(names), sizeof(names));
+    secs[2].name = 11;
+    secs[2].flags = infoFlags;
+    place(secs[2], info.data(), info.size());
+    secs[3].name = 23;
+    place(secs[3], abbrev.data(), abbrev.size());
+
+    std::uint64_t shoff = f.size();
+    for (const Section& s : secs) {
+        Put(f, s.name, 4);
+        Put(f, 0, 4);           // sh_type
+        Put(f, s.flags, 8);
+        Put(f, 0, 8);           // sh_addr
+        Put(f, s.off, 8);
+        Put(f, s.size, 8);
+        Put(f, 0, 8);           // sh_link, sh_info
+        Put(f, 0, 8);           // sh_addralign
+        Put(f, 0, 8);           // sh_entsize
+    }
+    std::memcpy(f.data() + 0x28, &shoff, 8);
+    f[0x3a] = 64;               // e_shentsize
+    f[0x3c] = 4;                // e_shnum
+    f[0x3e] = 1;                // e_shstrndx
+    return f;
+}
+
+} // namespace
+
+TEST_CASE("Compressed .debug sections round-trip in every built-in format", "[ut][dwarf][compress]") {
+    Bytes section = SectionLike(300 * 1024 + 17); // five 64 KiB chunks, the last partial
+    for (DwarfCompression kind : BuiltInFormats()) {
+        DwarfCompressOptions opts;
+        opts.kind = kind;
+        opts.chunkBytes = 64 * 1024;
+        opts.jobs = 4;
+
+        Bytes packed;
+        std::string error;
+        REQUIRE(CompressDwarfSection(View(section), opts, packed, error));
+        CHECK(packed.size() < section.size() / 2);
+        CHECK(packed[0] == (kind == DwarfCompression::Zlib ? 1 : 2)); // ch_type
+
+        Bytes back;
+        REQUIRE(DecompressDwarfSection(View(packed), back, error));
+        bool same = back == section;
+        CHECK(same);
+
+        // The parallel result does not depend on the thread count.
+        opts.jobs = 1;
+        Bytes serial;
+        REQUIRE(CompressDwarfSection(View(section), opts, serial, error));
+        bool deterministic = serial == packed;
+        CHECK(deterministic);
+
+        Bytes empty, packedEmpty;
+        REQUIRE(CompressDwarfSection(View(empty), opts, packedEmpty, error));
+        Bytes unpackedEmpty; // fresh, so it has no buffer at all
+        REQUIRE(DecompressDwarfSection(View(packedEmpty), unpackedEmpty, error));
+        CHECK(unpackedEmpty.empty());
+        REQUIRE(DecompressDwarfSection(View(packedEmpty), back, error));
+        CHECK(back.empty());
+
+        packed.resize(packed.size() - 3);
+        CHECK_FALSE(DecompressDwarfSection(View(packed), back, error));
+    }
+
+    DwarfCompression kind = DwarfCompression::None;
+    CHECK(ParseDwarfCompression("zstd", kind));
+    CHECK(kind == DwarfCompression::Zstd);
+    CHECK_FALSE(ParseDwarfCompression("lzma", kind));
+    if (!DwarfCompressionAvailable(DwarfCompression::Zstd)) {
+        DwarfCompressOptions opts;
+        opts.kind = DwarfCompression::Zstd;
+        Bytes packed;
+        std::string error;
+        CHECK_FALSE(CompressDwarfSection(View(section), opts, packed, error));
+        CHECK(error.find("not available") != std::string::npos);
+    }
+}
+
+#ifdef DWARF_PDB_HAVE_ZLIB
+TEST_CASE("Chunked zlib output is one ordinary zlib stream", "[ut][dwarf][compress]") {
+    Bytes section = SectionLike(200 * 1024);
+    DwarfCompressOptions opts;
+    opts.kind = DwarfCompression::Zlib;
+    opts.chunkBytes = 64 * 1024;
+    Bytes packed;
+    std::string error;
+    REQUIRE(CompressDwarfSection(View(section), opts, packed, error));
+
+    Bytes plain(section.size());
+    uLongf plainSize = static_cast<uLongf>(plain.size());
+    int rc = uncompress(plain.data(), &plainSize, packed.data() + 24, static_cast<uLong>(packed.size() - 24));
+    CHECK(rc == Z_OK);
+    CHECK(plainSize == section.size());
+    bool same = plain == section;
+    CHECK(same);
+}
+#endif
+
+TEST_CASE("Section compressor keeps order and skips what it should", "[ut][dwarf][compress]") {
+    DwarfCompressOptions opts;
+    opts.kind = BuiltInFormats().empty() ? DwarfCompression::None : BuiltInFormats()[0];
+    DwarfSectionCompressor compressor(opts);
+    Bytes info = SectionLike(100 * 1024);
+    compressor.submit(".debug_info", info);
+    compressor.submit(".text", SectionLike(100 * 1024));
+    compressor.submit(".debug_str", {'x', 0});
+    std::vector<DwarfOutputSection> out = compressor.finish();
+
+    REQUIRE(out.size() == 3);
+    CHECK(out[0].name == ".debug_info");
+    CHECK(out[1].name == ".text");
+    CHECK(out[2].name == ".debug_str");
+    CHECK(out[0].uncompressedSize == info.size());
+    CHECK(out[0].flags == (opts.kind == DwarfCompression::None ? 0 : kShfCompressed));
+    CHECK(out[1].flags == 0);  // not a debug section
+    CHECK(out[2].flags == 0);  // would grow
+    CHECK(out[2].bytes.size() == 2);
+    CHECK(compressor.error().empty());
+
+    DwarfWriter writer(opts);
+    writer.beginStreaming("out.o");
+    DwarfNode cu;
+    cu.lineProgram = SectionLike(80 * 1024);
+    writer.writeUnit(cu);
+    writer.finishStreaming();
+    REQUIRE(writer.outputSections().size() == 1);
+    CHECK(writer.outputSections()[0].name == ".debug_line");
+    CHECK(writer.outputSections()[0].uncompressedSize == cu.lineProgram.size());
+}
+
+TEST_CASE("DWARF verifier reads compressed sections", "[ut][verify][dwarf][compress]") {
+    // CU "cu" with no children; abbrev 1: compile_unit, no children, name:string.
+    Bytes abbrev = {1, 0x11, 0, 0x03, 0x08, 0, 0, 0};
+    Bytes info;
+    Put(info, 7 + 4, 4);
+    Put(info, 4, 2);
+    Put(info, 0, 4);
+    Put(info, 8, 1);
+    info.insert(info.end(), {1, 'c', 'u', 0});
+
+    DwarfSections sections;
+    std::string error;
+    Bytes plainFile = Elf(info, 0, abbrev);
+    REQUIRE(FindDwarfSections(View(plainFile), sections, error));
+    CHECK(VerifyDwarf(sections, nullptr).ok());
+
+    for (DwarfCompression kind : BuiltInFormats()) {
+        DwarfCompressOptions opts;
+        opts.kind = kind;
+        Bytes packed;
+        REQUIRE(CompressDwarfSection(View(info), opts, packed, error));
+        Bytes file = Elf(packed, kShfCompressed, abbrev);
+        REQUIRE(FindDwarfSections(View(file), sections, error));
+        REQUIRE(sections.info.size == info.size());
+        CHECK(std::memcmp(sections.info.data, info.data(), info.size()) == 0);
+        CHECK(VerifyDwarf(sections, nullptr).ok());
+    }
+
+    // A ch_type this build cannot read is reported, not misparsed.
+    Bytes bogus(24 + 4, 0);
+    bogus[0] = 0x7f;
+    Bytes bogusFile = Elf(bogus, kShfCompressed, abbrev);
+    CHECK_FALSE(FindDwarfSections(View(bogusFile), sections, error));
+    CHECK(error.find(".debug_info") != std::string::npos);
+}
@@ -0,0 +1,246 @@
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <vector>
+#include "ir/IRFilter.h"
+#include "ir/IRTypeTable.h"
+#include "ir/IRMaps.h"
+#include "dwarf/DwarfReader.h"
+
+namespace {
+
+bool Has(const std::vector<IRTypeID>& ids, IRTypeID id) {
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+IRScope* AddScope(IRScope& parent, IRScopeKind kind, const std::string& name) {
+    auto s = std::make_unique<IRScope>();
+    s->kind = kind;
+    s->name = name;
+    s->parent = &parent;
+    parent.children.push_back(std::move(s));
+    return parent.children.back().get();
+}
+
+} // namespace
+
+TEST_CASE("Name patterns accept globs and regexes", "[ut][ir][filter]") {
+    CHECK(GlobMatch("std::*", "std::vector<int>"));
+    CHECK(GlobMatch("*::detail::*", "llvm::detail::Impl"));
+    CHECK(GlobMatch("f?o", "foo"));
+    CHECK_FALSE(GlobMatch("f?o", "fooo"));
+    CHECK_FALSE(GlobMatch("std::*", "boost::any"));
+    CHECK(GlobMatch("*", ""));
+
+    CHECK(NamePattern("re:ns[0-9]+::.*").matches("ns42::x"));
+    CHECK_FALSE(NamePattern("re:ns[0-9]+").matches("ns42::x")); // whole-name match
+
+    NameRule rule;
+    CHECK(rule.passes("anything"));
+    rule.addInclude("app::*");
+    rule.addExclude("app::test*");
+    CHECK(rule.passes("app::main"));
+    CHECK_FALSE(rule.passes("app::testHelper"));
+    CHECK_FALSE(rule.passes("lib::x"));
+}
+
+TEST_CASE("Name patterns match interned names across fragments", "[ut][ir][filter]") {
+    IRName name("app::detail::Map<app::Key, std::vector<int>>");
+    int fragments = 0;
+    name.forEachFragment([&](std::string_view) { ++fragments; });
+    REQUIRE(fragments > 1);
+
+    CHECK(NamePattern("app::*").matchesName(name));
+    CHECK(NamePattern("*::detail::Map<*>").matchesName(name));
+    CHECK(NamePattern("*Key, std::vector<?nt>>").matchesName(name));
+    CHECK_FALSE(NamePattern("std::*").matchesName(name));
+    CHECK(NamePattern("re:app::(detail::)?Map<.*>").matchesName(name));
+    CHECK_FALSE(NamePattern("re:app::Map<.*>").matchesName(name));
+    CHECK(NamePattern("*").matchesName(IRName()));
+
+    NameRule rule;
+    rule.addExclude("*vector<int>>");
+    CHECK(rule.excludesName(name));
+    CHECK_FALSE(rule.passesName(name));
+    CHECK(rule.passesName(IRName("app::Key")));
+}
+
+TEST_CASE("Namespace filters keep nested namespaces and prune excluded ones", "[ut][ir][filter]") {
+    IRFilter f;
+    f.namespaces.addInclude("app");
+    f.namespaces.addExclude("app::internal");
+
+    CHECK(f.namespaceVerdict("app", false) == NamespaceVerdict::Keep);
+    CHECK(f.namespaceVerdict("app::ui", true) == NamespaceVerdict::Keep);
+    CHECK(f.namespaceVerdict("app::internal", true) == NamespaceVerdict::Prune);
+    CHECK(f.namespaceVerdict("lib", false) == NamespaceVerdict::Descend);
+}
+
+TEST_CASE("ApplyFilter keeps only symbols that pass and the types they reach", "[ut][ir][filter]") {
+    IRTypeTable types;
+    IRType* node = types.createType(IRTypeKind::StructOrUnion);
+    node->name = "app::Node";
+    IRType* nodePtr = types.createType(IRTypeKind::Pointer);
+    nodePtr->name = "app::Node*";
+    nodePtr->pointeeType = node->id;
+    node->fields.push_back(IRField{"next", nodePtr->id, 0, 0, 0, false});
+    IRType* payload = types.createType(IRTypeKind::StructOrUnion);
+    payload->name = "app::Payload";
+    node->fields.push_back(IRField{"data", payload->id, 8, 0, 0, false});
+    IRType* unused = types.createType(IRTypeKind::StructOrUnion);
+    unused->name = "lib::Unused";
+    IRType* secret = types.createType(IRTypeKind::StructOrUnion);
+    secret->name = "app::internal::Secret";
+
+    IRScope cu;
+    cu.name = "a.cpp";
+    cu.declaredTypes = {node->id, nodePtr->id, payload->id, unused->id};
+    cu.declaredSymbols = {{"globalCounter", IRSymbolKind::Variable, unused->id, {}}};
+
+    IRScope* app = AddScope(cu, IRScopeKind::Namespace, "app");
+    app->declaredSymbols = {{"head", IRSymbolKind::Variable, nodePtr->id, {}},
+                            {"testOnly", IRSymbolKind::Variable, unused->id, {}},
+                            {"run", IRSymbolKind::Function, 0, {}},
+                            {"testMain", IRSymbolKind::Function, 0, {}}};
+    AddScope(*app, IRScopeKind::Function, "run");
+    AddScope(*app, IRScopeKind::Function, "testMain");
+    IRScope* internal = AddScope(*app, IRScopeKind::Namespace, "internal");
+    internal->declaredTypes = {secret->id};
+    internal->declaredSymbols = {{"key", IRSymbolKind::Variable, secret->id, {}}};
+    IRScope* lib = AddScope(cu, IRScopeKind::Namespace, "lib");
+    lib->declaredSymbols = {{"helper", IRSymbolKind::Function, 0, {}}};
+
+    IRFilter f;
+    f.namespaces.addInclude("app");
+    f.namespaces.addExclude("app::internal");
+    f.symbols.addExclude("*::test*");
+    REQUIRE(ApplyFilter(cu, types, f));
+
+    CHECK(cu.declaredSymbols.empty());               // global namespace not selected
+    REQUIRE(cu.children.size() == 1);                 // lib had nothing selected
+    REQUIRE(cu.children[0].get() == app);
+    REQUIRE(app->declaredSymbols.size() == 2);
+    CHECK(app->declaredSymbols[0].name == "head");
+    CHECK(app->declaredSymbols[1].name == "run");
+    REQUIRE(app->children.size() == 1);               // testMain's body and internal are gone
+    CHECK(app->children[0]->name == "run");
+
+    // head -> Node* -> Node -> {Node*, Payload}; Unused is no longer referenced.
+    CHECK(Has(cu.declaredTypes, node->id));
+    CHECK(Has(cu.declaredTypes, nodePtr->id));
+    CHECK(Has(cu.declaredTypes, payload->id));
+    CHECK_FALSE(Has(cu.declaredTypes, unused->id));
+}
+
+TEST_CASE("Type filters add roots and cut the reachability walk", "[ut][ir][filter]") {
+    IRTypeTable types;
+    IRType* a = types.createType(IRTypeKind::StructOrUnion);
+    a->name = "A";
+    IRType* big = types.createType(IRTypeKind::StructOrUnion);
+    big->name = "BigGenerated";
+    a->fields.push_back(IRField{"gen", big->id, 0, 0, 0, false});
+    IRType* b = types.createType(IRTypeKind::StructOrUnion);
+    b->name = "Config";
+
+    IRScope cu;
+    cu.name = "b.cpp";
+    cu.declaredTypes = {a->id, big->id, b->id};
+    cu.declaredSymbols = {{"instance", IRSymbolKind::Variable, a->id, {}}};
+
+    IRFilter f;
+    f.types.addInclude("Conf*");
+    f.types.addExclude("Big*");
+    REQUIRE(ApplyFilter(cu, types, f));
+    CHECK(Has(cu.declaredTypes, a->id));
+    CHECK(Has(cu.declaredTypes, b->id));
+    CHECK_FALSE(Has(cu.declaredTypes, big->id));
+}
+
+TEST_CASE("Types declared in one unit and used in another stay declared once", "[ut][ir][filter]") {
+    IRTypeTable types;
+    IRType* shared = types.createType(IRTypeKind::StructOrUnion);
+    shared->name = "Shared";
+    IRType* local = types.createType(IRTypeKind::StructOrUnion);
+    local->name = "Local";
+
+    // 'declaring' declares Shared but only uses Local; 'using' uses Shared.
+    auto declaring = [&] {
+        IRScope cu;
+        cu.name = "decl.cpp";
+        cu.declaredTypes = {shared->id, local->id};
+        cu.declaredSymbols = {{"l", IRSymbolKind::Variable, local->id, {}}};
+        return cu;
+    };
+    auto using_ = [&] {
+        IRScope cu;
+        cu.name = "use.cpp";
+        cu.declaredSymbols = {{"s", IRSymbolKind::Variable, shared->id, {}},
+                              {"dropped", IRSymbolKind::Variable, local->id, {}}};
+        return cu;
+    };
+    IRFilter f;
+    f.symbols.addExclude("dropped");
+
+    {   // declared first
+        IRFilterState state;
+        IRScope a = declaring(), b = using_();
+        REQUIRE(ApplyFilter(a, types, f, &state));
+        REQUIRE(ApplyFilter(b, types, f, &state));
+        CHECK(a.declaredTypes == std::vector<IRTypeID>({local->id}));
+        CHECK(b.declaredTypes == std::vector<IRTypeID>({shared->id}));
+    }
+    {   // used first
+        IRFilterState state;
+        IRScope b = using_(), a = declaring();
+        REQUIRE(ApplyFilter(b, types, f, &state));
+        REQUIRE(ApplyFilter(a, types, f, &state));
+        CHECK(b.declaredTypes.empty());
+        CHECK(a.declaredTypes == std::vector<IRTypeID>({shared->id, local->id}));
+    }
+}
+
+TEST_CASE("ApplyFilter drops namespaces left with no types", "[ut][ir][filter]") {
+    IRTypeTable types;
+    IRType* used = types.createType(IRTypeKind::StructOrUnion);
+    used->name = "outer::Used";
+    IRType* unused = types.createType(IRTypeKind::StructOrUnion);
+    unused->name = "outer::inner::Unused";
+
+    IRScope cu;
+    cu.name = "c.cpp";
+    cu.declaredSymbols = {{"u", IRSymbolKind::Variable, used->id, {}}};
+    IRScope* outer = AddScope(cu, IRScopeKind::Namespace, "outer");
+    outer->declaredTypes = {used->id};
+    IRScope* inner = AddScope(*outer, IRScopeKind::Namespace, "inner");
+    inner->declaredTypes = {unused->id};
+    IRScope* statics = AddScope(*inner, IRScopeKind::FileStatic, "");
+    statics->declaredTypes = {unused->id};
+    IRScope* other = AddScope(cu, IRScopeKind::Namespace, "other");
+    other->declaredTypes = {unused->id};
+
+    IRFilter f;
+    f.symbols.addExclude("nothing");
+    REQUIRE(ApplyFilter(cu, types, f));
+    REQUIRE(cu.children.size() == 1);
+    CHECK(cu.children[0].get() == outer);
+    CHECK(outer->declaredTypes == std::vector<IRTypeID>({used->id}));
+    CHECK(outer->children.empty());
+}
+
+TEST_CASE("Readers skip units excluded by name", "[ut][ir][filter]") {
+    IRTypeTable types;
+    IRMaps maps;
+    IRFilter f;
+    f.units.addExclude("*.o");
+
+    DwarfReader reader;
+    reader.setFilter(&f);
+    std::size_t units = 0;
+    reader.readObjectStreaming("skipped.o", types, maps,
+                               [&](std::unique_ptr<IRScope>) { ++units; });
+    CHECK(units == 0);
+    CHECK(types.lookup(1) == nullptr); // nothing was decoded
+
+    reader.readObjectStreaming("kept.obj", types, maps,
+                               [&](std::unique_ptr<IRScope>) { ++units; });
+    CHECK(units == 1);
+}
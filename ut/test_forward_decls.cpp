@@ -0,0 +1,129 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include "ir/IRForwardDecls.h"
+#include "ir/IRTypeTable.h"
+
+namespace {
+
+IRType* Record(IRTypeTable& table, const std::string& name, std::uint64_t size, bool fwd,
+               bool isUnion = false) {
+    IRType* t = table.createType(IRTypeKind::StructOrUnion);
+    t->name = name;
+    t->sizeBytes = size;
+    t->isForwardDecl = fwd;
+    t->isUnion = isUnion;
+    return t;
+}
+
+IRType* PointerTo(IRTypeTable& table, IRTypeID pointee) {
+    IRType* p = table.createType(IRTypeKind::Pointer);
+    p->pointeeType = pointee;
+    p->ptrSizeBytes = 8;
+    return p;
+}
+
+// Many CUs each forward-declaring the same few structs, defined elsewhere.
+void BuildProgram(IRTypeTable& table, int units) {
+    for (int u = 0; u < units; ++u) {
+        std::string name = "ns::S" + std::to_string(u % 97);
+        IRType* decl = Record(table, name, 0, true);
+        IRType* ptr  = PointerTo(table, decl->id);
+        IRType* user = Record(table, "ns::User" + std::to_string(u), 8, false);
+        user->fields.push_back({"p", ptr->id});
+        if (u < 97) Record(table, name, 16, false);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Forward decls resolve to definitions in other units", "[ut][ir][fwd]") {
+    IRTypeTable table;
+
+    // CU 1: struct Node; struct List { Node* head; };
+    IRType* nodeDecl = Record(table, "Node", 0, true);
+    IRType* nodePtr1 = PointerTo(table, nodeDecl->id);
+    IRType* list     = Record(table, "List", 8, false);
+    list->fields.push_back({"head", nodePtr1->id});
+
+    // CU 2: struct Node { Node* next; int v; };  (self-referential)
+    IRType* nodeDecl2 = Record(table, "Node", 0, true);
+    IRType* nodePtr2  = PointerTo(table, nodeDecl2->id);
+    IRType* node      = Record(table, "Node", 16, false);
+    node->fields.push_back({"next", nodePtr2->id});
+    node->fields.push_back({"v", nodeDecl2->id, 8}); // by-value use of the decl
+
+    IRForwardResolution r = ResolveForwardDecls(table, 4);
+    CHECK(r.forwardDecls == 2);
+    CHECK(r.resolved == 2);
+    CHECK(r.references == 3);
+    CHECK(r.canonical(nodeDecl->id) == node->id);
+    CHECK(r.canonical(nodeDecl2->id) == node->id);
+    CHECK(r.canonical(list->id) == list->id);
+
+    CHECK(nodePtr1->pointeeType == node->id);
+    CHECK(nodePtr2->pointeeType == node->id);
+    CHECK(node->fields[1].type == node->id);
+    CHECK(list->fields[0].type == nodePtr1->id);
+}
+
+TEST_CASE("Forward decls match by kind and size only", "[ut][ir][fwd]") {
+    IRTypeTable table;
+    IRType* s4     = Record(table, "S", 4, false);
+    IRType* s8     = Record(table, "S", 8, false);
+    IRType* sized  = Record(table, "S", 8, true);
+    IRType* bare   = Record(table, "S", 0, true);
+    IRType* bare2  = Record(table, "S", 0, true);
+    IRType* uDecl  = Record(table, "S", 0, true, /*isUnion=*/true);
+    IRType* anon   = Record(table, "anonymous$1", 0, true);
+    IRType* anonD  = Record(table, "anonymous$1", 4, false);
+    IRType* unDecl = Record(table, "", 0, true);
+    IRType* nsAnon = Record(table, "ns::<unnamed-tag>", 0, true);
+    Record(table, "ns::<unnamed-tag>", 4, false);
+    IRType* argAnon = Record(table, "std::vector<(anonymous namespace)::Item>", 0, true);
+    Record(table, "std::vector<(anonymous namespace)::Item>", 24, false);
+    // A marker split across fragments by a reader that built the name.
+    IRName parts[] = {IRNameStore::shared().atom("x::__un"), IRNameStore::shared().atom("named_3")};
+    IRType* split = Record(table, "", 0, true);
+    split->name = IRNameStore::shared().concat(parts, 2);
+    Record(table, "x::__unnamed_3", 4, false);
+
+    IRForwardResolution r = ResolveForwardDecls(table);
+    CHECK(r.canonical(sized->id) == s8->id);
+    // Definitions disagree on the size: size-0 decls stay decls, merged.
+    CHECK(r.canonical(bare->id) == bare->id);
+    CHECK(r.canonical(bare2->id) == bare->id);
+    CHECK(r.canonical(s4->id) == s4->id);
+    // No union "S" definition.
+    CHECK(r.canonical(uDecl->id) == uDecl->id);
+    // Anonymous aggregates are never matched by name.
+    CHECK(r.canonical(anon->id) == anon->id);
+    CHECK(r.canonical(anonD->id) == anonD->id);
+    CHECK(r.canonical(unDecl->id) == unDecl->id);
+    CHECK(r.canonical(nsAnon->id) == nsAnon->id);
+    CHECK(r.canonical(argAnon->id) == argAnon->id);
+    CHECK(r.canonical(split->id) == split->id);
+    CHECK(r.forwardDecls == 4);
+    CHECK(r.resolved == 1);
+}
+
+TEST_CASE("Forward decl resolution rewrites symbols and ignores job count", "[ut][ir][fwd]") {
+    IRTypeTable one, many;
+    BuildProgram(one, 5000);
+    BuildProgram(many, 5000);
+
+    IRForwardResolution r1 = ResolveForwardDecls(one, 1);
+    IRForwardResolution r8 = ResolveForwardDecls(many, 8);
+    CHECK(r1.remap == r8.remap);
+    CHECK(r1.resolved == 5000);
+    CHECK(r8.references == r1.references);
+
+    IRScope cu;
+    IRSymbol global;
+    global.name = "g";
+    global.type = 1; // first "ns::S0" decl
+    cu.declaredSymbols.push_back(global);
+    CHECK(r1.rewrite(cu) == 1);
+    const IRType* def = one.lookup(cu.declaredSymbols[0].type);
+    bool isDefinition = def && !def->isForwardDecl && def->name == "ns::S0";
+    CHECK(isDefinition);
+}
@@ -0,0 +1,239 @@
+#include <catch2/catch_all.hpp>
+#include "ir/IRInlinee.h"
+#include "ir/IRTypeTable.h"
+#include "ir/IRMaps.h"
+#include "pdb/CodeViewInlinees.h"
+#include "pipeline/DwarfToPdb.h"
+#include "pipeline/PdbToDwarf.h"
+
+TEST_CASE("IRInlineeTable keeps one entry per origin", "[ut][ir][inline]") {
+    IRInlineeTable table;
+    IRInlineeID a = table.intern(0x100, "std::vector<int>::size", 7);
+    IRInlineeID b = table.intern(0x200, "std::max<int>", 8);
+    IRInlineeID c = table.intern(0x100, "ignored on re-intern", 0);
+
+    CHECK(a == c);
+    CHECK(a != b);
+    CHECK(table.size() == 2);
+    CHECK(table.get(a).name == "std::vector<int>::size");
+    CHECK(table.find(0x200) == b);
+    CHECK(table.find(0x300) == 0);
+}
+
+TEST_CASE("Binary annotations round-trip ranges, gaps and file changes", "[ut][pdb][inline]") {
+    std::vector<InlineSiteRange> in = {
+        {0x10, 4,  0,  12},
+        {0x14, 8,  0,  13},   // contiguous, small deltas
+        {0x40, 2,  0,  9},    // gap, negative line delta
+        {0x42, 300, 24, 500}, // other file, big deltas
+    };
+    std::vector<std::uint8_t> ann;
+    AppendInlineAnnotations(in.data(), in.size(), 0, 10, ann);
+
+    std::vector<InlineSiteRange> out;
+    REQUIRE(DecodeInlineAnnotations(IRBytes{ann.data(), ann.size()}, 0, 10, out));
+    REQUIRE(out.size() == in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        CHECK(out[i].codeOffset == in[i].codeOffset);
+        CHECK(out[i].length == in[i].length);
+        CHECK(out[i].fileId == in[i].fileId);
+        CHECK(out[i].line == in[i].line);
+    }
+
+    std::vector<std::uint8_t> rec;
+    AppendInlineSiteRecord(0x1000, ann, rec);
+    CHECK(rec.size() % 4 == 0);
+    CHECK(rec[2] == 0x4d); // S_INLINESITE
+}
+
+TEST_CASE("Inline site ranges exclude nested sites and follow line rows", "[ut][inline]") {
+    IRLineTable lines;
+    lines.files.resize(1);
+    lines.appendRow(0x1000, 0, 1, 0, IRLineIsStmt);
+    lines.appendRow(0x1010, 0, 50, 0, IRLineIsStmt); // inlined body
+    lines.appendRow(0x1018, 0, 51, 0, IRLineIsStmt);
+    lines.appendRow(0x1020, 0, 2, 0, IRLineIsStmt);
+    lines.endSequence(0, 0x1040);
+
+    IRScope fn;
+    fn.kind = IRScopeKind::Function;
+    fn.lowPC = 0x1000;
+    fn.highPC = 0x1040;
+
+    IRScope site;
+    site.kind = IRScopeKind::Inlined;
+    site.lowPC = 0x1010;
+    site.highPC = 0x1020;
+    auto nested = std::make_unique<IRScope>();
+    nested->kind = IRScopeKind::Inlined;
+    nested->lowPC = 0x1014;
+    nested->highPC = 0x1018;
+    site.children.push_back(std::move(nested));
+
+    std::vector<std::uint32_t> chk = {0};
+    std::vector<InlineSiteRange> ranges;
+    CollectInlineSiteRanges(site, fn, nullptr, &lines, chk, 0, 49, ranges);
+
+    REQUIRE(ranges.size() == 2);
+    CHECK(ranges[0].codeOffset == 0x10);
+    CHECK(ranges[0].length == 4);      // stops at the nested site
+    CHECK(ranges[0].line == 50);
+    CHECK(ranges[1].codeOffset == 0x18);
+    CHECK(ranges[1].length == 8);
+    CHECK(ranges[1].line == 51);
+}
+
+// f() inlines g() twice; g's origin is shared.
+static void BuildInlinedCU(IRScope& cu) {
+    cu.name = "inl.cpp";
+    cu.inlinees = std::make_unique<IRInlineeTable>();
+    IRInlineeID g = cu.inlinees->intern(0x500, "g", 0);
+    cu.inlinees->get(g).declLine = 3;
+
+    auto fn = std::make_unique<IRScope>();
+    fn->kind = IRScopeKind::Function;
+    fn->name = "f";
+    fn->lowPC = 0x1000;
+    fn->highPC = 0x1100;
+    fn->parent = &cu;
+    for (std::uint64_t lo : {0x1010, 0x1080}) {
+        auto site = std::make_unique<IRScope>();
+        site->kind = IRScopeKind::Inlined;
+        site->inlinee = g;
+        site->callLine = 20;
+        site->lowPC = lo;
+        site->highPC = lo + 0x10;
+        site->parent = fn.get();
+        fn->children.push_back(std::move(site));
+    }
+    cu.children.push_back(std::move(fn));
+}
+
+TEST_CASE("DwarfToPdb emits shared LF_FUNC_ID and one S_INLINESITE per site", "[ut][pdb][inline]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+    IRScope cu;
+    BuildInlinedCU(cu);
+
+    DwarfToPdb d2p;
+    auto mod = d2p.translateUnit(cu, typeTable, maps);
+
+    int funcIds = 0, sites = 0, inlineeLines = 0;
+    for (const auto& c : mod->children) {
+        if (c->leafKind == LF_FUNC_ID) ++funcIds;
+        if (c->leafKind == S_INLINESITE) ++sites;
+        if (c->leafKind == DEBUG_S_INLINEELINES) ++inlineeLines;
+    }
+    CHECK(funcIds == 1);
+    CHECK(sites == 2);
+    CHECK(inlineeLines == 1);
+
+    // A second CU inlining the same g() reuses the LF_FUNC_ID item.
+    IRScope cu2;
+    BuildInlinedCU(cu2);
+    auto mod2 = d2p.translateUnit(cu2, typeTable, maps);
+    for (const auto& c : mod2->children) CHECK(c->leafKind != LF_FUNC_ID);
+}
+
+TEST_CASE("Inline sites inside a block of an inlined body stay nested", "[ut][pdb][inline]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+    IRScope cu;
+    cu.name = "blk.cpp";
+    cu.inlinees = std::make_unique<IRInlineeTable>();
+    IRInlineeID g = cu.inlinees->intern(0x500, "g", 0);
+    IRInlineeID h = cu.inlinees->intern(0x600, "h", 0);
+
+    // f() { g() { { h(); } } }
+    auto fn = std::make_unique<IRScope>();
+    fn->kind = IRScopeKind::Function;
+    fn->name = "f";
+    fn->lowPC = 0x1000;
+    fn->highPC = 0x1100;
+    fn->parent = &cu;
+    auto outer = std::make_unique<IRScope>();
+    outer->kind = IRScopeKind::Inlined;
+    outer->inlinee = g;
+    outer->lowPC = 0x1010;
+    outer->highPC = 0x1040;
+    outer->parent = fn.get();
+    auto block = std::make_unique<IRScope>();
+    block->kind = IRScopeKind::Block;
+    block->lowPC = 0x1018;
+    block->highPC = 0x1030;
+    block->parent = outer.get();
+    auto inner = std::make_unique<IRScope>();
+    inner->kind = IRScopeKind::Inlined;
+    inner->inlinee = h;
+    inner->lowPC = 0x1020;
+    inner->highPC = 0x1028;
+    inner->parent = block.get();
+    block->children.push_back(std::move(inner));
+    outer->children.push_back(std::move(block));
+
+    std::vector<std::uint32_t> chk = {0};
+    std::vector<InlineSiteRange> ranges;
+    CollectInlineSiteRanges(*outer, *fn, nullptr, nullptr, chk, 0, 3, ranges);
+    REQUIRE(ranges.size() == 2); // h's code is cut out of g's
+    CHECK(ranges[0].length == 0x10);
+    CHECK(ranges[1].codeOffset == 0x28);
+
+    fn->children.push_back(std::move(outer));
+    cu.children.push_back(std::move(fn));
+    DwarfToPdb d2p;
+    auto mod = d2p.translateUnit(cu, typeTable, maps);
+
+    const PdbNode* site = nullptr;
+    for (const auto& c : mod->children) {
+        if (c->leafKind == S_INLINESITE) {
+            CHECK(site == nullptr);
+            site = c.get();
+        }
+    }
+    REQUIRE(site != nullptr);
+    REQUIRE(site->children.size() == 1);
+    CHECK(site->children[0]->leafKind == S_INLINESITE);
+}
+
+TEST_CASE("PdbToDwarf maps inline sites back to DW_AT_abstract_origin", "[ut][dwarf][inline]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+    IRScope cu;
+    BuildInlinedCU(cu);
+
+    PdbToDwarf p2d;
+    auto cuDie = p2d.translateUnit(cu, typeTable, maps);
+    REQUIRE(cuDie->children.size() == 2);
+
+    const DwarfNode& abstractG = *cuDie->children[0];
+    CHECK(abstractG.tag == 0x2e);
+    const DwarfNode& f = *cuDie->children[1];
+    REQUIRE(f.children.size() == 2);
+    for (const auto& site : f.children) {
+        CHECK(site->tag == 0x1d);
+        CHECK(site->attrsU64[0].first == 0x31);
+        CHECK(site->attrsU64[0].second == abstractG.originalDieOffset);
+    }
+}
+
+TEST_CASE("PdbToDwarf writes inline sites without an inlinee as blocks", "[ut][dwarf][inline]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+    IRScope cu;
+    BuildInlinedCU(cu);
+    IRScope& f = *cu.children.back();
+    f.children[0]->inlinee = 0;
+    f.children[1]->inlinee = 99; // not in the unit's inlinee table
+
+    PdbToDwarf p2d;
+    auto cuDie = p2d.translateUnit(cu, typeTable, maps);
+    REQUIRE(cuDie->children.size() == 2);
+    const DwarfNode& fn = *cuDie->children[1];
+    REQUIRE(fn.children.size() == 2);
+    for (const auto& site : fn.children) {
+        CHECK(site->tag == 0x0b);
+        bool hasOrigin = false;
+        for (const auto& a : site->attrsU64) hasOrigin |= a.first == 0x31;
+        CHECK_FALSE(hasOrigin);
+    }
+}
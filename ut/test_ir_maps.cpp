@@ -0,0 +1,106 @@
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "ir/IRMaps.h"
+
+TEST_CASE("IRDenseMap keeps holes and moves entries on remap", "[ut][maps]") {
+    IRDenseMap<std::uint32_t> m;
+    CHECK(m.empty());
+    m.set(3, 0x1002);
+    m.set(1, 0x1000);
+    m.set(3, 0x1003);
+    CHECK(m.size() == 2);
+    CHECK(!m.contains(2));
+    CHECK(m.find(2) == nullptr);
+    CHECK(*m.find(3) == 0x1003);
+    CHECK(m.at(1) == 0x1000);
+    bool threw = false;
+    try {
+        m.at(9);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    std::vector<std::pair<IRTypeID, std::uint32_t>> seen;
+    m.forEach([&](IRTypeID id, std::uint32_t ti) { seen.emplace_back(id, ti); });
+    REQUIRE(seen.size() == 2);
+    CHECK(seen[0].first == 1);
+    CHECK(seen[1].second == 0x1003);
+
+    // 1 -> 4, 3 -> 2; IDs past the remap keep theirs.
+    m.set(7, 0x1007);
+    m.remapKeys({0, 4, 0, 2});
+    CHECK(m.size() == 3);
+    CHECK(m.at(4) == 0x1000);
+    CHECK(m.at(2) == 0x1003);
+    CHECK(m.at(7) == 0x1007);
+    CHECK(!m.contains(1));
+
+    IRDenseMap<std::uint32_t> other;
+    other.set(7, 0x1007);
+    other.set(2, 0x1003);
+    other.set(4, 0x1000);
+    bool same = m == other;
+    CHECK(same);
+    other.erase(4);
+    CHECK(other.size() == 2);
+    bool differ = m != other;
+    CHECK(differ);
+}
+
+TEST_CASE("IRFlatMap grows, overwrites and looks up any key order", "[ut][maps]") {
+    IRFlatMap<std::uint64_t> m;
+    CHECK(m.find(42) == 0);
+
+    // Sequential offsets, then a scattered batch.
+    const IRTypeID kCount = 5000;
+    for (IRTypeID i = 1; i <= kCount; ++i) m.set(0x0b + 7ull * i, i);
+    for (IRTypeID i = 1; i <= kCount; ++i) m.set((std::uint64_t(i) * 0x2545f4914f6cdd1dull) | 1ull << 63, kCount + i);
+    CHECK(m.size() == 2 * kCount);
+    bool allFound = true;
+    for (IRTypeID i = 1; i <= kCount; ++i) {
+        allFound = allFound && m.find(0x0b + 7ull * i) == i;
+        allFound = allFound && m.find((std::uint64_t(i) * 0x2545f4914f6cdd1dull) | 1ull << 63) == kCount + i;
+    }
+    CHECK(allFound);
+    CHECK(!m.contains(0x0b));
+    CHECK(m.memoryBytes() <= 4 * 2 * kCount * (sizeof(std::uint64_t) + sizeof(IRTypeID)));
+
+    m.set(0x0b + 7, 99);
+    CHECK(m.size() == 2 * kCount);
+    CHECK(m.at(0x0b + 7) == 99);
+
+    // Bulk build gives the same table as one-by-one inserts, in any order.
+    std::vector<std::pair<std::uint32_t, IRTypeID>> pairs;
+    for (std::uint32_t ti = 0x1000; ti < 0x1000 + 300; ++ti) pairs.emplace_back(ti, ti - 0xfff);
+    IRFlatMap<std::uint32_t> bulk, single;
+    bulk.build(pairs);
+    for (auto it = pairs.rbegin(); it != pairs.rend(); ++it) single.set(it->first, it->second);
+    bool same = bulk == single;
+    CHECK(same);
+    CHECK(bulk.size() == 300);
+
+    std::vector<IRTypeID> remap(302, 0);
+    for (IRTypeID id = 1; id <= 300; ++id) remap[id] = 301 - id;
+    bulk.remapValues(remap);
+    CHECK(bulk.at(0x1000) == 300);
+    CHECK(bulk.at(0x1000 + 299) == 1);
+    bool differ = bulk != single;
+    CHECK(differ);
+}
+
+TEST_CASE("IRMaps links both directions of a side", "[ut][maps]") {
+    IRMaps maps;
+    maps.linkDwarf(5, 0x2a);
+    maps.linkPdb({{0x1000, 5}, {0x1001, 6}});
+    CHECK(maps.dwarfDieToIR.at(0x2a) == 5);
+    CHECK(maps.irToDwarfDie.at(5) == 0x2a);
+    CHECK(maps.pdbTIToIR.at(0x1001) == 6);
+    CHECK(maps.irToPdbTI.at(6) == 0x1001);
+    CHECK(maps.irToPdbTI.size() == 2);
+    CHECK(maps.dwarfSideBytes() > 0);
+    CHECK(maps.pdbSideBytes() > 0);
+}
@@ -0,0 +1,216 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <vector>
+#include "ir/IRLineTable.h"
+#include "dwarf/DwarfLineProgram.h"
+#include "pdb/CodeViewLines.h"
+#include "pipeline/DwarfToPdb.h"
+#include "ir/IRTypeTable.h"
+#include "ir/IRMaps.h"
+
+// Two functions in one sequence, the second partly from a header.
+static IRLineTable MakeTable() {
+    IRLineTable t;
+    IRLineFile a;
+    a.path = "/src/a.cpp";
+    a.checksumKind = 1;
+    for (int i = 0; i < 16; ++i) a.checksum[i] = static_cast<std::uint8_t>(i);
+    IRLineFile h = a;
+    h.path = "/src/a.h";
+    t.files = {a, h};
+
+    t.appendRow(0x1000, 0, 10, 5, IRLineIsStmt);
+    t.appendRow(0x1004, 0, 11, 9, IRLineIsStmt | IRLinePrologueEnd);
+    t.appendRow(0x1010, 0, 0,  0, 0);             // compiler-generated
+    t.appendRow(0x1100, 0, 20, 1, IRLineIsStmt);  // second function
+    t.appendRow(0x1108, 1, 3,  2, IRLineIsStmt);
+    t.appendRow(0x1400, 0, 25, 1, IRLineIsStmt);  // > 255 byte advance
+    t.endSequence(0, 0x1420);
+    return t;
+}
+
+static bool SameRows(const IRLineTable& a, const IRLineTable& b) {
+    return a.address == b.address && a.file == b.file && a.line == b.line &&
+           a.column == b.column && a.flags == b.flags &&
+           a.sequences.size() == b.sequences.size();
+}
+
+TEST_CASE("IRLineTable finds the rows of one function", "[ut][lines]") {
+    IRLineTable t = MakeTable();
+    std::uint32_t first = 0, count = 0;
+    REQUIRE(t.findRows(0x1100, 0x1420, first, count));
+    CHECK(first == 3);
+    CHECK(count == 3);
+    CHECK_FALSE(t.findRows(0x2000, 0x3000, first, count));
+
+    // A sequence that overlaps the range without a row in it is skipped.
+    t.appendRow(0x2000, 0, 30, 1, IRLineIsStmt);
+    t.endSequence(7, 0x2100);
+    REQUIRE(t.findRows(0x1410, 0x2100, first, count));
+    CHECK(first == 7);
+    CHECK(count == 1);
+}
+
+TEST_CASE(".debug_line encode -> decode round-trips the row columns", "[ut][lines][dwarf]") {
+    IRLineTable src = MakeTable();
+    std::vector<std::uint8_t> bytes;
+    EncodeLineProgram(src, bytes);
+
+    IRLineTable back;
+    std::size_t used = DecodeLineProgram(IRBytes{bytes.data(), bytes.size()},
+                                         DwarfLineStrings{}, back);
+    CHECK(used == bytes.size());
+    REQUIRE(back.files.size() == 2);
+    CHECK(back.files[1].path == "/src/a.h");
+    CHECK(back.files[0].checksumKind == 1);
+    CHECK(back.files[0].checksum[15] == 15);
+    CHECK(SameRows(src, back));
+    CHECK(back.sequences[0].highPC == 0x1420);
+}
+
+TEST_CASE(".debug_line headers with an unusable address size are rejected", "[ut][lines][dwarf]") {
+    std::vector<std::uint8_t> bytes;
+    EncodeLineProgram(MakeTable(), bytes);
+    for (std::uint8_t size : {0, 3, 16, 255}) {
+        std::vector<std::uint8_t> bad = bytes;
+        bad[6] = size; // address_size, after unit_length and version
+        IRLineTable back;
+        CHECK(DecodeLineProgram(IRBytes{bad.data(), bad.size()}, DwarfLineStrings{}, back) == 0);
+        CHECK(back.rowCount() == 0);
+    }
+}
+
+// A DWARF 'version' line program for one file whose only sequence starts
+// with a DW_LNE_set_address of 'addrBytes' bytes (no address_size field
+// before DWARF 5), emits a row, advances 0x10 and ends.
+static std::vector<std::uint8_t> OldLineProgram(std::uint16_t version, std::vector<std::uint8_t> addrBytes) {
+    std::vector<std::uint8_t> header = {1};                  // minimum_instruction_length
+    if (version >= 4) header.push_back(1);                    // maximum_operations_per_instruction
+    for (std::uint8_t b : {1, 0xfb, 14, 13}) header.push_back(b); // default_is_stmt .. opcode_base
+    for (std::uint8_t b : {0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1}) header.push_back(b);
+    header.push_back(0);                                      // no include_directories
+    for (char ch : std::string("a.c")) header.push_back(static_cast<std::uint8_t>(ch));
+    for (std::uint8_t b : {0, 0, 0, 0, 0}) header.push_back(b); // NUL, dir, mtime, length, end of files
+
+    std::vector<std::uint8_t> program = {0, static_cast<std::uint8_t>(addrBytes.size() + 1), 2};
+    program.insert(program.end(), addrBytes.begin(), addrBytes.end());
+    for (std::uint8_t b : {1, 2, 0x10, 0, 1, 1}) program.push_back(b); // copy, advance_pc, end_sequence
+
+    std::vector<std::uint8_t> unit;
+    auto put = [&](std::uint64_t v, unsigned n) {
+        for (unsigned i = 0; i < n; ++i) unit.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    };
+    put(2 + 4 + header.size() + program.size(), 4);
+    put(version, 2);
+    put(header.size(), 4);
+    unit.insert(unit.end(), header.begin(), header.end());
+    unit.insert(unit.end(), program.begin(), program.end());
+    return unit;
+}
+
+TEST_CASE("DWARF 2-4 line programs size set_address by its length", "[ut][lines][dwarf]") {
+    for (std::uint16_t version : {2, 3, 4}) {
+        std::vector<std::uint8_t> bytes = OldLineProgram(version, {0x00, 0x10, 0x40, 0x00});
+        IRLineTable back;
+        CHECK(DecodeLineProgram(IRBytes{bytes.data(), bytes.size()}, DwarfLineStrings{}, back) == bytes.size());
+        REQUIRE(back.rowCount() == 2);
+        CHECK(back.address[0] == 0x401000);
+        CHECK(back.line[0] == 1);
+        REQUIRE(back.sequences.size() == 1);
+        CHECK(back.sequences[0].highPC == 0x401010);
+        REQUIRE(back.files.size() == 1);
+        CHECK(back.files[0].path == "a.c");
+    }
+
+    std::vector<std::uint8_t> wide = OldLineProgram(4, {0, 0x10, 0x40, 0, 0, 0, 0, 0});
+    IRLineTable back;
+    DecodeLineProgram(IRBytes{wide.data(), wide.size()}, DwarfLineStrings{}, back);
+    REQUIRE(back.rowCount() == 2);
+    CHECK(back.address[0] == 0x401000);
+
+    std::vector<std::uint8_t> odd = OldLineProgram(4, {0, 0x10, 0x40});
+    IRLineTable none;
+    DecodeLineProgram(IRBytes{odd.data(), odd.size()}, DwarfLineStrings{}, none);
+    CHECK(none.rowCount() == 0);
+}
+
+TEST_CASE("Line programs of several CUs decode in parallel", "[ut][lines][dwarf]") {
+    IRLineTable src = MakeTable();
+    std::vector<std::uint8_t> section;
+    for (int i = 0; i < 8; ++i) EncodeLineProgram(src, section);
+
+    std::vector<IRBytes> units;
+    std::size_t off = 0;
+    while (off < section.size()) {
+        IRLineTable scratch;
+        IRBytes u{section.data() + off, section.size() - off};
+        std::size_t n = DecodeLineProgram(u, DwarfLineStrings{}, scratch);
+        REQUIRE(n != 0);
+        units.push_back(IRBytes{u.data, n});
+        off += n;
+    }
+    REQUIRE(units.size() == 8);
+
+    std::vector<IRLineTable> tables;
+    DecodeLineProgramsParallel(units, DwarfLineStrings{}, tables, 4);
+    REQUIRE(tables.size() == 8);
+    for (const IRLineTable& t : tables) CHECK(SameRows(src, t));
+}
+
+TEST_CASE("C13 file checksums + DEBUG_S_LINES round-trip", "[ut][lines][pdb]") {
+    IRLineTable src = MakeTable();
+    PdbStringTable names;
+
+    std::vector<std::uint8_t> chk;
+    std::vector<std::uint32_t> chkOffsets;
+    AppendFileChecksums(src, names, chk, chkOffsets);
+    REQUIRE(chkOffsets.size() == 2);
+    CHECK(chkOffsets[1] == 24); // 6 + 16 bytes, padded to 4
+
+    std::vector<std::uint8_t> lines;
+    REQUIRE(AppendLinesSubsection(src, 0x1100, 0x1420, 1, chkOffsets, lines));
+
+    // Skip the 8-byte subsection headers for decoding.
+    IRLineTable back;
+    std::unordered_map<std::uint32_t, std::uint32_t> fileMap;
+    const auto& n = names.data();
+    REQUIRE(DecodeFileChecksums(IRBytes{chk.data() + 8, chk.size() - 8},
+                                IRBytes{reinterpret_cast<const std::uint8_t*>(n.data()), n.size()},
+                                back, fileMap));
+    REQUIRE(DecodeLinesSubsection(IRBytes{lines.data() + 8, lines.size() - 8}, fileMap, back));
+
+    REQUIRE(back.files.size() == 2);
+    CHECK(back.files[1].path == "/src/a.h");
+    REQUIRE(back.rowCount() == 4); // 3 rows + end of sequence
+    CHECK(back.address[0] == 0);   // function-relative
+    CHECK(back.address[2] == 0x300);
+    CHECK(back.file[1] == 1);
+    CHECK(back.line[1] == 3);
+    CHECK(back.column[1] == 2);
+    CHECK(back.sequences[0].highPC == 0x320);
+}
+
+TEST_CASE("DwarfToPdb emits line subsections per function", "[ut][lines][pdb]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+
+    IRScope cu;
+    cu.name = "a.cpp";
+    cu.lines = std::make_unique<IRLineTable>(MakeTable());
+    for (auto range : {std::make_pair(0x1000, 0x1100), std::make_pair(0x1100, 0x1420)}) {
+        auto fn = std::make_unique<IRScope>();
+        fn->kind = IRScopeKind::Function;
+        fn->lowPC = range.first;
+        fn->highPC = range.second;
+        fn->parent = &cu;
+        cu.children.push_back(std::move(fn));
+    }
+
+    DwarfToPdb d2p;
+    auto mod = d2p.translateUnit(cu, typeTable, maps);
+    REQUIRE(mod->children.size() == 3);
+    CHECK(mod->children[0]->leafKind == DEBUG_S_FILECHKSMS);
+    CHECK(mod->children[1]->leafKind == DEBUG_S_LINES);
+    CHECK(mod->children[2]->leafKind == DEBUG_S_LINES);
+    CHECK(d2p.stringTable().data().size() > 1);
+}
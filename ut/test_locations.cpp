@@ -0,0 +1,177 @@
+#include <catch2/catch_all.hpp>
+#include <vector>
+#include "ir/IRLocation.h"
+#include "ir/IRTypeTable.h"
+#include "ir/IRMaps.h"
+#include "pipeline/LocationTranslate.h"
+#include "pipeline/DwarfToPdb.h"
+
+TEST_CASE("IRLocationPool interns identical expressions once", "[ut][ir][location]") {
+    IRLocationPool pool;
+    const std::uint8_t fbreg[] = {0x91, 0x70};  // DW_OP_fbreg -16
+    const std::uint8_t reg3[]  = {0x53};        // DW_OP_reg3
+
+    IRLocID a = pool.intern(IRLocFormat::DwarfExpr, fbreg, sizeof(fbreg));
+    IRLocID b = pool.intern(IRLocFormat::DwarfExpr, reg3, sizeof(reg3));
+    IRLocID c = pool.intern(IRLocFormat::DwarfExpr, fbreg, sizeof(fbreg));
+    IRLocID d = pool.intern(IRLocFormat::CodeViewDefRange, reg3, sizeof(reg3));
+
+    CHECK(a != 0);
+    CHECK(a == c);
+    CHECK(a != b);
+    CHECK(b != d); // same bytes, different format
+    CHECK(pool.size() == 3);
+    CHECK(pool.bytes(a).size == 2);
+
+    // Force a few rehashes and make sure everything still resolves.
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        std::uint8_t expr[] = {0x91, static_cast<std::uint8_t>(i & 0x7f),
+                               static_cast<std::uint8_t>(i >> 7)};
+        pool.intern(IRLocFormat::DwarfExpr, expr, sizeof(expr));
+    }
+    CHECK(pool.intern(IRLocFormat::DwarfExpr, fbreg, sizeof(fbreg)) == a);
+}
+
+TEST_CASE("Live ranges round-trip through the delta-encoded stream", "[ut][ir][location]") {
+    IRLocationPool pool;
+    const std::uint8_t reg0[] = {0x50};
+    IRLocID loc = pool.intern(IRLocFormat::DwarfExpr, reg0, 1);
+
+    const std::uint64_t fnLow = 0x140001000;
+    IRLiveRange in[] = {
+        {fnLow + 0x10, fnLow + 0x20, loc},
+        {fnLow + 0x18, fnLow + 0x40, loc}, // overlapping is allowed
+        {fnLow + 0x100, fnLow + 0x104, 0},
+    };
+    IRSymbolStorage st = pool.addRanges(fnLow, in, 3);
+    CHECK(st.rangeCount == 3);
+
+    auto cursor = pool.ranges(st, fnLow);
+    IRLiveRange r;
+    int n = 0;
+    while (cursor.next(r)) {
+        CHECK(r.begin == in[n].begin);
+        CHECK(r.end == in[n].end);
+        CHECK(r.loc == in[n].loc);
+        ++n;
+    }
+    CHECK(n == 3);
+}
+
+TEST_CASE("IRLocationPool::load rejects bad input and stays empty", "[ut][ir][location]") {
+    IRLocationPool pool;
+    const std::uint8_t fbreg[] = {0x91, 0x70};
+    pool.intern(IRLocFormat::DwarfExpr, fbreg, sizeof(fbreg));
+    pool.intern(IRLocFormat::CodeViewDefRange, fbreg, 1);
+    std::vector<std::uint8_t> saved;
+    pool.save(saved);
+
+    std::vector<std::uint8_t> badFormat = saved;
+    badFormat[1] = 7; // first entry's format byte, after the one-byte count
+    IRLocationPool back;
+    const std::uint8_t* p = badFormat.data();
+    CHECK_FALSE(back.load(p, badFormat.data() + badFormat.size()));
+    CHECK(back.size() == 0);
+
+    p = saved.data();
+    CHECK_FALSE(back.load(p, saved.data() + saved.size() - 3)); // truncated blob
+    CHECK(back.size() == 0);
+
+    p = saved.data();
+    REQUIRE(back.load(p, saved.data() + saved.size()));
+    CHECK(back.size() == 2);
+    CHECK(back.format(2) == IRLocFormat::CodeViewDefRange);
+}
+
+TEST_CASE("DW_OP locations convert directly to S_DEFRANGE and back", "[ut][location]") {
+    const std::uint8_t breg6[] = {0x76, 0x08}; // DW_OP_breg6 (rbp) +8
+    SimpleLocation loc = DecodeDwarfLocation(IRBytes{breg6, sizeof(breg6)});
+    REQUIRE(loc.shape == LocationShape::RegisterRel);
+    CHECK(loc.dwarfReg == 6);
+    CHECK(loc.offset == 8);
+
+    std::vector<std::uint8_t> rec;
+    REQUIRE(AppendDefRange(loc, 0x40, 1, 0x20, rec));
+
+    std::uint32_t off = 0;
+    std::uint16_t sect = 0, len = 0;
+    SimpleLocation back = DecodeDefRange(IRBytes{rec.data(), rec.size()}, &off, &sect, &len);
+    CHECK(back.shape == LocationShape::RegisterRel);
+    CHECK(back.dwarfReg == 6);
+    CHECK(back.offset == 8);
+    CHECK(off == 0x40);
+    CHECK(sect == 1);
+    CHECK(len == 0x20);
+
+    std::vector<std::uint8_t> expr;
+    REQUIRE(AppendDwarfLocation(back, expr));
+    CHECK(expr == std::vector<std::uint8_t>(breg6, breg6 + sizeof(breg6)));
+
+    // Ranges longer than 64K are split into several records.
+    const std::uint8_t reg5[] = {0x55};
+    SimpleLocation rdi = DecodeDwarfLocation(IRBytes{reg5, 1});
+    std::vector<std::uint8_t> recs;
+    REQUIRE(AppendDefRange(rdi, 0, 1, 0x18000, recs));
+    CHECK(recs.size() == 2 * 16);
+
+    // Frame-relative over the whole scope; truncated and foreign records.
+    SimpleLocation fb{LocationShape::FramePointerRel, 0, -24};
+    std::vector<std::uint8_t> full;
+    REQUIRE(AppendDefRange(fb, 0, 0, 0, full));
+    CHECK(full.size() == 8);
+    len = 1;
+    CHECK(DecodeDefRange(IRBytes{full.data(), full.size()}, nullptr, nullptr, &len).offset == -24);
+    CHECK(len == 0);
+    CHECK(DecodeDefRange(IRBytes{rec.data(), rec.size() - 4}).shape == LocationShape::None);
+    rec[2] = 0x43; // S_DEFRANGE_SUBFIELD_REGISTER
+    CHECK(DecodeDefRange(IRBytes{rec.data(), rec.size()}).shape == LocationShape::Complex);
+
+    // Pieces / stack values are not simple.
+    const std::uint8_t piece[] = {0x50, 0x93, 0x04}; // DW_OP_reg0 DW_OP_piece 4
+    CHECK(DecodeDwarfLocation(IRBytes{piece, sizeof(piece)}).shape == LocationShape::Complex);
+}
+
+TEST_CASE("DwarfToPdb emits S_LOCAL with defranges from pooled storage", "[ut][pdb][location]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+
+    IRScope cu;
+    cu.name = "opt.cpp";
+    cu.locations = std::make_unique<IRLocationPool>();
+
+    auto fn = std::make_unique<IRScope>();
+    fn->kind = IRScopeKind::Function;
+    fn->name = "f";
+    fn->lowPC = 0x1000;
+    fn->highPC = 0x1100;
+    fn->parent = &cu;
+
+    const std::uint8_t fbreg[] = {0x91, 0x70};
+    const std::uint8_t reg3[]  = {0x53};
+    IRSymbol whole;
+    whole.name = "x";
+    whole.storage.loc = cu.locations->intern(IRLocFormat::DwarfExpr, fbreg, sizeof(fbreg));
+
+    IRSymbol ranged;
+    ranged.name = "y";
+    IRLiveRange rs[] = {
+        {0x1000, 0x1010, cu.locations->intern(IRLocFormat::DwarfExpr, reg3, 1)},
+        {0x1010, 0x1080, whole.storage.loc},
+    };
+    ranged.storage = cu.locations->addRanges(fn->lowPC, rs, 2);
+
+    fn->declaredSymbols = {whole, ranged};
+    cu.children.push_back(std::move(fn));
+
+    DwarfToPdb d2p;
+    auto mod = d2p.translateUnit(cu, typeTable, maps);
+    REQUIRE(mod->children.size() == 2);
+
+    const PdbNode& x = *mod->children[0];
+    CHECK(x.leafKind == 0x113e);
+    REQUIRE(x.payload.size() == 8);
+    CHECK(DecodeDefRange(IRBytes{x.payload.data(), x.payload.size()}).offset == -16);
+
+    const PdbNode& y = *mod->children[1];
+    CHECK(y.payload.size() == 16 + 16); // one REGISTER + one FRAMEPOINTER_REL
+}
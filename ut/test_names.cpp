@@ -0,0 +1,115 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_set>
+#include "ir/IRName.h"
+#include "ir/IRTypeTable.h"
+
+TEST_CASE("Parsed names flatten back to the exact input", "[ut][ir][names]") {
+    IRNameStore store;
+    const char* names[] = {
+        "std::map<std::basic_string<char, std::char_traits<char>, std::allocator<char> >, int>",
+        "a::b::c",
+        "A<B<C>>::D<E,F>::G",
+        "Foo<int>*",
+        "x<>",
+        "operator<<",
+        "(anonymous namespace)::Impl",
+        "(lambda at a.cpp:3:4)",
+        "unbalanced<",
+        "stray>",
+    };
+    for (const char* n : names) {
+        IRName name = store.parse(n);
+        CHECK(name.str() == n);
+        CHECK(name == n);
+        CHECK(name.size() == std::string(n).size());
+    }
+}
+
+TEST_CASE("Shared sub-names are stored once", "[ut][ir][names]") {
+    IRNameStore store;
+    const std::string str = "std::basic_string<char, std::char_traits<char>, std::allocator<char> >";
+    store.parse(str);
+    std::size_t before = store.nodeCount();
+
+    IRName a = store.parse("std::vector<" + str + ">");
+    IRName b = store.parse("std::map<" + str + ", " + str + ">");
+    // Only the new wrappers are added; the string type is reused.
+    CHECK(store.nodeCount() - before < 12);
+
+    // Builders produce the same nodes as parsing the same text.
+    IRName built = store.qualified(store.atom("std"),
+                                   store.templated(store.atom("vector"), {store.parse(str)}));
+    CHECK(built.root() == a.root());
+    CHECK(built == a);
+    CHECK_FALSE(a == b);
+}
+
+TEST_CASE("Hash and order match the flattened text", "[ut][ir][names]") {
+    IRNameStore store;
+    IRName parsed = store.parse("ns::Box<ns::Item, 4>");
+    IRName flat = store.atom("ns::Box<ns::Item, 4>"); // same text, different shape
+    CHECK(parsed.root() != flat.root());
+    CHECK(parsed.hash() == flat.hash());
+    CHECK(parsed == flat);
+
+    CHECK(IRName::compare(store.parse("a<b>"), store.parse("a<c>")) < 0);
+    CHECK(IRName::compare(store.parse("a<b>::x"), store.parse("a<b>")) > 0);
+    CHECK(IRName::compare(store.parse("a<b>"), "a<b>") == 0);
+    CHECK(IRName::compare(IRName(), "") == 0);
+
+    std::unordered_set<IRName, IRNameHash> set{parsed};
+    CHECK(set.count(flat) == 1);
+}
+
+TEST_CASE("Deeply nested names fall back to one atom", "[ut][ir][names]") {
+    IRNameStore store;
+    std::string deep = "T";
+    for (int i = 0; i < 5000; ++i) deep = "W<" + deep + ">";
+    IRName name = store.parse(deep);
+    CHECK(name.root()->kind == IRNameNode::Atom);
+    CHECK(name == deep);
+
+    std::string shallow = "T";
+    for (int i = 0; i < 8; ++i) shallow = "W<" + shallow + ">";
+    CHECK(store.parse(shallow).root()->kind == IRNameNode::Concat);
+}
+
+TEST_CASE("Names parsed on several threads share nodes", "[ut][ir][names]") {
+    IRNameStore store;
+    std::vector<std::vector<IRName>> parsed(8);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < parsed.size(); ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 500; ++i) {
+                parsed[t].push_back(store.parse("ns::Box<ns::Item" + std::to_string(i) + ", std::pair<int, T" +
+                                                std::to_string((i + t) % 7) + ">>"));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    for (int i = 0; i < 500; ++i) {
+        std::string text = "ns::Box<ns::Item" + std::to_string(i) + ", std::pair<int, T" +
+                           std::to_string(i % 7) + ">>";
+        CHECK(parsed[0][i].str() == text);
+        CHECK(store.parse(text).root() == parsed[0][i].root());
+        CHECK(parsed[7][i] == store.parse("ns::Box<ns::Item" + std::to_string(i) + ", std::pair<int, T" +
+                                          std::to_string((i + 7) % 7) + ">>"));
+    }
+    // Same text from different threads is one node.
+    CHECK(parsed[0][0].root() == parsed[7][0].root());
+}
+
+TEST_CASE("IRType names intern through the shared store", "[ut][ir][names]") {
+    IRTypeTable table;
+    IRType* a = table.createType(IRTypeKind::StructOrUnion);
+    IRType* b = table.createType(IRTypeKind::StructOrUnion);
+    a->name = "std::pair<int, int>";
+    b->name = std::string("std::pair<int, int>");
+    CHECK(a->name.root() == b->name.root());
+    CHECK(a->name == "std::pair<int, int>");
+    CHECK(a->name.str() == "std::pair<int, int>");
+}
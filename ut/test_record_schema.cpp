@@ -0,0 +1,101 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include "util/RecordSchema.h"
+#include "pdb/CodeViewSchema.h"
+#include "pdb/CodeViewInlinees.h"
+#include "dwarf/DwarfSchema.h"
+
+TEST_CASE("Fixed-layout field lists decode with one bounds check", "[ut][schema]") {
+    using Fields = schema::FieldList<schema::Fixed<std::uint32_t>, schema::Fixed<std::uint16_t>>;
+    static_assert(Fields::kFixedLayout, "all fields are fixed");
+    static_assert(Fields::kFixedSize == 6, "u32 + u16");
+
+    std::vector<std::uint8_t> buf;
+    Fields::encode({0x11223344u, std::uint16_t(0xBEEF)}, buf);
+    REQUIRE(buf.size() == 6);
+
+    Fields::Values v;
+    std::size_t used = 0;
+    REQUIRE(Fields::decode(IRBytes{buf.data(), buf.size()}, v, &used));
+    CHECK(used == 6);
+    CHECK(std::get<0>(v) == 0x11223344u);
+    CHECK(std::get<1>(v) == 0xBEEF);
+    CHECK_FALSE(Fields::decode(IRBytes{buf.data(), 5}, v));
+}
+
+TEST_CASE("Numeric leaves pick the smallest encoding", "[ut][schema]") {
+    for (std::uint64_t value : {std::uint64_t(8), std::uint64_t(0x8000),
+                                std::uint64_t(0x12345678), std::uint64_t(1) << 40}) {
+        std::vector<std::uint8_t> buf;
+        schema::NumericLeaf::write(buf, value);
+        const std::uint8_t* p = buf.data();
+        std::uint64_t back = 0;
+        REQUIRE(schema::NumericLeaf::read(p, buf.data() + buf.size(), back));
+        CHECK(back == value);
+        CHECK(p == buf.data() + buf.size());
+    }
+}
+
+TEST_CASE("LF_STRUCTURE round-trips through its schema with LF_PAD", "[ut][schema][pdb]") {
+    std::vector<std::uint8_t> rec;
+    cv::LfStructure::encode({std::uint16_t(3), std::uint16_t(0x200), 0x1004u, 0u, 0u,
+                             std::uint64_t(24), "Pt", ".?AUPt@@"}, rec);
+    REQUIRE(rec.size() % 4 == 0);
+    CHECK(rec[2] == 0x05);
+    CHECK(rec[3] == 0x15);
+    CHECK((rec.back() & 0xF0) == 0xF0);
+
+    cv::LfStructure::Values v;
+    REQUIRE(cv::LfStructure::decode(IRBytes{rec.data(), rec.size()}, v));
+    CHECK(std::get<cv::LfStructure::Count>(v) == 3);
+    CHECK(std::get<cv::LfStructure::FieldList>(v) == 0x1004u);
+    CHECK(std::get<cv::LfStructure::Size>(v) == 24);
+    CHECK(std::get<cv::LfStructure::Name>(v) == "Pt");
+    CHECK(std::get<cv::LfStructure::UniqueName>(v) == ".?AUPt@@");
+
+    // Wrong kind is rejected rather than misread.
+    cv::LfUnion::Values u;
+    CHECK_FALSE(cv::LfUnion::decode(IRBytes{rec.data(), rec.size()}, u));
+}
+
+TEST_CASE("Dispatch selects the record type by kind", "[ut][schema][pdb]") {
+    std::vector<std::uint8_t> rec;
+    AppendFuncIdRecord(0, 0x1010, "helper", rec);
+
+    std::uint16_t kind = static_cast<std::uint16_t>(rec[2] | (rec[3] << 8));
+    std::string name;
+    bool hit = cv::Dispatch<cv::LfPointer, cv::LfFuncId, cv::LfStructure>(kind, [&](auto r) {
+        using Rec = decltype(r);
+        typename Rec::Values v;
+        REQUIRE(Rec::decode(IRBytes{rec.data(), rec.size()}, v));
+        if constexpr (std::is_same<Rec, cv::LfFuncId>::value) name = std::string(std::get<cv::LfFuncId::Name>(v));
+    });
+    CHECK(hit);
+    CHECK(name == "helper");
+    CHECK_FALSE(cv::Dispatch<cv::LfPointer>(kind, [](auto) {}));
+}
+
+TEST_CASE("DWARF schema emits a matching abbrev and DIE body", "[ut][schema][dwarf]") {
+    std::vector<std::uint8_t> abbrev;
+    dw::Member::appendAbbrev(7, abbrev);
+    // code, tag, children, then the (attr, form) pairs
+    REQUIRE(abbrev.size() > 3);
+    CHECK(abbrev[0] == 7);
+    CHECK(abbrev[1] == 0x0d);
+    CHECK(abbrev[2] == 0);
+    IRBytes specs{abbrev.data() + 3, abbrev.size() - 3};
+    CHECK(dw::Member::matchesAbbrev(specs));
+    CHECK_FALSE(dw::BitfieldMember::matchesAbbrev(specs));
+
+    std::vector<std::uint8_t> die;
+    dw::Member::encode(7, {0x40u, 0x2010u, std::uint64_t(300)}, die);
+    REQUIRE(die[0] == 7);
+
+    dw::Member::Values v;
+    std::size_t used = 0;
+    REQUIRE(dw::Member::decode(IRBytes{die.data() + 1, die.size() - 1}, v, &used));
+    CHECK(used == die.size() - 1);
+    CHECK(std::get<dw::Member::Name>(v) == 0x40u);
+    CHECK(std::get<dw::Member::Type>(v) == 0x2010u);
+    CHECK(std::get<dw::Member::DataMemberLocation>(v) == 300);
+}
@@ -0,0 +1,256 @@
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pipeline/SpillStore.h"
+#include "pipeline/StreamingPipeline.h"
+
+namespace {
+
+// CU { locals pool, line table, inlinee table, one type, one symbol }
+//   Function "f" { Inlined scope }
+std::unique_ptr<IRScope> SampleUnit() {
+    auto cu = std::make_unique<IRScope>();
+    cu->name = "spill.cpp";
+    cu->declaredTypes = {3, 7};
+    cu->image = 3;
+
+    cu->locations = std::make_unique<IRLocationPool>();
+    const std::uint8_t reg[] = {0x50};
+    const std::uint8_t fbreg[] = {0x91, 0x70};
+    IRLocID l1 = cu->locations->intern(IRLocFormat::DwarfExpr, reg, sizeof(reg));
+    IRLocID l2 = cu->locations->intern(IRLocFormat::DwarfExpr, fbreg, sizeof(fbreg));
+    IRLiveRange ranges[] = {{0x1000, 0x1010, l1}, {0x1010, 0x1040, l2}};
+
+    cu->lines = std::make_unique<IRLineTable>();
+    cu->lines->files.push_back({"spill.cpp", 1, {0xab}});
+    cu->lines->appendRow(0x1000, 0, 10, 3, IRLineIsStmt);
+    cu->lines->appendRow(0x1008, 0, 11, 5, IRLineIsStmt);
+    cu->lines->endSequence(0, 0x1040);
+
+    cu->inlinees = std::make_unique<IRInlineeTable>();
+    IRInlineeID callee = cu->inlinees->intern(0x77, "callee", 9);
+    cu->inlinees->get(callee).declLine = 42;
+
+    IRSymbol global;
+    global.name = "a_rather_long_global_variable_name";
+    global.type = 3;
+    cu->declaredSymbols.push_back(global);
+
+    auto fn = std::make_unique<IRScope>();
+    fn->kind = IRScopeKind::Function;
+    fn->name = "f";
+    fn->lowPC = 0x1000;
+    fn->highPC = 0x1040;
+    fn->parent = cu.get();
+    IRSymbol local;
+    local.name = "x";
+    local.kind = IRSymbolKind::Parameter;
+    local.type = 7;
+    local.storage = cu->locations->addRanges(fn->lowPC, ranges, 2);
+    fn->declaredSymbols.push_back(local);
+
+    auto inl = std::make_unique<IRScope>();
+    inl->kind = IRScopeKind::Inlined;
+    inl->inlinee = callee;
+    inl->callFile = 0;
+    inl->callLine = 11;
+    inl->callColumn = 5;
+    inl->lowPC = 0x1008;
+    inl->highPC = 0x1010;
+    inl->parent = fn.get();
+    fn->children.push_back(std::move(inl));
+    cu->children.push_back(std::move(fn));
+    return cu;
+}
+
+} // namespace
+
+TEST_CASE("Spilled scopes decode to the same tree", "[ut][spill]") {
+    auto cu = SampleUnit();
+    std::vector<std::uint8_t> bytes;
+    EncodeSpill(*cu, bytes);
+
+    std::unique_ptr<IRScope> back;
+    DecodeSpill(IRBytes{bytes.data(), bytes.size()}, back);
+    REQUIRE(back);
+    CHECK(back->name == "spill.cpp");
+    CHECK(back->declaredTypes == cu->declaredTypes);
+    CHECK(back->image == 3);
+    CHECK(back->declaredSymbols[0].name == cu->declaredSymbols[0].name);
+    REQUIRE(back->children.size() == 1);
+    const IRScope& fn = *back->children[0];
+    CHECK(fn.parent == back.get());
+    CHECK(fn.kind == IRScopeKind::Function);
+    CHECK(fn.highPC == 0x1040);
+    REQUIRE(fn.children.size() == 1);
+    CHECK(fn.children[0]->kind == IRScopeKind::Inlined);
+    CHECK(fn.children[0]->callColumn == 5);
+
+    // Locations keep their IDs and range offsets.
+    REQUIRE(back->locations);
+    CHECK(back->locations->size() == 2);
+    IRBytes fb = back->locations->bytes(2);
+    CHECK(fb.size == 2);
+    CHECK(fb.data[0] == 0x91);
+    const std::uint8_t reg[] = {0x50};
+    CHECK(back->locations->intern(IRLocFormat::DwarfExpr, reg, 1) == 1);
+    auto cursor = back->locations->ranges(fn.declaredSymbols[0].storage, fn.lowPC);
+    IRLiveRange r;
+    REQUIRE(cursor.next(r));
+    REQUIRE(cursor.next(r));
+    CHECK(r.begin == 0x1010);
+    CHECK(r.end == 0x1040);
+    CHECK(r.loc == 2);
+
+    REQUIRE(back->lines);
+    CHECK(back->lines->rowCount() == 3);
+    CHECK(back->lines->files[0].checksum[0] == 0xab);
+    std::uint32_t row = 0, seqEnd = 0;
+    CHECK(back->lines->rowAt(0x100c, row, seqEnd));
+    CHECK(back->lines->line[row] == 11);
+
+    REQUIRE(back->inlinees);
+    CHECK(back->inlinees->find(0x77) == 1);
+    CHECK(back->inlinees->get(1).declLine == 42);
+
+    CHECK(FootprintOf(*cu) > sizeof(IRScope) * 3);
+
+    bytes.pop_back();
+    bool threw = false;
+    try {
+        DecodeSpill(IRBytes{bytes.data(), bytes.size()}, back);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST_CASE("Spilled models decode to the same tree", "[ut][spill]") {
+    PdbNode mod;
+    mod.leafKind = 0x113c;
+    mod.prettyName = "a.cpp";
+    mod.children.push_back(std::make_unique<PdbNode>());
+    mod.children[0]->leafKind = 0x1505;
+    mod.children[0]->payload = {1, 2, 3};
+    mod.children[0]->typeIndexOrSymOffset = 0x1000;
+    std::vector<std::uint8_t> pdbBytes;
+    EncodeSpill(mod, pdbBytes);
+    std::unique_ptr<PdbNode> pdbBack;
+    DecodeSpill(IRBytes{pdbBytes.data(), pdbBytes.size()}, pdbBack);
+    REQUIRE(pdbBack->children.size() == 1);
+    CHECK(pdbBack->prettyName == "a.cpp");
+    CHECK(pdbBack->children[0]->parent == pdbBack.get());
+    CHECK(pdbBack->children[0]->payload == mod.children[0]->payload);
+    CHECK(pdbBack->children[0]->typeIndexOrSymOffset == 0x1000);
+
+    DwarfNode cu;
+    cu.tag = 0x11;
+    cu.attrsStr.push_back({0x03, "a.cpp"});
+    cu.attrsU64.push_back({0x10, 0x1234567890ull});
+    cu.lineProgram = {9, 8, 7};
+    cu.children.push_back(std::make_unique<DwarfNode>());
+    cu.children[0]->tag = 0x13;
+    std::vector<std::uint8_t> dwarfBytes;
+    EncodeSpill(cu, dwarfBytes);
+    std::unique_ptr<DwarfNode> dwarfBack;
+    DecodeSpill(IRBytes{dwarfBytes.data(), dwarfBytes.size()}, dwarfBack);
+    CHECK(dwarfBack->attrsStr == cu.attrsStr);
+    CHECK(dwarfBack->attrsU64 == cu.attrsU64);
+    CHECK(dwarfBack->lineProgram == cu.lineProgram);
+    REQUIRE(dwarfBack->children.size() == 1);
+    CHECK(dwarfBack->children[0]->tag == 0x13);
+}
+
+TEST_CASE("SpillFile maps records written from several threads", "[ut][spill]") {
+    SpillFile file;
+    REQUIRE(file.ok());
+
+    // Odd sizes so records straddle page boundaries.
+    std::vector<SpillRef> refs(8);
+    std::vector<std::thread> writers;
+    for (std::size_t t = 0; t < refs.size(); ++t) {
+        writers.emplace_back([&, t] {
+            std::vector<std::uint8_t> rec(3001 * (t + 1), static_cast<std::uint8_t>(t + 1));
+            refs[t] = file.append(rec);
+        });
+    }
+    for (auto& w : writers) w.join();
+
+    for (std::size_t t = 0; t < refs.size(); ++t) {
+        SpillView view = file.map(refs[t]);
+        IRBytes b = view.bytes();
+        REQUIRE(b.size == 3001 * (t + 1));
+        bool allSame = true;
+        for (std::size_t i = 0; i < b.size; ++i) allSame &= b.data[i] == t + 1;
+        CHECK(allSame);
+        file.release(refs[t]);
+    }
+    CHECK(file.bytesWritten() == 3001u * 36);
+}
+
+TEST_CASE("MemoryBudget admits up to the limit", "[ut][spill]") {
+    MemoryBudget budget(1000);
+    budget.setPinned(0, 400);
+    CHECK(budget.admit(500));
+    CHECK_FALSE(budget.admit(200));
+    budget.setPinned(1, 50);
+    CHECK(budget.admit(50));
+    CHECK(budget.resident() == 1000);
+    budget.release(500);
+    budget.force(800);
+    CHECK(budget.resident() == 1300);
+    CHECK(budget.peak() == 1300);
+    CHECK_FALSE(MemoryBudget().enabled());
+}
+
+TEST_CASE("IRTypeTable keeps a running footprint of what it holds", "[ut][spill]") {
+    IRTypeTable table;
+    std::size_t empty = table.memoryBytes();
+    IRType* a = table.createType(IRTypeKind::StructOrUnion);
+    std::size_t created = table.memoryBytes();
+    CHECK(created >= empty + sizeof(IRType));
+
+    table.addField(a, IRField{"x", a->id, 0, 0, 0, false});
+    table.addField(a, IRField{std::string(100, 'n'), a->id, 8, 0, 0, false});
+    table.addDim(a, IRArrayDim{});
+    std::size_t filled = table.memoryBytes();
+    CHECK(filled >= created + 2 * sizeof(IRField) + sizeof(IRArrayDim) + 100);
+
+    IRTypeTable copy;
+    copy.createType(IRTypeKind::Unknown);
+    IRType* b = copy.createType(IRTypeKind::Unknown);
+    std::size_t before = copy.memoryBytes();
+    copy.copyType(b, *a);
+    CHECK(b->id == 2);
+    CHECK(b->fields.size() == 2);
+    CHECK(copy.memoryBytes() >= before + 2 * sizeof(IRField) + 100);
+}
+
+TEST_CASE("StreamingPipeline spills over a tiny budget and gives the same result", "[ut][spill][pipeline]") {
+    StreamingOptions unlimited;
+    StreamingOptions tiny;
+    tiny.maxMemory = 1;
+
+    IRTypeTable t1, t2;
+    IRMaps m1, m2;
+    StreamingPipeline plain(unlimited);
+    StreamingPipeline budgeted(tiny);
+    CHECK(plain.runDwarfToPdb("in.o", "out.pdb", t1, m1) == 1);
+    CHECK(budgeted.runDwarfToPdb("in.o", "out.pdb", t2, m2) == 1);
+    bool sameTIs = m1.irToPdbTI == m2.irToPdbTI;
+    CHECK(sameTIs);
+    CHECK(plain.spillStats().unitsSpilled == 0);
+    CHECK(budgeted.spillStats().unitsSpilled == 1);
+    CHECK(budgeted.spillStats().modelsSpilled == 1);
+    CHECK(budgeted.spillStats().bytesSpilled > 0);
+
+    IRTypeTable t3;
+    IRMaps m3;
+    CHECK(budgeted.runPdbToDwarf("in.pdb", "out.o", t3, m3) == 1);
+    CHECK(budgeted.spillStats().unitsSpilled == 1);
+    CHECK(!m3.irToDwarfDie.empty());
+}
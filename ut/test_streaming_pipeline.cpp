@@ -0,0 +1,90 @@
+#include <catch2/catch_all.hpp>
+#include <thread>
+#include "pipeline/BoundedQueue.h"
+#include "pipeline/StreamingPipeline.h"
+#include "pipeline/DwarfToPdb.h"
+#include "ir/IRTypeTable.h"
+#include "ir/IRMaps.h"
+
+TEST_CASE("BoundedQueue hands items over in order and drains after close", "[ut][pipeline]") {
+    BoundedQueue<int> q(2);
+
+    std::thread producer([&] {
+        for (int i = 0; i < 100; ++i) q.push(i);
+        q.close();
+    });
+
+    int expected = 0;
+    int v = -1;
+    while (q.pop(v)) {
+        CHECK(v == expected);
+        ++expected;
+    }
+    producer.join();
+
+    CHECK(expected == 100);
+    CHECK_FALSE(q.push(1)); // closed queues reject new work
+}
+
+TEST_CASE("DwarfToPdb::translateUnit assigns TIs per unit", "[ut][pipeline]") {
+    IRTypeTable typeTable;
+    IRMaps maps;
+
+    IRScope cu;
+    cu.name = "a.cpp";
+    IRType* s = typeTable.createType(IRTypeKind::StructOrUnion);
+    s->name = "S";
+    IRType* u = typeTable.createType(IRTypeKind::StructOrUnion);
+    u->name = "U";
+    u->isUnion = true;
+    cu.declaredTypes = {s->id, u->id};
+
+    DwarfToPdb d2p;
+    auto mod = d2p.translateUnit(cu, typeTable, maps);
+
+    REQUIRE(mod);
+    CHECK(mod->prettyName == "a.cpp");
+    REQUIRE(mod->children.size() == 2);
+    CHECK(mod->children[0]->leafKind == 0x1505); // LF_STRUCTURE
+    CHECK(mod->children[1]->leafKind == 0x1506); // LF_UNION
+    CHECK(maps.irToPdbTI.at(s->id) == 0x1000);
+    CHECK(maps.pdbTIToIR.at(0x1001) == u->id);
+}
+
+TEST_CASE("StreamingPipeline runs both directions end to end", "[ut][pipeline]") {
+    StreamingOptions opts;
+    opts.queueDepth = 1;
+    StreamingPipeline pipeline(opts);
+
+    {
+        IRTypeTable typeTable;
+        IRMaps maps;
+        CHECK(pipeline.runDwarfToPdb("in.o", "out.pdb", typeTable, maps) == 1);
+        CHECK(!maps.irToPdbTI.empty());
+    }
+    {
+        IRTypeTable typeTable;
+        IRMaps maps;
+        CHECK(pipeline.runPdbToDwarf("in.pdb", "out.o", typeTable, maps) == 1);
+        CHECK(!maps.irToDwarfDie.empty());
+    }
+}
+
+TEST_CASE("StreamingPipeline resolves forward decls of a PDB before translating", "[ut][pipeline][fwd]") {
+    // Types the TPI would hold: struct Node (decl and definition), Node*.
+    IRTypeTable typeTable;
+    IRType* decl = typeTable.createType(IRTypeKind::StructOrUnion);
+    decl->name = "Node";
+    decl->isForwardDecl = true;
+    IRType* def = typeTable.createType(IRTypeKind::StructOrUnion);
+    def->name = "Node";
+    def->sizeBytes = 16;
+    IRType* ptr = typeTable.createType(IRTypeKind::Pointer);
+    ptr->pointeeType = decl->id;
+    ptr->ptrSizeBytes = 8;
+
+    StreamingPipeline pipeline(StreamingOptions{});
+    IRMaps maps;
+    CHECK(pipeline.runPdbToDwarf("in.pdb", "out.o", typeTable, maps) == 1);
+    CHECK(ptr->pointeeType == def->id);
+}
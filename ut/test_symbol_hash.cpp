@@ -0,0 +1,261 @@
+#include <catch2/catch_all.hpp>
+#include <string>
+#include "pdb/PdbSymbolHash.h"
+#include "pdb/PdbWriter.h"
+#include "pdb/CodeViewSchema.h"
+
+namespace {
+
+std::uint32_t Get32(const std::vector<std::uint8_t>& b, std::size_t at) {
+    return b[at] | (b[at + 1] << 8) | (b[at + 2] << 16) | (std::uint32_t(b[at + 3]) << 24);
+}
+
+std::vector<PdbGlobalSymbol> MakePublics(std::size_t n) {
+    std::vector<PdbGlobalSymbol> pubs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        pubs[i].name = "fn_" + std::to_string(i * 7919 % n);
+        pubs[i].kind = S_PUB32;
+        pubs[i].segment = 1;
+        pubs[i].offset = static_cast<std::uint32_t>((n - i) * 16);
+    }
+    return pubs;
+}
+
+// Name of the record at 'symOffset' in the symbol record stream.
+std::string NameAt(const std::vector<std::uint8_t>& records, std::uint32_t symOffset) {
+    std::size_t len = records[symOffset] | (records[symOffset + 1] << 8);
+    cv::SPub32::Values v;
+    if (!cv::SPub32::decode(IRBytes{&records[symOffset], len + 2}, v)) return std::string();
+    return std::string(std::get<cv::SPub32::Name>(v));
+}
+
+} // namespace
+
+TEST_CASE("GSI buckets hold the names that hash into them", "[ut][pdb][gsi]") {
+    std::vector<PdbGlobalSymbol> pubs = MakePublics(20000);
+    PdbSymbolStreams s = BuildSymbolStreams({}, pubs, 4);
+
+    const std::size_t hashAt = 28; // after PublicsStreamHeader
+    const std::vector<std::uint8_t>& b = s.publics;
+    CHECK(Get32(b, 0) > 0);
+    CHECK(Get32(b, 4) == pubs.size() * 4);
+    CHECK(Get32(b, hashAt) == 0xFFFFFFFF);
+    CHECK(Get32(b, hashAt + 4) == 0xEFFE0000 + 19990810);
+    std::uint32_t hrSize = Get32(b, hashAt + 8);
+    REQUIRE(hrSize == pubs.size() * 8);
+
+    const std::size_t recordsAt = hashAt + 16;
+    const std::size_t bitmapAt = recordsAt + hrSize;
+    const std::size_t bucketsAt = bitmapAt + (IPHR_HASH + 32) / 32 * 4;
+
+    // Walk the non-empty buckets; every record in one must hash there.
+    std::size_t nonEmpty = 0;
+    std::vector<std::uint32_t> starts;
+    std::vector<std::uint32_t> bucketIds;
+    for (std::uint32_t bucket = 0; bucket < IPHR_HASH; ++bucket) {
+        if (!(Get32(b, bitmapAt + bucket / 32 * 4) & (1u << (bucket % 32)))) continue;
+        starts.push_back(Get32(b, bucketsAt + nonEmpty * 4) / 12);
+        bucketIds.push_back(bucket);
+        ++nonEmpty;
+    }
+    starts.push_back(static_cast<std::uint32_t>(pubs.size()));
+    REQUIRE(nonEmpty > 0);
+
+    bool allInPlace = true;
+    bool ordered = true;
+    for (std::size_t k = 0; k < nonEmpty; ++k) {
+        std::string prev;
+        for (std::uint32_t r = starts[k]; r < starts[k + 1]; ++r) {
+            std::uint32_t off = Get32(b, recordsAt + r * 8) - 1;
+            std::string name = NameAt(s.symbolRecords, off);
+            if (HashStringV1(name) % IPHR_HASH != bucketIds[k]) allInPlace = false;
+            if (r > starts[k] && GsiRecordCompare(prev, name) > 0) ordered = false;
+            prev = name;
+        }
+    }
+    CHECK(allInPlace);
+    CHECK(ordered);
+}
+
+TEST_CASE("PSI address map is sorted and independent of jobs", "[ut][pdb][gsi]") {
+    std::vector<PdbGlobalSymbol> pubs = MakePublics(30000);
+    PdbSymbolStreams one = BuildSymbolStreams({}, pubs, 1);
+    PdbSymbolStreams many = BuildSymbolStreams({}, pubs, 8);
+    CHECK(one.publics == many.publics);
+    CHECK(one.symbolRecords == many.symbolRecords);
+
+    std::size_t mapAt = 28 + Get32(one.publics, 0);
+    std::uint32_t prevOffset = 0;
+    bool sorted = true;
+    for (std::size_t i = 0; i < pubs.size(); ++i) {
+        std::uint32_t sym = Get32(one.publics, mapAt + i * 4);
+        std::size_t len = one.symbolRecords[sym] | (one.symbolRecords[sym + 1] << 8);
+        cv::SPub32::Values v;
+        REQUIRE(cv::SPub32::decode(IRBytes{&one.symbolRecords[sym], len + 2}, v));
+        if (std::get<cv::SPub32::Offset>(v) < prevOffset) sorted = false;
+        prevOffset = std::get<cv::SPub32::Offset>(v);
+    }
+    CHECK(sorted);
+}
+
+TEST_CASE("PdbWriter collects globals and publics from declared symbols", "[ut][pdb][gsi]") {
+    IRMaps maps;
+    maps.irToPdbTI.set(7, 0x1003);
+
+    IRScope cu;
+    cu.name = "a.cpp";
+    cu.locations = std::make_unique<IRLocationPool>();
+    auto addrLoc = [&](std::uint64_t addr) {
+        std::uint8_t expr[9] = {0x03};
+        for (int i = 0; i < 8; ++i) expr[1 + i] = (addr >> (8 * i)) & 0xff;
+        return cu.locations->intern(IRLocFormat::DwarfExpr, expr, sizeof(expr));
+    };
+
+    IRSymbol counter{"counter", IRSymbolKind::Variable, 7, {}};
+    counter.storage.loc = addrLoc(0x4000);
+    IRSymbol externDecl{"elsewhere", IRSymbolKind::Variable, 7, {}}; // no address
+    cu.declaredSymbols = {counter, externDecl, {"main", IRSymbolKind::Function, 0, {}}};
+
+    auto fn = std::make_unique<IRScope>();
+    fn->kind = IRScopeKind::Function;
+    fn->name = "main";
+    fn->lowPC = 0x1000;
+    fn->highPC = 0x1040;
+    IRSymbol local{"tmp", IRSymbolKind::Variable, 7, {}};
+    local.storage.loc = addrLoc(0x5000); // locals never become globals
+    fn->declaredSymbols = {local};
+    cu.children.push_back(std::move(fn));
+
+    auto ns = std::make_unique<IRScope>();
+    ns->kind = IRScopeKind::Namespace;
+    ns->name = "util";
+    IRSymbol nsVar{"table", IRSymbolKind::Variable, 7, {}};
+    nsVar.storage.loc = addrLoc(0x4100);
+    ns->declaredSymbols = {nsVar};
+    auto statics = std::make_unique<IRScope>();
+    statics->kind = IRScopeKind::FileStatic;
+    IRSymbol st{"hidden", IRSymbolKind::Variable, 7, {}};
+    st.storage.loc = addrLoc(0x4200);
+    statics->declaredSymbols = {st};
+    ns->children.push_back(std::move(statics));
+    cu.children.push_back(std::move(ns));
+
+    PdbWriter writer(2);
+    writer.beginStreaming("out.pdb");
+    writer.addUnitSymbols(cu, maps);
+    writer.addUnitSymbols(cu, maps); // a second unit with the same publics
+    writer.finishStreaming();
+
+    const PdbSymbolStreams& s = writer.symbolStreams();
+    // globals: counter, util::table once, util::hidden (file static, x2
+    // units); publics deduped: counter, main, util::table.
+    std::vector<std::string> names;
+    std::vector<std::uint16_t> kinds;
+    for (std::size_t at = 0; at + 4 <= s.symbolRecords.size();) {
+        std::size_t len = s.symbolRecords[at] | (s.symbolRecords[at + 1] << 8);
+        std::uint16_t kind = s.symbolRecords[at + 2] | (s.symbolRecords[at + 3] << 8);
+        kinds.push_back(kind);
+        IRBytes rec{&s.symbolRecords[at], len + 2};
+        if (kind == S_PUB32) {
+            cv::SPub32::Values v;
+            REQUIRE(cv::SPub32::decode(rec, v));
+            names.emplace_back(std::get<cv::SPub32::Name>(v));
+        } else {
+            bool known = cv::Dispatch<cv::SGData32, cv::SLData32>(kind, [&](auto r) {
+                using Rec = decltype(r);
+                typename Rec::Values v;
+                REQUIRE(Rec::decode(rec, v));
+                CHECK(std::get<Rec::Type>(v) == 0x1003);
+                names.emplace_back(std::get<Rec::Name>(v));
+            });
+            CHECK(known);
+        }
+        at += len + 2;
+    }
+    REQUIRE(names.size() == 7);
+    CHECK(names[0] == "counter");
+    CHECK(names[1] == "util::table");
+    CHECK(names[2] == "util::hidden");
+    CHECK(kinds[2] == S_LDATA32);
+    CHECK(names[3] == "util::hidden");
+    CHECK(names[4] == "counter");
+    CHECK(names[5] == "main");
+    CHECK(names[6] == "util::table");
+}
+
+TEST_CASE("PdbWriter gives every merged image its own section", "[ut][pdb][gsi][merge]") {
+    IRMaps maps;
+    auto unitOf = [](std::uint16_t image, const char* name, IRSymbolKind kind, std::uint64_t addr) {
+        IRScope cu;
+        cu.image = image;
+        cu.locations = std::make_unique<IRLocationPool>();
+        std::uint8_t expr[9] = {0x03};
+        for (int i = 0; i < 8; ++i) expr[1 + i] = (addr >> (8 * i)) & 0xff;
+        IRSymbol sym{name, kind, 0, {}};
+        sym.storage.loc = cu.locations->intern(IRLocFormat::DwarfExpr, expr, sizeof(expr));
+        cu.declaredSymbols = {sym};
+        return cu;
+    };
+    const IRSymbolKind var = IRSymbolKind::Variable, fn = IRSymbolKind::Function;
+    // Both images put their own variable at 0x4000 and export a DllMain.
+    // 'shared' comes from a header: two units of image 0 repeat it (kept
+    // once), and image 1 has its own instance (kept too).
+    IRScope a = unitOf(0, "only_a", var, 0x4000), b = unitOf(1, "only_b", var, 0x4000);
+    IRScope sharedA = unitOf(0, "shared", var, 0x5000), sharedA2 = unitOf(0, "shared", var, 0x5000);
+    IRScope sharedB = unitOf(1, "shared", var, 0x6000);
+    IRScope mainA = unitOf(0, "DllMain", fn, 0x1000), mainB = unitOf(1, "DllMain", fn, 0x2000);
+
+    PdbWriter writer(2);
+    writer.beginStreaming("merged.pdb");
+    for (const IRScope* unit : {&a, &sharedA, &mainA, &sharedA2, &b, &sharedB, &mainB}) {
+        writer.addUnitSymbols(*unit, maps);
+    }
+    writer.finishStreaming();
+
+    const PdbSymbolStreams& s = writer.symbolStreams();
+    std::vector<std::string> names, pubNames;
+    std::vector<std::uint16_t> segments, pubSegments;
+    std::vector<std::uint32_t> offsets, pubOffsets;
+    for (std::size_t at = 0; at + 4 <= s.symbolRecords.size();) {
+        std::size_t len = s.symbolRecords[at] | (s.symbolRecords[at + 1] << 8);
+        std::uint16_t kind = s.symbolRecords[at + 2] | (s.symbolRecords[at + 3] << 8);
+        IRBytes rec{&s.symbolRecords[at], len + 2};
+        cv::SGData32::Values v;
+        cv::SPub32::Values pub;
+        if (kind == S_GDATA32 && cv::SGData32::decode(rec, v)) {
+            names.emplace_back(std::get<cv::SGData32::Name>(v));
+            segments.push_back(std::get<cv::SGData32::Segment>(v));
+            offsets.push_back(std::get<cv::SGData32::Offset>(v));
+        } else if (kind == S_PUB32 && cv::SPub32::decode(rec, pub)) {
+            pubNames.emplace_back(std::get<cv::SPub32::Name>(pub));
+            pubSegments.push_back(std::get<cv::SPub32::Segment>(pub));
+            pubOffsets.push_back(std::get<cv::SPub32::Offset>(pub));
+        }
+        at += len + 2;
+    }
+    REQUIRE(names.size() == 4);
+    CHECK(names[0] == "only_a");
+    CHECK(segments[0] == 1);
+    CHECK(names[1] == "shared");
+    CHECK(segments[1] == 1);
+    CHECK(offsets[1] == 0x5000);
+    CHECK(names[2] == "only_b");
+    CHECK(segments[2] == 2);
+    CHECK(offsets[2] == 0x4000);
+    CHECK(names[3] == "shared");
+    CHECK(segments[3] == 2);
+    CHECK(offsets[3] == 0x6000);
+
+    // Publics: only_a, shared, DllMain per image.
+    REQUIRE(pubNames.size() == 6);
+    int dllMains = 0, sharedPubs = 0;
+    for (std::size_t i = 0; i < pubNames.size(); ++i) {
+        if (pubNames[i] == "DllMain") {
+            ++dllMains;
+            CHECK(pubOffsets[i] == (pubSegments[i] == 1 ? 0x1000u : 0x2000u));
+        }
+        if (pubNames[i] == "shared") ++sharedPubs;
+    }
+    CHECK(dllMains == 2);
+    CHECK(sharedPubs == 2);
+}
@@ -0,0 +1,162 @@
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ir/IRTypeMerge.h"
+#include "pipeline/StreamingPipeline.h"
+
+namespace {
+
+struct Module {
+    IRTypeTable table;
+    IRTypeID intType = 0, node = 0, nodePtr = 0, extra = 0;
+};
+
+// int; struct Node { Node* next; int v; }; Node*; plus one struct named
+// 'extra' of 'extraSize' bytes. 'reversed' creates them in another order.
+void BuildModule(Module& m, bool reversed, const std::string& extra, std::uint64_t extraSize) {
+    IRType* t[4] = {};
+    IRTypeKind kinds[4] = {IRTypeKind::Unknown, IRTypeKind::StructOrUnion, IRTypeKind::Pointer,
+                           IRTypeKind::StructOrUnion};
+    for (int i = 0; i < 4; ++i) {
+        int role = reversed ? 3 - i : i;
+        t[role] = m.table.createType(kinds[role]);
+    }
+    t[0]->name = "int";
+    t[0]->sizeBytes = 4;
+    t[1]->name = "Node";
+    t[1]->sizeBytes = 16;
+    t[1]->fields = {{"next", t[2]->id, 0}, {"v", t[0]->id, 8}};
+    t[2]->pointeeType = t[1]->id;
+    t[2]->ptrSizeBytes = 8;
+    t[3]->name = extra;
+    t[3]->sizeBytes = extraSize;
+    t[3]->fields = {{"head", t[2]->id, 0}};
+    m.intType = t[0]->id;
+    m.node = t[1]->id;
+    m.nodePtr = t[2]->id;
+    m.extra = t[3]->id;
+}
+
+// struct Link { Link'* next; } repeated 'depth' times; the last one points
+// at a leaf type called 'leaf'. Only the leaf tells two chains apart.
+IRTypeID BuildChain(IRTypeTable& table, int depth, const std::string& leaf) {
+    IRType* end = table.createType(IRTypeKind::Unknown);
+    end->name = leaf;
+    end->sizeBytes = 4;
+    IRTypeID next = end->id;
+    for (int i = 0; i < depth; ++i) {
+        IRType* ptr = table.createType(IRTypeKind::Pointer);
+        ptr->pointeeType = next;
+        ptr->ptrSizeBytes = 8;
+        IRType* link = table.createType(IRTypeKind::StructOrUnion);
+        link->name = "Link";
+        link->sizeBytes = 8;
+        link->fields = {{"next", ptr->id, 0}};
+        next = link->id;
+    }
+    return next;
+}
+
+} // namespace
+
+TEST_CASE("Type merge stores types shared between inputs once", "[ut][merge]") {
+    Module a, b, c;
+    BuildModule(a, false, "OnlyA", 8);
+    BuildModule(b, true, "OnlyB", 8);
+    BuildModule(c, false, "OnlyA", 8);
+    std::vector<IRTypeTable*> inputs = {&a.table, &b.table, &c.table};
+
+    IRTypeTable merged, mergedSerial;
+    IRTypeMerge m = MergeTypeTables(inputs, merged, 8);
+    IRTypeMerge serial = MergeTypeTables(inputs, mergedSerial, 1);
+
+    CHECK(m.typesIn == 12);
+    CHECK(m.typesOut == 5); // int, Node, Node*, OnlyA, OnlyB
+    CHECK(m.rounds >= 1);
+    bool sameRemap = m.remap == serial.remap;
+    CHECK(sameRemap);
+
+    IRTypeID node = m.remap[0][a.node];
+    CHECK(m.remap[1][b.node] == node);
+    CHECK(m.remap[2][c.node] == node);
+    CHECK(m.remap[2][c.extra] == m.remap[0][a.extra]);
+    CHECK(m.remap[1][b.extra] != m.remap[0][a.extra]);
+
+    const IRType* n = merged.lookup(node);
+    REQUIRE(n != nullptr);
+    CHECK(n->id == node);
+    CHECK(n->name.str() == "Node");
+    CHECK(n->fields[0].type == m.remap[0][a.nodePtr]);
+    CHECK(n->fields[1].type == m.remap[1][b.intType]);
+    CHECK(merged.lookup(n->fields[0].type)->pointeeType == node);
+}
+
+TEST_CASE("Type merge tells apart types that differ deep down", "[ut][merge]") {
+    IRTypeTable a, b, c;
+    IRTypeID headA = BuildChain(a, 12, "int");
+    IRTypeID headB = BuildChain(b, 12, "long");
+    IRTypeID headC = BuildChain(c, 12, "int");
+
+    IRTypeTable merged;
+    IRTypeMerge m = MergeTypeTables({&a, &b, &c}, merged, 4);
+    CHECK(m.remap[0][headA] != m.remap[1][headB]);
+    CHECK(m.remap[0][headA] == m.remap[2][headC]);
+    CHECK(m.typesOut == 2 * (1 + 2 * 12));
+    CHECK(m.rounds > 12);
+
+    // No depth is too deep to tell apart.
+    IRTypeTable deepA, deepB, deepMerged;
+    IRTypeID deepHeadA = BuildChain(deepA, 100, "int");
+    IRTypeID deepHeadB = BuildChain(deepB, 100, "long");
+    IRTypeMerge deep = MergeTypeTables({&deepA, &deepB}, deepMerged, 4);
+    CHECK(deep.remap[0][deepHeadA] != deep.remap[1][deepHeadB]);
+    CHECK(deep.typesOut == 2 * (1 + 2 * 100));
+}
+
+TEST_CASE("Merged scopes drop duplicate declared types", "[ut][merge]") {
+    IRScope unit;
+    unit.declaredTypes = {3, 1, 2, 7};
+    IRSymbol sym;
+    sym.name = "x";
+    sym.type = 2;
+    unit.declaredSymbols.push_back(sym);
+    auto fn = std::make_unique<IRScope>();
+    fn->kind = IRScopeKind::Function;
+    fn->declaredSymbols.push_back(sym);
+    unit.children.push_back(std::move(fn));
+
+    RemapScopeTypes(unit, {0, 5, 6, 5});
+    std::vector<IRTypeID> expected = {5, 6};
+    CHECK(unit.declaredTypes == expected); // 7 was never mapped
+    CHECK(unit.declaredSymbols[0].type == 6);
+    CHECK(unit.children[0]->declaredSymbols[0].type == 6);
+}
+
+TEST_CASE("StreamingPipeline merges several inputs into one output", "[ut][merge][pipeline]") {
+    std::vector<std::string> objects = {"a.o", "b.o", "c.o"};
+    StreamingOptions opts;
+    opts.jobs = 3;
+    StreamingPipeline pipeline(opts);
+
+    IRTypeTable typeTable;
+    IRMaps maps;
+    CHECK(pipeline.mergeDwarfToPdb(objects, "merged.pdb", typeTable, maps) == 3);
+    const MergeStats& info = pipeline.mergeStats();
+    CHECK(info.inputs == 3);
+    CHECK(info.units == 3);
+    CHECK(info.typesIn == 3);
+    CHECK(info.typesOut == 1); // every stub input declares the same struct
+    CHECK(maps.irToPdbTI.size() == 1);
+    CHECK(maps.dwarfDieToIR.empty());
+
+    StreamingOptions tiny = opts;
+    tiny.maxMemory = 1;
+    StreamingPipeline budgeted(tiny);
+    IRTypeTable dwarfTypes;
+    IRMaps dwarfMaps;
+    CHECK(budgeted.mergePdbToDwarf({"a.pdb", "b.pdb"}, "merged.o", dwarfTypes, dwarfMaps) == 2);
+    CHECK(budgeted.mergeStats().typesOut == 1);
+    CHECK(budgeted.spillStats().unitsSpilled == 2);
+    CHECK(dwarfMaps.irToDwarfDie.size() == 1);
+}
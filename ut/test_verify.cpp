@@ -0,0 +1,293 @@
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "dwarf/DwarfSchema.h"
+#include "dwarf/DwarfVerifier.h"
+#include "pdb/CodeViewSchema.h"
+#include "pdb/PdbVerifier.h"
+#include "pipeline/OutputVerify.h"
+
+namespace {
+
+using Bytes = std::vector<std::uint8_t>;
+
+void Put(Bytes& out, std::uint64_t v, unsigned size) {
+    for (unsigned i = 0; i < size; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void Patch(Bytes& out, std::size_t at, std::uint64_t v, unsigned size) {
+    for (unsigned i = 0; i < size; ++i) out[at + i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+IRBytes View(const Bytes& b) { return IRBytes{b.data(), b.size()}; }
+
+// code 1: compile_unit, children, name:string
+// code 2: structure_type, name:strp
+// code 3: pointer_type, type:ref4
+// code 4: pointer_type, type:ref_addr
+Bytes Abbrevs() {
+    return {1, 0x11, 1, 0x03, 0x08, 0, 0,
+            2, 0x13, 0, 0x03, 0x0e, 0, 0,
+            3, 0x0f, 0, 0x49, 0x13, 0, 0,
+            4, 0x0f, 0, 0x49, 0x10, 0, 0,
+            0};
+}
+
+// One v4 unit: CU { struct; pointer -> struct (or 'refTo' if set) }.
+// Returns the unit-relative offset of the struct DIE through 'structDie'.
+Bytes Unit(std::uint64_t* structDie = nullptr, std::uint32_t refTo = 0, bool terminate = true) {
+    Bytes u;
+    Put(u, 0, 4);       // length, patched below
+    Put(u, 4, 2);       // version
+    Put(u, 0, 4);       // abbrev offset
+    Put(u, 8, 1);       // address size
+    u.insert(u.end(), {1, 'c', 'u', 0});
+    std::uint64_t die = u.size();
+    if (structDie) *structDie = die;
+    u.push_back(2);
+    Put(u, 0, 4);       // strp
+    u.push_back(3);
+    Put(u, refTo ? refTo : die, 4);
+    if (terminate) u.push_back(0);
+    Patch(u, 0, u.size() - 4, 4);
+    return u;
+}
+
+DwarfSections Sections(const Bytes& info, const Bytes& abbrev, const Bytes& str) {
+    DwarfSections s;
+    s.info = View(info);
+    s.abbrev = View(abbrev);
+    s.str = View(str);
+    return s;
+}
+
+bool Mentions(const VerifyReport& r, const std::string& text) {
+    for (const auto& p : r.problems) {
+        if (p.message.find(text) != std::string::npos) return true;
+    }
+    return false;
+}
+
+// Minimal MSF: block 0 superblock, 1/2 FPM, 3 block map, 4 directory,
+// streams 0 and 1 empty, stream 2 = 'tpi' from block 5 on.
+Bytes Msf(const Bytes& tpi) {
+    const std::uint32_t bs = 512;
+    const std::uint32_t tpiBlocks = static_cast<std::uint32_t>((tpi.size() + bs - 1) / bs);
+    const std::uint32_t numBlocks = 5 + tpiBlocks;
+
+    Bytes dir;
+    Put(dir, 3, 4);
+    Put(dir, 0, 4);
+    Put(dir, 0, 4);
+    Put(dir, tpi.size(), 4);
+    for (std::uint32_t i = 0; i < tpiBlocks; ++i) Put(dir, 5 + i, 4);
+
+    Bytes file(std::size_t(numBlocks) * bs, 0);
+    static const char magic[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0";
+    std::memcpy(file.data(), magic, sizeof(magic));
+    Patch(file, 32, bs, 4);
+    Patch(file, 36, 1, 4);
+    Patch(file, 40, numBlocks, 4);
+    Patch(file, 44, dir.size(), 4);
+    Patch(file, 52, 3, 4);
+    // FPM: blocks past the end are free, every used one is not.
+    for (std::uint32_t b = numBlocks; b < bs * 8; ++b) file[bs + b / 8] |= std::uint8_t(1u << (b % 8));
+    Patch(file, 3 * bs, 4, 4);
+    std::memcpy(file.data() + 4 * bs, dir.data(), dir.size());
+    std::memcpy(file.data() + 5 * bs, tpi.data(), tpi.size());
+    return file;
+}
+
+// TPI: 0x1000 fwd "Node", 0x1001 Node*, 0x1002 Node (definition unless
+// 'dropDefinition'), 0x1003 pointer to 'lastReferent'.
+Bytes Tpi(bool dropDefinition, std::uint32_t lastReferent) {
+    Bytes recs;
+    cv::LfStructure::encode({std::uint16_t(0), std::uint16_t(0x280), 0u, 0u, 0u,
+                             std::uint64_t(0), "Node", ".?AUNode@@"}, recs);
+    cv::LfPointer::encode({0x1000u, 0x1000cu}, recs);
+    cv::LfStructure::encode({std::uint16_t(1), std::uint16_t(0x200), 0u, 0u, 0u, std::uint64_t(8),
+                             "Node", dropDefinition ? ".?AUOther@@" : ".?AUNode@@"}, recs);
+    cv::LfPointer::encode({lastReferent, 0x1000cu}, recs);
+
+    Bytes tpi;
+    Put(tpi, 20040203, 4);
+    Put(tpi, 56, 4);
+    Put(tpi, 0x1000, 4);
+    Put(tpi, 0x1004, 4);
+    Put(tpi, recs.size(), 4);
+    Put(tpi, 0xffff, 2);  // no hash stream
+    Put(tpi, 0xffff, 2);
+    tpi.resize(56, 0);
+    tpi.insert(tpi.end(), recs.begin(), recs.end());
+    return tpi;
+}
+
+} // namespace
+
+TEST_CASE("DWARF verifier accepts well-formed units", "[ut][verify][dwarf]") {
+    std::uint64_t structDie = 0;
+    Bytes info = Unit(&structDie);
+    Bytes second = Unit();
+    info.insert(info.end(), second.begin(), second.end());
+    Bytes abbrev = Abbrevs();
+    Bytes str = {'N', 'o', 'd', 'e', 0};
+
+    IRMaps maps;
+    maps.irToDwarfDie.set(1, structDie);
+    VerifyReport r = VerifyDwarf(Sections(info, abbrev, str), &maps, 4);
+    CHECK(r.ok());
+    CHECK(r.itemsChecked == 1 + 2 * 3 + 2); // table + DIEs + units
+
+    maps.irToDwarfDie.set(2, structDie + 1);
+    VerifyReport withMaps = VerifyDwarf(Sections(info, abbrev, str), &maps, 4);
+    CHECK(withMaps.problemCount == 1);
+    CHECK(Mentions(withMaps, "not a DIE"));
+}
+
+TEST_CASE("DWARF verifier reports bad references and framing", "[ut][verify][dwarf]") {
+    Bytes abbrev = Abbrevs();
+    Bytes str = {'N', 0};
+
+    std::uint64_t structDie = 0;
+    Bytes info = Unit(&structDie, /*refTo=*/0);
+    Bytes badRef = Unit(nullptr, static_cast<std::uint32_t>(structDie + 1));
+    VerifyReport r1 = VerifyDwarf(Sections(badRef, abbrev, str), nullptr);
+    CHECK(Mentions(r1, "is not a DIE in this unit"));
+
+    Bytes open = Unit(nullptr, 0, /*terminate=*/false);
+    VerifyReport r2 = VerifyDwarf(Sections(open, abbrev, str), nullptr);
+    CHECK(Mentions(r2, "not terminated"));
+
+    Bytes noStr;
+    VerifyReport r3 = VerifyDwarf(Sections(info, abbrev, noStr), nullptr);
+    CHECK(Mentions(r3, "past the end of .debug_str"));
+
+    Bytes truncated(info.begin(), info.end() - 3);
+    VerifyReport r4 = VerifyDwarf(Sections(truncated, abbrev, str), nullptr);
+    CHECK(Mentions(r4, "past the end of .debug_info"));
+
+    // DW_AT_name with a reference form; unknown form 0x7f.
+    Bytes badAbbrev = {1, 0x11, 1, 0x03, 0x13, 0, 0, 2, 0x13, 0, 0x03, 0x7f, 0, 0, 0};
+    VerifyReport r5 = VerifyDwarf(Sections(info, badAbbrev, str), nullptr);
+    CHECK(Mentions(r5, "cannot use form"));
+    CHECK(Mentions(r5, "unknown form"));
+}
+
+TEST_CASE("DWARF verifier checks ref_addr across units", "[ut][verify][dwarf]") {
+    Bytes abbrev = Abbrevs();
+    Bytes str = {'N', 0};
+    std::uint64_t structDie = 0;
+    Bytes info = Unit(&structDie);
+
+    // Second unit: CU { pointer -> ref_addr }.
+    auto crossUnit = [&](std::uint64_t target) {
+        Bytes u;
+        Put(u, 0, 4);
+        Put(u, 4, 2);
+        Put(u, 0, 4);
+        Put(u, 8, 1);
+        u.insert(u.end(), {1, 'b', 0, 4});
+        Put(u, target, 4);
+        u.push_back(0);
+        Patch(u, 0, u.size() - 4, 4);
+        Bytes all = info;
+        all.insert(all.end(), u.begin(), u.end());
+        return all;
+    };
+    Bytes good = crossUnit(structDie);
+    Bytes bad = crossUnit(structDie + 2);
+    CHECK(VerifyDwarf(Sections(good, abbrev, str), nullptr, 2).ok());
+    VerifyReport r = VerifyDwarf(Sections(bad, abbrev, str), nullptr, 2);
+    CHECK(r.problemCount == 1);
+    CHECK(Mentions(r, "DW_FORM_ref_addr"));
+}
+
+TEST_CASE("DWARF verifier decodes schema-shaped DIEs in one pass", "[ut][verify][dwarf]") {
+    // CU { struct { member -> struct }; pointer -> 'pointee' }, with the
+    // struct, member and pointer abbrevs written from their dw:: schemas.
+    Bytes abbrev = {1, 0x11, 1, 0x03, 0x08, 0, 0};
+    dw::StructureType::appendAbbrev(2, abbrev);
+    dw::Member::appendAbbrev(3, abbrev);
+    dw::PointerType::appendAbbrev(4, abbrev);
+    abbrev.push_back(0);
+    Bytes str = {'S', 0, 'm', 0};
+
+    auto unit = [](std::uint8_t addrSize, std::uint32_t memberName, std::int64_t pointeeDelta) {
+        Bytes u;
+        Put(u, 0, 4);
+        Put(u, 4, 2);
+        Put(u, 0, 4);
+        Put(u, addrSize, 1);
+        u.insert(u.end(), {1, 'c', 0});
+        std::uint32_t s = static_cast<std::uint32_t>(u.size());
+        dw::StructureType::encode(2, {0u, std::uint64_t(8), std::uint64_t(1), std::uint64_t(3)}, u);
+        dw::Member::encode(3, {memberName, s, std::uint64_t(0)}, u);
+        u.push_back(0);
+        dw::PointerType::encode(4, {std::uint8_t(8), static_cast<std::uint32_t>(s + pointeeDelta)}, u);
+        u.push_back(0);
+        Patch(u, 0, u.size() - 4, 4);
+        return u;
+    };
+
+    VerifyReport good = VerifyDwarf(Sections(unit(8, 2, 0), abbrev, str), nullptr);
+    CHECK(good.ok());
+    CHECK(good.itemsChecked == 1 + 4 + 1); // table + DIEs + unit
+
+    VerifyReport bad = VerifyDwarf(Sections(unit(8, 9, 1), abbrev, str), nullptr);
+    CHECK(bad.problemCount == 2);
+    CHECK(Mentions(bad, "past the end of .debug_str"));
+    CHECK(Mentions(bad, "is not a DIE in this unit"));
+
+    // 4-byte addresses take the form-by-form walk and find the same.
+    VerifyReport narrow = VerifyDwarf(Sections(unit(4, 9, 1), abbrev, str), nullptr);
+    CHECK(narrow.problemCount == 2);
+    CHECK(VerifyDwarf(Sections(unit(4, 2, 0), abbrev, str), nullptr).ok());
+}
+
+TEST_CASE("PDB verifier checks MSF layout and TPI records", "[ut][verify][pdb]") {
+    Bytes good = Msf(Tpi(false, 0x1002));
+    IRMaps maps;
+    maps.irToPdbTI.set(1, 0x1002);
+    VerifyReport ok = VerifyPdb(View(good), &maps, 4);
+    CHECK(ok.ok());
+    CHECK(ok.itemsChecked == 3 + 4); // streams + type records
+
+    maps.irToPdbTI.set(2, 0x1010);
+    CHECK(Mentions(VerifyPdb(View(good), &maps), "past the TPI range"));
+
+    CHECK(ok.opaqueDecls == 0);
+
+    // An opaque type ('struct Node;' only used through pointers) is legal.
+    VerifyReport opaque = VerifyPdb(View(Msf(Tpi(true, 0x1002))), nullptr);
+    CHECK(opaque.ok());
+    CHECK(opaque.opaqueDecls == 1);
+    CHECK(Mentions(VerifyPdb(View(Msf(Tpi(false, 0x1003))), nullptr), "is not before"));
+
+    // Stream 2's block claimed twice and marked free.
+    Bytes reused = good;
+    Patch(reused, 4 * 512 + 16, 4, 4);
+    VerifyReport r = VerifyPdb(View(reused), nullptr);
+    CHECK(Mentions(r, "reuses block 4"));
+
+    Bytes freed = good;
+    freed[512] |= 1u << 5;
+    CHECK(Mentions(VerifyPdb(View(freed), nullptr), "marked free"));
+
+    Bytes notMsf(1024, 0);
+    CHECK(Mentions(VerifyPdb(View(notMsf), nullptr), "not an MSF"));
+}
+
+TEST_CASE("Output verification reads files from disk", "[ut][verify]") {
+    Bytes pdb = Msf(Tpi(false, 0x1002));
+    {
+        std::ofstream out("verify_ut.pdb", std::ios::binary);
+        out.write(reinterpret_cast<const char*>(pdb.data()), static_cast<std::streamsize>(pdb.size()));
+    }
+    CHECK(VerifyPdbOutput("verify_ut.pdb", nullptr).ok());
+    CHECK(Mentions(VerifyDwarfOutput("verify_ut.pdb", nullptr), "not an ELF"));
+    CHECK(Mentions(VerifyPdbOutput("verify_ut_missing.pdb", nullptr), "cannot read"));
+    std::remove("verify_ut.pdb");
+}